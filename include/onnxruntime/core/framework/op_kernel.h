@@ -130,6 +130,22 @@ class OpKernel {
     return Status::OK();
   }
 
+  // Override this function to restore the state PrePack() keeps besides the pre-packed buffers (e.g. the shape of
+  // the packed weight) when the pre-packed buffers of the same weight were found in a cache, so that the weight does
+  // not need to be packed again. The buffers are then provided to UseSharedPrePackedBuffers() and PrePack() is not
+  // called for this input.
+  // @param tensor: The initialized constant tensor
+  // @param input_idx: The input index of the tensor in this kernel
+  // @param prepacked_buffer_sizes: The sizes of the cached pre-packed buffers, in the order PrePack() stored them
+  // @param is_restored: Set it to true if the kernel restored its state for the cached buffers or to false
+  //                     to have PrePack() called instead.
+  virtual Status RestorePrePackedState(const Tensor& /*tensor*/, int /*input_idx*/,
+                                       gsl::span<const size_t> /*prepacked_buffer_sizes*/,
+                                       /*out*/ bool& is_restored) {
+    is_restored = false;
+    return Status::OK();
+  }
+
   const OrtDevice GetDevice(OrtMemType mem_type) const;
   const OpKernelInfo& Info() const {
     return *op_kernel_info_;
@@ -213,6 +213,21 @@ class ThreadPool {
     ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelSection);
   };
 
+  // Caps the degree of parallelism of the loops started by the calling thread while the
+  // object is alive, e.g. to run small operators on fewer threads than the pool provides
+  // instead of waking every worker for a few microseconds of work.  The cap counts the
+  // thread entering the loop, a cap of 1 runs the loops sequentially and a cap <= 0 has
+  // no effect.  Caps are thread-local and nested caps restore the previous one on exit.
+  class DegreeOfParallelismLimit {
+   public:
+    explicit DegreeOfParallelismLimit(int limit);
+    ~DegreeOfParallelismLimit();
+
+   private:
+    int previous_limit_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(DegreeOfParallelismLimit);
+  };
+
   // The below API allows to disable spinning
   // This is used to support real-time scenarios where
   // spinning between relatively infrequent requests
@@ -357,9 +372,18 @@ class ThreadPool {
   // the pool.
   //
   // Currently, a loop with degree-of-parallelism N is supported by a pool of N-1 threads
-  // working in combination with the thread initiating the loop.
+  // working in combination with the thread initiating the loop.  On hybrid CPUs the
+  // result is a multiple of the number of threads, so that the loops are split into
+  // smaller tasks balancing between the faster and slower cores.
+  // The result accounts for the DegreeOfParallelismLimit of the calling thread.
   static int DegreeOfParallelism(const ThreadPool* tp);
 
+  // Returns the number of threads running a loop, counting the thread initiating it.
+  // This is the unit of DegreeOfParallelismLimit, unlike DegreeOfParallelism it does
+  // not include the task granularity of hybrid CPUs.
+  // The result accounts for the DegreeOfParallelismLimit of the calling thread.
+  static int NumLoopThreads(const ThreadPool* tp);
+
   ORT_DISALLOW_COPY_AND_ASSIGNMENT(ThreadPool);
 
   // StartProfiling and StopProfiling are not to be consumed as public-facing API
@@ -380,6 +380,8 @@ typedef struct OrtAllocator {
    * - NumArenaExtensions: Number of arena extensions (Relevant only for arena based allocators)
    * - NumArenaShrinkages: Number of arena shrinkages (Relevant only for arena based allocators)
    * - MaxAllocSize: The max single allocation seen.
+   * - NumCacheHits: Number of allocations served by the arena thread cache (Relevant only if it is enabled)
+   * - NumCacheMisses: Number of allocations which missed the arena thread cache (Relevant only if it is enabled)
    *
    * The allocator is free to add other entries as appropriate.
    *
@@ -2980,6 +2982,9 @@ struct OrtApi {
    *  Use -1 to allow ORT to choose the default 1GB for max_power_of_two_extend_bytes.
    *  Ultimately, the allocation size is determined by the allocation memory request.
    *  Further allocation sizes are governed by the arena extend strategy.
+   * "thread_cache_max_bytes": Maximum number of bytes held by each shard of the arena thread cache.
+   *  The thread cache keeps recently freed small chunks per thread so that the next allocations avoid
+   *  the arena lock. Use 0 or -1 to disable it (default).
    *
    * \param[in] arena_config_keys Keys to configure the arena
    * \param[in] arena_config_values Values to configure the arena
@@ -369,11 +369,139 @@ static const char* const kOrtSessionOptionsEpContextModelExternalInitializersFil
     "ep.context_model_external_initializers_file_name";
 
 // Gemm fastmath mode provides fp32 gemm acceleration with bfloat16 based matmul.
+// It is used on Linux by the ARM64 processors supporting the BF16 extension and by the x86-64 processors
+// supporting AVX512-BF16, and ignored elsewhere.
 // Option values:
 // - "0": Gemm FastMath mode is not enabled. [DEFAULT]
 // - "1": Gemm FastMath mode is enabled.
+static const char* const kOrtSessionOptionsMlasGemmFastMathBfloat16 = "mlas.enable_gemm_fastmath_bfloat16";
+
+// Former name of kOrtSessionOptionsMlasGemmFastMathBfloat16, still honored when the new option is not set.
 static const char* const kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16 = "mlas.enable_gemm_fastmath_arm64_bfloat16";
 
+// Selects the evaluation engine used by the CPU tree ensemble kernels (TreeEnsembleRegressor,
+// TreeEnsembleClassifier and TreeEnsemble). The block engine copies the trees into a level-ordered,
+// structure-of-arrays layout and evaluates blocks of rows against one tree at a time without
+// data-dependent branches. It is only used when every node of the ensemble has the same comparison rule;
+// other ensembles keep the default engine.
+// Option values:
+// - "0": Trees are walked node by node for every row. [DEFAULT]
+// - "1": Block traversal is used for batches of rows when the ensemble is eligible.
+static const char* const kOrtSessionOptionsTreeEnsembleBlockTraversal = "session.tree_ensemble_block_traversal";
+
+// Path of a file storing the memory patterns generated by the session, one per set of input shapes.
+// The patterns found in the file are loaded when the session is initialized, so the first Run with known input
+// shapes uses the pre-planned memory blocks directly, and every new pattern is added to the file.
+// The file contains a hash of the execution plan, it is ignored and rewritten when the model, the session options
+// or the version of onnxruntime change. Only the patterns of the main graph are saved.
+// Sessions sharing the file across processes do not merge their patterns, the last one to write the file wins.
+// An unreadable or unwritable file never fails the session, it only disables the reuse of the patterns.
+// Memory patterns must be enabled (see SessionOptions::enable_mem_pattern) for the file to be used.
+// Option values:
+// - "": No file is used. [DEFAULT]
+// - a file path, typically next to the model, e.g. "model.onnx.mempattern".
+static const char* const kOrtSessionOptionsMemoryPatternCacheFile = "session.memory_pattern_cache_file";
+
+// Rounds the input dimensions up to buckets before looking up the memory pattern of a Run, so that inputs with
+// variable dimensions, e.g. the sequence length of NLP models, share the pattern of their bucket instead of
+// generating one pattern per shape. The pattern of a bucket is planned for its upper bound: the symbolic dimensions
+// of the graph inputs (dim_param) are replaced by the upper bound of their bucket in every tensor using them.
+// Smaller tensors of the same bucket are placed in the planned blocks, trading a bounded amount of memory for
+// runs without allocations. Tensors whose size does not only depend on named dimensions fall back to the allocator
+// when they do not fit. Memory patterns must be enabled (see SessionOptions::enable_mem_pattern).
+// Option values:
+// - "": Memory patterns are keyed by the exact input shapes. [DEFAULT]
+// - "pow2": Dimensions are rounded up to the next power of two.
+// - a comma-separated list of increasing bucket upper bounds, e.g. "64,128,256,512".
+//   Dimensions larger than the last bound are not rounded.
+static const char* const kOrtSessionOptionsMemoryPatternShapeBuckets = "session.memory_pattern_shape_buckets";
+
+// Coalesces concurrent Run calls whose inputs only differ on the batch axis into a single execution of the model.
+// Requests wait at most "session.micro_batching_max_latency_us" for other requests to join their batch, the outputs
+// of the batch are then split back on the batch axis. Only requests with CPU tensor inputs, without run options
+// configuration entries and without pre-allocated outputs are batched, the other ones run on their own.
+// The model must treat the rows of the batch axis independently.
+// Option values:
+// - "0" or "1": Micro-batching is disabled. [DEFAULT]
+// - A number greater than 1: the maximum number of rows, on the batch axis, of a batch.
+static const char* const kOrtSessionOptionsMicroBatchingMaxBatchSize = "session.micro_batching_max_batch_size";
+
+// Maximum time, in microseconds, the first request of a batch waits for other requests. Defaults to "1000".
+static const char* const kOrtSessionOptionsMicroBatchingMaxLatencyUs = "session.micro_batching_max_latency_us";
+
+// Axis of the inputs and outputs on which requests are concatenated. Defaults to "0".
+static const char* const kOrtSessionOptionsMicroBatchingBatchAxis = "session.micro_batching_batch_axis";
+
+// Schedules the nodes dynamically on the inter-op thread pool instead of running the static stream partition.
+// Every node is queued as soon as all its producers ran: a worker keeps running one of the nodes it made ready and
+// queues the other ones, idle workers of the pool steal them. Branches of wide graphs, e.g. the towers of
+// recommendation models, then use the cores whatever the relative cost of their nodes.
+// Only applies to the main graph with ExecutionMode::ORT_PARALLEL when all nodes run on the CPU execution provider,
+// otherwise the stream partition is used. "session.node_partition_config_file" is ignored when it applies.
+// Option values:
+// - "0": Run the static stream partition. [DEFAULT]
+// - "1": Schedule the nodes dynamically.
+static const char* const kOrtSessionOptionsInterOpWorkStealing = "session.inter_op.work_stealing";
+
+// Caps the number of intra-op threads used by every node from its measured cost.
+// The first runs of every operator and input shapes measure the work of the node, which then only wakes one thread
+// of the intra-op pool per 20us of work. Small nodes of large pools then skip the cost of waking and synchronizing
+// workers that would have had nothing to do.
+// Option values:
+// - "0": Nodes use the whole intra-op thread pool. [DEFAULT]
+// - "1": Calibrate the cost of the nodes during the first runs.
+static const char* const kOrtSessionOptionsIntraOpCostCalibration = "session.intra_op_cost_calibration";
+
+// Path of the file storing the costs measured by kOrtSessionOptionsIntraOpCostCalibration.
+// The file is loaded when the session is created and rewritten after the runs completing the calibration of nodes.
+// Setting the file without enabling the calibration applies the loaded costs, nodes missing from it are not limited.
+// The costs depend on the machine, the file should not be shared between different hardware.
+static const char* const kOrtSessionOptionsIntraOpCostTableFile = "session.intra_op_cost_table_file";
+
+// Loads ONNX models given by path from a memory mapping of the file, without copying the raw data of the large
+// initializers of the main graph. These initializers refer to the model file like external data and are mapped
+// into memory when first used, which reduces the load time and the resident memory of large models.
+// The model file must not be modified while the session is alive.
+// Option values:
+// - "0": Parse the whole model into memory. [DEFAULT]
+// - "1": Map the initializers from the model file.
+static const char* const kOrtSessionOptionsLoadModelWithMappedInitializers = "session.load_model_with_mapped_initializers";
+
+// Directory of a cache of pre-packed weights shared by the sessions of all the processes using it.
+// The weights packed by the CPU kernels are written to the cache once and the sessions map the cached entries
+// copy-on-write, so the processes serving the same model share one physical copy of the packed weights.
+// Entries are keyed by the kernel type and version, the node attributes, the session configuration, the hash of the
+// unpacked weight, the ONNX Runtime version and the instruction sets of the CPU. Kernels which can restore their
+// state from a cached entry do not pack the weight again.
+// The directory is created if needed. Failures to use it are logged and the session keeps private packed weights.
+// Option values:
+// - "": Do not use a cache. [DEFAULT]
+// - "<directory>": Share the pre-packed weights through this directory.
+static const char* const kOrtSessionOptionsPrepackedWeightsCacheDir = "session.prepacked_weights_cache_dir";
+
+// Selects the Winograd algorithm for the CPU float Conv and FusedConv kernels with a constant 3x3 filter and unit
+// strides and dilations. The filter is transformed when the session is created, replacing the original weights.
+// The Winograd algorithm performs fewer multiplications but is slightly less accurate than the GEMM based algorithms,
+// the error increasing with the output tile size.
+// Option values:
+// - "0": Use the GEMM based algorithms. [DEFAULT]
+// - "1": Use the Winograd algorithm for the convolutions expected to be faster with it.
+// - "4": Use the Winograd algorithm with 4x4 output tiles, F(4x4,3x3), for all the supported convolutions.
+// - "6": Use the Winograd algorithm with 6x6 output tiles, F(6x6,3x3), for all the supported convolutions.
+static const char* const kOrtSessionOptionsConvWinograd = "session.conv_winograd";
+
+// Packs the constant 2D B input of the CPU float MatMul and Gemm kernels in a block sparse format when at least this
+// fraction of its blocks of 1 row by 16 columns only contain zeros, as in the weights of a pruned model. The zero
+// blocks are then skipped by the multiplication. The dense kernels are faster below a fraction of about 0.7, depending
+// on the platform, and B always stays dense when less than half of its blocks are zeros. Only MatMul and Gemm nodes
+// with a non transposed A input are affected.
+// Option values:
+// - "0": Always use the dense kernels. [DEFAULT]
+// - A number in (0, 1], e.g. "0.75": Minimum fraction of zero blocks to pack B in the block sparse format. Values
+//   below 0.5 act as 0.5.
+static const char* const kOrtSessionOptionsBlockSparseWeightsMinZeroRatio =
+    "session.block_sparse_weights_min_zero_ratio";
+
 // When converting DQ + MatMul -> MatMulNBits, the accuracy level of the MatMulNBits is controlled by this option.
 // Refer to MatMulNBits op schema for more details.
 // If not provided, default is 4.
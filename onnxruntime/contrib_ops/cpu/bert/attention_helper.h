@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
@@ -175,5 +177,44 @@ T* ConcatStateChunkGQA(const T* past,
   return start;
 }
 
+// Quantized version of ConcatStateChunkGQA. The lengths are counted in values, and the new chunk of LxH values is
+// quantized with the scales of the H channels of its head, to int8 values for 8 bits, or to pairs of int4 values
+// packed in a byte with the low nibble first for 4 bits.
+template <typename T>
+void QuantizeStateChunkGQA(const uint8_t* past,
+                           const T* chunk,
+                           uint8_t* present,
+                           size_t present_buff_chunk_length,
+                           size_t past_buff_chunk_length,
+                           size_t past_chunk_length,
+                           size_t new_chunk_length,
+                           bool past_present_share_buffer,
+                           std::ptrdiff_t i,
+                           size_t head_size,
+                           const float* scales,
+                           int bits) {
+  uint8_t* p = present + i * present_buff_chunk_length * bits / 8;
+  if (!past_present_share_buffer && past_chunk_length > 0) {
+    memcpy(p, past + i * past_buff_chunk_length * bits / 8, past_chunk_length * bits / 8);
+  }
+  p += past_chunk_length * bits / 8;
+
+  const int max_value = (1 << (bits - 1)) - 1;
+  auto quantize = [&](size_t j) {
+    const float value = std::nearbyint(static_cast<float>(chunk[j]) / scales[j % head_size]);
+    return static_cast<int>(std::clamp(value, static_cast<float>(-max_value - 1), static_cast<float>(max_value)));
+  };
+
+  if (bits == 8) {
+    for (size_t j = 0; j < new_chunk_length; j++) {
+      p[j] = static_cast<uint8_t>(static_cast<int8_t>(quantize(j)));
+    }
+  } else {
+    for (size_t j = 0; j < new_chunk_length; j += 2) {
+      p[j / 2] = static_cast<uint8_t>((quantize(j) & 0xF) | ((quantize(j + 1) & 0xF) << 4));
+    }
+  }
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
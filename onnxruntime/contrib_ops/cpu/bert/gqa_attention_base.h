@@ -11,6 +11,8 @@
 #include "core/common/common.h"
 #include "core/common/safeint.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/env.h"
+#include "core/platform/env_var_utils.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -37,6 +39,13 @@ class GQAAttentionBase {
     local_window_size_ = has_local ? static_cast<int>(info.GetAttrOrDefault<int64_t>("local_window_size", -1)) : -1;
 
     qk_output_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("qk_output", static_cast<int64_t>(QKOutputType::NO_OUTPUT)));
+
+    kv_cache_bit_width_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("kv_cache_bit_width", 0));
+    ORT_ENFORCE(kv_cache_bit_width_ == 0 || kv_cache_bit_width_ == 4 || kv_cache_bit_width_ == 8,
+                "kv_cache_bit_width shall be 0, 4 or 8, got ", kv_cache_bit_width_);
+
+    l2_cache_size_ = Env::Default().GetL2CacheSize();
+    disable_flash_ = ParseEnvironmentVariableWithDefault<bool>(attention::kDisableFlashAttention, false);
   }
 
   int num_heads_;     // number of attention heads of Q
@@ -47,14 +56,20 @@ class GQAAttentionBase {
   bool rotary_interleaved_;
   int local_window_size_;
   int qk_output_;
+  int kv_cache_bit_width_;  // bits of the quantized values of the KV cache, 0 if not quantized
 
   bool use_smooth_softmax_;
 
+  int l2_cache_size_;
+  bool disable_flash_;  // whether to materialize the attention probs of the prompt instead of tiling them
+
   template <typename T>
   Status ApplyAttention(const T* Q,                                 // Q data with shape BxNxSxH
                         const T* K,                                 // K data with shape BxN_kvxSxH
                         const T* V,                                 // V data with shape BxN_kvxSxH
                         const T* head_sink,                         // Head sink for smooth softmax, nullptr if not used
+                        const float* key_scales,                    // N_kvxH scales of a quantized K cache
+                        const float* value_scales,                  // N_kvxH scales of a quantized V cache
                         const Tensor* attention_bias,               // Attention bias to add to QxK'
                         const Tensor* past_key,                     // past K input tensor (if not using past state)
                         const Tensor* past_value,                   // past V input tensor (if not using past state)
@@ -82,6 +97,26 @@ class GQAAttentionBase {
     }
     int seqlen_present_kv_cache = static_cast<int>(present_key->Shape().GetDims()[2]);
 
+    // A quantized cache is only read by tiles, which dequantize K and V in place of converting them to float.
+    if (kv_cache_bit_width_ != 0) {
+      if (attention_bias != nullptr || output_qk != nullptr) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                               "attention_bias and output_qk are not supported with a quantized KV cache.");
+      }
+      ApplyFlashAttention(Q, K, V, head_sink, key_scales, value_scales, past_key, past_value, output, present_key,
+                          present_value, seqlens_k, parameters, seqlen_past_kv_cache, seqlen_present_kv_cache, tp);
+      return Status::OK();
+    }
+
+    // The probs of a prompt take BxNxSxT elements, so the scores of a prompt are computed by tiles instead.
+    // A single token only takes BxNxT elements, which is cheaper to materialize.
+    if (sequence_length > 1 && !disable_flash_ && l2_cache_size_ > 0 &&
+        attention_bias == nullptr && output_qk == nullptr) {
+      ApplyFlashAttention(Q, K, V, head_sink, nullptr, nullptr, past_key, past_value, output, present_key,
+                          present_value, seqlens_k, parameters, seqlen_past_kv_cache, seqlen_present_kv_cache, tp);
+      return Status::OK();
+    }
+
     // Compute the attention score.
     bool gqa_mlas_supported = MlasGQASupported<T>(CblasNoTrans, CblasTrans) &&
                               MlasGQASupported<T>(CblasNoTrans, CblasNoTrans);
@@ -135,6 +170,165 @@ class GQAAttentionBase {
   }
 
  private:
+  // Computes the attention of a prompt by tiles of the present K and V with an online softmax, so that the memory
+  // of the scores is O(S) per thread instead of BxNxSxT. The query heads that share a KV head are attended together.
+  // With a quantized cache, the new K and V are quantized when they are appended to the present state.
+  template <typename T>
+  void ApplyFlashAttention(const T* Q,                                       // Q data with shape BxNxSxH
+                           const T* K,                                       // K data with shape BxN_kvxSxH
+                           const T* V,                                       // V data with shape BxN_kvxSxH
+                           const T* head_sink,                               // Head sink for smooth softmax
+                           const float* key_scales,                          // N_kvxH scales of a quantized K cache
+                           const float* value_scales,                        // N_kvxH scales of a quantized V cache
+                           const Tensor* past_key,                           // past K input tensor
+                           const Tensor* past_value,                         // past V input tensor
+                           Tensor* output,                                   // output tensor
+                           Tensor* present_key,                              // present K output tensor
+                           Tensor* present_value,                            // present V output tensor
+                           const Tensor* seqlens_k,                          // past sequence lengths tensor
+                           const GroupQueryAttentionParameters& parameters,  // attention parameters
+                           const int seqlen_past_kv_cache,                   // sequence length of past state
+                           const int seqlen_present_kv_cache,                // sequence length of present state
+                           ThreadPool* tp) const {
+    const int batch_size = parameters.batch_size;
+    const size_t sequence_length = static_cast<size_t>(parameters.sequence_length);
+    const size_t head_size = static_cast<size_t>(parameters.head_size);
+    const bool packed_qkv = parameters.is_packed_qkv;
+    const bool is_prompt = parameters.is_first_prompt;
+    const int32_t* seqlens_k_data = seqlens_k->Data<int32_t>();
+
+    const ptrdiff_t packed_batch_stride =
+        packed_qkv ? SafeInt<ptrdiff_t>(num_heads_ + 2 * kv_num_heads_) * sequence_length * head_size
+                   : SafeInt<ptrdiff_t>(0);
+    const size_t kv_input_chunk_length = sequence_length * head_size;                // L x H
+    const size_t past_buff_chunk_length = seqlen_past_kv_cache * head_size;          // L x H
+    const size_t present_buff_chunk_length = seqlen_present_kv_cache * head_size;    // T x H
+    const T* k = packed_qkv ? Q + num_heads_ * kv_input_chunk_length : K;
+    const T* v = packed_qkv ? Q + (num_heads_ + kv_num_heads_) * kv_input_chunk_length : V;
+
+    const void* past_key_data = past_key != nullptr ? past_key->DataRaw() : nullptr;
+    const void* past_value_data = past_value != nullptr ? past_value->DataRaw() : nullptr;
+    void* present_key_data = present_key->MutableDataRaw();
+    void* present_value_data = present_value->MutableDataRaw();
+    const bool past_present_share_buffer = past_key_data == present_key_data && past_value_data == present_value_data;
+
+    if (!past_present_share_buffer) {
+      memset(present_key_data, 0, present_key->SizeInBytes());
+      memset(present_value_data, 0, present_value->SizeInBytes());
+    }
+
+    std::vector<int> kv_sequence_lengths(batch_size);
+    std::vector<int> past_sequence_lengths(batch_size);
+    for (int b = 0; b < batch_size; b++) {
+      kv_sequence_lengths[b] = seqlens_k_data[b] + 1;
+      past_sequence_lengths[b] = is_prompt ? 0 : kv_sequence_lengths[b] - static_cast<int>(sequence_length);
+    }
+
+    // Append the new K and V to the present state of each KV head.
+    const int quant_bits = kv_cache_bit_width_;
+    TensorOpCost unit_cost;
+    unit_cost.bytes_loaded = static_cast<double>(2 * present_buff_chunk_length * sizeof(T));
+    unit_cost.bytes_stored = unit_cost.bytes_loaded;
+    unit_cost.compute_cycles = quant_bits != 0 ? static_cast<double>(2 * kv_input_chunk_length) : 0.0;
+    ThreadPool::TryParallelFor(tp, SafeInt<ptrdiff_t>(batch_size) * kv_num_heads_, unit_cost,
+                               [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+                                 for (std::ptrdiff_t i = begin; i != end; ++i) {
+                                   const size_t batch_index = i / kv_num_heads_;
+                                   const size_t head_index = i % kv_num_heads_;
+                                   const size_t past_chunk_length = past_sequence_lengths[batch_index] * head_size;
+                                   const ptrdiff_t input_offset =
+                                       packed_qkv ? packed_batch_stride * batch_index + kv_input_chunk_length * head_index
+                                                  : kv_input_chunk_length * i;
+                                   if (quant_bits != 0) {
+                                     QuantizeStateChunkGQA(static_cast<const uint8_t*>(past_key_data),
+                                                           k + input_offset, static_cast<uint8_t*>(present_key_data),
+                                                           present_buff_chunk_length, past_buff_chunk_length,
+                                                           past_chunk_length, kv_input_chunk_length,
+                                                           past_present_share_buffer, i, head_size,
+                                                           key_scales + head_index * head_size, quant_bits);
+                                     QuantizeStateChunkGQA(static_cast<const uint8_t*>(past_value_data),
+                                                           v + input_offset, static_cast<uint8_t*>(present_value_data),
+                                                           present_buff_chunk_length, past_buff_chunk_length,
+                                                           past_chunk_length, kv_input_chunk_length,
+                                                           past_present_share_buffer, i, head_size,
+                                                           value_scales + head_index * head_size, quant_bits);
+                                   } else {
+                                     ConcatStateChunkGQA(static_cast<const T*>(past_key_data), k + input_offset,
+                                                         static_cast<T*>(present_key_data), present_buff_chunk_length,
+                                                         past_buff_chunk_length, past_chunk_length,
+                                                         kv_input_chunk_length, past_present_share_buffer, i);
+                                     ConcatStateChunkGQA(static_cast<const T*>(past_value_data), v + input_offset,
+                                                         static_cast<T*>(present_value_data), present_buff_chunk_length,
+                                                         past_buff_chunk_length, past_chunk_length,
+                                                         kv_input_chunk_length, past_present_share_buffer, i);
+                                   }
+                                 }
+                               });
+
+    std::vector<float> head_sink_data;
+    if (use_smooth_softmax_ || head_sink != nullptr) {
+      head_sink_data.resize(num_heads_, 0.0f);
+      if (head_sink != nullptr) {
+        for (int h = 0; h < num_heads_; h++) {
+          head_sink_data[h] = static_cast<float>(head_sink[h]);
+        }
+      }
+    }
+
+    MlasGQAFlashAttentionArgs<T> args;
+    args.batch_size = batch_size;
+    args.num_heads = num_heads_;
+    args.kv_num_heads = kv_num_heads_;
+    args.kv_heads_interleaved = false;
+    args.q_sequence_length = static_cast<int>(sequence_length);
+    args.qk_head_size = static_cast<int>(head_size);
+    args.v_head_size = static_cast<int>(head_size);
+    args.scale = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+    args.softcap = softcap_;
+    args.is_causal = true;
+    args.local_window_size = local_window_size_;
+    args.kv_sequence_lengths = kv_sequence_lengths.data();
+    args.past_sequence_lengths = past_sequence_lengths.data();
+    args.head_sink = head_sink_data.empty() ? nullptr : head_sink_data.data();
+
+    // Same tiling as the flash attention of MultiHeadAttention, except that the rows of a tile of scores are
+    // split between the query heads of a group.
+    const int group_size = num_heads_ / kv_num_heads_;
+    const int kv_block_size = std::max(l2_cache_size_ / (static_cast<int>(sizeof(float)) * 4 * 2 * args.qk_head_size), 1);
+    args.q_block_size = std::max(std::min(kv_block_size, 2 * args.qk_head_size) / group_size, 1);
+    args.q_block_size = std::min(args.q_block_size, args.q_sequence_length);
+    args.kv_block_size = std::min(kv_block_size, seqlen_present_kv_cache);
+
+    args.query = Q;
+    args.query_batch_stride = packed_qkv ? static_cast<size_t>(packed_batch_stride) : num_heads_ * kv_input_chunk_length;
+    args.query_head_stride = kv_input_chunk_length;
+    args.query_sequence_stride = head_size;
+    if (quant_bits != 0) {
+      args.kv_quant_bits = quant_bits;
+      args.key_quantized = static_cast<const uint8_t*>(present_key_data);
+      args.value_quantized = static_cast<const uint8_t*>(present_value_data);
+      args.key_scales = key_scales;
+      args.value_scales = value_scales;
+      args.key = nullptr;
+      args.value = nullptr;
+    } else {
+      args.key = static_cast<const T*>(present_key_data);
+      args.value = static_cast<const T*>(present_value_data);
+    }
+    args.key_batch_stride = kv_num_heads_ * present_buff_chunk_length;
+    args.key_head_stride = present_buff_chunk_length;
+    args.key_sequence_stride = head_size;
+    args.value_batch_stride = kv_num_heads_ * present_buff_chunk_length;
+    args.value_head_stride = present_buff_chunk_length;
+    args.value_sequence_stride = head_size;
+    args.output = output->MutableData<T>();
+    args.output_batch_stride = sequence_length * num_heads_ * head_size;
+    args.output_head_stride = head_size;
+    args.output_sequence_stride = num_heads_ * head_size;
+
+    MlasGQAFlashAttention(&args, tp);
+  }
+
   // Helper function to compute the attention probs. It does 2 things:
   //  attention_probs(B, N, S, T) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, T, H -> B, N, H, T)
   //  attention_probs(B, N, S, T) = Softmax(attention_probs)
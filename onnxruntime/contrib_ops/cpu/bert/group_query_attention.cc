@@ -22,16 +22,19 @@ namespace onnxruntime {
 namespace contrib {
 
 // These ops are internal-only, so register outside of onnx
-#define REGISTER_KERNEL_TYPED(T)                                        \
-  ONNX_OPERATOR_TYPED_KERNEL_EX(                                        \
-      GroupQueryAttention,                                              \
-      kMSDomain,                                                        \
-      1,                                                                \
-      T,                                                                \
-      kCpuExecutionProvider,                                            \
-      KernelDefBuilder()                                                \
-          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())        \
-          .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()), \
+#define REGISTER_KERNEL_TYPED(T)                                               \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                               \
+      GroupQueryAttention,                                                     \
+      kMSDomain,                                                               \
+      1,                                                                       \
+      T,                                                                       \
+      kCpuExecutionProvider,                                                   \
+      KernelDefBuilder()                                                       \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())               \
+          .TypeConstraint("T_CACHE", {DataTypeImpl::GetTensorType<T>(),        \
+                                      DataTypeImpl::GetTensorType<int8_t>(),   \
+                                      DataTypeImpl::GetTensorType<uint8_t>()}) \
+          .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()),        \
       GroupQueryAttention<T>);
 
 REGISTER_KERNEL_TYPED(float)
@@ -55,6 +58,8 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
   const Tensor* position_ids = context->Input<Tensor>(9);
   const Tensor* attention_bias = context->Input<Tensor>(10);
   const Tensor* head_sink = context->Input<Tensor>(11);
+  const Tensor* k_scale = context->Input<Tensor>(12);
+  const Tensor* v_scale = context->Input<Tensor>(13);
 
   GroupQueryAttentionParameters parameters = {};
   ORT_RETURN_IF_ERROR(group_query_attention_helper::CheckInputs(query,
@@ -77,6 +82,12 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
                                                                                head_sink,
                                                                                parameters));
 
+  ORT_RETURN_IF_ERROR(group_query_attention_helper::CheckQuantizedKVCache(past_key,
+                                                                          k_scale,
+                                                                          v_scale,
+                                                                          kv_cache_bit_width_,
+                                                                          parameters));
+
   const int batch_size = parameters.batch_size;
   const int sequence_length = parameters.sequence_length;
   const int present_kv_seqlen = parameters.seqlen_present_kv_cache;
@@ -90,8 +101,10 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
   output_shape[2] = static_cast<int64_t>(q_hidden_size);
   Tensor* output = context->Output(0, output_shape);
 
-  std::vector<int64_t> present_k_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(head_size)});
-  std::vector<int64_t> present_v_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(head_size)});
+  // A 4-bit quantized cache packs two values per byte.
+  const int present_head_size = kv_cache_bit_width_ == 4 ? head_size / 2 : head_size;
+  std::vector<int64_t> present_k_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(present_head_size)});
+  std::vector<int64_t> present_v_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(present_head_size)});
   Tensor* present_k = context->Output(1, present_k_shape);
   Tensor* present_v = context->Output(2, present_v_shape);
 
@@ -213,10 +226,30 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
 
   const T* head_sink_data = (head_sink != nullptr) ? head_sink->Data<T>() : nullptr;
 
+  // Expand the scales of a quantized cache to one per channel of each KV head.
+  std::vector<float> key_scales;
+  std::vector<float> value_scales;
+  auto expand_scales = [&](const Tensor* scale, std::vector<float>& scales) {
+    const auto data = scale->DataAsSpan<float>();
+    scales.resize(static_cast<size_t>(kv_num_heads_) * head_size);
+    for (size_t c = 0; c < scales.size(); c++) {
+      scales[c] = data.size() == scales.size() ? data[c] : data[data.size() == 1 ? 0 : c / head_size];
+      if (!(scales[c] > 0.0f)) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'k_scale' and 'v_scale' shall be positive.");
+      }
+    }
+    return Status::OK();
+  };
+  if (kv_cache_bit_width_ != 0) {
+    ORT_RETURN_IF_ERROR(expand_scales(k_scale, key_scales));
+    ORT_RETURN_IF_ERROR(expand_scales(v_scale, value_scales));
+  }
+
   // Compute the attention score and apply the score to V
   return ApplyAttention(q_rotary, packed_qkv ? nullptr : k_rotary, packed_qkv ? nullptr : V.Get<Tensor>().Data<T>(),
-                        head_sink_data, attention_bias, past_key, past_value, output, present_k, present_v,
-                        output_qk, seqlens_k, parameters, allocator, context);
+                        head_sink_data, key_scales.empty() ? nullptr : key_scales.data(),
+                        value_scales.empty() ? nullptr : value_scales.data(), attention_bias, past_key, past_value,
+                        output, present_k, present_v, output_qk, seqlens_k, parameters, allocator, context);
 }
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -141,12 +141,15 @@ Status CheckPast(const T* past_key, const T* past_value, int batch_size, int kv_
   // We assume all sequence in past kv are right-padded to max or past sequence length
   past_sequence_length = static_cast<int>(past_key_dims[2]);
 
-  if (past_key_dims[3] != head_size) {
+  // A 4-bit quantized cache packs two values per byte, which is exact since head_size is a multiple of 8.
+  const bool is_packed = past_key->template IsDataType<uint8_t>();
+  const int64_t past_head_size = is_packed ? head_size / 2 : head_size;
+  if (past_key_dims[3] != past_head_size) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "Input 'past_key' dimension 3 should be same as head_size, got ",
                            past_key_dims[3]);
   }
-  if (past_value_dims[3] != head_size) {
+  if (past_value_dims[3] != past_head_size) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "Input 'past_value' dimension 3 should be same as head_size, got ",
                            past_value_dims[3]);
@@ -410,6 +413,54 @@ Status CheckOutputs(const T* output_qk, int qk_output) {
   return Status::OK();
 }
 
+// Checks the past KV cache type and the scales of a KV cache quantized to kv_cache_bit_width bits (0 if not
+// quantized). The scales are per-tensor with shape (1), per-head with shape (kv_num_heads), or per-channel with shape
+// (kv_num_heads, head_size).
+template <typename T = Tensor>
+Status CheckQuantizedKVCache(const T* past_key,
+                             const T* k_scale,
+                             const T* v_scale,
+                             int kv_cache_bit_width,
+                             const GroupQueryAttentionParameters& parameters) {
+  if (kv_cache_bit_width == 0) {
+    if (k_scale != nullptr || v_scale != nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'k_scale' and 'v_scale' are only used when kv_cache_bit_width is 4 or 8.");
+    }
+    if (past_key != nullptr && (past_key->template IsDataType<int8_t>() || past_key->template IsDataType<uint8_t>())) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'past_key' of a quantized type requires kv_cache_bit_width of 4 or 8.");
+    }
+    return Status::OK();
+  }
+
+  if (past_key != nullptr && !(kv_cache_bit_width == 8 ? past_key->template IsDataType<int8_t>()
+                                                       : past_key->template IsDataType<uint8_t>())) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'past_key' shall be int8 when kv_cache_bit_width is 8 and uint8 when it is 4.");
+  }
+
+  if (k_scale == nullptr || v_scale == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'k_scale' and 'v_scale' are required when kv_cache_bit_width is ",
+                           kv_cache_bit_width);
+  }
+
+  for (const T* scale : {k_scale, v_scale}) {
+    const auto& dims = scale->Shape().GetDims();
+    const bool is_valid = (dims.size() == 1 && (dims[0] == 1 || dims[0] == parameters.kv_num_heads)) ||
+                          (dims.size() == 2 && dims[0] == parameters.kv_num_heads && dims[1] == parameters.head_size);
+    if (!is_valid) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'k_scale' and 'v_scale' shall have shape (1), (kv_num_heads) or "
+                             "(kv_num_heads, head_size), got ",
+                             scale->Shape());
+    }
+  }
+
+  return Status::OK();
+}
+
 inline Status CheckNoQKOutput(int num_outputs, int qk_output) {
   if (num_outputs > 3) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
@@ -0,0 +1,294 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/bert/paged_attention.h"
+#include "contrib_ops/cpu/bert/paged_attention_helper.h"
+#include "contrib_ops/cpu/bert/rotary_embedding.h"
+#include "contrib_ops/cpu/bert/rotary_embedding_helper.h"
+
+#include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// These ops are internal-only, so register outside of onnx
+#define REGISTER_KERNEL_TYPED(T)                                       \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                       \
+      PagedAttention,                                                  \
+      kMSDomain,                                                       \
+      1,                                                               \
+      T,                                                               \
+      kCpuExecutionProvider,                                           \
+      KernelDefBuilder()                                               \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())       \
+          .TypeConstraint("S", DataTypeImpl::GetTensorType<int32_t>()) \
+          .MayInplace(3, 1)                                            \
+          .MayInplace(4, 2),                                           \
+      PagedAttention<T>);
+
+REGISTER_KERNEL_TYPED(float)
+REGISTER_KERNEL_TYPED(MLFloat16)
+
+template <typename T>
+PagedAttention<T>::PagedAttention(const OpKernelInfo& info)
+    : OpKernel(info), GQAAttentionBase(info, true) {
+  ORT_ENFORCE(num_heads_ % kv_num_heads_ == 0, "num_heads must be a multiple of kv_num_heads");
+}
+
+template <typename T>
+Status PagedAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* key_cache = context->Input<Tensor>(3);
+  const Tensor* value_cache = context->Input<Tensor>(4);
+  const Tensor* cumulative_seqlens_q = context->Input<Tensor>(5);
+  const Tensor* past_seqlens = context->Input<Tensor>(6);
+  const Tensor* block_table = context->Input<Tensor>(7);
+  const Tensor* cos_cache = context->Input<Tensor>(8);
+  const Tensor* sin_cache = context->Input<Tensor>(9);
+
+  PagedAttentionParameters parameters = {};
+  ORT_RETURN_IF_ERROR(paged_attention_helper::CheckInputs(query,
+                                                          key,
+                                                          value,
+                                                          key_cache,
+                                                          value_cache,
+                                                          cumulative_seqlens_q,
+                                                          past_seqlens,
+                                                          block_table,
+                                                          cos_cache,
+                                                          sin_cache,
+                                                          &parameters,
+                                                          num_heads_,
+                                                          kv_num_heads_,
+                                                          scale_,
+                                                          softcap_,
+                                                          0));
+
+  if (do_rotary_ && (cos_cache == nullptr || sin_cache == nullptr)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "cos_cache and sin_cache must be passed to PagedAttention when do_rotary = 1");
+  }
+
+  const int batch_size = parameters.batch_size;
+  const int token_count = parameters.token_count;
+  const int head_size = parameters.head_size;
+  const int hidden_size = parameters.hidden_size;
+  const int kv_hidden_size = parameters.kv_hidden_size;
+  const int block_size = parameters.block_size;
+  const int max_num_blocks_per_seq = parameters.max_num_blocks_per_seq;
+  const bool packed_qkv = parameters.is_packed_qkv;
+
+  Tensor* output = context->Output(0, {static_cast<int64_t>(token_count), static_cast<int64_t>(hidden_size)});
+  Tensor* key_cache_out = context->Output(1, key_cache->Shape());
+  Tensor* value_cache_out = context->Output(2, value_cache->Shape());
+
+  if (key_cache_out != nullptr && key_cache->Data<T>() != key_cache_out->MutableData<T>()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "key_cache and key_cache_out must be the same buffer");
+  } else if (value_cache_out != nullptr && value_cache->Data<T>() != value_cache_out->MutableData<T>()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "value_cache and value_cache_out must be the same buffer");
+  }
+
+  // The sequence lengths and the block table are read on the host, so they are validated before any block of the
+  // pool is written.
+  const int32_t* cumulative_seqlens_q_data = cumulative_seqlens_q->Data<int32_t>();
+  const int32_t* past_seqlens_data = past_seqlens->Data<int32_t>();
+  const int32_t* block_table_data = block_table->Data<int32_t>();
+  const int64_t max_position = cos_cache != nullptr ? cos_cache->Shape()[0] : std::numeric_limits<int64_t>::max();
+
+  if (cumulative_seqlens_q_data[0] != 0 || cumulative_seqlens_q_data[batch_size] != token_count) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "cumulative_sequence_length shall start at 0 and end at the token count ", token_count);
+  }
+
+  std::vector<int> kv_sequence_lengths(batch_size);
+  std::vector<int> token_batch(token_count);
+  int max_sequence_length = 0;
+  for (int b = 0; b < batch_size; b++) {
+    const int q_begin = cumulative_seqlens_q_data[b];
+    const int q_end = cumulative_seqlens_q_data[b + 1];
+    if (q_end < q_begin || q_end > token_count) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "cumulative_sequence_length shall be non-decreasing. Got ", q_begin, " and ", q_end,
+                             " for batch ", b);
+    }
+    if (past_seqlens_data[b] < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "past_seqlens shall not be negative. Got ", past_seqlens_data[b], " for batch ", b);
+    }
+
+    const int64_t total_length = static_cast<int64_t>(past_seqlens_data[b]) + (q_end - q_begin);
+    const int64_t num_blocks = (total_length + block_size - 1) / block_size;
+    if (num_blocks > max_num_blocks_per_seq) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "block_table has ", max_num_blocks_per_seq, " blocks per sequence, but batch ", b,
+                             " needs ", num_blocks, " blocks of size ", block_size);
+    }
+    if (do_rotary_ && total_length > max_position) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "cos_cache dimension 0 shall not be less than the total sequence length ", total_length);
+    }
+    for (int64_t i = 0; i < num_blocks; i++) {
+      const int32_t block = block_table_data[static_cast<ptrdiff_t>(b) * max_num_blocks_per_seq + i];
+      if (block < 0 || block >= parameters.num_blocks) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                               "block_table entry ", block, " of batch ", b, " is out of the range [0, ",
+                               parameters.num_blocks, ")");
+      }
+    }
+
+    kv_sequence_lengths[b] = static_cast<int>(total_length);
+    max_sequence_length = std::max(max_sequence_length, q_end - q_begin);
+    std::fill(token_batch.begin() + q_begin, token_batch.begin() + q_end, b);
+  }
+
+  if (token_count == 0) {
+    return Status::OK();
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+  auto* tp = context->GetOperatorThreadPool();
+
+  // Rows of Q, K and V. With packed QKV, a row holds the query heads followed by the key heads and the value heads.
+  const size_t q_row_stride = packed_qkv ? static_cast<size_t>(hidden_size + 2 * kv_hidden_size)
+                                         : static_cast<size_t>(hidden_size);
+  const size_t kv_row_stride = packed_qkv ? q_row_stride : static_cast<size_t>(kv_hidden_size);
+  const T* q = query->Data<T>();
+  const T* k = packed_qkv ? q + hidden_size : key->Data<T>();
+  const T* v = packed_qkv ? q + hidden_size + kv_hidden_size : value->Data<T>();
+
+  OrtValue RotaryQ;
+  OrtValue RotaryK;
+  if (do_rotary_) {
+    std::vector<int64_t> position_ids(token_count);
+    for (int t = 0; t < token_count; t++) {
+      const int b = token_batch[t];
+      position_ids[t] = static_cast<int64_t>(past_seqlens_data[b]) + t - cumulative_seqlens_q_data[b];
+    }
+
+    // The packed tokens are rotated as one sequence with a position per token. The rotated rows keep the strides
+    // of the input rows.
+    rotary_embedding_helper::RotaryParameters rotary_params = {};
+    rotary_params.batch_size = 1;
+    rotary_params.sequence_length = token_count;
+    rotary_params.hidden_size = hidden_size;
+    rotary_params.head_size = head_size;
+    rotary_params.rotary_embedding_dim = parameters.rotary_dim;
+    rotary_params.num_heads = num_heads_;
+    rotary_params.max_sequence_length = token_count;  // unused
+    rotary_params.seq_stride = static_cast<int>(q_row_stride);
+    rotary_params.head_stride = head_size;
+    rotary_params.batch_stride = 0;
+    rotary_params.position_ids_format = 1;
+    rotary_params.transposed = false;
+
+    auto element_type = DataTypeImpl::GetType<T>();
+    Tensor::InitOrtValue(element_type, query->Shape(), allocator, RotaryQ);
+    T* q_rotary = RotaryQ.GetMutable<Tensor>()->MutableData<T>();
+    T* k_rotary = q_rotary + hidden_size;
+    if (!packed_qkv) {
+      Tensor::InitOrtValue(element_type, key->Shape(), allocator, RotaryK);
+      k_rotary = RotaryK.GetMutable<Tensor>()->MutableData<T>();
+    }
+
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, q, position_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), q_rotary, rotary_interleaved_));
+
+    rotary_params.num_heads = kv_num_heads_;
+    rotary_params.hidden_size = kv_hidden_size;
+    rotary_params.seq_stride = static_cast<int>(kv_row_stride);
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, k, position_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), k_rotary, rotary_interleaved_));
+    q = q_rotary;
+    k = k_rotary;
+  }
+
+  // Append the new K and V of each token to the slot of its position in the blocks of its sequence.
+  T* key_cache_data = const_cast<T*>(key_cache->Data<T>());
+  T* value_cache_data = const_cast<T*>(value_cache->Data<T>());
+  const size_t block_stride = static_cast<size_t>(block_size) * kv_hidden_size;
+
+  TensorOpCost unit_cost;
+  unit_cost.bytes_loaded = static_cast<double>(2 * kv_hidden_size * sizeof(T));
+  unit_cost.bytes_stored = unit_cost.bytes_loaded;
+  ThreadPool::TryParallelFor(tp, token_count, unit_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+    for (std::ptrdiff_t t = begin; t != end; ++t) {
+      const int b = token_batch[t];
+      const int position = past_seqlens_data[b] + static_cast<int>(t) - cumulative_seqlens_q_data[b];
+      const size_t block = static_cast<size_t>(block_table_data[static_cast<ptrdiff_t>(b) * max_num_blocks_per_seq +
+                                                                position / block_size]);
+      const size_t slot_offset = block * block_stride + static_cast<size_t>(position % block_size) * kv_hidden_size;
+      std::copy_n(k + t * kv_row_stride, kv_hidden_size, key_cache_data + slot_offset);
+      std::copy_n(v + t * kv_row_stride, kv_hidden_size, value_cache_data + slot_offset);
+    }
+  });
+
+  // Attend each sequence to its blocks, gathered through the block table by tiles that don't cross a block.
+  MlasGQAFlashAttentionArgs<T> args;
+  args.batch_size = batch_size;
+  args.num_heads = num_heads_;
+  args.kv_num_heads = kv_num_heads_;
+  args.kv_heads_interleaved = false;
+  args.q_sequence_length = max_sequence_length;
+  args.qk_head_size = head_size;
+  args.v_head_size = head_size;
+  args.scale = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+  args.softcap = softcap_;
+  args.is_causal = true;
+  args.local_window_size = local_window_size_;
+  args.kv_sequence_lengths = kv_sequence_lengths.data();
+  args.past_sequence_lengths = past_seqlens_data;
+  args.head_sink = nullptr;
+  args.q_sequence_offsets = cumulative_seqlens_q_data;
+  args.kv_page_table = block_table_data;
+  args.kv_page_table_stride = static_cast<size_t>(max_num_blocks_per_seq);
+  args.kv_page_size = block_size;
+
+  // Same tiling as the flash attention of GroupQueryAttention, with tiles of keys no larger than a block.
+  const int group_size = num_heads_ / kv_num_heads_;
+  int kv_block_size = block_size;
+  if (l2_cache_size_ > 0) {
+    kv_block_size = std::min(std::max(l2_cache_size_ / (static_cast<int>(sizeof(float)) * 4 * 2 * head_size), 1),
+                             block_size);
+  }
+  args.q_block_size = std::max(std::min(kv_block_size, 2 * head_size) / group_size, 1);
+  args.q_block_size = std::min(args.q_block_size, max_sequence_length);
+  args.kv_block_size = kv_block_size;
+
+  args.query = q;
+  args.query_batch_stride = 0;
+  args.query_head_stride = static_cast<size_t>(head_size);
+  args.query_sequence_stride = q_row_stride;
+  args.key = key_cache_data;
+  args.key_batch_stride = block_stride;
+  args.key_head_stride = static_cast<size_t>(head_size);
+  args.key_sequence_stride = static_cast<size_t>(kv_hidden_size);
+  args.value = value_cache_data;
+  args.value_batch_stride = block_stride;
+  args.value_head_stride = static_cast<size_t>(head_size);
+  args.value_sequence_stride = static_cast<size_t>(kv_hidden_size);
+  args.output = output->MutableData<T>();
+  args.output_batch_stride = 0;
+  args.output_head_stride = static_cast<size_t>(head_size);
+  args.output_sequence_stride = static_cast<size_t>(hidden_size);
+
+  MlasGQAFlashAttention(&args, tp);
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
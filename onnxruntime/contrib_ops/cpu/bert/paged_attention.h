@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "gqa_attention_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Attention of packed sequences over a KV cache pool of fixed-size blocks. Each sequence owns the blocks listed in
+// its row of the block table, so that sequences of different lengths share one pool without padding.
+template <typename T>
+class PagedAttention final : public OpKernel, public GQAAttentionBase {
+ public:
+  PagedAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -106,11 +106,9 @@ Status CheckKVCache(const T* key_cache, const T* value_cache, const int kv_num_h
 
   num_blocks = static_cast<int>(key_cache_dims[0]);
   block_size = static_cast<int>(key_cache_dims[1]);
-  // TODO(aciddelgado): block size multiple of 8
-  if (block_size % 256 != 0) {
+  if (block_size <= 0) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
-                           "block_size must be a multiple of 256. Got block_size % 256 == ",
-                           block_size % 256);
+                           "block_size must be positive. Got block_size == ", block_size);
   }
   if (value_cache_dims[0] != num_blocks) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
@@ -166,7 +164,7 @@ Status CheckSequenceLengthTensors(const T* cumulative_sequence_length, const T*
   batch_size = static_cast<int>(cumulative_seqlen_dim[0]) - 1;
 
   const auto& seqlens_dim = seqlens->Shape().GetDims();
-  if (seqlens_dim.size() != 1 && seqlens_dim[0] != batch_size) {
+  if (seqlens_dim.size() != 1 || seqlens_dim[0] != batch_size) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "seqlens must be shape (batch_size).");
   }
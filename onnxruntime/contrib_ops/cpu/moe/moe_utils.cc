@@ -4,6 +4,7 @@
 #include "contrib_ops/cpu/moe/moe_utils.h"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 namespace onnxruntime {
 namespace contrib {
@@ -90,5 +91,59 @@ void ApplySwiGLUActivation(float* data, int64_t inter_size, bool is_interleaved_
   }
 }
 
+void SelectTopKExperts(const float* router_logits, int64_t num_experts, int64_t k, bool normalize_routing_weights,
+                       int64_t* expert_ids, float* routing_weights) {
+  float max_logit = std::numeric_limits<float>::lowest();
+  for (int64_t e = 0; e < num_experts; ++e) {
+    max_logit = std::max(max_logit, router_logits[e]);
+  }
+
+  float sum = 0.0f;
+  for (int64_t e = 0; e < num_experts; ++e) {
+    sum += std::exp(router_logits[e] - max_logit);
+  }
+
+  // k is small, so the experts are selected one at a time
+  float selected_sum = 0.0f;
+  for (int64_t slot = 0; slot < k; ++slot) {
+    int64_t best = -1;
+    for (int64_t e = 0; e < num_experts; ++e) {
+      if (best >= 0 && !(router_logits[e] > router_logits[best])) {
+        continue;
+      }
+      if (std::find(expert_ids, expert_ids + slot, e) == expert_ids + slot) {
+        best = e;
+      }
+    }
+    expert_ids[slot] = best;
+    routing_weights[slot] = std::exp(router_logits[best] - max_logit) / sum;
+    selected_sum += routing_weights[slot];
+  }
+
+  if (normalize_routing_weights && selected_sum > 0.0f) {
+    for (int64_t slot = 0; slot < k; ++slot) {
+      routing_weights[slot] /= selected_sum;
+    }
+  }
+}
+
+void GroupEntriesByExpert(const int64_t* expert_ids, int64_t num_entries, int64_t num_experts,
+                          int64_t* expert_offsets, int64_t* permuted_entries, int64_t* entry_positions) {
+  std::fill_n(expert_offsets, num_experts + 1, int64_t{0});
+  for (int64_t i = 0; i < num_entries; ++i) {
+    ++expert_offsets[expert_ids[i] + 1];
+  }
+  for (int64_t e = 0; e < num_experts; ++e) {
+    expert_offsets[e + 1] += expert_offsets[e];
+  }
+
+  std::vector<int64_t> next_position(expert_offsets, expert_offsets + num_experts);
+  for (int64_t i = 0; i < num_entries; ++i) {
+    const int64_t position = next_position[static_cast<size_t>(expert_ids[i])]++;
+    permuted_entries[position] = i;
+    entry_positions[i] = position;
+  }
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -11,5 +11,18 @@ namespace contrib {
 float ApplyActivation(float x, ActivationType activation_type);
 void ApplySwiGLUActivation(float* data, int64_t inter_size, bool is_interleaved_format);
 
+// Selects the k experts of a row with the largest router logits, in decreasing order of the logits (the lower expert
+// index first for equal logits). The routing weight of an expert is the softmax of the logits of the row, and the
+// routing weights of the selected experts are scaled to sum to 1 if normalize_routing_weights is set.
+void SelectTopKExperts(const float* router_logits, int64_t num_experts, int64_t k, bool normalize_routing_weights,
+                       int64_t* expert_ids, float* routing_weights);
+
+// Groups the routing entries (row * k + slot) by expert, with the entries of an expert in increasing order.
+// The entries routed to expert 'e' are permuted_entries[expert_offsets[e]] to permuted_entries[expert_offsets[e + 1] - 1],
+// and entry_positions holds the position of each entry in permuted_entries.
+// expert_offsets has num_experts + 1 elements, permuted_entries and entry_positions have num_entries elements.
+void GroupEntriesByExpert(const int64_t* expert_ids, int64_t num_entries, int64_t num_experts,
+                          int64_t* expert_offsets, int64_t* permuted_entries, int64_t* entry_positions);
+
 }  // namespace contrib
 }  // namespace onnxruntime
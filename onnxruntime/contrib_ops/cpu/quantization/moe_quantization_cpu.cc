@@ -10,6 +10,7 @@
 #include "core/platform/threadpool.h"
 #include "contrib_ops/cpu/moe/moe_utils.h"
 #include <algorithm>
+#include <cstring>
 
 using namespace onnxruntime::common;
 using namespace ONNX_NAMESPACE;
@@ -66,29 +67,13 @@ Status QMoE::Compute(OpKernelContext* context) const {
 
   // Dispatch based on input data type
   if (input->IsDataType<MLFloat16>()) {
-    if (expert_weight_bits_ == 4) {
-      return QuantizedMoEImpl<true, MLFloat16>(context, moe_params, input, router_probs,
-                                               fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
-                                               fc2_experts_bias_optional, fc3_experts_weights_optional,
-                                               fc3_experts_bias_optional, fc1_scales, fc2_scales, fc3_scales_optional);
-    } else {
-      return QuantizedMoEImpl<false, MLFloat16>(context, moe_params, input, router_probs,
-                                                fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
-                                                fc2_experts_bias_optional, fc3_experts_weights_optional,
-                                                fc3_experts_bias_optional, fc1_scales, fc2_scales, fc3_scales_optional);
-    }
+    return QuantizedMoEImpl<MLFloat16>(context, moe_params, input, router_probs,
+                                       fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
+                                       fc2_experts_bias_optional, fc3_experts_weights_optional, fc1_scales, fc2_scales);
   } else if (input->IsDataType<float>()) {
-    if (expert_weight_bits_ == 4) {
-      return QuantizedMoEImpl<true, float>(context, moe_params, input, router_probs,
-                                           fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
-                                           fc2_experts_bias_optional, fc3_experts_weights_optional,
-                                           fc3_experts_bias_optional, fc1_scales, fc2_scales, fc3_scales_optional);
-    } else {
-      return QuantizedMoEImpl<false, float>(context, moe_params, input, router_probs,
-                                            fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
-                                            fc2_experts_bias_optional, fc3_experts_weights_optional,
-                                            fc3_experts_bias_optional, fc1_scales, fc2_scales, fc3_scales_optional);
-    }
+    return QuantizedMoEImpl<float>(context, moe_params, input, router_probs,
+                                   fc1_experts_weights, fc1_experts_bias_optional, fc2_experts_weights,
+                                   fc2_experts_bias_optional, fc3_experts_weights_optional, fc1_scales, fc2_scales);
   } else {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "QMoE only supports float and MLFloat16 data types, but got ",
@@ -96,7 +81,7 @@ Status QMoE::Compute(OpKernelContext* context) const {
   }
 }
 
-template <bool UseUInt4x2, typename T>
+template <typename T>
 Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
                               MoEParameters& moe_params,
                               const Tensor* input,
@@ -106,10 +91,8 @@ Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
                               const Tensor* fc2_experts_weights,
                               const Tensor* fc2_experts_bias_optional,
                               const Tensor* fc3_experts_weights_optional,
-                              const Tensor* fc3_experts_bias_optional,
                               const Tensor* fc1_scales,
-                              const Tensor* fc2_scales,
-                              const Tensor* fc3_scales_optional) const {
+                              const Tensor* fc2_scales) const {
   // SwiGLU validation - FC3 not supported
   bool is_swiglu = (activation_type_ == ActivationType::SwiGLU);
   if (is_swiglu && fc3_experts_weights_optional != nullptr) {
@@ -120,6 +103,18 @@ Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
     return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
                            "FC3 gating is not yet implemented on CPU.");
   }
+  if (use_sparse_mixer_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "Sparse mixer is not yet implemented on CPU.");
+  }
+  if (moe_params.local_num_experts != moe_params.num_experts) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "Expert parallelism is not supported on CPU.");
+  }
+  if (k_ < 1 || k_ > moe_params.num_experts) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "k must be between 1 and the number of experts ", moe_params.num_experts, ", but got ", k_);
+  }
 
   // Check if we need to repack weights
   if (!is_prepacked_ ||
@@ -128,7 +123,7 @@ Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
       cached_inter_size_ != moe_params.inter_size ||
       cached_is_swiglu_ != is_swiglu) {
     // Need to prepack weights
-    Status status = const_cast<QMoE*>(this)->PrepackAndDequantizeWeights<UseUInt4x2>(
+    Status status = const_cast<QMoE*>(this)->PrepackWeights(
         context, moe_params, fc1_experts_weights, fc2_experts_weights,
         fc1_scales, fc2_scales, is_swiglu);
     ORT_RETURN_IF_ERROR(status);
@@ -148,81 +143,30 @@ Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
   AllocatorPtr allocator;
   ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
 
-  const int64_t num_threads = std::min<int64_t>(
-      static_cast<int64_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool)),
-      moe_params.num_rows);
-
   const int64_t total_output_size = moe_params.num_rows * moe_params.hidden_size;
-  std::fill_n(output_data, total_output_size, MLFloat16(0.0f));
-
-  // Using prepacked weights - no need to convert scales
-
-  auto thread_fc1_buffers = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(num_threads * moe_params.inter_size * (is_swiglu ? 2 : 1)));
-  auto thread_fc2_buffers = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(num_threads * moe_params.hidden_size));
-
-  // Set up output buffer
-  IAllocatorUniquePtr<float> output_float;
-  float* output_float_ptr = nullptr;
-
-  if constexpr (std::is_same_v<T, MLFloat16>) {
-    // For MLFloat16, we need a separate float buffer
-    output_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(total_output_size));
-    output_float_ptr = output_float.get();
-  } else {
-    // For float, we can write directly to output_data
-    output_float = IAllocatorUniquePtr<float>(output_data, [](float*) {});
-    output_float_ptr = output_data;
-  }
-
-  // Initialize output to zeros
-  std::fill_n(output_float_ptr, total_output_size, 0.0f);
-
-  // Prepare float buffers for input data and biases
-  IAllocatorUniquePtr<float> input_float;
-  IAllocatorUniquePtr<float> router_probs_float;
-
-  // Pointers for easier access
-  float* input_float_ptr = nullptr;
-  float* router_probs_float_ptr = nullptr;
-
-  // Pre-convert bias tensors to float (if they exist)
   const int64_t fc1_bias_size = is_swiglu ? 2 * moe_params.inter_size : moe_params.inter_size;
   const int64_t fc2_bias_size = moe_params.hidden_size;
 
-  // Allocate buffers for converted biases using ORT allocator
-  IAllocatorUniquePtr<float> fc1_bias_float;
-  IAllocatorUniquePtr<float> fc2_bias_float;
-
-  if (fc1_bias_data) {
-    fc1_bias_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_experts * fc1_bias_size));
-  }
-
-  if (fc2_bias_data) {
-    fc2_bias_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_experts * fc2_bias_size));
-  }
-
-  // Convert input and router_probs based on type
   if constexpr (std::is_same_v<T, MLFloat16>) {
-    // For MLFloat16, convert to float - need to allocate buffers first
-    input_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_rows * moe_params.hidden_size));
-    router_probs_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_rows * moe_params.num_experts));
-
-    input_float_ptr = input_float.get();
-    router_probs_float_ptr = router_probs_float.get();
+    // For MLFloat16, convert the inputs and biases to float, and the float result back to MLFloat16
+    auto input_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(total_output_size));
+    auto router_probs_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_rows * moe_params.num_experts));
+    auto output_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(total_output_size));
+    IAllocatorUniquePtr<float> fc1_bias_float;
+    IAllocatorUniquePtr<float> fc2_bias_float;
 
-    // Convert MLFloat16 to float
     MlasConvertHalfToFloatBufferInParallel(reinterpret_cast<const MLAS_FP16*>(input_data),
-                                           input_float_ptr,
-                                           static_cast<size_t>(moe_params.num_rows * moe_params.hidden_size),
+                                           input_float.get(),
+                                           static_cast<size_t>(total_output_size),
                                            thread_pool);
 
     MlasConvertHalfToFloatBufferInParallel(reinterpret_cast<const MLAS_FP16*>(router_probs_data),
-                                           router_probs_float_ptr,
+                                           router_probs_float.get(),
                                            static_cast<size_t>(moe_params.num_rows * moe_params.num_experts),
                                            thread_pool);
 
-    // Convert biases to float once (if they exist)
     if (fc1_bias_data) {
+      fc1_bias_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_experts * fc1_bias_size));
       MlasConvertHalfToFloatBufferInParallel(reinterpret_cast<const MLAS_FP16*>(fc1_bias_data),
                                              fc1_bias_float.get(),
                                              static_cast<size_t>(moe_params.num_experts * fc1_bias_size),
@@ -230,179 +174,42 @@ Status QMoE::QuantizedMoEImpl(OpKernelContext* context,
     }
 
     if (fc2_bias_data) {
+      fc2_bias_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(moe_params.num_experts * fc2_bias_size));
       MlasConvertHalfToFloatBufferInParallel(reinterpret_cast<const MLAS_FP16*>(fc2_bias_data),
                                              fc2_bias_float.get(),
                                              static_cast<size_t>(moe_params.num_experts * fc2_bias_size),
                                              thread_pool);
     }
-  } else {
-    // For float, point to original input and router_probs directly instead of copying
-    input_float = IAllocatorUniquePtr<float>(const_cast<float*>(input_data), [](float*) {});
-    router_probs_float = IAllocatorUniquePtr<float>(const_cast<float*>(router_probs_data), [](float*) {});
-
-    // Set pointers to the original data
-    input_float_ptr = const_cast<float*>(input_data);
-    router_probs_float_ptr = const_cast<float*>(router_probs_data);
-
-    // For float, just point to the original bias data directly without copying
-    // No need to allocate or copy, just reuse the original pointers
-    if (fc1_bias_data) {
-      // Release previously allocated memory if any
-      fc1_bias_float.reset();
-      // Direct pointer to original data
-      fc1_bias_float = IAllocatorUniquePtr<float>(const_cast<float*>(fc1_bias_data), [](float*) {});
-    }
 
-    if (fc2_bias_data) {
-      // Release previously allocated memory if any
-      fc2_bias_float.reset();
-      // Direct pointer to original data
-      fc2_bias_float = IAllocatorUniquePtr<float>(const_cast<float*>(fc2_bias_data), [](float*) {});
-    }
-  }
+    ORT_RETURN_IF_ERROR(ComputeQMoEExperts(input_float.get(), router_probs_float.get(),
+                                           fc1_weights_, fc1_bias_float.get(), fc2_weights_, fc2_bias_float.get(),
+                                           moe_params.num_rows, moe_params.num_experts, moe_params.hidden_size,
+                                           moe_params.inter_size, k_, normalize_routing_weights_, activation_type_,
+                                           output_float.get(), allocator, thread_pool));
 
-  // No need to initialize thread results - using direct output buffer
-
-  // Determine activation related parameters
-  const bool is_4bit = UseUInt4x2;
-  const int64_t act_multiplier = is_swiglu ? 2 : 1;
-  const int64_t fc1_output_size = is_swiglu ? 2 * moe_params.inter_size : moe_params.inter_size;
-
-  // Use prepacked dequantized weights - no need to dequantize here
-  const float* dequant_fc1_weights = prepacked_fc1_weights_data_;
-  const float* dequant_fc2_weights = prepacked_fc2_weights_data_;
-
-  // Process tokens in parallel
-  concurrency::ThreadPool::TryParallelFor(
-      thread_pool, static_cast<std::ptrdiff_t>(moe_params.num_rows),
-      static_cast<double>(std::max<int64_t>(1, moe_params.num_rows / num_threads)),
-      [&](ptrdiff_t start_token, ptrdiff_t end_token) {
-        const int64_t thread_id = start_token / ((moe_params.num_rows + num_threads - 1) / num_threads);
-        const int64_t thread_fc1_size = is_4bit ? (moe_params.inter_size * (is_swiglu ? 2 : 1)) : (moe_params.inter_size * act_multiplier);
-        float* thread_fc1_output = thread_fc1_buffers.get() + thread_id * thread_fc1_size;
-        float* thread_fc2_output = thread_fc2_buffers.get() + thread_id * moe_params.hidden_size;
-
-        // Process each token in this thread's range
-        for (std::ptrdiff_t token_idx = start_token; token_idx < end_token; ++token_idx) {
-          const float* token_input = input_float_ptr + static_cast<int64_t>(SafeInt<int64_t>(token_idx)) * moe_params.hidden_size;
-          float* token_result = output_float_ptr + static_cast<int64_t>(SafeInt<int64_t>(token_idx)) * moe_params.hidden_size;
-
-          // Process all experts for this token
-          for (std::ptrdiff_t expert_idx = 0; expert_idx < moe_params.num_experts; ++expert_idx) {
-            float routing_weight = router_probs_float_ptr[static_cast<int64_t>(SafeInt<int64_t>(token_idx)) * moe_params.num_experts + static_cast<int64_t>(SafeInt<int64_t>(expert_idx))];
-            if (routing_weight <= 1e-6f) continue;  // Skip experts with negligible routing weight
-
-            // FC1: input -> intermediate using pre-dequantized weights + MLAS SGEMM
-            const int64_t fc1_weight_offset = is_4bit ? (static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.hidden_size * fc1_output_size) : (static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.hidden_size * moe_params.inter_size * act_multiplier);
-            const float* fc1_expert_weights = dequant_fc1_weights + fc1_weight_offset;
-
-            // Bias size is always equal to output size (fc1_output_size), regardless of bit width
-            const int64_t fc1_bias_size = fc1_output_size;
-
-            // Use MLAS SGEMM for FC1
-            MLAS_SGEMM_DATA_PARAMS fc1_params;
-            fc1_params.A = token_input;
-            fc1_params.lda = static_cast<size_t>(moe_params.hidden_size);
-            fc1_params.B = fc1_expert_weights;
-            fc1_params.ldb = static_cast<size_t>(moe_params.hidden_size);
-            fc1_params.C = thread_fc1_output;
-            fc1_params.ldc = static_cast<size_t>(fc1_bias_size);
-            fc1_params.alpha = 1.0f;
-            fc1_params.beta = 0.0f;
-
-            MlasGemm(CblasNoTrans, CblasNoTrans, 1, static_cast<size_t>(fc1_bias_size), static_cast<size_t>(moe_params.hidden_size), fc1_params, nullptr);
-
-            // Handle different activation types
-            if (is_swiglu) {
-              // Add bias if present
-              if (fc1_bias_data) {
-                // Use the pre-converted float bias data
-                const float* fc1_expert_bias_float = fc1_bias_float.get() + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * fc1_bias_size;
-                for (int64_t i = 0; i < fc1_bias_size; ++i) {
-                  thread_fc1_output[i] += fc1_expert_bias_float[i];
-                }
-              }
-              contrib::ApplySwiGLUActivation(thread_fc1_output, moe_params.inter_size, is_4bit);
-            } else {
-              // Standard activation (non-SwiGLU)
-              if (fc1_bias_data) {
-                // Use the pre-converted float bias data
-                const float* fc1_expert_bias_float = fc1_bias_float.get() + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.inter_size;
-                for (int64_t i = 0; i < moe_params.inter_size; ++i) {
-                  thread_fc1_output[i] += fc1_expert_bias_float[i];
-                  thread_fc1_output[i] = ApplyActivation(thread_fc1_output[i], activation_type_);
-                }
-              } else {
-                for (int64_t i = 0; i < moe_params.inter_size; ++i) {
-                  thread_fc1_output[i] = ApplyActivation(thread_fc1_output[i], activation_type_);
-                }
-              }
-            }
-
-            // FC2: intermediate -> output using pre-dequantized weights + MLAS SGEMM
-            const float* fc2_expert_weights = dequant_fc2_weights + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.inter_size * moe_params.hidden_size;
-
-            // Use MLAS SGEMM for FC2
-            MLAS_SGEMM_DATA_PARAMS fc2_params;
-            fc2_params.A = thread_fc1_output;
-            fc2_params.lda = static_cast<size_t>(moe_params.inter_size);
-            fc2_params.B = fc2_expert_weights;
-            fc2_params.ldb = static_cast<size_t>(moe_params.inter_size);
-            fc2_params.C = thread_fc2_output;
-            fc2_params.ldc = static_cast<size_t>(moe_params.hidden_size);
-            fc2_params.alpha = 1.0f;
-            fc2_params.beta = 0.0f;
-
-            MlasGemm(CblasNoTrans, CblasNoTrans, 1, static_cast<size_t>(moe_params.hidden_size), static_cast<size_t>(moe_params.inter_size), fc2_params, nullptr);
-
-            // Add bias, apply routing weight, and accumulate to final result
-            if (fc2_bias_data) {
-              // Use the pre-converted float bias data
-              const float* fc2_expert_bias_float = fc2_bias_float.get() + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.hidden_size;
-              for (int64_t i = 0; i < moe_params.hidden_size; ++i) {
-                token_result[i] += routing_weight * (thread_fc2_output[i] + fc2_expert_bias_float[i]);
-              }
-            } else {
-              for (int64_t i = 0; i < moe_params.hidden_size; ++i) {
-                token_result[i] += routing_weight * thread_fc2_output[i];
-              }
-            }
-          }
-        }
-      });
-
-  // No need for accumulation since threads write directly to output_float
-
-  // Convert results back to the appropriate output type, if needed
-  if constexpr (std::is_same_v<T, MLFloat16>) {
-    // For MLFloat16, convert from float to half
-    MlasConvertFloatToHalfBuffer(output_float_ptr, reinterpret_cast<MLAS_FP16*>(output_data), static_cast<size_t>(total_output_size));
-  }
-  // For float, no conversion needed as we directly wrote to output_data
-
-  // Suppress unused parameter warnings for optional parameters that are not used in non-SwiGLU modes
-  if (!is_swiglu) {
-    ORT_UNUSED_PARAMETER(fc3_experts_bias_optional);
-    ORT_UNUSED_PARAMETER(fc3_scales_optional);
+    MlasConvertFloatToHalfBuffer(output_float.get(), reinterpret_cast<MLAS_FP16*>(output_data), static_cast<size_t>(total_output_size));
+  } else {
+    // For float, the inputs, biases and output are used directly
+    ORT_RETURN_IF_ERROR(ComputeQMoEExperts(input_data, router_probs_data,
+                                           fc1_weights_, fc1_bias_data, fc2_weights_, fc2_bias_data,
+                                           moe_params.num_rows, moe_params.num_experts, moe_params.hidden_size,
+                                           moe_params.inter_size, k_, normalize_routing_weights_, activation_type_,
+                                           output_data, allocator, thread_pool));
   }
 
   return Status::OK();
 }
 
-template <bool UseUInt4x2>
-Status QMoE::PrepackAndDequantizeWeights(OpKernelContext* context,
-                                         MoEParameters& moe_params,
-                                         const Tensor* fc1_experts_weights,
-                                         const Tensor* fc2_experts_weights,
-                                         const Tensor* fc1_scales,
-                                         const Tensor* fc2_scales,
-                                         bool is_swiglu) {
+Status QMoE::PrepackWeights(OpKernelContext* context,
+                            const MoEParameters& moe_params,
+                            const Tensor* fc1_experts_weights,
+                            const Tensor* fc2_experts_weights,
+                            const Tensor* fc1_scales,
+                            const Tensor* fc2_scales,
+                            bool is_swiglu) {
   // Get thread pool
   auto* thread_pool = context->GetOperatorThreadPool();
 
-  // Get input data pointers
-  const uint8_t* fc1_weights_data = fc1_experts_weights->Data<uint8_t>();
-  const uint8_t* fc2_weights_data = fc2_experts_weights->Data<uint8_t>();
   const void* fc1_scales_data_typed = fc1_scales->DataRaw();
   const void* fc2_scales_data_typed = fc2_scales->DataRaw();
   bool is_fp32_scales = fc1_scales->IsDataType<float>();
@@ -410,12 +217,9 @@ Status QMoE::PrepackAndDequantizeWeights(OpKernelContext* context,
   AllocatorPtr allocator;
   ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
 
-  const int64_t num_threads = std::min<int64_t>(
-      static_cast<int64_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool)),
-      moe_params.num_experts);
-
   // Prepare scales in float format
-  const int64_t fc1_scales_size = moe_params.num_experts * (is_swiglu ? 2 * moe_params.inter_size : moe_params.inter_size);
+  const int64_t fc1_output_size = is_swiglu ? 2 * moe_params.inter_size : moe_params.inter_size;
+  const int64_t fc1_scales_size = moe_params.num_experts * fc1_output_size;
   const int64_t fc2_scales_size = moe_params.num_experts * moe_params.hidden_size;
 
   auto fc1_scales_float = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(fc1_scales_size));
@@ -437,160 +241,299 @@ Status QMoE::PrepackAndDequantizeWeights(OpKernelContext* context,
                                            thread_pool);
   }
 
-  const float* fc1_scales_data = fc1_scales_float.get();
-  const float* fc2_scales_data = fc2_scales_float.get();
-
-  // Determine quantization parameters based on bit width - using symmetric quantization for TensorRT compatibility
-  const bool is_4bit = UseUInt4x2;
-  const int64_t act_multiplier = is_swiglu ? 2 : 1;
-  const int64_t fc1_output_size = is_swiglu ? 2 * moe_params.inter_size : moe_params.inter_size;
-
-  // Calculate weight sizes and strides based on quantization type
-  const int64_t fc1_weight_stride = is_4bit ? (moe_params.hidden_size * fc1_output_size / 2) : (moe_params.hidden_size * moe_params.inter_size * act_multiplier);
-  const int64_t fc2_weight_stride = is_4bit ? (moe_params.inter_size * moe_params.hidden_size / 2) : (moe_params.inter_size * moe_params.hidden_size);
-
   // Get or create a persistent allocator for weights
   if (weights_allocator_ == nullptr) {
     ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&weights_allocator_));
   }
 
-  // Allocate prepacked weight buffers using ORT allocator
-  const size_t fc1_weights_size = static_cast<size_t>(moe_params.num_experts * moe_params.hidden_size * (is_4bit ? fc1_output_size : moe_params.inter_size * act_multiplier));
-  const size_t fc2_weights_size = static_cast<size_t>(moe_params.num_experts * moe_params.inter_size * moe_params.hidden_size);
-
-  prepacked_fc1_weights_ = IAllocator::MakeUniquePtr<float>(weights_allocator_, fc1_weights_size);
-  prepacked_fc2_weights_ = IAllocator::MakeUniquePtr<float>(weights_allocator_, fc2_weights_size);
-
-  // Store pointers for easy access
-  prepacked_fc1_weights_data_ = prepacked_fc1_weights_.get();
-  prepacked_fc2_weights_data_ = prepacked_fc2_weights_.get();
-
-  // Helper lambda for dequantizing a single weight value - updated for symmetric quantization
-  auto DequantizeWeight = [&](const uint8_t* weights, size_t linear_idx,
-                              const float* scales, int64_t scale_idx) -> float {
-    if (is_4bit) {
-      // For Int4, two values are packed in each uint8
-      size_t packed_idx = linear_idx / 2;
-      uint8_t packed_value = weights[packed_idx];
-      uint8_t quantized_weight = (linear_idx % 2 == 0) ? (packed_value & 0x0F) : ((packed_value >> 4) & 0x0F);
-      // Convert uint4 to int4 with proper mapping for symmetric quantization
-      int8_t signed_weight = static_cast<int8_t>(quantized_weight);
-      if (signed_weight >= 8) {
-        signed_weight -= 16;  // Map [8, 15] to [-8, -1] for proper signed representation
+  // The weights of an expert are stored as (N, K) in memory for both the current and the legacy shapes
+  const size_t bits = static_cast<size_t>(expert_weight_bits_);
+  ORT_RETURN_IF_ERROR(fc1_weights_.Prepack(fc1_experts_weights->Data<uint8_t>(), fc1_scales_float.get(),
+                                           static_cast<size_t>(moe_params.num_experts),
+                                           static_cast<size_t>(fc1_output_size),
+                                           static_cast<size_t>(moe_params.hidden_size),
+                                           bits, weights_allocator_, thread_pool));
+  ORT_RETURN_IF_ERROR(fc2_weights_.Prepack(fc2_experts_weights->Data<uint8_t>(), fc2_scales_float.get(),
+                                           static_cast<size_t>(moe_params.num_experts),
+                                           static_cast<size_t>(moe_params.hidden_size),
+                                           static_cast<size_t>(moe_params.inter_size),
+                                           bits, weights_allocator_, thread_pool));
+
+  // Update cached parameters
+  cached_num_experts_ = moe_params.num_experts;
+  cached_hidden_size_ = moe_params.hidden_size;
+  cached_inter_size_ = moe_params.inter_size;
+  cached_is_swiglu_ = is_swiglu;
+  is_prepacked_ = true;
+
+  return Status::OK();
+}
+
+Status QMoEExpertWeights::Prepack(const uint8_t* quantized_weights, const float* scales, size_t num_experts,
+                                  size_t N, size_t K, size_t bits, AllocatorPtr allocator,
+                                  concurrency::ThreadPool* thread_pool) {
+  ORT_RETURN_IF_NOT(bits == 4 || bits == 8, "expert_weight_bits must be 4 or 8, but got ", bits);
+
+  N_ = N;
+  K_ = K;
+  bits_ = bits;
+  packed_weights_.reset();
+  block_scales_.reset();
+  dequantized_weights_.reset();
+
+  // MlasQNBitGemm only supports 8-bit weights with int8 activations
+  compute_type_ = bits == 4 ? SQNBIT_CompFp32 : SQNBIT_CompInt8;
+
+  // The scale of a channel is shared by all its blocks, so any block size that divides K keeps the layout of the
+  // quantized weights
+  block_size_ = 0;
+  for (size_t block_size : {size_t{32}, size_t{16}}) {
+    if (K % block_size == 0 && MlasIsQNBitGemmAvailable(bits, block_size, compute_type_) &&
+        MlasQNBitGemmPackQuantBDataSize(N, K, bits, block_size, false, compute_type_) > 0) {
+      block_size_ = block_size;
+      break;
+    }
+  }
+
+  const size_t expert_weights_size = N * K * bits / 8;
+
+  if (block_size_ != 0) {
+    const size_t block_count = K / block_size_;
+    packed_expert_stride_ = (MlasQNBitGemmPackQuantBDataSize(N, K, bits, block_size_, false, compute_type_) + 63) &
+                            ~size_t{63};
+    packed_weights_ = IAllocator::MakeUniquePtr<std::byte>(allocator, num_experts * packed_expert_stride_, true);
+    block_scales_ = IAllocator::MakeUniquePtr<float>(allocator, num_experts * N * block_count, true);
+
+    for (size_t channel = 0; channel < num_experts * N; ++channel) {
+      std::fill_n(block_scales_.get() + channel * block_count, block_count, scales[channel]);
+    }
+
+    // MlasQNBitGemm takes unsigned weights with the default zero point (8 or 128) instead of signed weights
+    const uint8_t sign_flip = bits == 4 ? uint8_t{0x88} : uint8_t{0x80};
+    std::vector<uint8_t> unsigned_weights(expert_weights_size);
+
+    for (size_t expert = 0; expert < num_experts; ++expert) {
+      const uint8_t* expert_weights = quantized_weights + expert * expert_weights_size;
+      for (size_t i = 0; i < expert_weights_size; ++i) {
+        unsigned_weights[i] = expert_weights[i] ^ sign_flip;
       }
-      return static_cast<float>(signed_weight) * scales[scale_idx];
-    } else {
-      // For Int8, convert uint8 to int8 for symmetric quantization
-      int8_t signed_weight = static_cast<int8_t>(weights[linear_idx]);
-      return static_cast<float>(signed_weight) * scales[scale_idx];
+      MlasQNBitGemmPackQuantBData(N, K, bits, block_size_, compute_type_, unsigned_weights.data(),
+                                  packed_weights_.get() + expert * packed_expert_stride_,
+                                  block_scales_.get() + expert * N * block_count, false, nullptr, thread_pool);
     }
-  };
+    return Status::OK();
+  }
+
+  dequantized_weights_ = IAllocator::MakeUniquePtr<float>(allocator, num_experts * N * K, true);
+  float* dequantized_weights = dequantized_weights_.get();
 
-  // Dequantize FC1 weights for all experts
   concurrency::ThreadPool::TryParallelFor(
-      thread_pool, static_cast<std::ptrdiff_t>(moe_params.num_experts),
-      static_cast<double>(std::max<int64_t>(1, moe_params.num_experts / num_threads)),
-      [&](ptrdiff_t expert_start, ptrdiff_t expert_end) {
-        for (std::ptrdiff_t expert_idx = expert_start; expert_idx < expert_end; ++expert_idx) {
-          const uint8_t* fc1_expert_weights = fc1_weights_data + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * fc1_weight_stride;
-          const float* fc1_expert_scales = fc1_scales_data + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * (is_4bit ? fc1_output_size : moe_params.inter_size * act_multiplier);
-          float* dequant_fc1_expert = prepacked_fc1_weights_data_ + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.hidden_size * (is_4bit ? fc1_output_size : moe_params.inter_size * act_multiplier);
-
-          const int64_t output_cols = is_4bit ? fc1_output_size : moe_params.inter_size * act_multiplier;
-          for (int64_t out_col = 0; out_col < output_cols; ++out_col) {
-            for (int64_t in_col = 0; in_col < moe_params.hidden_size; ++in_col) {
-              size_t linear_idx = static_cast<size_t>(out_col * moe_params.hidden_size + in_col);
-              dequant_fc1_expert[linear_idx] = DequantizeWeight(fc1_expert_weights, linear_idx, fc1_expert_scales, out_col);
+      thread_pool, static_cast<std::ptrdiff_t>(num_experts * N), static_cast<double>(K * 2),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t channel = begin; channel < end; ++channel) {
+          const float scale = scales[channel];
+          const size_t offset = static_cast<size_t>(channel) * K;
+          float* channel_weights = dequantized_weights + offset;
+          for (size_t i = 0; i < K; ++i) {
+            int quantized;
+            if (bits == 4) {
+              // Two signed 4-bit values are packed in each byte, the first one in the low nibble
+              const uint8_t packed = quantized_weights[(offset + i) / 2];
+              quantized = ((offset + i) % 2 == 0) ? (packed & 0x0F) : (packed >> 4);
+              quantized = quantized >= 8 ? quantized - 16 : quantized;
+            } else {
+              quantized = static_cast<int8_t>(quantized_weights[offset + i]);
             }
+            channel_weights[i] = static_cast<float>(quantized) * scale;
           }
         }
       });
 
-  // Dequantize FC2 weights for all experts
+  return Status::OK();
+}
+
+void QMoEExpertWeights::Gemm(size_t expert, size_t M, const float* A, size_t lda, float* C, AllocatorPtr allocator,
+                             concurrency::ThreadPool* thread_pool) const {
+  if (packed_weights_ == nullptr) {
+    MlasGemm(CblasNoTrans, CblasTrans, M, N_, K_, 1.0f, A, lda, dequantized_weights_.get() + expert * N_ * K_, K_,
+             0.0f, C, N_, thread_pool);
+    return;
+  }
+
+  IAllocatorUniquePtr<std::byte> workspace;
+  const size_t workspace_size = MlasQNBitGemmBatchWorkspaceSize(M, N_, K_, 1, bits_, block_size_, false, compute_type_);
+  if (workspace_size > 0) {
+    workspace = IAllocator::MakeUniquePtr<std::byte>(allocator, workspace_size, true);
+  }
+
+  const std::byte* packed_weights = packed_weights_.get() + expert * packed_expert_stride_;
+
+  MLAS_QNBIT_GEMM_DATA_PARAMS<float> params;
+  params.A = A;
+  params.lda = lda;
+  params.QuantBDataWorkspace = packed_weights;
+  params.PackedQuantBData = packed_weights;
+  params.QuantBScale = block_scales_.get() + expert * N_ * (K_ / block_size_);
+  params.C = C;
+  params.ldc = N_;
+  MlasQNBitGemmBatch(M, N_, K_, 1, bits_, block_size_, compute_type_, &params, workspace.get(), thread_pool);
+}
+
+Status ComputeQMoEExperts(const float* input, const float* router_logits,
+                          const QMoEExpertWeights& fc1_weights, const float* fc1_bias,
+                          const QMoEExpertWeights& fc2_weights, const float* fc2_bias,
+                          int64_t num_rows, int64_t num_experts, int64_t hidden_size, int64_t inter_size, int64_t k,
+                          bool normalize_routing_weights, ActivationType activation_type, float* output,
+                          AllocatorPtr allocator, concurrency::ThreadPool* thread_pool) {
+  const bool is_swiglu = activation_type == ActivationType::SwiGLU;
+  const int64_t fc1_output_size = is_swiglu ? 2 * inter_size : inter_size;
+  const int64_t num_entries = num_rows * k;
+
+  // Route each row to its top-k experts. Entry 'row * k + slot' is the slot-th expert of the row.
+  std::vector<int64_t> expert_ids(static_cast<size_t>(num_entries));
+  std::vector<float> routing_weights(static_cast<size_t>(num_entries));
+
   concurrency::ThreadPool::TryParallelFor(
-      thread_pool, static_cast<std::ptrdiff_t>(moe_params.num_experts),
-      static_cast<double>(std::max<int64_t>(1, moe_params.num_experts / num_threads)),
-      [&](ptrdiff_t expert_start, ptrdiff_t expert_end) {
-        for (std::ptrdiff_t expert_idx = expert_start; expert_idx < expert_end; ++expert_idx) {
-          const uint8_t* fc2_expert_weights = fc2_weights_data + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * fc2_weight_stride;
-          const float* fc2_expert_scales = fc2_scales_data + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.hidden_size;
-          float* dequant_fc2_expert = prepacked_fc2_weights_data_ + static_cast<int64_t>(SafeInt<int64_t>(expert_idx)) * moe_params.inter_size * moe_params.hidden_size;
-
-          for (int64_t out_col = 0; out_col < moe_params.hidden_size; ++out_col) {
-            for (int64_t in_col = 0; in_col < moe_params.inter_size; ++in_col) {
-              size_t linear_idx = static_cast<size_t>(out_col * moe_params.inter_size + in_col);
-              dequant_fc2_expert[linear_idx] = DequantizeWeight(fc2_expert_weights, linear_idx, fc2_expert_scales, out_col);
+      thread_pool, static_cast<std::ptrdiff_t>(num_rows), static_cast<double>(num_experts * (k + 4)),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t row = begin; row < end; ++row) {
+          SelectTopKExperts(router_logits + row * num_experts, num_experts, k, normalize_routing_weights,
+                            expert_ids.data() + row * k, routing_weights.data() + row * k);
+        }
+      });
+
+  // Permute the entries so that the rows of each expert are contiguous
+  std::vector<int64_t> expert_offsets(static_cast<size_t>(num_experts + 1));
+  std::vector<int64_t> permuted_entries(static_cast<size_t>(num_entries));
+  std::vector<int64_t> entry_positions(static_cast<size_t>(num_entries));
+  GroupEntriesByExpert(expert_ids.data(), num_entries, num_experts,
+                       expert_offsets.data(), permuted_entries.data(), entry_positions.data());
+
+  auto permuted_input = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(num_entries * hidden_size));
+  auto fc1_output = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(num_entries * fc1_output_size));
+  auto fc2_output = IAllocator::MakeUniquePtr<float>(allocator, static_cast<size_t>(num_entries * hidden_size));
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_entries),
+      TensorOpCost{static_cast<double>(hidden_size * sizeof(float)), static_cast<double>(hidden_size * sizeof(float)), 0},
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t position = begin; position < end; ++position) {
+          const int64_t row = permuted_entries[position] / k;
+          std::memcpy(permuted_input.get() + position * hidden_size, input + row * hidden_size,
+                      static_cast<size_t>(hidden_size) * sizeof(float));
+        }
+      });
+
+  // Runs both layers of an expert on its group of rows
+  auto compute_expert = [&](int64_t expert, concurrency::ThreadPool* gemm_thread_pool) {
+    const int64_t begin = expert_offsets[expert];
+    const size_t rows = static_cast<size_t>(expert_offsets[expert + 1] - begin);
+    float* fc1_rows = fc1_output.get() + begin * fc1_output_size;
+
+    fc1_weights.Gemm(static_cast<size_t>(expert), rows, permuted_input.get() + begin * hidden_size,
+                     static_cast<size_t>(hidden_size), fc1_rows, allocator, gemm_thread_pool);
+
+    const float* expert_fc1_bias = fc1_bias ? fc1_bias + expert * fc1_output_size : nullptr;
+    for (size_t r = 0; r < rows; ++r) {
+      float* fc1_row = fc1_rows + r * fc1_output_size;
+      if (expert_fc1_bias) {
+        for (int64_t i = 0; i < fc1_output_size; ++i) {
+          fc1_row[i] += expert_fc1_bias[i];
+        }
+      }
+      if (is_swiglu) {
+        // The linear and gate values are interleaved, and the result is stored in the first inter_size values
+        ApplySwiGLUActivation(fc1_row, inter_size, true);
+      } else {
+        for (int64_t i = 0; i < inter_size; ++i) {
+          fc1_row[i] = ApplyActivation(fc1_row[i], activation_type);
+        }
+      }
+    }
+
+    fc2_weights.Gemm(static_cast<size_t>(expert), rows, fc1_rows, static_cast<size_t>(fc1_output_size),
+                     fc2_output.get() + begin * hidden_size, allocator, gemm_thread_pool);
+  };
+
+  std::vector<int64_t> active_experts;
+  for (int64_t expert = 0; expert < num_experts; ++expert) {
+    if (expert_offsets[expert + 1] > expert_offsets[expert]) {
+      active_experts.push_back(expert);
+    }
+  }
+
+  // With enough experts to occupy the threads, each expert runs single threaded. Otherwise the experts run one
+  // after another, with the GEMMs split over the threads.
+  if (static_cast<int64_t>(active_experts.size()) >= concurrency::ThreadPool::DegreeOfParallelism(thread_pool)) {
+    const double expert_cost = static_cast<double>(num_entries) / static_cast<double>(active_experts.size()) *
+                               static_cast<double>(hidden_size * (fc1_output_size + inter_size));
+    concurrency::ThreadPool::TryParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(active_experts.size()), expert_cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          for (std::ptrdiff_t i = begin; i < end; ++i) {
+            compute_expert(active_experts[i], nullptr);
+          }
+        });
+  } else {
+    for (int64_t expert : active_experts) {
+      compute_expert(expert, thread_pool);
+    }
+  }
+
+  // Sum the outputs of the experts of each row, scaled by the routing weights
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_rows),
+      TensorOpCost{static_cast<double>(k * hidden_size * sizeof(float)), static_cast<double>(hidden_size * sizeof(float)),
+                   static_cast<double>(k * hidden_size * 2)},
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t row = begin; row < end; ++row) {
+          float* output_row = output + row * hidden_size;
+          std::fill_n(output_row, hidden_size, 0.0f);
+          for (int64_t slot = 0; slot < k; ++slot) {
+            const int64_t entry = row * k + slot;
+            const float weight = routing_weights[entry];
+            const float* expert_output = fc2_output.get() + entry_positions[entry] * hidden_size;
+            const float* expert_fc2_bias = fc2_bias ? fc2_bias + expert_ids[entry] * hidden_size : nullptr;
+            if (expert_fc2_bias) {
+              for (int64_t i = 0; i < hidden_size; ++i) {
+                output_row[i] += weight * (expert_output[i] + expert_fc2_bias[i]);
+              }
+            } else {
+              for (int64_t i = 0; i < hidden_size; ++i) {
+                output_row[i] += weight * expert_output[i];
+              }
             }
           }
         }
       });
 
-  // Update cached parameters
-  cached_num_experts_ = moe_params.num_experts;
-  cached_hidden_size_ = moe_params.hidden_size;
-  cached_inter_size_ = moe_params.inter_size;
-  cached_is_swiglu_ = is_swiglu;
-  is_prepacked_ = true;
-
   return Status::OK();
 }
 
 // Explicit template instantiations
-template Status QMoE::QuantizedMoEImpl<true, MLFloat16>(OpKernelContext* context,
-                                                        MoEParameters& moe_params,
-                                                        const Tensor* input,
-                                                        const Tensor* router_probs,
-                                                        const Tensor* fc1_experts_weights,
-                                                        const Tensor* fc1_experts_bias_optional,
-                                                        const Tensor* fc2_experts_weights,
-                                                        const Tensor* fc2_experts_bias_optional,
-                                                        const Tensor* fc3_experts_weights_optional,
-                                                        const Tensor* fc3_experts_bias_optional,
-                                                        const Tensor* fc1_scales,
-                                                        const Tensor* fc2_scales,
-                                                        const Tensor* fc3_scales_optional) const;
-
-template Status QMoE::QuantizedMoEImpl<false, MLFloat16>(OpKernelContext* context,
-                                                         MoEParameters& moe_params,
-                                                         const Tensor* input,
-                                                         const Tensor* router_probs,
-                                                         const Tensor* fc1_experts_weights,
-                                                         const Tensor* fc1_experts_bias_optional,
-                                                         const Tensor* fc2_experts_weights,
-                                                         const Tensor* fc2_experts_bias_optional,
-                                                         const Tensor* fc3_experts_weights_optional,
-                                                         const Tensor* fc3_experts_bias_optional,
-                                                         const Tensor* fc1_scales,
-                                                         const Tensor* fc2_scales,
-                                                         const Tensor* fc3_scales_optional) const;
-
-template Status QMoE::QuantizedMoEImpl<true, float>(OpKernelContext* context,
-                                                    MoEParameters& moe_params,
-                                                    const Tensor* input,
-                                                    const Tensor* router_probs,
-                                                    const Tensor* fc1_experts_weights,
-                                                    const Tensor* fc1_experts_bias_optional,
-                                                    const Tensor* fc2_experts_weights,
-                                                    const Tensor* fc2_experts_bias_optional,
-                                                    const Tensor* fc3_experts_weights_optional,
-                                                    const Tensor* fc3_experts_bias_optional,
-                                                    const Tensor* fc1_scales,
-                                                    const Tensor* fc2_scales,
-                                                    const Tensor* fc3_scales_optional) const;
-
-template Status QMoE::QuantizedMoEImpl<false, float>(OpKernelContext* context,
-                                                     MoEParameters& moe_params,
-                                                     const Tensor* input,
-                                                     const Tensor* router_probs,
-                                                     const Tensor* fc1_experts_weights,
-                                                     const Tensor* fc1_experts_bias_optional,
-                                                     const Tensor* fc2_experts_weights,
-                                                     const Tensor* fc2_experts_bias_optional,
-                                                     const Tensor* fc3_experts_weights_optional,
-                                                     const Tensor* fc3_experts_bias_optional,
-                                                     const Tensor* fc1_scales,
-                                                     const Tensor* fc2_scales,
-                                                     const Tensor* fc3_scales_optional) const;
+template Status QMoE::QuantizedMoEImpl<MLFloat16>(OpKernelContext* context,
+                                                  MoEParameters& moe_params,
+                                                  const Tensor* input,
+                                                  const Tensor* router_probs,
+                                                  const Tensor* fc1_experts_weights,
+                                                  const Tensor* fc1_experts_bias_optional,
+                                                  const Tensor* fc2_experts_weights,
+                                                  const Tensor* fc2_experts_bias_optional,
+                                                  const Tensor* fc3_experts_weights_optional,
+                                                  const Tensor* fc1_scales,
+                                                  const Tensor* fc2_scales) const;
+
+template Status QMoE::QuantizedMoEImpl<float>(OpKernelContext* context,
+                                              MoEParameters& moe_params,
+                                              const Tensor* input,
+                                              const Tensor* router_probs,
+                                              const Tensor* fc1_experts_weights,
+                                              const Tensor* fc1_experts_bias_optional,
+                                              const Tensor* fc2_experts_weights,
+                                              const Tensor* fc2_experts_bias_optional,
+                                              const Tensor* fc3_experts_weights_optional,
+                                              const Tensor* fc1_scales,
+                                              const Tensor* fc2_scales) const;
 
 }  // namespace contrib
 }  // namespace onnxruntime
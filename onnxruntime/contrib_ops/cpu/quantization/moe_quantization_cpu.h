@@ -6,26 +6,65 @@
 #include "contrib_ops/cpu/moe/moe_base_cpu.h"
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas_qnbit.h"
 
 namespace onnxruntime {
 namespace contrib {
 
+// Weights of a fully connected layer of all the experts of QMoE, from the symmetric quantized weights of shape
+// (num_experts, N, K / pack_size) with one scale per output channel.
+// The weights are prepacked for MlasQNBitGemm, with the scale of a channel repeated for each quantization block,
+// or dequantized to fp32 on the platforms where MlasQNBitGemm doesn't support the bit width.
+class QMoEExpertWeights {
+ public:
+  Status Prepack(const uint8_t* quantized_weights, const float* scales, size_t num_experts, size_t N, size_t K,
+                 size_t bits, AllocatorPtr allocator, concurrency::ThreadPool* thread_pool);
+
+  // C (M x N) = A (M x K) * transpose(W) of the expert
+  void Gemm(size_t expert, size_t M, const float* A, size_t lda, float* C, AllocatorPtr allocator,
+            concurrency::ThreadPool* thread_pool) const;
+
+  bool IsQNBitGemm() const { return packed_weights_ != nullptr; }
+
+ private:
+  size_t N_{0};
+  size_t K_{0};
+  size_t bits_{0};
+  size_t block_size_{0};
+  MLAS_QNBIT_GEMM_COMPUTE_TYPE compute_type_{SQNBIT_CompFp32};
+
+  IAllocatorUniquePtr<std::byte> packed_weights_;
+  size_t packed_expert_stride_{0};
+  IAllocatorUniquePtr<float> block_scales_;
+
+  IAllocatorUniquePtr<float> dequantized_weights_;
+};
+
+// Computes the experts of QMoE for fp32 rows. Each row is routed to the top-k experts of its router logits, the
+// rows are grouped by expert, and each expert runs its two fully connected layers on its whole group of rows.
+// fc1_bias and fc2_bias are optional.
+Status ComputeQMoEExperts(const float* input, const float* router_logits,
+                          const QMoEExpertWeights& fc1_weights, const float* fc1_bias,
+                          const QMoEExpertWeights& fc2_weights, const float* fc2_bias,
+                          int64_t num_rows, int64_t num_experts, int64_t hidden_size, int64_t inter_size, int64_t k,
+                          bool normalize_routing_weights, ActivationType activation_type, float* output,
+                          AllocatorPtr allocator, concurrency::ThreadPool* thread_pool);
+
 class QMoE final : public OpKernel, public MoEBaseCPU {
  public:
   explicit QMoE(const OpKernelInfo& op_kernel_info);
   Status Compute(OpKernelContext* ctx) const override;
 
  private:
-  template <bool UseUInt4x2>
-  Status PrepackAndDequantizeWeights(OpKernelContext* context,
-                                     MoEParameters& moe_params,
-                                     const Tensor* fc1_experts_weights,
-                                     const Tensor* fc2_experts_weights,
-                                     const Tensor* fc1_scales,
-                                     const Tensor* fc2_scales,
-                                     bool is_swiglu);
-
-  template <bool UseUInt4x2, typename T>
+  Status PrepackWeights(OpKernelContext* context,
+                        const MoEParameters& moe_params,
+                        const Tensor* fc1_experts_weights,
+                        const Tensor* fc2_experts_weights,
+                        const Tensor* fc1_scales,
+                        const Tensor* fc2_scales,
+                        bool is_swiglu);
+
+  template <typename T>
   Status QuantizedMoEImpl(OpKernelContext* context,
                           MoEParameters& moe_params,
                           const Tensor* input,
@@ -35,16 +74,12 @@ class QMoE final : public OpKernel, public MoEBaseCPU {
                           const Tensor* fc2_experts_weights,
                           const Tensor* fc2_experts_bias_optional,
                           const Tensor* fc3_experts_weights_optional,
-                          const Tensor* fc3_experts_bias_optional,
                           const Tensor* fc1_scales,
-                          const Tensor* fc2_scales,
-                          const Tensor* fc3_scales_optional) const;
-
-  // Prepacked dequantized weights stored for reuse
-  IAllocatorUniquePtr<float> prepacked_fc1_weights_;
-  IAllocatorUniquePtr<float> prepacked_fc2_weights_;
-  float* prepacked_fc1_weights_data_{nullptr};
-  float* prepacked_fc2_weights_data_{nullptr};
+                          const Tensor* fc2_scales) const;
+
+  // Prepacked expert weights stored for reuse
+  QMoEExpertWeights fc1_weights_;
+  QMoEExpertWeights fc2_weights_;
 
   // Persistent allocator for weights
   AllocatorPtr weights_allocator_;
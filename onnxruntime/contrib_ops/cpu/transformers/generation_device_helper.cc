@@ -4,10 +4,12 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/cpu/math/top_k.h"
 #include "core/providers/cpu/math/softmax_shared.h"
 #include "core/providers/cpu/generator/random.h"
 #include "core/common/safeint.h"
+#include "core/platform/threadpool.h"
 #include <gsl/gsl>
 #include "contrib_ops/cpu/transformers/sequences.h"
 #include "contrib_ops/cpu/transformers/beam_search_scorer.h"
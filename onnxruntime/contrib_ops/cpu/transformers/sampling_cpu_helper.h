@@ -2,56 +2,45 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include <algorithm>
+#include <vector>
+#include "core/framework/tensor.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/generator/random.h"
+#include "core/providers/cpu/math/top_k.h"
+#include "contrib_ops/cpu/transformers/generation_shared.h"
+
 namespace onnxruntime {
 namespace contrib {
 namespace SamplingCpuHelper {
 
-template <typename T>
-void filter_scores(std::vector<size_t>& sorted_indice,
-                   gsl::span<T>& next_token_score,
-                   const transformers::IGenerationParameters* parameters,
-                   size_t chunk_offset,
-                   size_t offset) {
-  size_t real_index = sorted_indice[chunk_offset + offset];
-  next_token_score[chunk_offset + real_index] = (T)parameters->filter_value;
-}
-
-template <typename T>
-void cumulate_and_filter_custom(gsl::span<T>& next_token_scores,
-                                gsl::span<T>& cumulative_probs,
-                                const transformers::IGenerationParameters* parameters,
-                                std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] > parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 1);
+// Number of candidates selected first in a row. The candidates are doubled until they reach the top-p mass.
+constexpr size_t kInitialTopPCandidateCount = 64;
+
+// Returns the number of tokens kept by top-p filtering, given the probabilities of the candidates in descending
+// order, or -1 if the candidates don't reach the point where filtering starts.
+// Custom sampling keeps the first token and every token before which the cumulative probability is at most top_p.
+// Otherwise, like Hugging Face, the tokens before which the cumulative probability is below top_p are kept, with at
+// least min_tokens_to_keep tokens.
+inline ptrdiff_t top_p_keep_count(const float* candidate_probs,
+                                  size_t candidate_count,
+                                  size_t vocab_size,
+                                  const transformers::IGenerationParameters* parameters) {
+  const size_t min_keep = parameters->custom_sampling ? 1 : static_cast<size_t>(parameters->min_tokens_to_keep);
+  float cumulative_prob = 0.0f;
+  for (size_t i = 0; i <= candidate_count && i < vocab_size; i++) {
+    const bool is_filtered = parameters->custom_sampling ? cumulative_prob > parameters->top_p
+                                                         : cumulative_prob >= parameters->top_p;
+    if (i >= min_keep && is_filtered) {
+      return static_cast<ptrdiff_t>(i);
     }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - 1; j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] > parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j + 1);
-      }
+    if (i < candidate_count) {
+      cumulative_prob += candidate_probs[i];
     }
   }
-}
 
-template <typename T>
-void cumulate_and_filter(gsl::span<T>& next_token_scores,
-                         gsl::span<T>& cumulative_probs,
-                         const transformers::IGenerationParameters* parameters,
-                         std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] <= 1 - parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 0);
-    }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - static_cast<size_t>(parameters->min_tokens_to_keep); j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] <= 1 - parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j);
-      }
-    }
-  }
+  return candidate_count == vocab_size ? static_cast<ptrdiff_t>(vocab_size) : -1;
 }
 
 template <typename T>
@@ -64,56 +53,58 @@ Status Sample(AllocatorPtr& allocator,
               const IConsoleDumper* dumper) {
   ORT_UNUSED_PARAMETER(dumper);
 
-  gsl::span<T>& sorted_scores = sampling_state->sorted_scores;
-  memcpy(sorted_scores.data(), next_token_scores.data(), next_token_scores.size_bytes());
-  std::vector<size_t> sorted_indices(static_cast<size_t>(parameters->batch_size) * static_cast<size_t>(parameters->vocab_size));
-
-  std::function<bool(T, T)> predicator;
-  if (parameters->custom_sampling) {
-    predicator = std::greater<T>();
-  } else {
-    predicator = std::less<T>();
-  }
-
-  // TODO: This could be optimized with allocated buffer and handwritten sort algorithm
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    auto indices_begin = sorted_indices.begin() + i * parameters->vocab_size;
-    auto indices_end = sorted_indices.begin() + (i + 1) * parameters->vocab_size;
-    gsl::span<T> next_token_score = next_token_scores.subspan(i * parameters->vocab_size, parameters->vocab_size);
-    std::iota(indices_begin, indices_end, 0);
-    std::sort(indices_begin, indices_end,
-              [&next_token_score, &predicator](size_t i1, size_t i2) {
-                return predicator(next_token_score[i1], next_token_score[i2]);
-              });
-
-    std::sort(sorted_scores.begin() + i * parameters->vocab_size,
-              sorted_scores.begin() + (i + 1) * parameters->vocab_size,
-              predicator);
-  }
-
-#ifdef DEBUG_GENERATION
-  dumper->Print("sorted_scores", sorted_scores.data(), parameters->batch_size, parameters->vocab_size);
-  std::vector<int64_t> sorted_indices_copy(sorted_indices.begin(), sorted_indices.end());
-  dumper->Print("sorted_indices", sorted_indices_copy.data(), parameters->batch_size, parameters->vocab_size);
-#endif
-
-  gsl::span<T>& cumulative_probs = sampling_state->cumulative_probs;
-
-  ORT_RETURN_IF_ERROR(SoftmaxCPU<T>(parameters->batch_size,
-                                    parameters->vocab_size,
-                                    sorted_scores.data(),
-                                    cumulative_probs.data(),
-                                    false,
-                                    thread_pool));
-
-  if (parameters->custom_sampling) {
-    cumulate_and_filter_custom(next_token_scores, cumulative_probs, parameters, sorted_indices);
-  } else {
-    cumulate_and_filter(next_token_scores, cumulative_probs, parameters, sorted_indices);
+  // Filter each row to the smallest set of most probable tokens that reaches top_p, without sorting the whole
+  // vocabulary: the softmax of the row is computed in one pass, then the largest candidates are selected with the
+  // selection shared with TopK, and only they are sorted. The candidates are doubled while their cumulative
+  // probability is short of top_p.
+  // A top_p of 1 or more keeps every token, so the rows are left as they are rather than letting a cumulative
+  // probability that rounds up to 1 drop the tail of the vocabulary.
+  if (parameters->top_p < 1.0f) {
+    const size_t vocab_size = static_cast<size_t>(parameters->vocab_size);
+    std::vector<int64_t> candidate_indices(static_cast<size_t>(parameters->batch_size) * vocab_size);
+
+    TensorOpCost unit_cost;
+    unit_cost.bytes_loaded = static_cast<double>(3 * vocab_size * sizeof(T));
+    unit_cost.bytes_stored = static_cast<double>(2 * vocab_size * sizeof(T));
+    unit_cost.compute_cycles = static_cast<double>(8 * vocab_size);
+
+    concurrency::ThreadPool::TryParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(parameters->batch_size), unit_cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            T* row_scores = next_token_scores.data() + i * vocab_size;
+            T* row_probs = sampling_state->cumulative_probs.data() + i * vocab_size;
+            T* kept_scores = sampling_state->sorted_scores.data() + i * vocab_size;
+            int64_t* row_indices = candidate_indices.data() + i * vocab_size;
+
+            MlasComputeSoftmax(row_scores, row_probs, 1, vocab_size, false, false, 0.0f, nullptr);
+
+            size_t candidate_count = std::min(vocab_size, kInitialTopPCandidateCount);
+            ptrdiff_t keep_count;
+            for (;;) {
+              GetTopKIndicesOfRow(row_scores, vocab_size, candidate_count, true, true, row_indices);
+              for (size_t j = 0; j < candidate_count; j++) {
+                kept_scores[j] = row_probs[row_indices[j]];
+              }
+              keep_count = top_p_keep_count(kept_scores, candidate_count, vocab_size, parameters);
+              if (keep_count >= 0) {
+                break;
+              }
+              candidate_count = std::min(vocab_size, 2 * candidate_count);
+            }
+
+            for (ptrdiff_t j = 0; j < keep_count; j++) {
+              kept_scores[j] = row_scores[row_indices[j]];
+            }
+            std::fill_n(row_scores, vocab_size, static_cast<T>(parameters->filter_value));
+            for (ptrdiff_t j = 0; j < keep_count; j++) {
+              row_scores[row_indices[j]] = kept_scores[j];
+            }
+          }
+        });
   }
 
 #ifdef DEBUG_GENERATION
-  dumper->Print("cumulative_probs after filtering", cumulative_probs.data(), parameters->batch_size, parameters->vocab_size);
   dumper->Print("next_token_scores after filtering", next_token_scores.data(), parameters->batch_size, parameters->vocab_size);
 #endif
 
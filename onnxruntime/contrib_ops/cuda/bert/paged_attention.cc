@@ -7,7 +7,7 @@
 #include "contrib_ops/cuda/utils/dump_cuda_tensor.h"
 #include "contrib_ops/cuda/bert/paged_attention_impl.h"
 #include "contrib_ops/cuda/bert/paged_attention.h"
-#include "contrib_ops/cuda/bert/paged_attention_helper.h"
+#include "contrib_ops/cpu/bert/paged_attention_helper.h"
 #include "contrib_ops/cuda/bert/flash_attention/flash_api.h"
 
 using namespace onnxruntime::cuda;
@@ -87,6 +87,12 @@ Status PagedAttention<T>::ComputeInternal(OpKernelContext* context) const {
                                                           scale_,
                                                           softcap_,
                                                           device_prop.maxThreadsPerBlock));
+  // TODO(aciddelgado): block size multiple of 8
+  if (parameters.block_size % 256 != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "block_size must be a multiple of 256. Got block_size % 256 == ",
+                           parameters.block_size % 256);
+  }
   parameters.local_window_size = local_window_size_;
   parameters.do_rotary = do_rotary_;
   parameters.rotary_interleaved = rotary_interleaved_;
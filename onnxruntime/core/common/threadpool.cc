@@ -402,6 +402,28 @@ ThreadPool::ThreadPool(Env* env,
 
 ThreadPool::~ThreadPool() = default;
 
+namespace {
+// Degree of parallelism limit of the loops started by the current thread, <= 0 when there is none.
+thread_local int degree_of_parallelism_limit = 0;
+
+// Caps the number of work items of a loop to the limit of the current thread.
+int LimitWorkItems(int num_work_items) {
+  const int limit = degree_of_parallelism_limit;
+  return limit > 0 ? std::min(num_work_items, limit) : num_work_items;
+}
+}  // namespace
+
+ThreadPool::DegreeOfParallelismLimit::DegreeOfParallelismLimit(int limit)
+    : previous_limit_(degree_of_parallelism_limit) {
+  if (limit > 0) {
+    degree_of_parallelism_limit = limit;
+  }
+}
+
+ThreadPool::DegreeOfParallelismLimit::~DegreeOfParallelismLimit() {
+  degree_of_parallelism_limit = previous_limit_;
+}
+
 // Base case for parallel loops, running iterations 0..total, divided into blocks
 // of block_size iterations, and calling into a function that takes a start..end
 // range of indices to run.
@@ -423,6 +445,7 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     auto num_blocks = total / block_size;
     auto num_threads_inc_main = NumThreads() + 1;
     int num_work_items = static_cast<int>(std::min(static_cast<std::ptrdiff_t>(num_threads_inc_main), num_blocks));
+    num_work_items = LimitWorkItems(num_work_items);
     assert(num_work_items > 0);
 
     LoopCounter lc(total, d_of_p, block_size);
@@ -460,7 +483,7 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     };
     // Distribute task among all threads in the pool, reduce number of work items if
     // num_of_blocks is smaller than number of threads.
-    RunInParallel(run_work, std::min(NumThreads() + 1, num_of_blocks), base_block_size);
+    RunInParallel(run_work, LimitWorkItems(std::min(NumThreads() + 1, num_of_blocks)), base_block_size);
   }
 }
 
@@ -640,16 +663,24 @@ int ThreadPool::DegreeOfParallelism(const concurrency::ThreadPool* tp) {
   // When not using OpenMP, we parallelize over the N threads created by the pool
   // tp, plus 1 for the thread entering a loop.
   if (tp) {
-    if (tp->force_hybrid_ || CPUIDInfo::GetCPUIDInfo().IsHybrid()) {
-      return ((tp->NumThreads() + 1)) * TaskGranularityFactor;
+    // The limit counts threads, the tasks of hybrid CPUs are split from the limited number of threads.
+    // A limit of one thread runs the loops sequentially without splitting them.
+    const int num_threads = NumLoopThreads(tp);
+    if ((tp->force_hybrid_ || CPUIDInfo::GetCPUIDInfo().IsHybrid()) &&
+        (num_threads > 1 || degree_of_parallelism_limit != 1)) {
+      return num_threads * TaskGranularityFactor;
     } else {
-      return ((tp->NumThreads() + 1));
+      return num_threads;
     }
   } else {
     return 1;
   }
 }
 
+int ThreadPool::NumLoopThreads(const concurrency::ThreadPool* tp) {
+  return tp ? LimitWorkItems(tp->NumThreads() + 1) : 1;
+}
+
 void ThreadPool::StartProfiling(concurrency::ThreadPool* tp) {
   if (tp) {
     tp->StartProfiling();
@@ -18,6 +18,8 @@ struct AllocatorStats {
   int64_t total_allocated_bytes;  // The total number of allocated bytes by the allocator.
   int64_t max_bytes_in_use;       // The maximum bytes in use.
   int64_t max_alloc_size;         // The max single allocation seen.
+  int64_t num_cache_hits;         // Number of allocations served by the thread cache (BFCArena only).
+  int64_t num_cache_misses;       // Number of allocations that missed the thread cache (BFCArena only).
                                   // The upper limit what the allocator can allocate, if such a limit
                                   // is known. Certain allocator may return 0 to indicate the limit is
                                   // unknown.
@@ -33,10 +35,18 @@ struct AllocatorStats {
     this->bytes_in_use = 0;
     this->max_bytes_in_use = 0;
     this->max_alloc_size = 0;
+    this->num_cache_hits = 0;
+    this->num_cache_misses = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
   }
 
+  // Ratio of the allocations served by the thread cache, 0 if the cache is disabled.
+  double CacheHitRatio() const {
+    const int64_t lookups = num_cache_hits + num_cache_misses;
+    return lookups == 0 ? 0. : static_cast<double>(num_cache_hits) / static_cast<double>(lookups);
+  }
+
   std::string DebugString() const {
     std::ostringstream ss;
     ss << "Limit:                    " << this->bytes_limit << "\n"
@@ -47,7 +57,10 @@ struct AllocatorStats {
        << "NumReserves:              " << this->num_reserves << "\n"
        << "NumArenaExtensions:       " << this->num_arena_extensions << "\n"
        << "NumArenaShrinkages:       " << this->num_arena_shrinkages << "\n"
-       << "MaxAllocSize:             " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:             " << this->max_alloc_size << "\n"
+       << "NumCacheHits:             " << this->num_cache_hits << "\n"
+       << "NumCacheMisses:           " << this->num_cache_misses << "\n"
+       << "CacheHitRatio:            " << this->CacheHitRatio() << "\n";
     return ss.str();
   }
 };
@@ -6,13 +6,19 @@
 #include <type_traits>
 
 namespace onnxruntime {
+namespace {
+// Used to spread the threads over the cache shards.
+std::atomic<size_t> next_cache_shard{0};
+}  // namespace
+
 BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                    size_t total_memory,
                    ArenaExtendStrategy arena_extend_strategy,
                    int initial_chunk_size_bytes,
                    int max_dead_bytes_per_chunk,
                    int initial_growth_chunk_size_bytes,
-                   int64_t max_power_of_two_extend_bytes)
+                   int64_t max_power_of_two_extend_bytes,
+                   int64_t thread_cache_max_bytes)
     : IAllocator(OrtMemoryInfo(resource_allocator->Info().name,
                                OrtAllocatorType::OrtArenaAllocator,
                                resource_allocator->Info().device,
@@ -24,12 +30,14 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       initial_chunk_size_bytes_(initial_chunk_size_bytes),
       max_dead_bytes_per_chunk_(max_dead_bytes_per_chunk),
       initial_growth_chunk_size_bytes_(initial_growth_chunk_size_bytes),
-      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes) {
+      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes),
+      thread_cache_max_bytes_(thread_cache_max_bytes) {
   LOGS_DEFAULT(INFO) << "Creating BFCArena for " << device_allocator_->Info().name
                      << " with following configs: initial_chunk_size_bytes: " << initial_chunk_size_bytes_
                      << " max_dead_bytes_per_chunk: " << max_dead_bytes_per_chunk_
                      << " initial_growth_chunk_size_bytes: " << initial_growth_chunk_size_bytes_
                      << " max_power_of_two_extend_bytes: " << max_power_of_two_extend_bytes_
+                     << " thread_cache_max_bytes: " << thread_cache_max_bytes_
                      << " memory limit: " << total_memory
                      << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy);
 
@@ -74,6 +82,14 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       ORT_ENFORCE(BinForSize(bin_size * 2) != BinFromIndex(b));
     }
   }
+
+  if (thread_cache_max_bytes_ > 0) {
+    cache_shards_ = std::make_unique<CacheShard[]>(kNumCacheShards);
+    cache_size_shards_ = std::make_unique<CacheSizeShard[]>(kNumCacheShards);
+    for (int i = 0; i < kNumCacheShards; ++i) {
+      cache_size_shards_[i].sizes.reserve(kNumCachedBins * kMaxCachedChunksPerBin);
+    }
+  }
 }
 
 BFCArena::~BFCArena() {
@@ -269,9 +285,144 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
 }
 
 void* BFCArena::Alloc(size_t size) {
+  if (cache_shards_ && size != 0) {
+    return AllocateWithThreadCache(size);
+  }
   return AllocateRawInternal(size, false, nullptr);
 }
 
+BFCArena::CacheShard& BFCArena::ThreadCacheShard() {
+  static thread_local const size_t shard = next_cache_shard++ % kNumCacheShards;
+  return cache_shards_[shard];
+}
+
+void* BFCArena::AllocateWithThreadCache(size_t num_bytes) {
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  const BinNum bin_num = BinNumForSize(rounded_bytes);
+  void* ptr = nullptr;
+  size_t chunk_size = 0;
+
+  if (bin_num < kNumCachedBins) {
+    CacheShard& shard = ThreadCacheShard();
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto& cached = shard.bins[bin_num];
+    // Most recently freed chunks first, their memory is more likely to be in the cache.
+    for (auto it = cached.rbegin(); it != cached.rend(); ++it) {
+      // A chunk of the same bin is less than twice as large as rounded_bytes.
+      if (it->size >= rounded_bytes) {
+        ptr = it->ptr;
+        chunk_size = it->size;
+        shard.bytes -= chunk_size;
+        cached.erase(std::next(it).base());
+        break;
+      }
+    }
+  }
+
+  if (ptr != nullptr) {
+    // The size of a cached chunk is still recorded in its size shard.
+    ++num_cache_hits_;
+    return ptr;
+  }
+
+  ++num_cache_misses_;
+  ORT_TRY {
+    ptr = AllocateRawInternal(num_bytes, false, nullptr, &chunk_size);
+  }
+  ORT_CATCH(const OnnxRuntimeException&) {
+    // The chunks held by the thread cache may be enough once they are given back to the bins.
+    ORT_HANDLE_EXCEPTION([&]() {
+      FlushThreadCache();
+      ptr = AllocateRawInternal(num_bytes, false, nullptr, &chunk_size);
+    });
+  }
+
+  CacheSizeShard& size_shard = CacheSizeShardFor(ptr);
+  std::lock_guard<std::mutex> lock(size_shard.lock);
+  size_shard.sizes.emplace(ptr, chunk_size);
+  return ptr;
+}
+
+bool BFCArena::FreeToThreadCache(void* p) {
+  size_t chunk_size = 0;
+  {
+    CacheSizeShard& size_shard = CacheSizeShardFor(p);
+    std::lock_guard<std::mutex> lock(size_shard.lock);
+    auto it = size_shard.sizes.find(p);
+    if (it == size_shard.sizes.end()) {
+      return false;
+    }
+    chunk_size = it->second;
+  }
+
+  std::vector<void*> to_release;
+  const BinNum bin_num = BinNumForSize(chunk_size);
+  if (bin_num < kNumCachedBins) {
+    CacheShard& shard = ThreadCacheShard();
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto& cached = shard.bins[bin_num];
+    cached.push_back({p, chunk_size});
+    shard.bytes += chunk_size;
+
+    // Evicts the oldest chunks of this bin first, then the oldest chunks of the largest bins.
+    while (cached.size() > kMaxCachedChunksPerBin) {
+      to_release.push_back(cached.front().ptr);
+      shard.bytes -= cached.front().size;
+      cached.erase(cached.begin());
+    }
+    for (BinNum b = kNumCachedBins - 1; b >= 0 && shard.bytes > static_cast<size_t>(thread_cache_max_bytes_); --b) {
+      auto& victims = shard.bins[b];
+      while (!victims.empty() && shard.bytes > static_cast<size_t>(thread_cache_max_bytes_)) {
+        to_release.push_back(victims.front().ptr);
+        shard.bytes -= victims.front().size;
+        victims.erase(victims.begin());
+      }
+    }
+  } else {
+    to_release.push_back(p);
+  }
+
+  if (!to_release.empty()) {
+    ReleaseCachedChunks(to_release);
+  }
+  return true;
+}
+
+void BFCArena::FlushThreadCache() {
+  if (!cache_shards_) {
+    return;
+  }
+
+  std::vector<void*> to_release;
+  for (int i = 0; i < kNumCacheShards; ++i) {
+    CacheShard& shard = cache_shards_[i];
+    std::lock_guard<std::mutex> lock(shard.lock);
+    for (auto& cached : shard.bins) {
+      for (const CachedChunk& chunk : cached) {
+        to_release.push_back(chunk.ptr);
+      }
+      cached.clear();
+    }
+    shard.bytes = 0;
+  }
+
+  ReleaseCachedChunks(to_release);
+}
+
+void BFCArena::ReleaseCachedChunks(const std::vector<void*>& ptrs) {
+  // The sizes are removed first, the arena hands a pointer out again as soon as it is deallocated.
+  for (void* ptr : ptrs) {
+    CacheSizeShard& size_shard = CacheSizeShardFor(ptr);
+    std::lock_guard<std::mutex> lock(size_shard.lock);
+    size_shard.sizes.erase(ptr);
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  for (void* ptr : ptrs) {
+    DeallocateRawInternal(ptr);
+  }
+}
+
 void* BFCArena::Reserve(size_t size) {
   if (size == 0)
     return nullptr;
@@ -310,7 +461,8 @@ size_t BFCArena::AllocatedSize(const void* ptr) {
 
 void* BFCArena::AllocateRawInternal(size_t num_bytes,
                                     bool dump_log_on_failure,
-                                    Stream* stream) {
+                                    Stream* stream,
+                                    size_t* allocated_bytes) {
   if (num_bytes == 0) {
     return nullptr;
   }
@@ -328,6 +480,9 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   auto* chunk = FindChunkPtr(bin_num, rounded_bytes, num_bytes, stream);
 
   if (chunk != nullptr) {
+    if (allocated_bytes != nullptr) {
+      *allocated_bytes = chunk->size;
+    }
     return chunk->ptr;
   }
 
@@ -339,6 +494,9 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   if (status.IsOK()) {
     chunk = FindChunkPtr(bin_num, rounded_bytes, num_bytes, stream);
     if (chunk != nullptr) {
+      if (allocated_bytes != nullptr) {
+        *allocated_bytes = chunk->size;
+      }
       return chunk->ptr;
     } else {
       status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
@@ -362,6 +520,10 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 void BFCArena::GetStats(AllocatorStats* stats) {
   std::lock_guard<std::mutex> lock(lock_);
   *stats = stats_;
+  stats->num_cache_hits = num_cache_hits_;
+  stats->num_cache_misses = num_cache_misses_;
+  // An allocation served by the thread cache does not reach FindChunkPtr.
+  stats->num_allocs += stats->num_cache_hits;
 }
 
 BFCArena::Chunk* BFCArena::SplitFreeChunkFromBin(BFCArena::Bin::FreeChunkSet* free_chunks,
@@ -474,6 +636,9 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
+  if (cache_shards_ && FreeToThreadCache(p)) {
+    return;
+  }
   std::lock_guard<std::mutex> lock(lock_);
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
@@ -487,6 +652,7 @@ void BFCArena::Free(void* p) {
 }
 
 Status BFCArena::Shrink() {
+  FlushThreadCache();
   std::lock_guard<std::mutex> lock(lock_);
   auto num_regions = region_manager_.regions().size();
   std::vector<void*> region_ptrs;
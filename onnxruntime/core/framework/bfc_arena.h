@@ -16,9 +16,12 @@ limitations under the License.
 
 #pragma once
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "onnxruntime_config.h"
 
@@ -60,6 +63,8 @@ class BFCArena : public IAllocator {
   static const int DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES = 2 * 1024 * 1024;
   static const int64_t DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES = 1024 * 1024 * 1024;  // 1GB
   static const size_t DEFAULT_MAX_MEM = std::numeric_limits<size_t>::max();
+  // The thread cache is disabled by default.
+  static const int64_t DEFAULT_THREAD_CACHE_MAX_BYTES = 0;
 
   enum ArenaType {
     BaseArena,
@@ -72,7 +77,8 @@ class BFCArena : public IAllocator {
            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
            int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
-           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES);
+           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+           int64_t thread_cache_max_bytes = DEFAULT_THREAD_CACHE_MAX_BYTES);
 
   ~BFCArena() override;
 
@@ -85,6 +91,7 @@ class BFCArena : public IAllocator {
   void Free(void* p) override;
 
   // Frees all allocation regions in which no chunk is in use.
+  // The chunks held by the thread cache are returned to the arena first.
   // Does not free any reserved chunks.
   // Resets the size that the arena will grow by in the next allocation to
   // `initial_growth_chunk_size_bytes_` but ultimately all
@@ -103,9 +110,11 @@ class BFCArena : public IAllocator {
   ArenaType GetArenaType() const { return arena_type_; }
 
  protected:
+  // If allocated_bytes is not null, it receives the size of the chunk backing the returned pointer.
   void* AllocateRawInternal(size_t num_bytes,
                             bool dump_log_on_failure,
-                            Stream* stream);
+                            Stream* stream,
+                            size_t* allocated_bytes = nullptr);
 
 #ifdef ORT_ENABLE_STREAM
   // for any chunk that associated with target stream, reset it to default (nullptr in stream, sync id 0)
@@ -407,6 +416,56 @@ class BFCArena : public IAllocator {
   ChunkHandle AllocateChunk();
   void DeallocateChunk(ChunkHandle h);
 
+  // Thread cache.
+  //
+  // When thread_cache_max_bytes_ > 0, Free() does not give small chunks back to the bins.
+  // The chunk stays in use from the arena point of view and is pushed into a cache shard
+  // selected by the calling thread, in a list indexed by its bin number. The next Alloc()
+  // of the same bin on that thread takes it back without acquiring lock_.
+  // The shards use their own mutex, they are only contended when two threads share a shard.
+  // A shard gives its oldest chunks back to the arena when a bin holds more than
+  // kMaxCachedChunksPerBin chunks or the shard holds more than thread_cache_max_bytes_ bytes.
+  // Shrink() flushes every shard. Chunks held by the cache are counted in bytes_in_use and
+  // RequestedSize() returns the size of the request which took the chunk out of the bins.
+  static const int kNumCacheShards = 16;
+  static const int kNumCachedBins = 13;  // chunks up to 2MB
+  static const size_t kMaxCachedChunksPerBin = 8;
+
+  struct CachedChunk {
+    void* ptr;
+    size_t size;
+  };
+
+  struct alignas(64) CacheShard {
+    std::mutex lock;
+    std::array<std::vector<CachedChunk>, kNumCachedBins> bins;
+    size_t bytes = 0;
+  };
+
+  // Size of every chunk taken out of the bins while the cache is enabled, sharded by pointer.
+  // Free() uses it to find the bin of a pointer without acquiring lock_. An entry is added when
+  // a chunk leaves the bins and removed when it goes back, so a cache hit does not touch it.
+  struct alignas(64) CacheSizeShard {
+    std::mutex lock;
+    std::unordered_map<void*, size_t> sizes;
+  };
+
+  void* AllocateWithThreadCache(size_t num_bytes);
+
+  // Returns false if p was not allocated by AllocateWithThreadCache (reserved chunk).
+  bool FreeToThreadCache(void* p);
+
+  // Gives all the cached chunks back to the arena.
+  void FlushThreadCache();
+
+  // Gives chunks taken out of the bins by AllocateWithThreadCache back to the arena.
+  void ReleaseCachedChunks(const std::vector<void*>& ptrs);
+
+  CacheShard& ThreadCacheShard();
+  CacheSizeShard& CacheSizeShardFor(const void* p) {
+    return cache_size_shards_[(reinterpret_cast<std::uintptr_t>(p) >> kMinAllocationBits) % kNumCacheShards];
+  }
+
   Chunk* ChunkFromHandle(ChunkHandle h);
 
   // Information about a Bin that is useful for debugging.
@@ -501,6 +560,12 @@ class BFCArena : public IAllocator {
   const int initial_growth_chunk_size_bytes_;
   const int64_t max_power_of_two_extend_bytes_;
 
+  const int64_t thread_cache_max_bytes_;
+  std::unique_ptr<CacheShard[]> cache_shards_;
+  std::unique_ptr<CacheSizeShard[]> cache_size_shards_;
+  std::atomic<int64_t> num_cache_hits_{0};
+  std::atomic<int64_t> num_cache_misses_{0};
+
   // This flag is only relevant if Shrink() is invoked.
   // This is a boolean flag that controls whether the first allocation region
   // is to be considered for shrinkage or not.
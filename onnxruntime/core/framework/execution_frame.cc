@@ -399,6 +399,9 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
       // if no existing patterns, generate one in this execution frame
       if (!mem_patterns_) {
         planner_.emplace(*session_state.GetExecutionPlan());
+        if (session_state.GetMemoryPatternShapeBuckets().IsEnabled()) {
+          session_state.ResolveMemoryPatternBucketDims(feeds, feed_mlvalue_idxs, bucketed_dim_params_);
+        }
       } else {
         // pre-allocate the big chunk requested in memory pattern.
         // all the internal kernel's input/output tensors will be allocated on these buffer.
@@ -550,8 +553,10 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
       if (block) {
         auto it = buffers_.find(location);
         if (it != buffers_.end()) {
-          // if the block is not correct, log message then fall back to default behavior
-          if (block->size_ == size) {
+          // if the block is not correct, log message then fall back to default behavior.
+          // with shape buckets, the block is planned for the upper bound of the bucket and fits any smaller tensor.
+          if (block->size_ == size ||
+              (block->size_ > size && session_state_.GetMemoryPatternShapeBuckets().IsEnabled())) {
             void* buffer = it->second.get();
             auto status = AllocateTensorWithPreAllocateBufferHelper(
                 ort_value, static_cast<void*>(static_cast<char*>(buffer) + block->offset_), element_type, location,
@@ -598,7 +603,9 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
   // don't trace the memory allocation on string tensors, as it need
   // placement new, we don't support it in memory pattern optimization.
   if (!utils::IsDataTypeString(element_type)) {
-    TraceAllocate(ort_value_index, size);
+    TraceAllocate(ort_value_index, bucketed_dim_params_.empty()
+                                       ? size
+                                       : GetBucketedTensorSize(ort_value_index, element_type, shape, alignment, size));
   }
 
   {
@@ -904,6 +911,42 @@ void ExecutionFrame::TraceAllocate(int ort_value_idx, size_t size) {
   }
 }
 
+size_t ExecutionFrame::GetBucketedTensorSize(int ort_value_idx, MLDataType element_type, const TensorShape& shape,
+                                             size_t alignment, size_t size) const {
+  // Only the dimensions named like a symbolic dimension of the graph inputs are known to depend on them,
+  // the other ones keep their value and a larger tensor in the same bucket falls back to the allocator.
+  std::string name;
+  if (!session_state_.GetOrtValueNameIdxMap().GetName(ort_value_idx, name).IsOK()) {
+    return size;
+  }
+  const NodeArg* node_arg = session_state_.GetGraphViewer().GetNodeArg(name);
+  const auto* shape_proto = node_arg != nullptr ? node_arg->Shape() : nullptr;
+  if (shape_proto == nullptr || shape_proto->dim_size() != static_cast<int>(shape.NumDimensions())) {
+    return size;
+  }
+
+  TensorShapeVector bucketed_dims = shape.AsShapeVector();
+  bool changed = false;
+  for (int i = 0, end = shape_proto->dim_size(); i < end; ++i) {
+    const auto& dim = shape_proto->dim(i);
+    if (!dim.has_dim_param()) {
+      continue;
+    }
+    auto it = bucketed_dim_params_.find(dim.dim_param());
+    if (it != bucketed_dim_params_.end() && it->second > bucketed_dims[i]) {
+      bucketed_dims[i] = it->second;
+      changed = true;
+    }
+  }
+
+  size_t bucketed_size = 0;
+  if (!changed ||
+      !Tensor::CalculateTensorStorageSize(element_type, TensorShape(bucketed_dims), alignment, bucketed_size).IsOK()) {
+    return size;
+  }
+  return bucketed_size;
+}
+
 // do not call this in ParallExecutionPlan
 void ExecutionFrame::TraceFree(int ort_value_idx) {
   // don't trace free on output tensors.
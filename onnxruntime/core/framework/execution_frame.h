@@ -227,6 +227,11 @@ class ExecutionFrame final : public IExecutionFrame {
   void TraceAllocate(int ort_value_idx, size_t size);
   void TraceFree(int ort_value_idx);
 
+  // Size to trace for a tensor when memory pattern shape buckets are enabled: the size of the tensor
+  // once its symbolic dimensions are rounded up to their bucket.
+  size_t GetBucketedTensorSize(int ort_value_idx, MLDataType element_type, const TensorShape& shape,
+                               size_t alignment, size_t size) const;
+
   const AllocPlanPerValue& GetAllocationPlan(int ort_value_idx);
 
   Stream* GetValueStream(int ort_value_idx) const;
@@ -249,6 +254,10 @@ class ExecutionFrame final : public IExecutionFrame {
   // use this planner_ to trace the memory allocation in current executor.
   std::optional<OrtValuePatternPlanner> planner_;
 
+  // Bucket upper bound of every symbolic dimension of the graph inputs, set when the planner traces
+  // a pattern with memory pattern shape buckets enabled.
+  InlinedHashMap<std::string, int64_t> bucketed_dim_params_;
+
   // Big chunks on different locations that will be used by mem_pattern.
   InlinedHashMap<OrtDevice, BufferUniquePtr> buffers_;
 
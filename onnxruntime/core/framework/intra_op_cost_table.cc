@@ -0,0 +1,200 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/intra_op_cost_table.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+
+#include "core/framework/murmurhash3.h"
+#include "core/framework/op_kernel_context_internal.h"
+#include "core/graph/graph.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+namespace {
+
+constexpr std::string_view kFileHeader = "ORTINTRAOPCOST 1";
+
+}  // namespace
+
+IntraOpCostTable::IntraOpCostTable(int max_num_threads, bool calibrate, PathString path)
+    : max_num_threads_(max_num_threads), calibrate_(calibrate), path_(std::move(path)) {
+}
+
+uint64_t IntraOpCostTable::Key(const Node& node, const OpKernelContextInternal& kernel_ctx) {
+  std::string buffer;
+  buffer.reserve(128);
+  buffer.append(node.OpType()).push_back('\0');
+  buffer.append(node.Domain()).push_back('\0');
+  auto append = [&buffer](int64_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  for (int i = 0, end = kernel_ctx.InputCount(); i < end; ++i) {
+    const OrtValue* input = kernel_ctx.GetInputMLValue(i);
+    if (input == nullptr || !input->IsTensor()) {
+      append(-1);
+      continue;
+    }
+    const auto dims = input->Get<Tensor>().Shape().GetDims();
+    append(static_cast<int64_t>(dims.size()));
+    for (int64_t dim : dims) {
+      append(dim);
+    }
+  }
+
+  uint64_t hash[2] = {0, 0};
+  MurmurHash3::x86_128(buffer.data(), buffer.size(), 0, hash);
+  return hash[0] ^ hash[1];
+}
+
+int IntraOpCostTable::ComputeLimit(int64_t sequential_ns) const {
+  if (sequential_ns < 0) {
+    return 0;
+  }
+  const int64_t num_threads = std::max<int64_t>(1, (sequential_ns + kMinWorkPerThreadNs - 1) / kMinWorkPerThreadNs);
+  return num_threads >= max_num_threads_ ? 0 : static_cast<int>(num_threads);
+}
+
+IntraOpCostTable::Decision IntraOpCostTable::Decide(uint64_t key) {
+  Decision decision;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      const Entry& entry = it->second;
+      if (entry.calibrated) {
+        decision.degree_of_parallelism_limit = entry.degree_of_parallelism_limit;
+      } else if (entry.parallel_sampled) {
+        decision.degree_of_parallelism_limit = 1;
+        decision.sample = Decision::Sample::kSequential;
+      } else {
+        decision.sample = Decision::Sample::kParallel;
+      }
+      return decision;
+    }
+  }
+
+  if (calibrate_) {
+    decision.sample = Decision::Sample::kParallel;
+  }
+  return decision;
+}
+
+void IntraOpCostTable::Record(uint64_t key, const Decision& decision, int64_t duration_ns,
+                              std::string_view op_type) {
+  if (decision.sample == Decision::Sample::kNone) {
+    return;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Entry& entry = entries_[key];
+  if (entry.calibrated) {
+    // another run of the same key completed the calibration
+    return;
+  }
+  if (entry.op_type.empty()) {
+    entry.op_type = op_type;
+  }
+
+  if (decision.sample == Decision::Sample::kParallel) {
+    if (duration_ns >= kMinWorkPerThreadNs * max_num_threads_) {
+      // the sequential work is at least as long, the node uses the whole pool
+      entry.sequential_ns = -1;
+      entry.calibrated = true;
+    } else {
+      entry.parallel_sampled = true;
+    }
+  } else {
+    entry.sequential_ns = entry.num_sequential_samples == 0 ? duration_ns
+                                                            : std::min(entry.sequential_ns, duration_ns);
+    entry.calibrated = ++entry.num_sequential_samples >= kNumSequentialSamples;
+  }
+
+  if (entry.calibrated) {
+    entry.degree_of_parallelism_limit = ComputeLimit(entry.sequential_ns);
+    modified_.store(true, std::memory_order_relaxed);
+  }
+}
+
+Status IntraOpCostTable::Load() {
+  std::ifstream file{std::filesystem::path(path_)};
+  if (!file.is_open()) {
+    // First session for this file.
+    return Status::OK();
+  }
+
+  std::string line;
+  ORT_RETURN_IF(!std::getline(file, line) || line != kFileHeader, "The file is not an intra-op cost table.");
+
+  InlinedHashMap<uint64_t, Entry> entries;
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream fields(line);
+    fields.imbue(std::locale::classic());
+    uint64_t key = 0;
+    Entry entry;
+    fields >> std::hex >> key >> std::dec >> entry.sequential_ns >> entry.op_type;
+    ORT_RETURN_IF(fields.fail() || entry.sequential_ns < -1, "Invalid intra-op cost table entry: ", line);
+    entry.calibrated = true;
+    // The limit depends on the pool of this session.
+    entry.degree_of_parallelism_limit = ComputeLimit(entry.sequential_ns);
+    entries[key] = std::move(entry);
+  }
+  ORT_RETURN_IF(file.bad(), "Failed to read the intra-op cost table.");
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  for (auto& [key, entry] : entries) {
+    entries_[key] = std::move(entry);
+  }
+  return Status::OK();
+}
+
+Status IntraOpCostTable::SaveIfModified() {
+  if (path_.empty() || !modified_.exchange(false, std::memory_order_relaxed)) {
+    return Status::OK();
+  }
+
+  std::ostringstream content;
+  content.imbue(std::locale::classic());
+  content << kFileHeader << '\n';
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [key, entry] : entries_) {
+      if (entry.calibrated) {
+        content << std::hex << key << std::dec << ' ' << entry.sequential_ns << ' ' << entry.op_type << '\n';
+      }
+    }
+  }
+
+  // Readers never see a partially written file, the new content replaces the previous one atomically.
+  std::filesystem::path path(path_);
+  std::filesystem::path tmp_path = path;
+  tmp_path += ToPathString(".tmp" + std::to_string(Env::Default().GetSelfPid()));
+  {
+    std::ofstream file(tmp_path, std::ios::trunc);
+    ORT_RETURN_IF(!file.is_open(), "Failed to create ", PathToUTF8String(tmp_path.native()));
+    const std::string data = content.str();
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.close();
+    ORT_RETURN_IF(file.fail(), "Failed to write ", PathToUTF8String(tmp_path.native()));
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tmp_path, path, error);
+  if (error) {
+    std::filesystem::remove(tmp_path, error);
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to replace ", PathToUTF8String(path.native()), ": ",
+                           error.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/path_string.h"
+
+namespace onnxruntime {
+
+class Node;
+class OpKernelContextInternal;
+
+/**
+ * Learned cost of the nodes, used to cap the degree of parallelism of their intra-op loops,
+ * see kOrtSessionOptionsIntraOpCostCalibration.
+ *
+ * The table is keyed by the operator type and the shapes of the inputs. During calibration the first run of
+ * a key uses the whole pool. If it is shorter than kMinWorkPerThreadNs per thread of the pool, the next runs
+ * are sequential to measure the work of the node. The node then runs on one thread per kMinWorkPerThreadNs
+ * of work, so that small nodes do not wake every worker of large pools.
+ *
+ * The table can be saved to a text file and loaded by the next sessions, possibly of other models,
+ * on the same machine.
+ */
+class IntraOpCostTable {
+ public:
+  // Minimum amount of sequential work given to every thread of a loop.
+  static constexpr int64_t kMinWorkPerThreadNs = 20000;
+  // Number of sequential runs measuring the work of a node, the fastest one is kept.
+  static constexpr int kNumSequentialSamples = 2;
+
+  // What to do for the next run of a node.
+  struct Decision {
+    // Degree of parallelism limit of the node, see concurrency::ThreadPool::DegreeOfParallelismLimit.
+    int degree_of_parallelism_limit{0};
+    enum class Sample {
+      kNone,
+      kParallel,
+      kSequential,
+    } sample{Sample::kNone};
+  };
+
+  // `max_num_threads` is the number of threads running the loops of the intra-op thread pool, see
+  // concurrency::ThreadPool::NumLoopThreads. Costs and limits count threads, not the tasks of hybrid CPUs.
+  // Nodes without entry are measured when `calibrate` is true, otherwise they run without limit.
+  IntraOpCostTable(int max_num_threads, bool calibrate, PathString path);
+
+  static uint64_t Key(const Node& node, const OpKernelContextInternal& kernel_ctx);
+
+  Decision Decide(uint64_t key);
+
+  // Records the duration of a run sampled by Decide().
+  void Record(uint64_t key, const Decision& decision, int64_t duration_ns, std::string_view op_type);
+
+  // Reads the entries of the file. The file may not exist yet.
+  Status Load();
+
+  // Rewrites the file if calibration completed entries since the last save.
+  Status SaveIfModified();
+
+  const PathString& Path() const { return path_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(IntraOpCostTable);
+
+  struct Entry {
+    // Fastest sequential run, -1 when the node is long enough to use the whole pool.
+    int64_t sequential_ns{-1};
+    int num_sequential_samples{0};
+    bool parallel_sampled{false};
+    bool calibrated{false};
+    int degree_of_parallelism_limit{0};
+    std::string op_type;
+  };
+
+  int ComputeLimit(int64_t sequential_ns) const;
+
+  const int max_num_threads_;
+  const bool calibrate_;
+  const PathString path_;
+
+  std::shared_mutex mutex_;
+  InlinedHashMap<uint64_t, Entry> entries_;
+  std::atomic<bool> modified_{false};
+};
+
+}  // namespace onnxruntime
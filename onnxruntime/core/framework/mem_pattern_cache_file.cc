@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'R', 'T', 'M', 'E', 'M', 'P', 'T'};
+constexpr uint32_t kVersion = 1;
+
+template <typename T>
+void Write(std::string& buffer, T value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads the content of the file with bounds checking, a truncated or corrupted file makes Load() fail.
+class Reader {
+ public:
+  Reader(const std::string& buffer, size_t offset) : buffer_(buffer), offset_(offset) {}
+
+  template <typename T>
+  Status Read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    ORT_RETURN_IF(buffer_.size() - offset_ < sizeof(T), "Unexpected end of the memory pattern cache file.");
+    std::memcpy(&value, buffer_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return Status::OK();
+  }
+
+  size_t Offset() const { return offset_; }
+
+ private:
+  const std::string& buffer_;
+  size_t offset_;
+};
+
+constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint64_t);
+
+void SerializeEntry(const std::vector<TensorShapeVector>& input_shapes, const MemoryPatternGroup& group,
+                    std::string& buffer) {
+  Write(buffer, static_cast<uint32_t>(input_shapes.size()));
+  for (const auto& shape : input_shapes) {
+    Write(buffer, static_cast<uint32_t>(shape.size()));
+    for (int64_t dim : shape) {
+      Write(buffer, dim);
+    }
+  }
+
+  Write(buffer, static_cast<uint32_t>(group.locations.size()));
+  for (const OrtDevice& device : group.locations) {
+    Write(buffer, device.Type());
+    Write(buffer, device.MemType());
+    Write(buffer, device.Vendor());
+    Write(buffer, device.Id());
+    Write(buffer, static_cast<uint64_t>(device.GetAlignment()));
+  }
+
+  for (const MemoryPattern& pattern : group.patterns) {
+    Write(buffer, static_cast<uint64_t>(pattern.PeakSize()));
+    const auto& blocks = pattern.GetPatternsMap();
+    Write(buffer, static_cast<uint32_t>(blocks.size()));
+    for (const auto& [ort_value_idx, block] : blocks) {
+      Write(buffer, static_cast<int32_t>(ort_value_idx));
+      Write(buffer, static_cast<uint64_t>(block.offset_));
+      Write(buffer, static_cast<uint64_t>(block.size_));
+    }
+  }
+}
+
+}  // namespace
+
+Status MemoryPatternCacheFile::Load(std::vector<Entry>& entries) {
+  entries.clear();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  num_entries_ = 0;
+
+  std::ifstream file(std::filesystem::path(path_), std::ios::binary);
+  if (!file.is_open()) {
+    // First session for this file.
+    return Status::OK();
+  }
+  std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ORT_RETURN_IF(file.bad(), "Failed to read the memory pattern cache file.");
+
+  Reader reader(buffer, 0);
+  char magic[sizeof(kMagic)];
+  for (char& c : magic) {
+    ORT_RETURN_IF_ERROR(reader.Read(c));
+  }
+  ORT_RETURN_IF(std::memcmp(magic, kMagic, sizeof(kMagic)) != 0, "The file is not a memory pattern cache file.");
+  uint32_t version = 0;
+  uint64_t plan_hash = 0;
+  uint64_t num_entries = 0;
+  ORT_RETURN_IF_ERROR(reader.Read(version));
+  ORT_RETURN_IF_ERROR(reader.Read(plan_hash));
+  ORT_RETURN_IF_ERROR(reader.Read(num_entries));
+  if (version != kVersion || plan_hash != plan_hash_) {
+    // Written by another version of onnxruntime or for another plan, it is overwritten by the next Append().
+    return Status::OK();
+  }
+
+  std::vector<Entry> loaded;
+  for (uint64_t e = 0; e < num_entries; ++e) {
+    Entry entry;
+    auto& [input_shapes, group] = entry;
+
+    uint32_t num_inputs = 0;
+    ORT_RETURN_IF_ERROR(reader.Read(num_inputs));
+    input_shapes.resize(num_inputs);
+    for (auto& shape : input_shapes) {
+      uint32_t rank = 0;
+      ORT_RETURN_IF_ERROR(reader.Read(rank));
+      ORT_RETURN_IF(rank > buffer.size(), "Invalid rank in the memory pattern cache file.");
+      shape.resize(rank);
+      for (int64_t& dim : shape) {
+        ORT_RETURN_IF_ERROR(reader.Read(dim));
+      }
+    }
+
+    uint32_t num_locations = 0;
+    ORT_RETURN_IF_ERROR(reader.Read(num_locations));
+    ORT_RETURN_IF(num_locations > buffer.size(), "Invalid number of devices in the memory pattern cache file.");
+    group.locations.reserve(num_locations);
+    for (uint32_t l = 0; l < num_locations; ++l) {
+      OrtDevice::DeviceType type;
+      OrtDevice::MemoryType mem_type;
+      OrtDevice::VendorId vendor;
+      OrtDevice::DeviceId id;
+      uint64_t alignment;
+      ORT_RETURN_IF_ERROR(reader.Read(type));
+      ORT_RETURN_IF_ERROR(reader.Read(mem_type));
+      ORT_RETURN_IF_ERROR(reader.Read(vendor));
+      ORT_RETURN_IF_ERROR(reader.Read(id));
+      ORT_RETURN_IF_ERROR(reader.Read(alignment));
+      ORT_RETURN_IF(mem_type != OrtDevice::MemType::DEFAULT && mem_type != OrtDevice::MemType::HOST_ACCESSIBLE,
+                    "Invalid memory type in the memory pattern cache file.");
+      group.locations.emplace_back(type, mem_type, vendor, id, static_cast<OrtDevice::Alignment>(alignment));
+    }
+
+    group.patterns.resize(num_locations);
+    for (MemoryPattern& pattern : group.patterns) {
+      uint64_t peak_size = 0;
+      uint32_t num_blocks = 0;
+      ORT_RETURN_IF_ERROR(reader.Read(peak_size));
+      ORT_RETURN_IF_ERROR(reader.Read(num_blocks));
+      ORT_RETURN_IF(num_blocks > buffer.size(), "Invalid number of blocks in the memory pattern cache file.");
+      pattern.peak_size_ = static_cast<size_t>(peak_size);
+      pattern.patterns_.reserve(num_blocks);
+      for (uint32_t b = 0; b < num_blocks; ++b) {
+        int32_t ort_value_idx = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        ORT_RETURN_IF_ERROR(reader.Read(ort_value_idx));
+        ORT_RETURN_IF_ERROR(reader.Read(offset));
+        ORT_RETURN_IF_ERROR(reader.Read(size));
+        ORT_RETURN_IF(offset > peak_size || size > peak_size - offset, "Invalid memory block in the memory pattern cache file.");
+        pattern.patterns_[ort_value_idx] = MemoryBlock(static_cast<size_t>(offset), static_cast<size_t>(size));
+      }
+    }
+
+    loaded.push_back(std::move(entry));
+  }
+
+  entries_.assign(buffer, kHeaderSize, reader.Offset() - kHeaderSize);
+  num_entries_ = num_entries;
+  entries = std::move(loaded);
+  return Status::OK();
+}
+
+Status MemoryPatternCacheFile::Append(const std::vector<TensorShapeVector>& input_shapes,
+                                      const MemoryPatternGroup& patterns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SerializeEntry(input_shapes, patterns, entries_);
+  ++num_entries_;
+
+  std::string header;
+  header.append(kMagic, sizeof(kMagic));
+  Write(header, kVersion);
+  Write(header, plan_hash_);
+  Write(header, num_entries_);
+
+  // Readers never see a partially written file, the new content replaces the previous one atomically.
+  std::filesystem::path path(path_);
+  std::filesystem::path tmp_path = path;
+  tmp_path += ToPathString(".tmp" + std::to_string(Env::Default().GetSelfPid()));
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    ORT_RETURN_IF(!file.is_open(), "Failed to create ", PathToUTF8String(tmp_path.native()));
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(entries_.data(), static_cast<std::streamsize>(entries_.size()));
+    file.close();
+    ORT_RETURN_IF(file.fail(), "Failed to write ", PathToUTF8String(tmp_path.native()));
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tmp_path, path, error);
+  if (error) {
+    std::filesystem::remove(tmp_path, error);
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to replace ", PathToUTF8String(path.native()), ": ", error.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
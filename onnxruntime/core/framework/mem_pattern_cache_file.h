@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/path_string.h"
+#include "core/framework/mem_pattern.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+/**
+ * File storing the memory patterns learned by a session so that the next sessions of the same model,
+ * in the same process or after a restart, start with them and the first Run for a known set of input
+ * shapes already uses one pre-planned block per device.
+ *
+ * The file starts with a hash of the execution plan (see SessionState), entries written for another
+ * model or another version of the plan are ignored. Every entry holds the shapes of the feeds and the
+ * MemoryPatternGroup generated for them. The file is rewritten as a whole each time an entry is added,
+ * through a temporary file renamed over the previous one. When several processes share the file,
+ * the last writer wins and the others re-learn the patterns they lost.
+ */
+class MemoryPatternCacheFile {
+ public:
+  using Entry = std::pair<std::vector<TensorShapeVector>, MemoryPatternGroup>;
+
+  MemoryPatternCacheFile(PathString path, uint64_t plan_hash)
+      : path_(std::move(path)), plan_hash_(plan_hash) {}
+
+  // Reads the entries saved for plan_hash_. The file may not exist yet, `entries` is then empty.
+  // The entries are kept serialized so that Append() can rewrite them.
+  Status Load(std::vector<Entry>& entries);
+
+  // Adds an entry and rewrites the file.
+  Status Append(const std::vector<TensorShapeVector>& input_shapes, const MemoryPatternGroup& patterns);
+
+  const PathString& Path() const { return path_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(MemoryPatternCacheFile);
+
+  const PathString path_;
+  const uint64_t plan_hash_;
+
+  std::mutex mutex_;
+  // Serialized entries known by this session, loaded or appended.
+  std::string entries_;
+  uint64_t num_entries_{0};
+};
+
+}  // namespace onnxruntime
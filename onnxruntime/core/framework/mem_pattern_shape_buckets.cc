@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_shape_buckets.h"
+
+#include <algorithm>
+
+#include "core/common/parse_string.h"
+#include "core/common/string_utils.h"
+
+namespace onnxruntime {
+
+Status MemoryPatternShapeBuckets::Parse(std::string_view config, MemoryPatternShapeBuckets& buckets) {
+  buckets = MemoryPatternShapeBuckets();
+  if (config.empty()) {
+    return Status::OK();
+  }
+
+  if (config == "pow2") {
+    buckets.mode_ = Mode::kPowerOfTwo;
+    return Status::OK();
+  }
+
+  std::vector<int64_t> edges;
+  for (const auto& edge_str : utils::SplitString(config, ",")) {
+    int64_t edge = 0;
+    ORT_RETURN_IF_NOT(TryParseStringWithClassicLocale(edge_str, edge) && edge > 0,
+                      "Invalid memory pattern shape bucket '", edge_str, "', expected a positive integer.");
+    ORT_RETURN_IF_NOT(edges.empty() || edge > edges.back(),
+                      "Memory pattern shape buckets must be in increasing order: ", config);
+    edges.push_back(edge);
+  }
+  ORT_RETURN_IF(edges.empty(), "No memory pattern shape bucket found in: ", config);
+
+  buckets.mode_ = Mode::kEdges;
+  buckets.edges_ = std::move(edges);
+  return Status::OK();
+}
+
+int64_t MemoryPatternShapeBuckets::RoundUp(int64_t dim) const {
+  if (dim <= 0) {
+    return dim;
+  }
+
+  switch (mode_) {
+    case Mode::kPowerOfTwo: {
+      constexpr int64_t kLargestPowerOfTwo = int64_t(1) << 62;
+      if (dim > kLargestPowerOfTwo) {
+        return dim;
+      }
+      int64_t bound = 1;
+      while (bound < dim) {
+        bound <<= 1;
+      }
+      return bound;
+    }
+    case Mode::kEdges: {
+      auto it = std::lower_bound(edges_.begin(), edges_.end(), dim);
+      return it == edges_.end() ? dim : *it;
+    }
+    default:
+      return dim;
+  }
+}
+
+}  // namespace onnxruntime
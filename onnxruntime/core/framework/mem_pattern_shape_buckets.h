@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+/**
+ * Buckets used to share one memory pattern between runs whose input dimensions differ,
+ * see kOrtSessionOptionsMemoryPatternShapeBuckets.
+ * A dimension is rounded up to the upper bound of its bucket, either the next power of two
+ * or the next edge given by the user. The pattern of a bucket is planned for that upper bound
+ * so that every run in the bucket fits in it.
+ */
+class MemoryPatternShapeBuckets {
+ public:
+  MemoryPatternShapeBuckets() = default;
+
+  // Parses the value of kOrtSessionOptionsMemoryPatternShapeBuckets:
+  // "" (disabled), "pow2" or a comma-separated list of increasing positive edges, e.g. "64,128,256,512".
+  static Status Parse(std::string_view config, MemoryPatternShapeBuckets& buckets);
+
+  bool IsEnabled() const { return mode_ != Mode::kDisabled; }
+
+  // Returns the upper bound of the bucket containing `dim`.
+  // `dim` is returned unchanged when buckets are disabled, when it is not positive
+  // or when it is larger than the last edge.
+  int64_t RoundUp(int64_t dim) const;
+
+ private:
+  enum class Mode {
+    kDisabled,
+    kPowerOfTwo,
+    kEdges,
+  };
+
+  Mode mode_{Mode::kDisabled};
+  std::vector<int64_t> edges_;
+};
+
+}  // namespace onnxruntime
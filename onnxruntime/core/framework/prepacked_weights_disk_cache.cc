@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepacked_weights_disk_cache.h"
+
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+#include "core/common/cpuid_info.h"
+#include "core/framework/murmurhash3.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
+#include "onnxruntime_config.h"  // for ORT_VERSION
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace onnxruntime {
+
+namespace {
+
+// Entry layout: magic, number of buffers, size of every buffer, then the buffers at kBufferAlignment offsets.
+constexpr char kMagic[8] = {'O', 'R', 'T', 'P', 'P', 'W', '0', '1'};
+// Same alignment as the buffers allocated by the kernels, the mapping itself is page aligned.
+constexpr size_t kBufferAlignment = 64;
+
+size_t AlignUp(size_t offset) {
+  return (offset + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+size_t HeaderSize(size_t num_buffers) {
+  return sizeof(kMagic) + sizeof(uint64_t) * (1 + num_buffers);
+}
+
+std::string Platform() {
+  const auto& cpuid_info = CPUIDInfo::GetCPUIDInfo();
+  const bool features[] = {
+      cpuid_info.HasAVX(),
+      cpuid_info.HasAVX2(),
+      cpuid_info.HasAVX512f(),
+      cpuid_info.HasAVX512Skylake(),
+      cpuid_info.HasAVX512_BF16(),
+      cpuid_info.HasAMX_BF16(),
+      cpuid_info.HasF16C(),
+      cpuid_info.HasArmNeonDot(),
+      cpuid_info.HasArmNeon_I8MM(),
+      cpuid_info.HasArmSVE_I8MM(),
+      cpuid_info.HasArmNeon_BF16(),
+      cpuid_info.HasArm_SME(),
+  };
+  uint32_t mask = 0;
+  for (size_t i = 0; i < std::size(features); ++i) {
+    mask |= static_cast<uint32_t>(features[i]) << i;
+  }
+
+  std::ostringstream platform;
+  platform << ORT_VERSION << '-' << cpuid_info.GetCPUVendor() << '-' << std::hex << mask << '-' << std::dec
+           << MlasGetPreferredBufferAlignment();
+  std::string result = platform.str();
+  for (char& c : result) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-') {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+Status WriteEntry(const std::filesystem::path& path, const PrePackedWeights& weights) {
+  static std::atomic<uint64_t> num_writes{0};
+  // Unique per process and thread, the entry is published by renaming the complete file.
+  std::filesystem::path tmp_path = path;
+  tmp_path += ToPathString(".tmp" + std::to_string(Env::Default().GetSelfPid()) + "_" +
+                           std::to_string(num_writes.fetch_add(1)));
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    ORT_RETURN_IF(!file.is_open(), "Failed to create ", PathToUTF8String(tmp_path.native()));
+
+    const uint64_t num_buffers = weights.buffers_.size();
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(&num_buffers), sizeof(num_buffers));
+    for (size_t size : weights.buffer_sizes_) {
+      const uint64_t size_u64 = size;
+      file.write(reinterpret_cast<const char*>(&size_u64), sizeof(size_u64));
+    }
+
+    size_t offset = HeaderSize(weights.buffers_.size());
+    const char padding[kBufferAlignment] = {};
+    for (size_t i = 0; i < weights.buffers_.size(); ++i) {
+      const size_t aligned_offset = AlignUp(offset);
+      file.write(padding, static_cast<std::streamsize>(aligned_offset - offset));
+      file.write(static_cast<const char*>(weights.buffers_[i].get()),
+                 static_cast<std::streamsize>(weights.buffer_sizes_[i]));
+      offset = aligned_offset + weights.buffer_sizes_[i];
+    }
+
+    file.close();
+    ORT_RETURN_IF(file.fail(), "Failed to write ", PathToUTF8String(tmp_path.native()));
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tmp_path, path, error);
+  if (error) {
+    std::error_code ignored;
+    std::filesystem::remove(tmp_path, ignored);
+    // Another process may have published the same entry, possibly mapped and locked on some platforms.
+    ORT_RETURN_IF(!std::filesystem::exists(path, ignored), "Failed to create ", PathToUTF8String(path.native()), ": ",
+                  error.message());
+  }
+  return Status::OK();
+}
+
+// Maps the whole file copy-on-write: the buffers are writable and a kernel writing to one gets private pages instead
+// of modifying the entry shared with the other processes.
+Status MapCopyOnWrite(const std::filesystem::path& path, size_t size, Env::MappedMemoryPtr& mapping) {
+#ifdef _WIN32
+  // Env::MapFileIntoMemory() maps files read-only on Windows.
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  ORT_RETURN_IF(file == INVALID_HANDLE_VALUE, "Failed to open ", PathToUTF8String(path.native()),
+                ", errcode = ", GetLastError());
+  // The view keeps the file mapped once the handles are closed.
+  HANDLE file_mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  const DWORD mapping_error = GetLastError();
+  CloseHandle(file);
+  ORT_RETURN_IF(file_mapping == nullptr, "Failed to map ", PathToUTF8String(path.native()),
+                ", errcode = ", mapping_error);
+  void* view = MapViewOfFile(file_mapping, FILE_MAP_COPY, 0, 0, size);
+  const DWORD view_error = GetLastError();
+  CloseHandle(file_mapping);
+  ORT_RETURN_IF(view == nullptr, "Failed to map ", PathToUTF8String(path.native()), ", errcode = ", view_error);
+  mapping = Env::MappedMemoryPtr{static_cast<char*>(view), [](void* p) { UnmapViewOfFile(p); }};
+  return Status::OK();
+#else
+  // A private writable mapping.
+  return Env::Default().MapFileIntoMemory(path.native().c_str(), 0, size, mapping);
+#endif
+}
+
+Status MapEntry(const std::filesystem::path& path, PrePackedWeights& entry) {
+  std::error_code error;
+  const auto file_size = std::filesystem::file_size(path, error);
+  ORT_RETURN_IF(error, "Failed to query the size of ", PathToUTF8String(path.native()), ": ", error.message());
+  ORT_RETURN_IF(file_size < HeaderSize(0), "Truncated pre-packed weights cache entry.");
+
+  // Shared by the buffers, the entry is unmapped with the last one of them.
+  auto mapping = std::make_shared<Env::MappedMemoryPtr>();
+  ORT_RETURN_IF_ERROR(MapCopyOnWrite(path, static_cast<size_t>(file_size), *mapping));
+  char* data = mapping->get();
+
+  uint64_t num_buffers = 0;
+  std::memcpy(&num_buffers, data + sizeof(kMagic), sizeof(num_buffers));
+  ORT_RETURN_IF(std::memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+                    num_buffers > (file_size - HeaderSize(0)) / sizeof(uint64_t),
+                "Invalid pre-packed weights cache entry.");
+
+  size_t offset = HeaderSize(static_cast<size_t>(num_buffers));
+  for (size_t i = 0; i < num_buffers; ++i) {
+    uint64_t size = 0;
+    std::memcpy(&size, data + sizeof(kMagic) + sizeof(uint64_t) * (1 + i), sizeof(size));
+    offset = AlignUp(offset);
+    ORT_RETURN_IF(size > file_size || offset > file_size - size, "Truncated pre-packed weights cache entry.");
+    void* buffer = size == 0 ? nullptr : data + offset;
+    entry.buffers_.emplace_back(buffer, [mapping](void*) {});
+    entry.buffer_sizes_.push_back(static_cast<size_t>(size));
+    offset += static_cast<size_t>(size);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+PrepackedWeightsDiskCache::PrepackedWeightsDiskCache(PathString directory)
+    : directory_(std::move(directory)), platform_(Platform()) {
+}
+
+Status PrepackedWeightsDiskCache::Create(const PathString& directory,
+                                         std::unique_ptr<PrepackedWeightsDiskCache>& cache) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  ORT_RETURN_IF(error, "Failed to create the pre-packed weights cache directory ", PathToUTF8String(directory), ": ",
+                error.message());
+  cache.reset(new PrepackedWeightsDiskCache(directory));
+  return Status::OK();
+}
+
+PathString PrepackedWeightsDiskCache::EntryPath(const std::string& op_type, const std::string& key) const {
+  uint32_t hash[4] = {0, 0, 0, 0};
+  MurmurHash3::x86_128(key.data(), key.size(), 0, hash);
+
+  std::ostringstream name;
+  name << op_type << '_' << platform_ << '_' << std::hex << std::setfill('0');
+  for (uint32_t word : hash) {
+    name << std::setw(8) << word;
+  }
+  name << ".bin";
+  return (std::filesystem::path(directory_) / ToPathString(name.str())).native();
+}
+
+Status PrepackedWeightsDiskCache::Load(const std::string& op_type, const std::string& key,
+                                       PrePackedWeights& weights, bool& found) const {
+  found = false;
+  const std::filesystem::path path = EntryPath(op_type, key);
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    return Status::OK();
+  }
+
+  PrePackedWeights entry;
+  ORT_RETURN_IF_ERROR(MapEntry(path, entry));
+  weights = std::move(entry);
+  found = true;
+  return Status::OK();
+}
+
+Status PrepackedWeightsDiskCache::Share(const std::string& op_type, const std::string& key,
+                                        PrePackedWeights& weights) const {
+  ORT_RETURN_IF_NOT(weights.buffers_.size() == weights.buffer_sizes_.size(),
+                    "Every pre-packed buffer must have a size.");
+  for (size_t i = 0; i < weights.buffers_.size(); ++i) {
+    ORT_RETURN_IF(weights.buffers_[i] == nullptr && weights.buffer_sizes_[i] != 0,
+                  "Place-holder pre-packed buffers are not cached.");
+  }
+
+  const std::filesystem::path path = EntryPath(op_type, key);
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    ORT_RETURN_IF_ERROR(WriteEntry(path, weights));
+  }
+
+  PrePackedWeights entry;
+  ORT_RETURN_IF_ERROR(MapEntry(path, entry));
+  // The key is computed before packing, an entry written by another build or configuration must not be used.
+  ORT_RETURN_IF(entry.buffer_sizes_ != weights.buffer_sizes_,
+                "Pre-packed weights cache entry does not match the weights.");
+  for (size_t i = 0; i < entry.buffers_.size(); ++i) {
+    ORT_RETURN_IF(entry.buffer_sizes_[i] != 0 &&
+                      std::memcmp(entry.buffers_[i].get(), weights.buffers_[i].get(), entry.buffer_sizes_[i]) != 0,
+                  "Pre-packed weights cache entry does not match the weights.");
+  }
+
+  weights.buffers_ = std::move(entry.buffers_);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
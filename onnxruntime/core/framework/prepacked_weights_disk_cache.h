@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "core/common/common.h"
+#include "core/common/path_string.h"
+#include "core/framework/prepacked_weights.h"
+
+namespace onnxruntime {
+
+/**
+ * Directory of pre-packed weights shared by the sessions of all the processes of a host,
+ * see kOrtSessionOptionsPrepackedWeightsCacheDir.
+ *
+ * Every entry is a file named after the op type, the version of ONNX Runtime, the instruction sets of the CPU and a
+ * key computed before packing from the kernel and the unpacked weight, so a session finds the entry without calling
+ * PrePack(). The sessions map the entries copy-on-write instead of keeping the buffers produced by PrePack(), so
+ * the processes using the same model share one physical copy of the packed weights through the page cache.
+ */
+class PrepackedWeightsDiskCache {
+ public:
+  // Creates the cache directory if needed.
+  static Status Create(const PathString& directory, std::unique_ptr<PrepackedWeightsDiskCache>& cache);
+
+  // Maps the entry `key` into `weights` if the cache has it, `found` is set accordingly.
+  Status Load(const std::string& op_type, const std::string& key, PrePackedWeights& weights, bool& found) const;
+
+  // Replaces the buffers produced by PrePack() in `weights` by a mapping of the entry `key`, writing the entry first
+  // when the cache does not have it yet. Fails if an existing entry has a different content, `weights` is unchanged
+  // on failure.
+  Status Share(const std::string& op_type, const std::string& key, PrePackedWeights& weights) const;
+
+  // Path of the entry `key` for a kernel of type `op_type`.
+  PathString EntryPath(const std::string& op_type, const std::string& key) const;
+
+ private:
+  explicit PrepackedWeightsDiskCache(PathString directory);
+
+  const PathString directory_;
+  // Version of ONNX Runtime, instruction sets of the CPU and MLAS buffer alignment: kernels may pack weights
+  // differently for each of them.
+  const std::string platform_;
+};
+
+}  // namespace onnxruntime
@@ -11,11 +11,13 @@
 #include "core/common/logging/logging.h"
 #include "core/framework/allocation_planner.h"
 #include "core/framework/execution_frame.h"
+#include "core/framework/intra_op_cost_table.h"
 #include "core/framework/resource_accountant.h"
 #include "core/framework/stream_execution_context.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/utils.h"
+#include "core/framework/work_stealing_executor.h"
 
 #if defined DEBUG_NODE_INPUTS_OUTPUTS
 #include "core/framework/debug_node_inputs_outputs_utils.h"
@@ -430,6 +432,31 @@ class KernelScope {
 #endif
 };
 
+// Runs the kernel with the intra-op parallelism allowed by the cost table of the session, measuring the run
+// when the table calibrates the node.
+static Status ComputeKernel(const OpKernel& kernel, OpKernelContextInternal& kernel_ctx,
+                            IntraOpCostTable* cost_table) {
+  if (cost_table == nullptr) {
+    return kernel.Compute(&kernel_ctx);
+  }
+
+  const uint64_t key = IntraOpCostTable::Key(kernel.Node(), kernel_ctx);
+  const IntraOpCostTable::Decision decision = cost_table->Decide(key);
+  concurrency::ThreadPool::DegreeOfParallelismLimit limit(decision.degree_of_parallelism_limit);
+  if (decision.sample == IntraOpCostTable::Decision::Sample::kNone) {
+    return kernel.Compute(&kernel_ctx);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  Status status = kernel.Compute(&kernel_ctx);
+  if (status.IsOK()) {
+    const auto duration = std::chrono::steady_clock::now() - start;
+    cost_table->Record(key, decision, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+                       kernel.Node().OpType());
+  }
+  return status;
+}
+
 onnxruntime::Status ExecuteKernel(StreamExecutionContext& ctx,
                                   NodeIndex idx,
                                   size_t stream_idx,
@@ -484,12 +511,12 @@ onnxruntime::Status ExecuteKernel(StreamExecutionContext& ctx,
         }
       }
       if (!reuse_cached_value) {
-        status = p_kernel->Compute(&kernel_ctx);
+        status = ComputeKernel(*p_kernel, kernel_ctx, ctx.GetSessionState().GetIntraOpCostTable());
       } else {
         status = kernel_ctx.SetOutputMLValue(0, cache.get()->at(cached_arg_name));
       }
 #else
-      status = p_kernel->Compute(&kernel_ctx);
+      status = ComputeKernel(*p_kernel, kernel_ctx, ctx.GetSessionState().GetIntraOpCostTable());
 
 #if !defined(ORT_MINIMAL_BUILD)
       auto* node_stats_recorder = ctx.GetSessionState().GetNodeStatsRecorder();
@@ -634,17 +661,23 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
   SessionScope session_scope(session_state, ctx.GetExecutionFrame());
 
   auto* tp = single_thread_mode ? nullptr : session_state.GetInterOpThreadPool();
+  const auto* work_stealing_plan = session_state.GetWorkStealingPlan();
 
-  for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
-    if (execution_plan->execution_plan[i]->steps_.empty()) {
-      // execution context is initialized with number of valid streams
-      // for invalid stream (0 steps), it doesn't count in number of tasks
-      // so don't need to invoke CompleteTask here
-      // ctx.CompleteTask();
-    } else {
-      concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
-        RunSince(i, ctx, session_scope, terminate_flag, 0);
-      });
+  if (tp != nullptr && work_stealing_plan != nullptr) {
+    // nodes are scheduled once their producers ran instead of following the stream
+    RunWithWorkStealing(*work_stealing_plan, ctx, session_scope, terminate_flag, tp);
+  } else {
+    for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
+      if (execution_plan->execution_plan[i]->steps_.empty()) {
+        // execution context is initialized with number of valid streams
+        // for invalid stream (0 steps), it doesn't count in number of tasks
+        // so don't need to invoke CompleteTask here
+        // ctx.CompleteTask();
+      } else {
+        concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
+          RunSince(i, ctx, session_scope, terminate_flag, 0);
+        });
+      }
     }
   }
 
@@ -667,6 +700,15 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
     }
   }
 
+  if (auto* cost_table = session_state.GetIntraOpCostTable(); cost_table != nullptr) {
+    // The run succeeded with the costs it measured, a failure to persist them does not fail it.
+    auto save_status = cost_table->SaveIfModified();
+    if (!save_status.IsOK()) {
+      LOGS(logger, WARNING) << "Failed to save the intra-op cost table "
+                            << PathToUTF8String(cost_table->Path()) << ": " << save_status.ErrorMessage();
+    }
+  }
+
   return Status::OK();
 }
 
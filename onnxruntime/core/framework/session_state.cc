@@ -3,6 +3,8 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 #include <mutex>
@@ -10,14 +12,17 @@
 #include "core/common/safeint.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
+#include "core/framework/murmurhash3.h"
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_pattern_planner.h"
 #include "core/framework/prepacked_weights_container.h"
+#include "core/framework/prepacked_weights_disk_cache.h"
 #include "core/framework/session_state_utils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
+#include "onnxruntime_config.h"
 
 using namespace ::onnxruntime::common;
 
@@ -433,6 +438,81 @@ static Status KernelUseSharedPrePackedBuffers(OpKernel& kernel, int input_idx,
   return Status::OK();
 }
 
+// Key of the disk cache entry of the weights pre-packed for input `input_idx` of `node`, built from everything the
+// packing may depend on so that the entry is found before calling PrePack(): the kernel type and version, the node
+// attributes and input types, the session configuration and the content of the unpacked weight.
+static std::string GenerateKeyForPrepackedWeightsDiskCache(const Node& node, const OpKernel& kernel, int input_idx,
+                                                           const Tensor& tensor,
+                                                           const ConfigOptions& config_options) {
+  const KernelDef& kernel_def = kernel.KernelDef();
+  std::ostringstream key;
+  key << kernel_def.Domain() << ':' << kernel_def.OpName() << ':' << kernel_def.SinceVersion().first << '-'
+      << kernel_def.SinceVersion().second << ':' << kernel_def.Provider() << ':' << node.SinceVersion() << ':'
+      << input_idx;
+
+  for (const auto* input_def : node.InputDefs()) {
+    key << ':' << (input_def->Exists() && input_def->Type() != nullptr ? *input_def->Type() : "");
+  }
+
+  const std::map<std::string, ONNX_NAMESPACE::AttributeProto> attributes(node.GetAttributes().begin(),
+                                                                         node.GetAttributes().end());
+  for (const auto& [name, attribute] : attributes) {
+    key << ':' << name << '=' << attribute.SerializeAsString();
+  }
+
+  const std::map<std::string, std::string> configurations(config_options.configurations.begin(),
+                                                          config_options.configurations.end());
+  for (const auto& [name, value] : configurations) {
+    key << ':' << name << '=' << value;
+  }
+
+  uint32_t hash[4] = {0, 0, 0, 0};
+  MurmurHash3::x86_128(tensor.DataRaw(), tensor.SizeInBytes(), 0, hash);
+  key << ':' << DataTypeImpl::ToString(tensor.DataType()) << ':' << tensor.Shape() << ':' << std::hex << hash[0]
+      << '-' << hash[1] << '-' << hash[2] << '-' << hash[3];
+  return key.str();
+}
+
+// Pre-packs `tensor` through the disk cache when there is one. If the cache has the entry of the weight and the
+// kernel can restore its state for it, the entry is mapped into `weights` and the weight is not packed. Otherwise
+// the buffers produced by PrePack() are replaced by the shared entry, or kept when the cache cannot be used.
+static Status PrePackThroughDiskCache(const PrepackedWeightsDiskCache* disk_cache, const Node& node, OpKernel& kernel,
+                                      const Tensor& tensor, int input_idx, const AllocatorPtr& alloc,
+                                      const ConfigOptions& config_options, /*out*/ bool& is_packed,
+                                      /*out*/ PrePackedWeights& weights, const logging::Logger& logger) {
+  if (disk_cache == nullptr || node.GetExecutionProviderType() != kCpuExecutionProvider ||
+      tensor.IsDataTypeString()) {
+    return kernel.PrePack(tensor, input_idx, alloc, is_packed, &weights);
+  }
+
+  const std::string key = GenerateKeyForPrepackedWeightsDiskCache(node, kernel, input_idx, tensor, config_options);
+  PrePackedWeights cached_weights;
+  bool found = false;
+  auto status = disk_cache->Load(node.OpType(), key, cached_weights, found);
+  if (!status.IsOK()) {
+    LOGS(logger, WARNING) << "Not using the pre-packed weights cache entry of node " << node.Name() << ": "
+                          << status.ErrorMessage();
+  } else if (found) {
+    bool is_restored = false;
+    ORT_RETURN_IF_ERROR(kernel.RestorePrePackedState(tensor, input_idx, cached_weights.buffer_sizes_, is_restored));
+    if (is_restored) {
+      is_packed = true;
+      weights = std::move(cached_weights);
+      return Status::OK();
+    }
+  }
+
+  ORT_RETURN_IF_ERROR(kernel.PrePack(tensor, input_idx, alloc, is_packed, &weights));
+  if (is_packed && !weights.buffers_.empty()) {
+    status = disk_cache->Share(node.OpType(), key, weights);
+    if (!status.IsOK()) {
+      LOGS(logger, WARNING) << "Not sharing the pre-packed weights of node " << node.Name()
+                            << " through the disk cache: " << status.ErrorMessage();
+    }
+  }
+  return Status::OK();
+}
+
 static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
                                                      const PrePackedWeights& pre_packed_weights) {
   std::ostringstream ss_1;
@@ -446,7 +526,18 @@ static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
 Status SessionState::PrepackConstantInitializedTensors(
     InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
     const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map) {
-  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map](
+  std::unique_ptr<PrepackedWeightsDiskCache> disk_cache;
+  const std::string disk_cache_dir =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsPrepackedWeightsCacheDir, "");
+  if (!disk_cache_dir.empty()) {
+    auto status = PrepackedWeightsDiskCache::Create(ToPathString(disk_cache_dir), disk_cache);
+    if (!status.IsOK()) {
+      LOGS(logger_, WARNING) << "Ignoring the pre-packed weights cache: " << status.ErrorMessage();
+    }
+  }
+
+  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map,
+                                     disk_cache = disk_cache.get()](
                                         bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
     for (auto& node : GetGraphViewer().Nodes()) {
       if (sess_options_.IsLoadCancellationFlagSet()) {
@@ -489,9 +580,10 @@ Status SessionState::PrepackConstantInitializedTensors(
                   // pre-packed  weight with the pre-packed weight generated by this instance of the same op_type
                   // because other static properties of the node like node attributes could play a role in the
                   // pre-packed weights' contents.
-                  ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx, allocator_for_caching,
-                                                      is_packed,
-                                                      &weights_to_be_filled_in));
+                  ORT_RETURN_IF_ERROR(PrePackThroughDiskCache(disk_cache, node, *kernel, const_initialized_tensor,
+                                                              input_idx, allocator_for_caching,
+                                                              sess_options_.config_options, is_packed,
+                                                              weights_to_be_filled_in, logger_));
 
                   if (is_packed) {
                     // BUG CHECK: Ensure that the kernel has filled in the pre-packed weight
@@ -587,9 +679,10 @@ Status SessionState::PrepackConstantInitializedTensors(
                   // pre-packed weight with the pre-packed weight generated by this instance of the same op_type because
                   // other static properties of the node like node attributes could play a role in the pre-packed
                   // weights' contents.
-                  ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx, session_cpu_alloc,
-                                                      is_packed,
-                                                      &weights_to_be_filled_in));
+                  ORT_RETURN_IF_ERROR(PrePackThroughDiskCache(disk_cache, node, *kernel, const_initialized_tensor,
+                                                              input_idx, session_cpu_alloc,
+                                                              sess_options_.config_options, is_packed,
+                                                              weights_to_be_filled_in, logger_));
 
                   // Some kernels (matmul_nbits and non-CPU related kernels) do not share their pre-packed results
                   // even though they set is_packed = true so we leave it up to them.
@@ -661,10 +754,20 @@ Status SessionState::PrepackConstantInitializedTensors(
 }
 
 static int64_t
-CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
+CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs, const MemoryPatternShapeBuckets& buckets) {
   int64_t key = 0;
   for (const auto& input : tensor_inputs) {
-    for (auto dim : input.Get<Tensor>().Shape().GetDims()) key ^= dim;
+    for (auto dim : input.Get<Tensor>().Shape().GetDims()) key ^= buckets.RoundUp(dim);
+  }
+  return key;
+}
+
+static int64_t
+CalculateMemoryPatternsKey(const std::vector<TensorShapeVector>& input_shapes,
+                           const MemoryPatternShapeBuckets& buckets) {
+  int64_t key = 0;
+  for (const auto& shape : input_shapes) {
+    for (auto dim : shape) key ^= buckets.RoundUp(dim);
   }
   return key;
 }
@@ -910,7 +1013,7 @@ const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
     gsl::span<const int> feed_mlvalue_idxs,
     const InlinedHashMap<int, TensorShape>*& out_inferred_shapes) const {
   out_inferred_shapes = nullptr;
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  int64_t key = CalculateMemoryPatternsKey(tensor_inputs, mem_pattern_shape_buckets_);
   std::lock_guard<std::mutex> lock(mem_patterns_lock_);
   auto it = mem_patterns_.find(key);
   if (it == mem_patterns_.end()) {
@@ -981,18 +1084,140 @@ void SessionState::ResolveMemoryPatternFlag() {
       }
     }
   }
+
+  if (enable_mem_pattern_ && !graph_viewer_->IsSubgraph()) {
+    const std::string cache_file = sess_options_.config_options.GetConfigOrDefault(
+        kOrtSessionOptionsMemoryPatternCacheFile, "");
+    if (!cache_file.empty()) {
+      LoadMemoryPatternCacheFile(ToPathString(cache_file));
+    }
+  }
+}
+
+uint64_t SessionState::ComputeMemoryPatternPlanHash() const {
+  // The patterns depend on the nodes, their order, the shapes inferred for the values
+  // and the allocation plan.
+  std::ostringstream plan;
+  plan << ORT_VERSION << '\n';
+  for (NodeIndex node_index : graph_viewer_->GetNodesInTopologicalOrder()) {
+    const Node* node = graph_viewer_->GetNode(node_index);
+    if (node != nullptr) {
+      plan << node->OpType() << ' ' << node->Domain() << ' ' << node->GetExecutionProviderType() << ' '
+           << node->Name() << '\n';
+    }
+  }
+
+  const auto& allocation_plan = p_seq_exec_plan_->allocation_plan;
+  for (int idx = 0, end = ort_value_name_idx_map_.MaxIdx(); idx <= end; ++idx) {
+    std::string name;
+    if (!ort_value_name_idx_map_.GetName(idx, name).IsOK()) {
+      continue;
+    }
+    plan << idx << ' ' << name;
+    if (static_cast<size_t>(idx) < allocation_plan.size()) {
+      const auto& value_plan = allocation_plan[idx];
+      plan << ' ' << static_cast<int>(value_plan.alloc_kind) << ' ' << value_plan.reused_buffer << ' '
+           << value_plan.location.ToString();
+    }
+    const NodeArg* node_arg = graph_viewer_->GetNodeArg(name);
+    const auto* shape = node_arg != nullptr ? node_arg->Shape() : nullptr;
+    if (shape != nullptr) {
+      for (const auto& dim : shape->dim()) {
+        if (dim.has_dim_value()) {
+          plan << ' ' << dim.dim_value();
+        } else {
+          plan << ' ' << dim.dim_param() << '?';
+        }
+      }
+    }
+    plan << '\n';
+  }
+
+  const std::string buffer = plan.str();
+  uint64_t hash[2] = {0, 0};
+  MurmurHash3::x86_128(buffer.data(), buffer.size(), 0, hash);
+  return hash[0] ^ hash[1];
+}
+
+void SessionState::LoadMemoryPatternCacheFile(const PathString& path) {
+  mem_pattern_cache_file_ = std::make_unique<MemoryPatternCacheFile>(path, ComputeMemoryPatternPlanHash());
+
+  // A missing or invalid file never fails the session, the patterns are generated again.
+  std::vector<MemoryPatternCacheFile::Entry> entries;
+  auto status = mem_pattern_cache_file_->Load(entries);
+  if (!status.IsOK()) {
+    LOGS(logger_, WARNING) << "Ignoring the memory pattern cache file " << PathToUTF8String(path) << ": "
+                           << status.ErrorMessage();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
+  for (auto& [input_shapes, mem_patterns] : entries) {
+    mem_patterns_.emplace(CalculateMemoryPatternsKey(input_shapes, mem_pattern_shape_buckets_),
+                          std::move(mem_patterns));
+  }
+  LOGS(logger_, INFO) << "Loaded " << entries.size() << " memory patterns from " << PathToUTF8String(path);
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                                    MemoryPatternGroup mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  int64_t key = CalculateMemoryPatternsKey(tensor_inputs, mem_pattern_shape_buckets_);
 
-  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
-  // Do not update if present, as the pointer to the existing one is cached
-  mem_patterns_.emplace(key, std::move(mem_patterns));
+  const MemoryPatternGroup* added = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mem_patterns_lock_);
+    // Do not update if present, as the pointer to the existing one is cached
+    auto result = mem_patterns_.emplace(key, std::move(mem_patterns));
+    if (result.second) {
+      added = &result.first->second;
+    }
+  }
+
+  // The entries of mem_patterns_ are never modified once added, the file is written without holding the lock.
+  if (added != nullptr && mem_pattern_cache_file_ != nullptr) {
+    std::vector<TensorShapeVector> input_shapes;
+    input_shapes.reserve(tensor_inputs.size());
+    for (const auto& input : tensor_inputs) {
+      // The pattern was planned for the upper bound of the buckets.
+      auto& shape = input_shapes.emplace_back(input.Get<Tensor>().Shape().AsShapeVector());
+      for (auto& dim : shape) {
+        dim = mem_pattern_shape_buckets_.RoundUp(dim);
+      }
+    }
+    auto status = mem_pattern_cache_file_->Append(input_shapes, *added);
+    if (!status.IsOK()) {
+      LOGS(logger_, WARNING) << "Failed to update the memory pattern cache file "
+                             << PathToUTF8String(mem_pattern_cache_file_->Path()) << ": " << status.ErrorMessage();
+    }
+  }
   return Status::OK();
 }
 
+void SessionState::ResolveMemoryPatternBucketDims(gsl::span<const OrtValue> tensor_inputs,
+                                                  gsl::span<const int> feed_mlvalue_idxs,
+                                                  InlinedHashMap<std::string, int64_t>& bucketed_dim_params) const {
+  bucketed_dim_params.clear();
+  for (size_t i = 0, end = std::min(tensor_inputs.size(), feed_mlvalue_idxs.size()); i < end; ++i) {
+    std::string name;
+    if (!ort_value_name_idx_map_.GetName(feed_mlvalue_idxs[i], name).IsOK()) {
+      continue;
+    }
+    const NodeArg* node_arg = graph_viewer_->GetNodeArg(name);
+    const auto* shape = node_arg != nullptr ? node_arg->Shape() : nullptr;
+    const auto dims = tensor_inputs[i].Get<Tensor>().Shape().GetDims();
+    if (shape == nullptr || shape->dim_size() != static_cast<int>(dims.size())) {
+      continue;
+    }
+    for (int k = 0, rank = shape->dim_size(); k < rank; ++k) {
+      if (shape->dim(k).has_dim_param()) {
+        // Two inputs may disagree on the value of a symbol, keep the largest one.
+        auto& value = bucketed_dim_params[shape->dim(k).dim_param()];
+        value = std::max(value, mem_pattern_shape_buckets_.RoundUp(dims[k]));
+      }
+    }
+  }
+}
+
 bool SessionState::GetEnableMemoryPattern() const { return enable_mem_pattern_; }
 
 bool SessionState::GetEnableMemoryReuse() const { return sess_options_.enable_mem_reuse; }
@@ -1545,6 +1770,11 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                                    session_options.execution_order,
                                    session_options.enable_mem_reuse);
 
+  // Subgraphs always run sequentially, see the options of the subgraph session states.
+  const bool use_work_stealing =
+      session_options.execution_mode == ExecutionMode::ORT_PARALLEL &&
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsInterOpWorkStealing, "0") == "1";
+
 #ifdef _WIN32
 
   PathString partition_config_file =
@@ -1559,6 +1789,11 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
 
 #endif
 
+  if (use_work_stealing && !partition_config_file.empty()) {
+    LOGS(Logger(), WARNING) << "The node partition config file is ignored with work stealing inter-op scheduling.";
+    partition_config_file.clear();
+  }
+
   auto status = SequentialPlanner::CreatePlan(parent_node, *graph_viewer_, valid_outer_scope_node_args,
                                               execution_providers_, kernel_create_info_map_,
                                               subgraphs_kernel_create_info_maps,
@@ -1572,6 +1807,35 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                                               p_seq_exec_plan_);
   ORT_RETURN_IF_ERROR(status);
 
+  ORT_RETURN_IF_ERROR(MemoryPatternShapeBuckets::Parse(
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsMemoryPatternShapeBuckets, ""),
+      mem_pattern_shape_buckets_));
+
+  if (use_work_stealing) {
+    ORT_RETURN_IF_ERROR(WorkStealingPlan::Create(*graph_viewer_, *p_seq_exec_plan_, Logger(), work_stealing_plan_));
+  }
+
+  if (parent_node == nullptr) {
+    const bool calibrate_intra_op_cost =
+        session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsIntraOpCostCalibration, "0") == "1";
+    const std::string cost_table_file =
+        session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsIntraOpCostTableFile, "");
+    const int max_num_threads = concurrency::ThreadPool::NumLoopThreads(thread_pool_);
+    // Nothing to cap without intra-op threads.
+    if ((calibrate_intra_op_cost || !cost_table_file.empty()) && max_num_threads > 1) {
+      intra_op_cost_table_ = std::make_unique<IntraOpCostTable>(max_num_threads, calibrate_intra_op_cost,
+                                                                ToPathString(cost_table_file));
+      if (!cost_table_file.empty()) {
+        // A missing or invalid file never fails the session, the costs are measured again.
+        auto cost_table_status = intra_op_cost_table_->Load();
+        if (!cost_table_status.IsOK()) {
+          LOGS(Logger(), WARNING) << "Ignoring the intra-op cost table file " << cost_table_file << ": "
+                                  << cost_table_status.ErrorMessage();
+        }
+      }
+    }
+  }
+
   if (session_options.IsLoadCancellationFlagSet()) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, MODEL_LOAD_CANCELED,
                            "SessionState finalize is canceled due to user request");
@@ -28,9 +28,13 @@
 #include "core/framework/fuse_nodes_funcs.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
+#include "core/framework/mem_pattern_cache_file.h"
+#include "core/framework/mem_pattern_shape_buckets.h"
 #include "core/framework/ort_value.h"
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
+#include "core/framework/work_stealing_executor.h"
+#include "core/framework/intra_op_cost_table.h"
 #include "core/framework/ort_value_name_idx_map.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/onnx_protobuf.h"
@@ -240,6 +244,37 @@ class SessionState {
   Status UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                        MemoryPatternGroup mem_patterns) const;
 
+  /**
+  Buckets applied to the input shapes before looking up a memory pattern,
+  see kOrtSessionOptionsMemoryPatternShapeBuckets.
+  */
+  const MemoryPatternShapeBuckets& GetMemoryPatternShapeBuckets() const { return mem_pattern_shape_buckets_; }
+
+  /**
+  Maps every symbolic dimension of the graph inputs to the upper bound of the bucket of its value in `tensor_inputs`.
+  A memory pattern traced for these inputs is planned with these values.
+  */
+  void ResolveMemoryPatternBucketDims(gsl::span<const OrtValue> tensor_inputs,
+                                      gsl::span<const int> feed_mlvalue_idxs,
+                                      InlinedHashMap<std::string, int64_t>& bucketed_dim_params) const;
+
+  /**
+  Dependency counters used to schedule the nodes on the inter-op thread pool,
+  null unless kOrtSessionOptionsInterOpWorkStealing is enabled and the plan supports it.
+  */
+  const WorkStealingPlan* GetWorkStealingPlan() const { return work_stealing_plan_.get(); }
+
+  /**
+  Costs capping the intra-op parallelism of the nodes, null unless kOrtSessionOptionsIntraOpCostCalibration or
+  kOrtSessionOptionsIntraOpCostTableFile is set. The table is only present at the root SessionState object.
+  */
+  IntraOpCostTable* GetIntraOpCostTable() const {
+    if (parent_ != nullptr) {
+      return parent_->GetIntraOpCostTable();
+    }
+    return intra_op_cost_table_.get();
+  }
+
   bool GetUseDeterministicCompute() const { return sess_options_.use_deterministic_compute; }
 
   /**
@@ -256,6 +291,8 @@ class SessionState {
   /**
   Update enable_mem_pattern_ flag according to the presence of graph inputs' shape
   If any one of the graph input is shapeless, enable_mem_pattern_ will be set to false
+  When memory patterns stay enabled for the main graph, the patterns saved in the file given by
+  kOrtSessionOptionsMemoryPatternCacheFile are loaded.
   */
   void ResolveMemoryPatternFlag();
 
@@ -431,6 +468,11 @@ class SessionState {
                                   const InlinedHashMap<OrtValueName, OrtDevice>& outer_scope_node_arg_to_location_map = {},
                                   bool graph_info_already_created = false);
 
+  // Hash identifying the execution plan, memory patterns saved with another plan cannot be reused.
+  uint64_t ComputeMemoryPatternPlanHash() const;
+
+  void LoadMemoryPatternCacheFile(const PathString& path);
+
 #ifdef ENABLE_TRAINING
   Status GeneratePatternGroupCache(
       gsl::span<const OrtValue> inputs,
@@ -523,6 +565,11 @@ class SessionState {
   // cache for the generated mem_patterns. key is calculated based on input shapes.
   // must be a node based container as a pointer is cached.
   mutable NodeHashMap<int64_t, MemoryPatternGroup> mem_patterns_;
+  MemoryPatternShapeBuckets mem_pattern_shape_buckets_;
+  // Persists the patterns added to mem_patterns_, only set for the main graph.
+  std::unique_ptr<MemoryPatternCacheFile> mem_pattern_cache_file_;
+  std::unique_ptr<WorkStealingPlan> work_stealing_plan_;
+  std::unique_ptr<IntraOpCostTable> intra_op_cost_table_;
   // This is mutable under mutex in training scenarios so execution frame would make a copy
   // of the value when created.
 #ifdef ENABLE_TRAINING
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/work_stealing_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+
+#include "core/framework/sequential_execution_plan.h"
+#include "core/framework/session_state.h"
+#include "core/framework/stream_execution_context.h"
+#include "core/graph/constants.h"
+#include "core/graph/graph_viewer.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+Status WorkStealingPlan::Create(const GraphViewer& graph_viewer, const SequentialExecutionPlan& execution_plan,
+                                const logging::Logger& logger, std::unique_ptr<WorkStealingPlan>& plan) {
+  plan.reset();
+
+  if (execution_plan.execution_plan.size() != 1 || execution_plan.execution_plan[0]->steps_.empty()) {
+    LOGS(logger, WARNING) << "Work stealing inter-op scheduling requires a single non-empty logic stream, found "
+                          << execution_plan.execution_plan.size() << " streams. Using the stream partition.";
+    return Status::OK();
+  }
+
+  const auto& steps = execution_plan.execution_plan[0]->steps_;
+  InlinedHashMap<NodeIndex, size_t> step_of_node;
+  step_of_node.reserve(steps.size());
+  for (size_t i = 0; i < steps.size(); ++i) {
+    const NodeIndex node_index = steps[i]->GetNodeIndex();
+    const Node* node = graph_viewer.GetNode(node_index);
+    ORT_RETURN_IF(node == nullptr, "Execution plan step ", i, " refers to an unknown node ", node_index);
+    if (node->GetExecutionProviderType() != kCpuExecutionProvider) {
+      LOGS(logger, WARNING) << "Work stealing inter-op scheduling only supports the CPU execution provider, node "
+                            << node->Name() << " runs on " << node->GetExecutionProviderType()
+                            << ". Using the stream partition.";
+      return Status::OK();
+    }
+    ORT_RETURN_IF_NOT(step_of_node.emplace(node_index, i).second, "Node ", node_index,
+                      " appears twice in the execution plan.");
+  }
+
+  auto new_plan = std::make_unique<WorkStealingPlan>();
+  new_plan->num_dependencies.resize(steps.size(), 0);
+  new_plan->consumers.resize(steps.size());
+  for (size_t i = 0; i < steps.size(); ++i) {
+    const Node& node = *graph_viewer.GetNode(steps[i]->GetNodeIndex());
+    auto& consumers = new_plan->consumers[i];
+    // Data and control edges, a node consuming several outputs of a producer depends on it once.
+    for (auto it = node.OutputNodesBegin(), end = node.OutputNodesEnd(); it != end; ++it) {
+      auto consumer = step_of_node.find(it->Index());
+      if (consumer != step_of_node.end() &&
+          std::find(consumers.begin(), consumers.end(), consumer->second) == consumers.end()) {
+        ORT_RETURN_IF_NOT(consumer->second > i, "Node ", it->Name(), " is planned before its producer ",
+                          node.Name());
+        consumers.push_back(consumer->second);
+        ++new_plan->num_dependencies[consumer->second];
+      }
+    }
+  }
+  for (size_t i = 0; i < steps.size(); ++i) {
+    if (new_plan->num_dependencies[i] == 0) {
+      new_plan->roots.push_back(i);
+    }
+  }
+
+  plan = std::move(new_plan);
+  return Status::OK();
+}
+
+namespace {
+
+struct WorkStealingRun {
+  const WorkStealingPlan& plan;
+  const SequentialExecutionPlan::LogicStream& logic_stream;
+  StreamExecutionContext& ctx;
+  SessionScope& session_scope;
+  const bool& terminate_flag;
+  concurrency::ThreadPool* tp;
+  // Producers still to run for every node, a node is ready when it reaches 0.
+  std::unique_ptr<std::atomic_int[]> num_pending_dependencies;
+};
+
+void RunFrom(WorkStealingRun& run, size_t step);
+
+void Schedule(WorkStealingRun& run, size_t step) {
+  // increase the task count before scheduling, WaitAll() must not return while the node is queued
+  run.ctx.AddTask();
+  concurrency::ThreadPool::Schedule(run.tp, [&run, step]() { RunFrom(run, step); });
+}
+
+// Runs `step`, then keeps running one of the nodes it made ready on the current worker, where its inputs are
+// still in cache, and hands the other ones to the thread pool where idle workers pick them up.
+void RunFrom(WorkStealingRun& run, size_t step) {
+  for (;;) {
+    if (!run.ctx.TaskStatus().IsOK()) {
+      break;
+    }
+    if (run.terminate_flag) {
+      Status status_made = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+      run.ctx.SetStatus(status_made);
+      break;
+    }
+
+    bool continue_flag = true;
+    Status status;
+    ORT_TRY {
+      status = run.logic_stream.steps_[step]->Execute(run.ctx, 0, run.session_scope, run.terminate_flag,
+                                                      continue_flag);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+    if (!status.IsOK()) {
+      run.ctx.SetStatus(status);
+      break;
+    }
+    if (!continue_flag) {
+      break;
+    }
+
+    std::optional<size_t> next;
+    for (size_t consumer : run.plan.consumers[step]) {
+      // acq_rel so that the consumer sees the outputs of all its producers
+      if (run.num_pending_dependencies[consumer].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!next.has_value()) {
+          next = consumer;
+        } else {
+          Schedule(run, consumer);
+        }
+      }
+    }
+    if (!next.has_value()) {
+      break;
+    }
+    step = *next;
+  }
+
+  run.ctx.CompleteTask();
+}
+
+}  // namespace
+
+void RunWithWorkStealing(const WorkStealingPlan& plan, StreamExecutionContext& ctx, SessionScope& session_scope,
+                         const bool& terminate_flag, concurrency::ThreadPool* tp) {
+  const size_t num_steps = plan.num_dependencies.size();
+  WorkStealingRun run{plan,
+                      *ctx.GetSessionState().GetExecutionPlan()->execution_plan[0],
+                      ctx,
+                      session_scope,
+                      terminate_flag,
+                      tp,
+                      std::make_unique<std::atomic_int[]>(num_steps)};
+  for (size_t i = 0; i < num_steps; ++i) {
+    run.num_pending_dependencies[i].store(plan.num_dependencies[i], std::memory_order_relaxed);
+  }
+
+  // The task counted by the execution context for the stream is the first root, run by the calling thread.
+  for (size_t i = 1; i < plan.roots.size(); ++i) {
+    Schedule(run, plan.roots[i]);
+  }
+  RunFrom(run, plan.roots[0]);
+
+  // `run` is referenced by the scheduled tasks.
+  ctx.WaitAll();
+}
+
+}  // namespace onnxruntime
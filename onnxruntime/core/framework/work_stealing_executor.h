@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/logging/logging.h"
+
+namespace onnxruntime {
+
+class SessionState;
+class SessionScope;
+class StreamExecutionContext;
+struct SequentialExecutionPlan;
+class GraphViewer;
+
+namespace concurrency {
+class ThreadPool;
+}
+
+/**
+ * Dependency counters used to schedule the nodes of a CPU graph dynamically on the inter-op thread pool,
+ * see kOrtSessionOptionsInterOpWorkStealing.
+ *
+ * The indices are the step indices of the single logic stream of the execution plan.
+ * A node is ready once all the nodes producing its inputs have run, so independent branches of the graph
+ * run concurrently however the cost of their nodes differs from the static stream partition.
+ */
+struct WorkStealingPlan {
+  // Number of distinct producer nodes of every node.
+  InlinedVector<int> num_dependencies;
+  // Nodes consuming an output of every node.
+  std::vector<InlinedVector<size_t>> consumers;
+  // Nodes without producer, ready at the beginning of a run.
+  InlinedVector<size_t> roots;
+
+  // Creates the plan, `plan` is null when the execution plan cannot be scheduled dynamically:
+  // the graph is empty, runs on several logic streams or has a node outside of the CPU execution provider.
+  static Status Create(const GraphViewer& graph_viewer, const SequentialExecutionPlan& execution_plan,
+                       const logging::Logger& logger, std::unique_ptr<WorkStealingPlan>& plan);
+};
+
+// Runs the nodes of `plan` on the inter-op thread pool `tp`, the calling thread runs the first root.
+// The execution context must count one remaining task for the stream. Returns once every scheduled node completed,
+// the status of the run is ctx.TaskStatus().
+void RunWithWorkStealing(const WorkStealingPlan& plan, StreamExecutionContext& ctx, SessionScope& session_scope,
+                         const bool& terminate_flag, concurrency::ThreadPool* tp);
+
+}  // namespace onnxruntime
@@ -280,11 +280,22 @@ void BaseGroupQueryAttentionTypeAndShapeInference(ONNX_NAMESPACE::InferenceConte
   }
 
   if (ctx.getNumOutputs() >= 3) {  // has present output
-    // copy the type from query to present key
-    ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 1);
-
-    // copy the type from query to present value
-    ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 2);
+    // present key and value have the type of past key and value. Without past, they have the type of query, or the
+    // type of a quantized cache.
+    const int64_t kv_cache_bit_width = getAttribute(ctx, "kv_cache_bit_width", 0);
+    if (past_key_index >= 0 && hasInputType(ctx, past_key_index)) {
+      ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, past_key_index, 1);
+      ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, static_cast<size_t>(past_key_index) + 1, 2);
+    } else if (kv_cache_bit_width == 8) {
+      updateOutputElemType(ctx, 1, ONNX_NAMESPACE::TensorProto::INT8);
+      updateOutputElemType(ctx, 2, ONNX_NAMESPACE::TensorProto::INT8);
+    } else if (kv_cache_bit_width == 4) {
+      updateOutputElemType(ctx, 1, ONNX_NAMESPACE::TensorProto::UINT8);
+      updateOutputElemType(ctx, 2, ONNX_NAMESPACE::TensorProto::UINT8);
+    } else {
+      ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 1);
+      ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 2);
+    }
 
     int64_t total_sequence_length_value = 0;
     const auto* total_sequence_length_data = ctx.getInputData(6);
@@ -1129,6 +1140,11 @@ Only supports causal and local attention.
 Supports rotary position embedding for CPU and CUDA.
 Supports packed input for CPU and CUDA.
 Supports continuous decoding for batch_size == 1 for CPU and CUDA.
+Supports a quantized KV cache for CPU: with kv_cache_bit_width of 8 the cache is int8, and with kv_cache_bit_width of 4
+it is uint8 holding two signed 4-bit values per byte, low nibble first, so its last dimension is head_size / 2.
+Values are symmetric quantized with k_scale and v_scale, which are per-tensor with shape (1), per-head with shape
+(kv_num_heads), or per-channel with shape (kv_num_heads, head_size). New key and value are quantized when they are
+written to present_key and present_value.
 
 )DOC";
 
@@ -1166,6 +1182,11 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
               "Output values of QK matrix multiplication before (1) or after (2) softmax normalization. Default value is 0 (don't output).",
               AttributeProto::INT,
               static_cast<int64_t>(QKOutputType::NO_OUTPUT))
+        .Attr("kv_cache_bit_width",
+              "Bit width of a quantized KV cache: 8 (int8), 4 (int4 packed in uint8) or 0 (not quantized). "
+              "Default value is 0.",
+              AttributeProto::INT,
+              static_cast<int64_t>(0))
         .Input(0,
                "query",
                "Query with shape (batch_size, sequence_length, hidden_size), or packed QKV with shape"
@@ -1185,13 +1206,13 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
                "past_key",
                "past state key with support for format BNSH. When past_key uses same tensor as present_key"
                "(k-v cache), it is of length max_sequence_length... otherwise of length past_sequence_length.",
-               "T",
+               "T_CACHE",
                OpSchema::Optional)
         .Input(4,
                "past_value",
                "past state value with support for format BNSH. When past_value uses same tensor as present_value"
                "(k-v cache), it is of length max_sequence_length... otherwise of length past_sequence_length.",
-               "T",
+               "T_CACHE",
                OpSchema::Optional)
         .Input(5,
                "seqlens_k",
@@ -1228,6 +1249,18 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
                "1D tensor with shape (num_heads). Each head has a smooth factor adding to the denominator of softmax.",
                "T",
                OpSchema::Optional)
+        .Input(12,
+               "k_scale",
+               "Scale of the quantized key cache with shape (1), (kv_num_heads) or (kv_num_heads, head_size). "
+               "Required when kv_cache_bit_width is not 0.",
+               "tensor(float)",
+               OpSchema::Optional)
+        .Input(13,
+               "v_scale",
+               "Scale of the quantized value cache with shape (1), (kv_num_heads) or (kv_num_heads, head_size). "
+               "Required when kv_cache_bit_width is not 0.",
+               "tensor(float)",
+               OpSchema::Optional)
         .Output(0,
                 "output",
                 "3D output tensor with shape (batch_size, sequence_length, hidden_size)",
@@ -1237,19 +1270,21 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
                 "present state key with support for format BNSH. When past_key uses same tensor as present_key"
                 "(k-v buffer), it is of length max_sequence_length... otherwise of length past_sequence_length +"
                 "kv_sequence_length.",
-                "T")
+                "T_CACHE")
         .Output(2,
                 "present_value",
                 "present state value with support for format BNSH. When past_value uses same tensor as present_value"
                 "(k-v buffer), it is of length max_sequence_length... otherwise of length past_sequence_length +"
                 "kv_sequence_length.",
-                "T")
+                "T_CACHE")
         .Output(3,
                 "output_qk",
                 "Values of QK matrix multiplication, either before or after softmax normalization",
                 "T",
                 OpSchema::Optional)
         .TypeConstraint("T", {"tensor(float16)", "tensor(bfloat16)", "tensor(float)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("T_CACHE", {"tensor(float16)", "tensor(bfloat16)", "tensor(float)", "tensor(int8)", "tensor(uint8)"},
+                        "Constrain KV cache to float tensors, or to int8 and uint8 tensors of a quantized cache.")
         .TypeConstraint("M", {"tensor(int32)"}, "Constrain mask to int tensor.")
         .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
           GroupQueryAttentionTypeAndShapeInference(ctx, 3, 3);
@@ -1258,8 +1293,8 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
 constexpr const char* PagedAttention_ver1_doc = R"DOC(
 Paged Attention.
 
-This op leverages a block-based KV cache to enable continuous batching for LLMs. Currently, it is designed to work with
-the CUDA Execution Provider only.
+This op leverages a block-based KV cache to enable continuous batching for LLMs. It is implemented for the CUDA and CPU
+Execution Providers. The CUDA Execution Provider requires a block size that is a multiple of 256.
 
 In other attention ops, batch entries typically aren't of the same length, so they are padded.
 Below is a batch with 3 sequences where * denotes a padding token.
@@ -1445,7 +1480,8 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
                 "the same tensor as value_cache.",
                 "T",
                 OpSchema::Optional)
-        .TypeConstraint("T", {"tensor(float16)", "tensor(bfloat16)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("T", {"tensor(float)", "tensor(float16)", "tensor(bfloat16)"},
+                        "Constrain input and output to float tensors.")
         .TypeConstraint("S", {"tensor(int32)"}, "Constrain Positional inputs to int tensor.")
         .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
           PagedAttentionTypeAndShapeInference(ctx);
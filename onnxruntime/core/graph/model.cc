@@ -1,7 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <filesystem>
+#include <limits>
 #include <memory>
+#include <string_view>
 #include "core/common/logging/logging.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/flatbuffers/flatbuffers_utils.h"
@@ -733,6 +736,217 @@ Status Model::Load(int fd, ONNX_NAMESPACE::ModelProto& model_proto) {
   return Status::OK();
 }
 
+namespace {
+
+// Field numbers and wire types of the onnx.proto messages rewritten by LoadWithMappedInitializers().
+constexpr uint32_t kModelProtoGraphField = 7;
+constexpr uint32_t kGraphProtoInitializerField = 5;
+constexpr uint32_t kTensorProtoDataTypeField = 2;
+constexpr uint32_t kTensorProtoRawDataField = 9;
+constexpr uint32_t kTensorProtoExternalDataField = 13;
+constexpr uint32_t kTensorProtoDataLocationField = 14;
+constexpr uint32_t kStringStringEntryKeyField = 1;
+constexpr uint32_t kStringStringEntryValueField = 2;
+
+constexpr uint32_t kVarintWireType = 0;
+constexpr uint32_t kFixed64WireType = 1;
+constexpr uint32_t kLengthDelimitedWireType = 2;
+constexpr uint32_t kFixed32WireType = 5;
+
+// Raw data is only referenced in place when its offset in the file is aligned like the buffers of the CPU allocator,
+// so that kernels and prepacking get aligned data from the mapping. Other raw data stays inline.
+constexpr uint64_t kMappedInitializerAlignment = 64;
+
+#ifdef _WIN32
+// MapViewOfFile maps from a multiple of the allocation granularity, and the external data is copied instead of
+// mapped unless its page is at such a multiple.
+constexpr uint64_t kWindowsAllocationGranularity = 64 * 1024;
+constexpr uint64_t kWindowsPageSize = 4 * 1024;
+#endif
+
+bool IsMappableOffset(uint64_t offset) {
+  if (offset % kMappedInitializerAlignment != 0) {
+    return false;
+  }
+#ifdef _WIN32
+  if (offset % kWindowsAllocationGranularity >= kWindowsPageSize) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+struct WireField {
+  uint32_t number;
+  uint32_t wire_type;
+  // value of varint fields
+  uint64_t varint;
+  // payload of length delimited fields
+  const uint8_t* payload;
+  size_t payload_size;
+  // encoded field, including the tag
+  const uint8_t* begin;
+  const uint8_t* end;
+};
+
+Status ReadVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    ORT_RETURN_IF(cursor == end, "Truncated varint.");
+    const uint8_t byte = *cursor++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return Status::OK();
+    }
+  }
+  return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Invalid varint.");
+}
+
+Status ReadField(const uint8_t*& cursor, const uint8_t* end, WireField& field) {
+  field = {};
+  field.begin = cursor;
+  uint64_t tag = 0;
+  ORT_RETURN_IF_ERROR(ReadVarint(cursor, end, tag));
+  field.number = static_cast<uint32_t>(tag >> 3);
+  field.wire_type = static_cast<uint32_t>(tag & 7);
+  switch (field.wire_type) {
+    case kVarintWireType:
+      ORT_RETURN_IF_ERROR(ReadVarint(cursor, end, field.varint));
+      break;
+    case kFixed64WireType:
+    case kFixed32WireType: {
+      const size_t size = field.wire_type == kFixed64WireType ? 8 : 4;
+      ORT_RETURN_IF(static_cast<size_t>(end - cursor) < size, "Truncated fixed size field.");
+      cursor += size;
+      break;
+    }
+    case kLengthDelimitedWireType: {
+      uint64_t size = 0;
+      ORT_RETURN_IF_ERROR(ReadVarint(cursor, end, size));
+      ORT_RETURN_IF(static_cast<uint64_t>(end - cursor) < size, "Truncated length delimited field.");
+      field.payload = cursor;
+      field.payload_size = static_cast<size_t>(size);
+      cursor += size;
+      break;
+    }
+    default:
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Unsupported protobuf wire type ", field.wire_type);
+  }
+  field.end = cursor;
+  return Status::OK();
+}
+
+void AppendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void AppendLengthDelimited(std::string& out, uint32_t number, std::string_view payload) {
+  AppendVarint(out, (static_cast<uint64_t>(number) << 3) | kLengthDelimitedWireType);
+  AppendVarint(out, payload.size());
+  out.append(payload);
+}
+
+void AppendExternalDataEntry(std::string& out, std::string_view key, std::string_view value) {
+  std::string entry;
+  AppendLengthDelimited(entry, kStringStringEntryKeyField, key);
+  AppendLengthDelimited(entry, kStringStringEntryValueField, value);
+  AppendLengthDelimited(out, kTensorProtoExternalDataField, entry);
+}
+
+// Copies the TensorProto, replacing large raw data at an aligned offset by a reference to the same bytes in the
+// model file.
+Status RewriteInitializer(const uint8_t* begin, const uint8_t* end, const uint8_t* file_begin,
+                          std::string_view location, std::string& out) {
+  const WireField* raw_data = nullptr;
+  WireField raw_data_field;
+  bool convertible = true;
+  for (const uint8_t* cursor = begin; cursor != end;) {
+    WireField field;
+    ORT_RETURN_IF_ERROR(ReadField(cursor, end, field));
+    if (field.number == kTensorProtoRawDataField && field.wire_type == kLengthDelimitedWireType) {
+      raw_data_field = field;
+      raw_data = &raw_data_field;
+    } else if (field.number == kTensorProtoExternalDataField || field.number == kTensorProtoDataLocationField ||
+               (field.number == kTensorProtoDataTypeField &&
+                field.varint == static_cast<uint64_t>(ONNX_NAMESPACE::TensorProto_DataType_STRING))) {
+      convertible = false;
+    }
+  }
+
+  if (!convertible || raw_data == nullptr || raw_data->payload_size <= utils::kSmallTensorExternalDataThreshold ||
+      !IsMappableOffset(static_cast<uint64_t>(raw_data->payload - file_begin))) {
+    out.append(reinterpret_cast<const char*>(begin), static_cast<size_t>(end - begin));
+    return Status::OK();
+  }
+
+  out.append(reinterpret_cast<const char*>(begin), static_cast<size_t>(raw_data->begin - begin));
+  out.append(reinterpret_cast<const char*>(raw_data->end), static_cast<size_t>(end - raw_data->end));
+  AppendExternalDataEntry(out, "location", location);
+  AppendExternalDataEntry(out, "offset", std::to_string(raw_data->payload - file_begin));
+  AppendExternalDataEntry(out, "length", std::to_string(raw_data->payload_size));
+  AppendVarint(out, (static_cast<uint64_t>(kTensorProtoDataLocationField) << 3) | kVarintWireType);
+  AppendVarint(out, ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  return Status::OK();
+}
+
+// Copies the fields of a message, rewriting the length delimited fields `number` with `rewrite`.
+template <typename Rewrite>
+Status RewriteMessage(const uint8_t* begin, const uint8_t* end, uint32_t number, const Rewrite& rewrite,
+                      std::string& out) {
+  for (const uint8_t* cursor = begin; cursor != end;) {
+    WireField field;
+    ORT_RETURN_IF_ERROR(ReadField(cursor, end, field));
+    if (field.number != number || field.wire_type != kLengthDelimitedWireType) {
+      out.append(reinterpret_cast<const char*>(field.begin), static_cast<size_t>(field.end - field.begin));
+      continue;
+    }
+    std::string rewritten;
+    ORT_RETURN_IF_ERROR(rewrite(field.payload, field.payload + field.payload_size, rewritten));
+    AppendLengthDelimited(out, number, rewritten);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status Model::LoadWithMappedInitializers(const PathString& file_path, ONNX_NAMESPACE::ModelProto& model_proto) {
+  const auto& env = Env::Default();
+  size_t file_size = 0;
+  ORT_RETURN_IF_ERROR(env.GetFileLength(file_path.c_str(), file_size));
+  ORT_RETURN_IF(file_size == 0, "Load model ", ToUTF8String(file_path), " failed. The file is empty.");
+
+  // The mapping only lives while the structure is copied, the initializers map the file again on first use.
+  Env::MappedMemoryPtr mapped_file;
+  ORT_RETURN_IF_ERROR(env.MapFileIntoMemory(file_path.c_str(), 0, file_size, mapped_file));
+  const auto* file_begin = reinterpret_cast<const uint8_t*>(mapped_file.get());
+  const uint8_t* file_end = file_begin + file_size;
+
+  // External data locations are relative to the directory of the model.
+  const std::string location = PathToUTF8String(std::filesystem::path(file_path).filename().native());
+
+  const auto rewrite_initializer = [file_begin, &location](const uint8_t* begin, const uint8_t* end,
+                                                           std::string& out) {
+    return RewriteInitializer(begin, end, file_begin, location, out);
+  };
+  const auto rewrite_graph = [&rewrite_initializer](const uint8_t* begin, const uint8_t* end, std::string& out) {
+    return RewriteMessage(begin, end, kGraphProtoInitializerField, rewrite_initializer, out);
+  };
+
+  std::string structure;
+  Status status = RewriteMessage(file_begin, file_end, kModelProtoGraphField, rewrite_graph, structure);
+  if (!status.IsOK()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Protobuf parsing failed. ", status.ErrorMessage());
+  }
+
+  ORT_RETURN_IF(structure.size() > static_cast<size_t>(std::numeric_limits<int>::max()),
+                "The model is too large without its initializers.");
+  return LoadFromBytes(static_cast<int>(structure.size()), structure.data(), model_proto);
+}
+
 Status Model::Load(int fd, std::shared_ptr<Model>& p_model, const IOnnxRuntimeOpSchemaRegistryList* local_registries,
                    const logging::Logger& logger, const ModelOptions& options) {
   return Load(fd, PathString{}, p_model, local_registries, logger, options);
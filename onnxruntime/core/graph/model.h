@@ -239,6 +239,13 @@ class Model {
 
   static common::Status Load(int fd, /*out*/ ONNX_NAMESPACE::ModelProto& model_proto);
 
+  // Loads the model from a memory mapped file without copying the raw data of the large initializers
+  // of the main graph whose raw data is 64-byte aligned in the file. Their TensorProto refers to the bytes in the model file as external data instead,
+  // so that the initializers are mapped into memory when first used. The file must not change while the model
+  // or a session created from it uses the initializers.
+  static common::Status LoadWithMappedInitializers(const PathString& file_path,
+                                                   /*out*/ ONNX_NAMESPACE::ModelProto& model_proto);
+
   static common::Status Load(int fd, /*out*/ std::shared_ptr<Model>& p_model,
                              const IOnnxRuntimeOpSchemaRegistryList* local_registries,
                              const logging::Logger& logger,
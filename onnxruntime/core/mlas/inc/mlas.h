@@ -723,6 +723,60 @@ MlasSymmQgemmBatch(
     MLAS_THREADPOOL* ThreadPool
     );
 
+//
+// Block sparse SGEMM routines for a constant B matrix with many zeros, such as
+// the weights of a pruned model. The packed B matrix only keeps the blocks of
+// 1 row by 16 columns with a nonzero element, so the multiplication skips the
+// zero blocks. MlasBlockSparseSgemm computes C = alpha * A * B + beta * C with
+// a row major A that is not transposed.
+//
+
+float
+MLASCALL
+MlasBlockSparseSgemmZeroBlockRatio(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb
+    );
+
+size_t
+MLASCALL
+MlasBlockSparseSgemmPackBSize(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb
+    );
+
+void
+MLASCALL
+MlasBlockSparseSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasBlockSparseSgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
 
 //
 // Buffer packing routines.
@@ -827,6 +881,7 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmWinograd,
 #if defined(MLAS_TARGET_WASM_SCALAR)
     MlasConvAlgorithmDepthwise,
 #endif
@@ -859,6 +914,11 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            size_t OutputTile;
+            size_t TileBlockSize;
+            size_t TileBlockCount;
+        } Winograd;
     } u;
 };
 
@@ -892,6 +952,51 @@ MlasConv(
     MLAS_THREADPOOL* ThreadPool
     );
 
+//
+// Winograd convolution routines for 2D convolutions with a 3x3 kernel and unit
+// strides and dilations, computing output tiles of 4x4 (F(4x4,3x3)) or 6x6
+// (F(6x6,3x3)) elements. The filter is transformed once by
+// MlasConvWinogradPackFilter and MlasConvPrepareWinograd switches a prepared
+// convolution to the Winograd algorithm, in which case MlasConv takes the
+// packed filter instead of the filter tensor.
+//
+
+size_t
+MLASCALL
+MlasConvWinogradPreferredOutputTile(
+    size_t InputChannels,
+    size_t FilterCount
+    );
+
+size_t
+MLASCALL
+MlasConvWinogradPackFilterSize(
+    size_t OutputTile,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    );
+
+void
+MLASCALL
+MlasConvWinogradPackFilter(
+    size_t OutputTile,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    float* PackedFilter
+    );
+
+bool
+MLASCALL
+MlasConvPrepareWinograd(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t OutputTile,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 void
 MLASCALL
 MlasConvDepthwise(
@@ -1122,6 +1227,104 @@ MlasComputeTanh(
     size_t N
     );
 
+//
+// Reduction routines.
+//
+
+enum MLAS_REDUCE_KIND {
+    MlasReduceSum,
+    MlasReduceMean,
+    MlasReduceMaximum,
+    MlasReduceSumSquare,
+    MlasReduceLogSumExp,
+};
+
+//
+// Reduces the middle dimension of an input of shape [OuterCount, ReduceCount,
+// InnerCount] to an output of shape [OuterCount, InnerCount]. InnerCount == 1
+// reduces contiguous rows, otherwise the columns are reduced with strided
+// accesses. ReduceCount must not be zero.
+//
+
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND ReduceKind,
+    const float* Input,
+    float* Output,
+    size_t OuterCount,
+    size_t ReduceCount,
+    size_t InnerCount,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Selects the K largest or smallest elements of a row, with equal values
+// ordered by index. Returns false without writing the outputs if the row has
+// fewer than K elements that compare beyond the infinity of the opposite
+// sign. The workspace holds MlasTopKGetWorkspaceCount(K) elements.
+//
+
+size_t
+MLASCALL
+MlasTopKGetWorkspaceCount(
+    size_t K
+    );
+
+bool
+MLASCALL
+MlasTopK(
+    const float* Input,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    float* Values,
+    int64_t* Indices,
+    uint32_t* Workspace
+    );
+
+//
+// Resize routines.
+//
+// The 2-D resize of an image with interleaved channels is split into a
+// horizontal pass over each input row and a vertical pass over the
+// horizontally resized rows, each driven by precomputed index and weight
+// tables.
+//
+// MlasResizeHorizontalLinear interpolates between the pixels InputIndex1[x]
+// and InputIndex2[x] of the input row with the weights Weight1[x] and
+// Weight2[x], for each of the OutputWidth pixels of the output row.
+//
+// MlasResizeVerticalFilter computes Output[i] = sum(Weights[t] * Input[t *
+// InputStride + i]) over the Taps rows of Input for each of the Count
+// elements of the output row. The products are summed in tap order.
+//
+
+void
+MLASCALL
+MlasResizeHorizontalLinear(
+    const float* Input,
+    size_t Channels,
+    size_t OutputWidth,
+    const int32_t* InputIndex1,
+    const int32_t* InputIndex2,
+    const float* Weight1,
+    const float* Weight2,
+    float* Output
+    );
+
+void
+MLASCALL
+MlasResizeVerticalFilter(
+    const float* Input,
+    ptrdiff_t InputStride,
+    const float* Weights,
+    size_t Taps,
+    size_t Count,
+    float* Output
+    );
+
 //
 // Transpose routines.
 //
@@ -1546,6 +1749,44 @@ MlasRotaryEmbedOneRow(
     T* output
 );
 
+/**
+ * @brief layer normalization of one row, with the residual addition of the
+ *        skip variants fused in. The row is computed as x = input + skip + bias,
+ *        then y = (x - mean(x)) / sqrt(var(x) + epsilon) * scale + shift. The
+ *        simplified form (RMSNorm) uses y = x / sqrt(mean(x^2) + epsilon) * scale.
+ *
+ * @tparam T: data type of the input, skip and outputs. Currently only float32/16 are supported.
+ * @param input:      input vector, of shape [N]
+ * @param skip:       optional skip vector, of shape [N]
+ * @param bias:       optional bias vector, of shape [N]
+ * @param scale:      scale vector, of shape [N]
+ * @param shift:      optional shift vector, of shape [N], ignored by the simplified form
+ * @param N:          number of elements of the row
+ * @param epsilon:    value added to the variance
+ * @param simplified: whether the root mean square normalization is used
+ * @param output:     output vector, of shape [N], which may be the input vector
+ * @param sum_output: optional output of x, of shape [N]
+ * @param mean:       optional output of the mean of x
+ * @param inv_std_dev: optional output of the inverse standard deviation
+ */
+template <typename T>
+void
+MLASCALL
+MlasLayerNormalizeOneRow(
+    const T* input,
+    const T* skip,
+    const float* bias,
+    const float* scale,
+    const float* shift,
+    size_t N,
+    float epsilon,
+    bool simplified,
+    T* output,
+    T* sum_output,
+    float* mean,
+    float* inv_std_dev
+);
+
 /**
  * @brief Supply matrices data information to half precision gemm functions
  */
@@ -1865,9 +2106,18 @@ MlasHalfGemmConvertPackB(
     void* PackedB
     );
 
-#if defined(__aarch64__) && defined(__linux__)
+//
+// Bfloat16 precision GEMM routines are built for ARM64 and x86-64 on Linux.
+//
+
+#if (defined(__aarch64__) || defined(__x86_64__)) && defined(__linux__)
+#define MLAS_SBGEMM_SUPPORTED
+#endif
+
+#if defined(MLAS_SBGEMM_SUPPORTED)
 /**
- * @brief Whether current CPU supports Bfloat16(bf16) acceleration.
+ * @brief Whether current CPU supports Bfloat16(bf16) acceleration, the ARM64
+ *        BF16 extension or the x86-64 AVX512-BF16 instructions.
  */
 bool MLASCALL
 MlasBf16AccelerationSupported();
@@ -1976,7 +2226,7 @@ MlasSBGemmPackBSize(size_t N, size_t K);
  */
 void MLASCALL
 MlasSBGemmConvertPackB(size_t N, size_t K, const float* B, size_t ldb, void* PackedB);
-#endif
+#endif  // defined(MLAS_SBGEMM_SUPPORTED)
 
 /**
  * @brief Indirect Depthwise convolution for fp16
@@ -2094,6 +2344,84 @@ MlasFlashAttention(
     MLAS_THREADPOOL* ThreadPool
 );
 
+/**
+ * @brief Arguments of the flash attention of grouped query heads
+ *
+ * The element (b, h, s, i) of a tensor is at b * batch_stride + h * head_stride + s * sequence_stride + i,
+ * so that both the BxNxSxH and BxSxNxH layouts are supported. The query heads that share a key/value head
+ * are attended together, so that a tile of K and V is loaded once for the whole group.
+ */
+template <typename T>
+struct MlasGQAFlashAttentionArgs {
+    int batch_size;
+    int num_heads;
+    int kv_num_heads;
+    bool kv_heads_interleaved;  // query head h attends kv head h % kv_num_heads, else h / (num_heads / kv_num_heads)
+    int q_sequence_length;
+    int qk_head_size;
+    int v_head_size;
+    int q_block_size;   // number of query rows of a head per tile
+    int kv_block_size;  // number of keys per tile
+    float scale;
+    float softcap;          // 0 if the scores are not capped
+    bool is_causal;         // query s attends the keys up to past_sequence_lengths[b] + s
+    int local_window_size;  // number of keys attended before the query position, -1 if unlimited (causal only)
+    const int* kv_sequence_lengths;    // number of valid keys of each batch
+    const int* past_sequence_lengths;  // position of the first query of each batch in the key sequence
+    const float* head_sink;            // sink logit added to the softmax of each head, nullptr if none
+    // If not nullptr, the queries of batch b are the rows [q_sequence_offsets[b], q_sequence_offsets[b + 1]) of a
+    // packed sequence, addressed without query_batch_stride and output_batch_stride, and q_sequence_length is the
+    // longest of them.
+    const int* q_sequence_offsets = nullptr;
+    // If not nullptr, key and value row t of batch b are the row t % kv_page_size of the page
+    // kv_page_table[b * kv_page_table_stride + t / kv_page_size], and key_batch_stride and value_batch_stride are
+    // the strides of a page.
+    const int* kv_page_table = nullptr;
+    size_t kv_page_table_stride = 0;
+    int kv_page_size = 0;
+    // If kv_quant_bits is 8 or 4, key and value are not used, and K and V are symmetric quantized signed values of
+    // that width at key_quantized and value_quantized, two 4-bit values per byte with the low nibble first, with the
+    // strides counted in values. Channel i of kv head h is scaled by key_scales[h * qk_head_size + i] and
+    // value_scales[h * v_head_size + i].
+    int kv_quant_bits = 0;
+    const uint8_t* key_quantized = nullptr;
+    const uint8_t* value_quantized = nullptr;
+    const float* key_scales = nullptr;
+    const float* value_scales = nullptr;
+    const T* query;
+    size_t query_batch_stride;
+    size_t query_head_stride;
+    size_t query_sequence_stride;
+    const T* key;
+    size_t key_batch_stride;
+    size_t key_head_stride;
+    size_t key_sequence_stride;
+    const T* value;
+    size_t value_batch_stride;
+    size_t value_head_stride;
+    size_t value_sequence_stride;
+    T* output;
+    size_t output_batch_stride;
+    size_t output_head_stride;
+    size_t output_sequence_stride;
+};
+
+/**
+ * @brief Computes the attention of grouped query heads by tiles of K and V with an online softmax, so that the
+ *        scores of a query row are never materialized beyond one tile. Queries without any key to attend
+ *        produce zeros. K and V are either dense per batch or gathered from the pages of a KV cache pool,
+ *        and are either of type T or quantized to 8 or 4 bits.
+ * @param args          Arguments, T is float or MLAS_FP16 (computed in float)
+ * @param ThreadPool    Thread pool, the (batch, kv head, query block) tiles are processed in parallel
+*/
+template <typename T>
+void
+MLASCALL
+MlasGQAFlashAttention(
+    const MlasGQAFlashAttentionArgs<T>* args,
+    MLAS_THREADPOOL* ThreadPool
+);
+
 #if defined(USE_KLEIDIAI) && !defined(_MSC_VER)
 /**
  * @brief Function to override the packing mechanism decision if kleidi ai is included
@@ -861,6 +861,15 @@ Return Value:
 
 --*/
 {
+    //
+    // The Winograd algorithm takes a packed filter, see MlasConvPrepareWinograd.
+    //
+
+    if (Parameters->Algorithm == MlasConvAlgorithmWinograd) {
+        MlasConvWinograd(Parameters, Input, Filter, Bias, WorkingBuffer, Output, ThreadPool);
+        return;
+    }
+
     // Override
     if(GetMlasPlatform().MlasConvOverride != nullptr &&
         GetMlasPlatform().MlasConvOverride(Parameters,Input,Filter,Bias,WorkingBuffer,Output,ThreadPool)){
@@ -1008,6 +1017,15 @@ Return Value:
 
                     break;
                 }
+
+                case MlasConvAlgorithmWinograd:
+                {
+                    //
+                    // Dispatched above for all batches and groups.
+                    //
+
+                    break;
+                }
             }
 
             //
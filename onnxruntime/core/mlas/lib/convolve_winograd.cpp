@@ -0,0 +1,702 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convolve_winograd.cpp
+
+Abstract:
+
+    This module implements the Winograd convolution algorithm for 2D
+    convolutions with a 3x3 kernel and unit strides and dilations.
+
+    The output of every group is split into tiles of OutputTile x OutputTile
+    elements. The input patch of each tile and the filters are transformed to
+    Alpha x Alpha matrices (Alpha = OutputTile + 2), so that the convolution
+    becomes Alpha x Alpha independent GEMMs of the transformed filters with the
+    transformed input patches. The product is transformed back to the output
+    tile. F(4x4,3x3) performs 4x fewer multiplications than the direct
+    convolution and F(6x6,3x3) 5.06x fewer, at the cost of the transforms and
+    of a lower accuracy for the larger tiles.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of working buffer elements to target per thread for the
+// transformed input and output of a block of tiles.
+//
+
+#define MLAS_CONV_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD (128 * 1024)
+
+//
+// Define the minimum and maximum number of tiles transformed as one block.
+//
+
+#define MLAS_CONV_WINOGRAD_MINIMUM_TILE_BLOCK 8
+#define MLAS_CONV_WINOGRAD_MAXIMUM_TILE_BLOCK 64
+
+//
+// Define the transform matrices of the Winograd algorithms: G transforms the
+// filter, BT the input patch and AT the product back to the output tile.
+//
+
+template<size_t OutputTile>
+struct MLAS_CONV_WINOGRAD_TRANSFORM;
+
+template<>
+struct MLAS_CONV_WINOGRAD_TRANSFORM<4>
+{
+    static constexpr size_t Alpha = 6;
+
+    static constexpr float G[6][3] = {
+        {1.0f / 4, 0.0f, 0.0f},
+        {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+        {-1.0f / 6, 1.0f / 6, -1.0f / 6},
+        {1.0f / 24, 1.0f / 12, 1.0f / 6},
+        {1.0f / 24, -1.0f / 12, 1.0f / 6},
+        {0.0f, 0.0f, 1.0f},
+    };
+
+    static constexpr float BT[6][6] = {
+        {4.0f, 0.0f, -5.0f, 0.0f, 1.0f, 0.0f},
+        {0.0f, -4.0f, -4.0f, 1.0f, 1.0f, 0.0f},
+        {0.0f, 4.0f, -4.0f, -1.0f, 1.0f, 0.0f},
+        {0.0f, -2.0f, -1.0f, 2.0f, 1.0f, 0.0f},
+        {0.0f, 2.0f, -1.0f, -2.0f, 1.0f, 0.0f},
+        {0.0f, 4.0f, 0.0f, -5.0f, 0.0f, 1.0f},
+    };
+
+    static constexpr float AT[4][6] = {
+        {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f},
+        {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f},
+        {0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 0.0f},
+        {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f},
+    };
+};
+
+template<>
+struct MLAS_CONV_WINOGRAD_TRANSFORM<6>
+{
+    static constexpr size_t Alpha = 8;
+
+    static constexpr float G[8][3] = {
+        {1.0f, 0.0f, 0.0f},
+        {-2.0f / 9, -2.0f / 9, -2.0f / 9},
+        {-2.0f / 9, 2.0f / 9, -2.0f / 9},
+        {1.0f / 90, 1.0f / 45, 2.0f / 45},
+        {1.0f / 90, -1.0f / 45, 2.0f / 45},
+        {32.0f / 45, 16.0f / 45, 8.0f / 45},
+        {32.0f / 45, -16.0f / 45, 8.0f / 45},
+        {0.0f, 0.0f, 1.0f},
+    };
+
+    static constexpr float BT[8][8] = {
+        {1.0f, 0.0f, -21.0f / 4, 0.0f, 21.0f / 4, 0.0f, -1.0f, 0.0f},
+        {0.0f, 1.0f, 1.0f, -17.0f / 4, -17.0f / 4, 1.0f, 1.0f, 0.0f},
+        {0.0f, -1.0f, 1.0f, 17.0f / 4, -17.0f / 4, -1.0f, 1.0f, 0.0f},
+        {0.0f, 1.0f / 2, 1.0f / 4, -5.0f / 2, -5.0f / 4, 2.0f, 1.0f, 0.0f},
+        {0.0f, -1.0f / 2, 1.0f / 4, 5.0f / 2, -5.0f / 4, -2.0f, 1.0f, 0.0f},
+        {0.0f, 2.0f, 4.0f, -5.0f / 2, -5.0f, 1.0f / 2, 1.0f, 0.0f},
+        {0.0f, -2.0f, 4.0f, 5.0f / 2, -5.0f, -1.0f / 2, 1.0f, 0.0f},
+        {0.0f, -1.0f, 0.0f, 21.0f / 4, 0.0f, -21.0f / 4, 0.0f, 1.0f},
+    };
+
+    static constexpr float AT[6][8] = {
+        {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f},
+        {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f / 2, -1.0f / 2, 0.0f},
+        {0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 1.0f / 4, 1.0f / 4, 0.0f},
+        {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f / 8, -1.0f / 8, 0.0f},
+        {0.0f, 1.0f, 1.0f, 16.0f, 16.0f, 1.0f / 16, 1.0f / 16, 0.0f},
+        {0.0f, 1.0f, -1.0f, 32.0f, -32.0f, 1.0f / 32, -1.0f / 32, 1.0f},
+    };
+};
+
+static
+bool
+MlasConvWinogradIsOutputTileSupported(
+    size_t OutputTile
+    )
+{
+    //
+    // The platform convolution overrides consume the filter tensor, so defer
+    // to them when present.
+    //
+
+    if (GetMlasPlatform().MlasConvPrepareOverride != nullptr) {
+        return false;
+    }
+
+    return OutputTile == 4 || OutputTile == 6;
+}
+
+template<size_t OutputTile>
+void
+MlasConvWinogradPackFilterImpl(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    float* PackedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the filter tensor to Alpha x Alpha matrices of
+    FilterCount rows and InputChannels columns per group.
+
+--*/
+{
+    using Transform = MLAS_CONV_WINOGRAD_TRANSFORM<OutputTile>;
+    constexpr size_t Alpha = Transform::Alpha;
+
+    const size_t MatrixSize = FilterCount * InputChannels;
+
+    for (size_t group = 0; group < GroupCount; group++) {
+
+        for (size_t f = 0; f < FilterCount; f++) {
+
+            for (size_t c = 0; c < InputChannels; c++) {
+
+                //
+                // Compute G * g * GT.
+                //
+
+                float Temp[Alpha][3];
+
+                for (size_t i = 0; i < Alpha; i++) {
+                    for (size_t j = 0; j < 3; j++) {
+                        Temp[i][j] = Transform::G[i][0] * Filter[j] +
+                                     Transform::G[i][1] * Filter[3 + j] +
+                                     Transform::G[i][2] * Filter[6 + j];
+                    }
+                }
+
+                for (size_t i = 0; i < Alpha; i++) {
+                    for (size_t j = 0; j < Alpha; j++) {
+                        PackedFilter[(i * Alpha + j) * MatrixSize + f * InputChannels + c] =
+                            Temp[i][0] * Transform::G[j][0] +
+                            Temp[i][1] * Transform::G[j][1] +
+                            Temp[i][2] * Transform::G[j][2];
+                    }
+                }
+
+                Filter += 9;
+            }
+        }
+
+        PackedFilter += Alpha * Alpha * MatrixSize;
+    }
+}
+
+template<size_t OutputTile>
+void
+MlasConvWinogradTransformInput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    size_t TileStart,
+    size_t TileCount,
+    float* TransformedInput
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the input patches of a block of tiles to Alpha x
+    Alpha matrices of InputChannels rows and TileCount columns.
+
+--*/
+{
+    using Transform = MLAS_CONV_WINOGRAD_TRANSFORM<OutputTile>;
+    constexpr size_t Alpha = Transform::Alpha;
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t TilesWidth = (Parameters->OutputShape[1] + OutputTile - 1) / OutputTile;
+    const size_t MatrixSize = InputChannels * TileCount;
+
+    for (size_t c = 0; c < InputChannels; c++) {
+
+        const float* input = Input + c * InputSize;
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const size_t tile = TileStart + t;
+            const ptrdiff_t ih0 = ptrdiff_t((tile / TilesWidth) * OutputTile) - ptrdiff_t(Parameters->Padding[0]);
+            const ptrdiff_t iw0 = ptrdiff_t((tile % TilesWidth) * OutputTile) - ptrdiff_t(Parameters->Padding[1]);
+
+            //
+            // Gather the input patch, padding with zeros outside of the image.
+            //
+
+            float Patch[Alpha][Alpha];
+
+            if (ih0 >= 0 && iw0 >= 0 && size_t(ih0) + Alpha <= InputHeight && size_t(iw0) + Alpha <= InputWidth) {
+
+                const float* row = input + size_t(ih0) * InputWidth + size_t(iw0);
+
+                for (size_t i = 0; i < Alpha; i++) {
+                    for (size_t j = 0; j < Alpha; j++) {
+                        Patch[i][j] = row[j];
+                    }
+                    row += InputWidth;
+                }
+
+            } else {
+
+                for (size_t i = 0; i < Alpha; i++) {
+                    const ptrdiff_t ih = ih0 + ptrdiff_t(i);
+                    for (size_t j = 0; j < Alpha; j++) {
+                        const ptrdiff_t iw = iw0 + ptrdiff_t(j);
+                        const bool Inside = ih >= 0 && size_t(ih) < InputHeight && iw >= 0 && size_t(iw) < InputWidth;
+                        Patch[i][j] = Inside ? input[size_t(ih) * InputWidth + size_t(iw)] : 0.0f;
+                    }
+                }
+            }
+
+            //
+            // Compute BT * d * B.
+            //
+
+            float Temp[Alpha][Alpha];
+
+            for (size_t i = 0; i < Alpha; i++) {
+                for (size_t j = 0; j < Alpha; j++) {
+                    float Sum = 0.0f;
+                    for (size_t k = 0; k < Alpha; k++) {
+                        Sum += Transform::BT[i][k] * Patch[k][j];
+                    }
+                    Temp[i][j] = Sum;
+                }
+            }
+
+            float* output = TransformedInput + c * TileCount + t;
+
+            for (size_t i = 0; i < Alpha; i++) {
+                for (size_t j = 0; j < Alpha; j++) {
+                    float Sum = 0.0f;
+                    for (size_t k = 0; k < Alpha; k++) {
+                        Sum += Temp[i][k] * Transform::BT[j][k];
+                    }
+                    output[(i * Alpha + j) * MatrixSize] = Sum;
+                }
+            }
+        }
+    }
+}
+
+template<size_t OutputTile>
+void
+MlasConvWinogradTransformOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* TransformedOutput,
+    const float* Bias,
+    size_t TileStart,
+    size_t TileCount,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the Alpha x Alpha matrices of FilterCount rows and
+    TileCount columns back to the output tiles, then applies the bias, the
+    accumulation with the existing output and the activation.
+
+--*/
+{
+    using Transform = MLAS_CONV_WINOGRAD_TRANSFORM<OutputTile>;
+    constexpr size_t Alpha = Transform::Alpha;
+
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t TilesWidth = (OutputWidth + OutputTile - 1) / OutputTile;
+    const size_t MatrixSize = FilterCount * TileCount;
+    const float Beta = Parameters->Beta;
+
+    for (size_t t = 0; t < TileCount; t++) {
+
+        const size_t tile = TileStart + t;
+        const size_t oh0 = (tile / TilesWidth) * OutputTile;
+        const size_t ow0 = (tile % TilesWidth) * OutputTile;
+        const size_t TileHeight = std::min(OutputTile, OutputHeight - oh0);
+        const size_t TileWidth = std::min(OutputTile, OutputWidth - ow0);
+
+        float* output = Output + oh0 * OutputWidth + ow0;
+
+        for (size_t f = 0; f < FilterCount; f++) {
+
+            const float* input = TransformedOutput + f * TileCount + t;
+
+            //
+            // Compute AT * m * A.
+            //
+
+            float Temp[OutputTile][Alpha];
+
+            for (size_t i = 0; i < OutputTile; i++) {
+                for (size_t j = 0; j < Alpha; j++) {
+                    float Sum = 0.0f;
+                    for (size_t k = 0; k < Alpha; k++) {
+                        Sum += Transform::AT[i][k] * input[(k * Alpha + j) * MatrixSize];
+                    }
+                    Temp[i][j] = Sum;
+                }
+            }
+
+            const float BiasValue = (Bias != nullptr) ? Bias[f] : 0.0f;
+            float* row = output + f * OutputSize;
+
+            for (size_t i = 0; i < TileHeight; i++) {
+                for (size_t j = 0; j < TileWidth; j++) {
+                    float Sum = BiasValue;
+                    for (size_t k = 0; k < Alpha; k++) {
+                        Sum += Temp[i][k] * Transform::AT[j][k];
+                    }
+                    row[j] = (Beta == 0.0f) ? Sum : Sum + Beta * row[j];
+                }
+                row += OutputWidth;
+            }
+        }
+
+        if (Parameters->Activation->ActivationKind != MlasIdentityActivation) {
+            for (size_t i = 0; i < TileHeight; i++) {
+                MlasActivation(Parameters->Activation, output + i * OutputWidth, nullptr, FilterCount,
+                    TileWidth, OutputSize);
+            }
+        }
+    }
+}
+
+template<size_t OutputTile>
+void
+MlasConvWinogradImpl(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+{
+    constexpr size_t Alpha = MLAS_CONV_WINOGRAD_TRANSFORM<OutputTile>::Alpha;
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t TileBlockSize = Parameters->u.Winograd.TileBlockSize;
+    const size_t TileBlockCount = Parameters->u.Winograd.TileBlockCount;
+    const size_t TilesPerImage = ((Parameters->OutputShape[0] + OutputTile - 1) / OutputTile) *
+                                 ((Parameters->OutputShape[1] + OutputTile - 1) / OutputTile);
+
+    const size_t InputGroupSize = InputChannels * Parameters->InputSize;
+    const size_t OutputGroupSize = FilterCount * Parameters->OutputSize;
+    const size_t PackedFilterGroupSize = Alpha * Alpha * FilterCount * InputChannels;
+    const size_t WorkingBufferSizePerThread = Alpha * Alpha * (InputChannels + FilterCount) * TileBlockSize;
+
+    //
+    // Distribute the blocks of tiles of every batch and group across threads.
+    //
+
+    const size_t WorkCount = Parameters->BatchCount * GroupCount * TileBlockCount;
+    const ptrdiff_t ThreadCount = Parameters->ThreadCount;
+
+    MlasTrySimpleParallel(ThreadPool, ThreadCount, [&](ptrdiff_t tid) {
+
+        float* TransformedInput = WorkingBuffer + tid * WorkingBufferSizePerThread;
+        float* TransformedOutput = TransformedInput + Alpha * Alpha * InputChannels * TileBlockSize;
+
+        size_t WorkIndex;
+        size_t WorkRemaining;
+
+        MlasPartitionWork(tid, ThreadCount, WorkCount, &WorkIndex, &WorkRemaining);
+
+        for (; WorkRemaining > 0; WorkIndex++, WorkRemaining--) {
+
+            const size_t bg = WorkIndex / TileBlockCount;
+            const size_t group = bg % GroupCount;
+            const size_t TileStart = (WorkIndex % TileBlockCount) * TileBlockSize;
+            const size_t TileCount = std::min(TileBlockSize, TilesPerImage - TileStart);
+
+            const float* filter = PackedFilter + group * PackedFilterGroupSize;
+            const float* bias = (Bias != nullptr) ? Bias + group * FilterCount : nullptr;
+
+            MlasConvWinogradTransformInput<OutputTile>(Parameters, Input + bg * InputGroupSize, TileStart,
+                TileCount, TransformedInput);
+
+            for (size_t i = 0; i < Alpha * Alpha; i++) {
+                MlasSgemmOperation(CblasNoTrans, CblasNoTrans, FilterCount, TileCount, InputChannels, 1.0f,
+                    filter + i * FilterCount * InputChannels, InputChannels,
+                    TransformedInput + i * InputChannels * TileCount, TileCount, 0.0f,
+                    TransformedOutput + i * FilterCount * TileCount, TileCount);
+            }
+
+            MlasConvWinogradTransformOutput<OutputTile>(Parameters, TransformedOutput, bias, TileStart,
+                TileCount, Output + bg * OutputGroupSize);
+        }
+    });
+}
+
+size_t
+MLASCALL
+MlasConvWinogradPreferredOutputTile(
+    size_t InputChannels,
+    size_t FilterCount
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the output tile of the Winograd algorithm expected to
+    be faster than the GEMM based algorithms for the channel counts of a
+    convolution group.
+
+Arguments:
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+Return Value:
+
+    Returns the output tile, else zero if the Winograd algorithm should not be
+    used.
+
+--*/
+{
+    //
+    // The transforms are amortized over the channels: narrow convolutions are
+    // dominated by them. F(4x4,3x3) is preferred to F(6x6,3x3) for its accuracy.
+    //
+
+    if (InputChannels < 16 || FilterCount < 16 || !MlasConvWinogradIsOutputTileSupported(4)) {
+        return 0;
+    }
+
+    return 4;
+}
+
+size_t
+MLASCALL
+MlasConvWinogradPackFilterSize(
+    size_t OutputTile,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of elements of the packed filter used by
+    the Winograd algorithm.
+
+Arguments:
+
+    OutputTile - Supplies the size of the output tiles, 4 or 6.
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+Return Value:
+
+    Returns the number of elements of the packed filter, else zero if the
+    Winograd algorithm is not supported for the output tile.
+
+--*/
+{
+    if (!MlasConvWinogradIsOutputTileSupported(OutputTile)) {
+        return 0;
+    }
+
+    const size_t Alpha = OutputTile + 2;
+
+    return GroupCount * Alpha * Alpha * FilterCount * InputChannels;
+}
+
+void
+MLASCALL
+MlasConvWinogradPackFilter(
+    size_t OutputTile,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    float* PackedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the filter tensor for the Winograd algorithm.
+
+Arguments:
+
+    OutputTile - Supplies the size of the output tiles, 4 or 6.
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+    Filter - Supplies the filter tensor of shape [GroupCount * FilterCount,
+        InputChannels, 3, 3].
+
+    PackedFilter - Supplies the buffer receiving the packed filter, sized by
+        MlasConvWinogradPackFilterSize.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (OutputTile == 4) {
+        MlasConvWinogradPackFilterImpl<4>(GroupCount, InputChannels, FilterCount, Filter, PackedFilter);
+    } else {
+        MlasConvWinogradPackFilterImpl<6>(GroupCount, InputChannels, FilterCount, Filter, PackedFilter);
+    }
+}
+
+bool
+MLASCALL
+MlasConvPrepareWinograd(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t OutputTile,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine switches a convolution prepared by MlasConvPrepare to the
+    Winograd algorithm. MlasConv then takes the filter packed by
+    MlasConvWinogradPackFilter for the same output tile.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the parameters computed by
+        MlasConvPrepare, updated when the Winograd algorithm is selected.
+
+    OutputTile - Supplies the size of the output tiles, 4 or 6.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    Returns true if the Winograd algorithm was selected, else false if the
+    convolution is not supported, in which case the parameters are unchanged.
+
+--*/
+{
+    if (!MlasConvWinogradIsOutputTileSupported(OutputTile) ||
+        Parameters->Dimensions != 2 ||
+        Parameters->KernelShape[0] != 3 || Parameters->KernelShape[1] != 3 ||
+        Parameters->StrideShape[0] != 1 || Parameters->StrideShape[1] != 1 ||
+        Parameters->DilationShape[0] != 1 || Parameters->DilationShape[1] != 1) {
+        return false;
+    }
+
+    const size_t Alpha = OutputTile + 2;
+    const size_t TilesPerImage = ((Parameters->OutputShape[0] + OutputTile - 1) / OutputTile) *
+                                 ((Parameters->OutputShape[1] + OutputTile - 1) / OutputTile);
+
+    //
+    // Size the blocks of tiles so that the transformed input and output of a
+    // block stay in the cache of the thread.
+    //
+
+    const size_t ElementsPerTile = Alpha * Alpha * (Parameters->InputChannels + Parameters->FilterCount);
+
+    size_t TileBlockSize = MLAS_CONV_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD / ElementsPerTile;
+    TileBlockSize = std::max(TileBlockSize, size_t(MLAS_CONV_WINOGRAD_MINIMUM_TILE_BLOCK));
+    TileBlockSize = std::min(TileBlockSize, size_t(MLAS_CONV_WINOGRAD_MAXIMUM_TILE_BLOCK));
+    TileBlockSize = std::min(TileBlockSize, TilesPerImage);
+
+    const size_t TileBlockCount = (TilesPerImage + TileBlockSize - 1) / TileBlockSize;
+    const size_t WorkCount = Parameters->BatchCount * Parameters->GroupCount * TileBlockCount;
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (size_t(ThreadCount) > WorkCount) {
+        ThreadCount = ptrdiff_t(WorkCount);
+    }
+
+    Parameters->Algorithm = MlasConvAlgorithmWinograd;
+    Parameters->ThreadCount = ThreadCount;
+    Parameters->u.Winograd.OutputTile = OutputTile;
+    Parameters->u.Winograd.TileBlockSize = TileBlockSize;
+    Parameters->u.Winograd.TileBlockCount = TileBlockCount;
+
+    *WorkingBufferSize = size_t(ThreadCount) * ElementsPerTile * TileBlockSize;
+
+    return true;
+}
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the convolution operation with the Winograd
+    algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters, prepared by MlasConvPrepareWinograd.
+
+    Input - Supplies the input tensor.
+
+    PackedFilter - Supplies the filter packed by MlasConvWinogradPackFilter.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepareWinograd.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Parameters->u.Winograd.OutputTile == 4) {
+        MlasConvWinogradImpl<4>(Parameters, Input, PackedFilter, Bias, WorkingBuffer, Output, ThreadPool);
+    } else {
+        MlasConvWinogradImpl<6>(Parameters, Input, PackedFilter, Bias, WorkingBuffer, Output, ThreadPool);
+    }
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <numeric>
 
 #include "mlasi.h"
@@ -165,3 +166,446 @@ MlasFlashAttention(
         static_cast<std::ptrdiff_t>(args->thread_count),
         ThreadPool);
 }
+
+template <typename T>
+void
+MlasGQAFlashAttentionLoadRows(
+    const T* Source,
+    size_t SourceStride,
+    size_t Rows,
+    size_t Columns,
+    float* Destination
+    )
+/*++
+
+Routine Description:
+
+    This routine copies rows of a tensor to a packed float buffer.
+
+Arguments:
+
+    Source - Supplies the first row.
+
+    SourceStride - Supplies the distance in elements between two rows.
+
+    Rows - Supplies the number of rows.
+
+    Columns - Supplies the number of elements of a row.
+
+    Destination - Supplies the packed buffer of Rows * Columns elements.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t r = 0; r < Rows; r++) {
+        if constexpr (std::is_same_v<T, float>) {
+            std::copy_n(Source, Columns, Destination);
+        } else {
+            MlasConvertHalfToFloatBuffer(Source, Destination, Columns);
+        }
+        Source += SourceStride;
+        Destination += Columns;
+    }
+}
+
+void
+MlasGQAFlashAttentionLoadQuantizedRows(
+    const uint8_t* Source,
+    size_t SourceStride,
+    size_t Rows,
+    size_t Columns,
+    int Bits,
+    float* Destination
+    )
+/*++
+
+Routine Description:
+
+    This routine converts rows of symmetric quantized 8-bit or 4-bit values to
+    a packed float buffer, without applying their scales.
+
+Arguments:
+
+    Source - Supplies the first row.
+
+    SourceStride - Supplies the distance in values between two rows.
+
+    Rows - Supplies the number of rows.
+
+    Columns - Supplies the number of values of a row, even for 4 bits.
+
+    Bits - Supplies the width of a value: 8 for int8, 4 for two values per
+        byte with the low nibble first.
+
+    Destination - Supplies the packed buffer of Rows * Columns elements.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t row_bytes = SourceStride * static_cast<size_t>(Bits) / 8;
+
+    for (size_t r = 0; r < Rows; r++) {
+        if (Bits == 8) {
+            const int8_t* values = reinterpret_cast<const int8_t*>(Source);
+            for (size_t c = 0; c < Columns; c++) {
+                Destination[c] = static_cast<float>(values[c]);
+            }
+        } else {
+            for (size_t c = 0; c < Columns; c += 2) {
+                const uint8_t pair = Source[c / 2];
+                Destination[c] = static_cast<float>(static_cast<int8_t>(pair << 4) >> 4);
+                Destination[c + 1] = static_cast<float>(static_cast<int8_t>(pair) >> 4);
+            }
+        }
+        Source += row_bytes;
+        Destination += Columns;
+    }
+}
+
+template <typename T>
+void
+MlasGQAFlashAttentionTile(
+    const MlasGQAFlashAttentionArgs<T>* args,
+    ptrdiff_t TileIndex
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the attention of a block of query rows for all the
+    query heads that share a key/value head.
+
+    When the keys and values are paged, a tile of keys doesn't cross a page,
+    so that the rows of a tile are contiguous.
+
+    When the keys and values are quantized, the tiles are converted to float
+    without their scales. The per-channel scales of K are applied to the
+    query rows once, and those of V to the output rows once.
+
+    The rows of the group are stacked in a single matrix, so that each tile of
+    scores is a single matrix product with the shared tile of K. Each row keeps
+    its running maximum and sum of the online softmax, and the partial output
+    is rescaled when the maximum of the row grows.
+
+Arguments:
+
+    args - Supplies the attention arguments.
+
+    TileIndex - Supplies the index of the (batch, kv head, query block) tile.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_TARGET_AMD64) || defined(MLAS_TARGET_LARCH64)
+    auto&& mlas_platform = GetMlasPlatform();
+#endif
+
+    const size_t group_size = static_cast<size_t>(args->num_heads / args->kv_num_heads);
+    const size_t q_sequence_length = static_cast<size_t>(args->q_sequence_length);
+    const size_t q_block_size = static_cast<size_t>(args->q_block_size);
+    const size_t kv_block_size = static_cast<size_t>(args->kv_block_size);
+    const size_t qk_head_size = static_cast<size_t>(args->qk_head_size);
+    const size_t v_head_size = static_cast<size_t>(args->v_head_size);
+    const size_t q_block_count = (q_sequence_length + q_block_size - 1) / q_block_size;
+
+    const size_t q_start = (static_cast<size_t>(TileIndex) % q_block_count) * q_block_size;
+    const size_t kv_head = (static_cast<size_t>(TileIndex) / q_block_count) % static_cast<size_t>(args->kv_num_heads);
+    const size_t batch = static_cast<size_t>(TileIndex) / q_block_count / static_cast<size_t>(args->kv_num_heads);
+
+    //
+    // The packed queries of a batch may be fewer than the longest sequence
+    // the tiles are laid out for.
+    //
+
+    const T* query;
+    T* output_base;
+    size_t batch_q_length;
+
+    if (args->q_sequence_offsets != nullptr) {
+        const size_t q_offset = static_cast<size_t>(args->q_sequence_offsets[batch]);
+        query = args->query + q_offset * args->query_sequence_stride;
+        output_base = args->output + q_offset * args->output_sequence_stride;
+        batch_q_length = static_cast<size_t>(args->q_sequence_offsets[batch + 1]) - q_offset;
+        if (q_start >= batch_q_length) {
+            return;
+        }
+    } else {
+        query = args->query + batch * args->query_batch_stride;
+        output_base = args->output + batch * args->output_batch_stride;
+        batch_q_length = q_sequence_length;
+    }
+
+    const size_t q_rows = std::min(q_block_size, batch_q_length - q_start);
+    const size_t rows = group_size * q_rows;
+
+    const ptrdiff_t kv_sequence_length = args->kv_sequence_lengths[batch];
+    const ptrdiff_t past_sequence_length = args->past_sequence_lengths[batch];
+
+    //
+    // Returns the range of keys attended by a query row.
+    //
+
+    auto KeyRange = [&](size_t s, ptrdiff_t& begin, ptrdiff_t& end) {
+        begin = 0;
+        end = kv_sequence_length;
+        if (args->is_causal) {
+            const ptrdiff_t causal_length = past_sequence_length + static_cast<ptrdiff_t>(s) + 1;
+            end = std::min(end, causal_length);
+            if (args->local_window_size >= 0) {
+                begin = std::max(begin, causal_length - args->local_window_size - 1);
+            }
+        }
+    };
+
+    auto QueryHead = [&](size_t g) {
+        return args->kv_heads_interleaved ? kv_head + g * static_cast<size_t>(args->kv_num_heads)
+                                          : kv_head * group_size + g;
+    };
+
+    //
+    // Partition the buffer of the thread.
+    //
+
+    const int quant_bits = args->kv_quant_bits;
+
+    size_t buffer_size = rows * (2 + kv_block_size + v_head_size + qk_head_size);
+    if (!std::is_same_v<T, float> || quant_bits != 0) {
+        buffer_size += kv_block_size * (qk_head_size + v_head_size);
+    }
+    MlasThreadedBufAlloc(buffer_size * sizeof(float));
+
+    float* m = reinterpret_cast<float*>(ThreadedBufHolder.get());
+    float* l = m + rows;
+    float* scores = l + rows;
+    float* temp_output = scores + rows * kv_block_size;
+    float* q = temp_output + rows * v_head_size;
+    float* k_tile = q + rows * qk_head_size;
+    float* v_tile = k_tile + kv_block_size * qk_head_size;
+
+    for (size_t g = 0; g < group_size; g++) {
+        const size_t head = QueryHead(g);
+        const float sink = args->head_sink != nullptr ? args->head_sink[head] : std::numeric_limits<float>::lowest();
+
+        for (size_t r = 0; r < q_rows; r++) {
+            m[g * q_rows + r] = sink;
+            l[g * q_rows + r] = args->head_sink != nullptr ? 1.0f : 0.0f;
+        }
+
+        float* q_rows_of_head = q + g * q_rows * qk_head_size;
+        MlasGQAFlashAttentionLoadRows(query + head * args->query_head_stride + q_start * args->query_sequence_stride,
+                                      args->query_sequence_stride, q_rows, qk_head_size, q_rows_of_head);
+
+        if (quant_bits != 0) {
+            const float* key_scales = args->key_scales + kv_head * qk_head_size;
+            for (size_t r = 0; r < q_rows; r++) {
+                for (size_t i = 0; i < qk_head_size; i++) {
+                    q_rows_of_head[r * qk_head_size + i] *= key_scales[i];
+                }
+            }
+        }
+    }
+
+    std::fill_n(temp_output, rows * v_head_size, 0.0f);
+
+    //
+    // The keys attended by the block are bounded by the range of its first
+    // and last rows.
+    //
+
+    ptrdiff_t kv_begin;
+    ptrdiff_t kv_end;
+    ptrdiff_t unused;
+    KeyRange(q_start, kv_begin, unused);
+    KeyRange(q_start + q_rows - 1, unused, kv_end);
+
+    //
+    // The rows of K and V are addressed by their offsets in elements, which
+    // are converted to bytes for quantized values.
+    //
+
+    const bool is_paged = args->kv_page_table != nullptr;
+    size_t key_base = kv_head * args->key_head_stride;
+    size_t value_base = kv_head * args->value_head_stride;
+    if (!is_paged) {
+        key_base += batch * args->key_batch_stride;
+        value_base += batch * args->value_batch_stride;
+    }
+
+    size_t kv_count;
+
+    for (ptrdiff_t ir = kv_begin; ir < kv_end; ir += static_cast<ptrdiff_t>(kv_count)) {
+
+        kv_count = std::min(kv_block_size, static_cast<size_t>(kv_end - ir));
+
+        size_t key_offset;
+        size_t value_offset;
+
+        if (is_paged) {
+            const size_t page_size = static_cast<size_t>(args->kv_page_size);
+            const size_t page_row = static_cast<size_t>(ir) % page_size;
+            const size_t page = static_cast<size_t>(
+                args->kv_page_table[batch * args->kv_page_table_stride + static_cast<size_t>(ir) / page_size]);
+
+            kv_count = std::min(kv_count, page_size - page_row);
+            key_offset = key_base + page * args->key_batch_stride + page_row * args->key_sequence_stride;
+            value_offset = value_base + page * args->value_batch_stride + page_row * args->value_sequence_stride;
+        } else {
+            key_offset = key_base + ir * args->key_sequence_stride;
+            value_offset = value_base + ir * args->value_sequence_stride;
+        }
+
+        const float* k = k_tile;
+        const float* v = v_tile;
+        size_t ldk = qk_head_size;
+        size_t ldv = v_head_size;
+
+        if (quant_bits != 0) {
+            MlasGQAFlashAttentionLoadQuantizedRows(args->key_quantized + key_offset * quant_bits / 8,
+                                                   args->key_sequence_stride, kv_count, qk_head_size, quant_bits, k_tile);
+            MlasGQAFlashAttentionLoadQuantizedRows(args->value_quantized + value_offset * quant_bits / 8,
+                                                   args->value_sequence_stride, kv_count, v_head_size, quant_bits, v_tile);
+        } else if constexpr (std::is_same_v<T, float>) {
+            k = args->key + key_offset;
+            v = args->value + value_offset;
+            ldk = args->key_sequence_stride;
+            ldv = args->value_sequence_stride;
+        } else {
+            MlasGQAFlashAttentionLoadRows(args->key + key_offset, args->key_sequence_stride, kv_count, qk_head_size, k_tile);
+            MlasGQAFlashAttentionLoadRows(args->value + value_offset, args->value_sequence_stride, kv_count, v_head_size,
+                                          v_tile);
+        }
+
+        MlasSgemmOperation(CblasNoTrans, CblasTrans, rows, kv_count, qk_head_size, args->scale,
+                           q, qk_head_size, k, ldk, 0.0f, scores, kv_count);
+
+        for (size_t row = 0; row < rows; row++) {
+
+            float* p = scores + row * kv_count;
+
+            ptrdiff_t begin;
+            ptrdiff_t end;
+            KeyRange(q_start + row % q_rows, begin, end);
+            const size_t lo = static_cast<size_t>(std::clamp<ptrdiff_t>(begin - ir, 0, ptrdiff_t(kv_count)));
+            const size_t hi = static_cast<size_t>(std::clamp<ptrdiff_t>(end - ir, 0, ptrdiff_t(kv_count)));
+
+            if (lo >= hi) {
+                std::fill_n(p, kv_count, 0.0f);
+                continue;
+            }
+
+            std::fill_n(p, lo, 0.0f);
+            std::fill_n(p + hi, kv_count - hi, 0.0f);
+
+            if (args->softcap > 0.0f) {
+                MlasComputeSoftcap(p + lo, p + lo, hi - lo, args->softcap);
+            }
+
+#if defined(MLAS_TARGET_AMD64) || defined(MLAS_TARGET_LARCH64)
+            const float rowmax = mlas_platform.ReduceMaximumF32Kernel(p + lo, hi - lo);
+#else
+            const float rowmax = MlasReduceMaximumF32Kernel(p + lo, hi - lo);
+#endif
+
+            const float m_old = m[row];
+            m[row] = std::max(m_old, rowmax);
+            float negmax = -m[row];
+
+#if defined(MLAS_TARGET_AMD64)
+            const float rowsum = mlas_platform.ComputeSumExpF32Kernel(p + lo, p + lo, hi - lo, &negmax);
+#else
+            const float rowsum = MlasComputeSumExpF32Kernel(p + lo, p + lo, hi - lo, &negmax);
+#endif
+
+            if (m[row] != m_old) {
+                const float exp_diff = std::exp(m_old - m[row]);
+                l[row] = exp_diff * l[row] + rowsum;
+
+                float* o = temp_output + row * v_head_size;
+                for (size_t i = 0; i < v_head_size; i++) {
+                    o[i] *= exp_diff;
+                }
+            } else {
+                l[row] += rowsum;
+            }
+        }
+
+        MlasSgemmOperation(CblasNoTrans, CblasNoTrans, rows, v_head_size, kv_count, 1.0f,
+                           scores, kv_count, v, ldv, 1.0f, temp_output, v_head_size);
+    }
+
+    //
+    // Normalize the rows and store them to the output.
+    //
+
+    for (size_t g = 0; g < group_size; g++) {
+
+        T* output = output_base + QueryHead(g) * args->output_head_stride + q_start * args->output_sequence_stride;
+
+        for (size_t r = 0; r < q_rows; r++) {
+
+            const size_t row = g * q_rows + r;
+            float* o = temp_output + row * v_head_size;
+            const float scale = l[row] > 0.0f ? 1.0f / l[row] : 0.0f;
+
+            if (quant_bits != 0) {
+                const float* value_scales = args->value_scales + kv_head * v_head_size;
+                for (size_t i = 0; i < v_head_size; i++) {
+                    o[i] *= scale * value_scales[i];
+                }
+            } else {
+                for (size_t i = 0; i < v_head_size; i++) {
+                    o[i] *= scale;
+                }
+            }
+
+            if constexpr (std::is_same_v<T, float>) {
+                std::copy_n(o, v_head_size, output);
+            } else {
+                MlasConvertFloatToHalfBuffer(o, output, v_head_size);
+            }
+
+            output += args->output_sequence_stride;
+        }
+    }
+}
+
+template <typename T>
+void
+MLASCALL
+MlasGQAFlashAttention(
+    const MlasGQAFlashAttentionArgs<T>* args,
+    MLAS_THREADPOOL* ThreadPool
+    )
+{
+    const ptrdiff_t q_block_count = (args->q_sequence_length + args->q_block_size - 1) / args->q_block_size;
+    const ptrdiff_t tile_count = ptrdiff_t(args->batch_size) * args->kv_num_heads * q_block_count;
+
+    MlasTrySimpleParallel(ThreadPool, tile_count, [&](ptrdiff_t tid) {
+        MlasGQAFlashAttentionTile(args, tid);
+    });
+}
+
+template
+void
+MLASCALL
+MlasGQAFlashAttention<float>(
+    const MlasGQAFlashAttentionArgs<float>* args,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasGQAFlashAttention<MLAS_FP16>(
+    const MlasGQAFlashAttentionArgs<MLAS_FP16>* args,
+    MLAS_THREADPOOL* ThreadPool
+    );
@@ -0,0 +1,401 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    layernorm.cpp
+
+Abstract:
+
+    This module implements the layer normalization of a row, with the
+    residual and bias additions of the skip variants fused in.
+
+    The first pass adds the inputs and accumulates the sum and the sum of
+    squares of the row in vector accumulators. The second pass applies the
+    normalization, scale and shift. Half precision rows are converted by
+    blocks in a local buffer, and the sum of the inputs is recomputed by the
+    second pass instead of being stored to memory.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of elements of a half precision row that are converted
+// to single precision at a time.
+//
+
+#define MLAS_LAYERNORM_HALF_BLOCK_SIZE 256
+
+/*++
+
+Routine Description:
+
+    This routine adds the optional skip and bias vectors to the input vector,
+    and optionally accumulates the sum and the sum of squares of the result.
+
+Arguments:
+
+    Input - Supplies the input vector.
+
+    Skip - Optionally supplies the skip vector.
+
+    Bias - Optionally supplies the bias vector.
+
+    Output - Supplies the output vector, which may be the input vector.
+
+    SumOutput - Optionally supplies a second output vector for the result.
+
+    N - Supplies the number of elements.
+
+    Statistics - Supplies the sum and the sum of squares to update.
+
+Return Value:
+
+    None.
+
+--*/
+template <bool Accumulate>
+void
+MlasLayerNormAddInputs(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    float* Output,
+    float* SumOutput,
+    size_t N,
+    float* Statistics
+    )
+{
+    MLAS_FLOAT32X4 Sum0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 Sum1 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 SumSquare0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 SumSquare1 = MlasZeroFloat32x4();
+
+    size_t n = 0;
+
+    while (n + 8 <= N) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasLoadFloat32x4(Input + n);
+        MLAS_FLOAT32X4 Vector1 = MlasLoadFloat32x4(Input + n + 4);
+
+        if (Skip != nullptr) {
+            Vector0 = MlasAddFloat32x4(Vector0, MlasLoadFloat32x4(Skip + n));
+            Vector1 = MlasAddFloat32x4(Vector1, MlasLoadFloat32x4(Skip + n + 4));
+        }
+
+        if (Bias != nullptr) {
+            Vector0 = MlasAddFloat32x4(Vector0, MlasLoadFloat32x4(Bias + n));
+            Vector1 = MlasAddFloat32x4(Vector1, MlasLoadFloat32x4(Bias + n + 4));
+        }
+
+        MlasStoreFloat32x4(Output + n, Vector0);
+        MlasStoreFloat32x4(Output + n + 4, Vector1);
+
+        if (SumOutput != nullptr) {
+            MlasStoreFloat32x4(SumOutput + n, Vector0);
+            MlasStoreFloat32x4(SumOutput + n + 4, Vector1);
+        }
+
+        if (Accumulate) {
+            Sum0 = MlasAddFloat32x4(Sum0, Vector0);
+            Sum1 = MlasAddFloat32x4(Sum1, Vector1);
+            SumSquare0 = MlasMultiplyAddFloat32x4(Vector0, Vector0, SumSquare0);
+            SumSquare1 = MlasMultiplyAddFloat32x4(Vector1, Vector1, SumSquare1);
+        }
+
+        n += 8;
+    }
+
+    float Sum = 0.0f;
+    float SumSquare = 0.0f;
+
+    for (; n < N; n++) {
+
+        float Value = Input[n];
+
+        if (Skip != nullptr) {
+            Value += Skip[n];
+        }
+
+        if (Bias != nullptr) {
+            Value += Bias[n];
+        }
+
+        Output[n] = Value;
+
+        if (SumOutput != nullptr) {
+            SumOutput[n] = Value;
+        }
+
+        Sum += Value;
+        SumSquare += Value * Value;
+    }
+
+    if (Accumulate) {
+        Statistics[0] += MlasReduceAddFloat32x4(MlasAddFloat32x4(Sum0, Sum1)) + Sum;
+        Statistics[1] += MlasReduceAddFloat32x4(MlasAddFloat32x4(SumSquare0, SumSquare1)) + SumSquare;
+    }
+}
+
+/*++
+
+Routine Description:
+
+    This routine normalizes a vector with the given mean and inverse standard
+    deviation, then applies the scale and the optional shift vectors.
+
+Arguments:
+
+    Input - Supplies the input vector.
+
+    Scale - Supplies the scale vector.
+
+    Shift - Optionally supplies the shift vector.
+
+    Output - Supplies the output vector, which may be the input vector.
+
+    N - Supplies the number of elements.
+
+    Mean - Supplies the mean to subtract.
+
+    InvStdDev - Supplies the inverse standard deviation.
+
+Return Value:
+
+    None.
+
+--*/
+void
+MlasLayerNormScaleShift(
+    const float* Input,
+    const float* Scale,
+    const float* Shift,
+    float* Output,
+    size_t N,
+    float Mean,
+    float InvStdDev
+    )
+{
+    //
+    // Fold the mean into the offset of the multiply-add: (x - mean) * inv is
+    // computed as x * inv + (-mean * inv).
+    //
+
+    const float Offset = -Mean * InvStdDev;
+    const MLAS_FLOAT32X4 InvStdDevVector = MlasBroadcastFloat32x4(InvStdDev);
+    const MLAS_FLOAT32X4 OffsetVector = MlasBroadcastFloat32x4(Offset);
+
+    size_t n = 0;
+
+    while (n + 8 <= N) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(Input + n), InvStdDevVector, OffsetVector);
+        MLAS_FLOAT32X4 Vector1 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(Input + n + 4), InvStdDevVector, OffsetVector);
+
+        if (Shift != nullptr) {
+            Vector0 = MlasMultiplyAddFloat32x4(Vector0, MlasLoadFloat32x4(Scale + n), MlasLoadFloat32x4(Shift + n));
+            Vector1 = MlasMultiplyAddFloat32x4(Vector1, MlasLoadFloat32x4(Scale + n + 4), MlasLoadFloat32x4(Shift + n + 4));
+        } else {
+            Vector0 = MlasMultiplyFloat32x4(Vector0, MlasLoadFloat32x4(Scale + n));
+            Vector1 = MlasMultiplyFloat32x4(Vector1, MlasLoadFloat32x4(Scale + n + 4));
+        }
+
+        MlasStoreFloat32x4(Output + n, Vector0);
+        MlasStoreFloat32x4(Output + n + 4, Vector1);
+
+        n += 8;
+    }
+
+    for (; n < N; n++) {
+
+        float Value = (Input[n] * InvStdDev + Offset) * Scale[n];
+
+        if (Shift != nullptr) {
+            Value += Shift[n];
+        }
+
+        Output[n] = Value;
+    }
+}
+
+/*++
+
+Routine Description:
+
+    This routine computes the mean and the inverse standard deviation of a
+    row from its accumulated sum and sum of squares.
+
+Arguments:
+
+    Statistics - Supplies the sum and the sum of squares of the row.
+
+    N - Supplies the number of elements of the row.
+
+    Epsilon - Supplies the value added to the variance.
+
+    Simplified - Supplies true to normalize by the root mean square instead
+        of the standard deviation (RMSNorm).
+
+    Mean - Receives the mean of the row.
+
+    InvStdDev - Receives the inverse standard deviation of the row.
+
+Return Value:
+
+    None.
+
+--*/
+MLAS_FORCEINLINE
+void
+MlasLayerNormComputeStatistics(
+    const float* Statistics,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float& Mean,
+    float& InvStdDev
+    )
+{
+    Mean = Statistics[0] / float(N);
+
+    float Variance = Statistics[1] / float(N);
+
+    if (!Simplified) {
+        Variance = std::max(Variance - Mean * Mean, 0.0f);
+    }
+
+    InvStdDev = 1.0f / std::sqrt(Variance + Epsilon);
+}
+
+template <>
+void
+MLASCALL
+MlasLayerNormalizeOneRow<float>(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Output,
+    float* SumOutput,
+    float* Mean,
+    float* InvStdDev
+    )
+{
+    float Statistics[2] = {0.0f, 0.0f};
+
+    MlasLayerNormAddInputs<true>(Input, Skip, Bias, Output, SumOutput, N, Statistics);
+
+    float RowMean;
+    float RowInvStdDev;
+
+    MlasLayerNormComputeStatistics(Statistics, N, Epsilon, Simplified, RowMean, RowInvStdDev);
+
+    MlasLayerNormScaleShift(Output, Scale, Simplified ? nullptr : Shift, Output, N,
+                            Simplified ? 0.0f : RowMean, RowInvStdDev);
+
+    if (Mean != nullptr) {
+        *Mean = RowMean;
+    }
+
+    if (InvStdDev != nullptr) {
+        *InvStdDev = RowInvStdDev;
+    }
+}
+
+template <>
+void
+MLASCALL
+MlasLayerNormalizeOneRow<MLAS_FP16>(
+    const MLAS_FP16* Input,
+    const MLAS_FP16* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    MLAS_FP16* Output,
+    MLAS_FP16* SumOutput,
+    float* Mean,
+    float* InvStdDev
+    )
+{
+    constexpr size_t BlockSize = MLAS_LAYERNORM_HALF_BLOCK_SIZE;
+
+    MLAS_DECLSPEC_ALIGN(float RowBuffer[BlockSize], 64);
+    MLAS_DECLSPEC_ALIGN(float SkipBuffer[BlockSize], 64);
+
+    //
+    // Converts a block of the row and adds the skip and bias vectors.
+    //
+
+    auto LoadBlock = [&](size_t n, size_t CountN, float* Statistics) {
+        MlasConvertHalfToFloatBuffer(Input + n, RowBuffer, CountN);
+
+        if (Skip != nullptr) {
+            MlasConvertHalfToFloatBuffer(Skip + n, SkipBuffer, CountN);
+        }
+
+        const float* BiasBlock = (Bias != nullptr) ? Bias + n : nullptr;
+        const float* SkipBlock = (Skip != nullptr) ? SkipBuffer : nullptr;
+
+        if (Statistics != nullptr) {
+            MlasLayerNormAddInputs<true>(RowBuffer, SkipBlock, BiasBlock, RowBuffer, nullptr, CountN, Statistics);
+        } else {
+            MlasLayerNormAddInputs<false>(RowBuffer, SkipBlock, BiasBlock, RowBuffer, nullptr, CountN, nullptr);
+        }
+    };
+
+    float Statistics[2] = {0.0f, 0.0f};
+
+    for (size_t n = 0; n < N; n += BlockSize) {
+
+        const size_t CountN = std::min(N - n, BlockSize);
+
+        LoadBlock(n, CountN, Statistics);
+
+        if (SumOutput != nullptr) {
+            MlasConvertFloatToHalfBuffer(RowBuffer, SumOutput + n, CountN);
+        }
+    }
+
+    float RowMean;
+    float RowInvStdDev;
+
+    MlasLayerNormComputeStatistics(Statistics, N, Epsilon, Simplified, RowMean, RowInvStdDev);
+
+    for (size_t n = 0; n < N; n += BlockSize) {
+
+        const size_t CountN = std::min(N - n, BlockSize);
+
+        //
+        // Recompute the block of the sum of the inputs, which is cheaper
+        // than a round trip through memory for the whole row.
+        //
+
+        if (n != 0 || CountN != N) {
+            LoadBlock(n, CountN, nullptr);
+        }
+
+        MlasLayerNormScaleShift(RowBuffer, Scale + n, (Simplified || Shift == nullptr) ? nullptr : Shift + n,
+                                RowBuffer, CountN, Simplified ? 0.0f : RowMean, RowInvStdDev);
+
+        MlasConvertFloatToHalfBuffer(RowBuffer, Output + n, CountN);
+    }
+
+    if (Mean != nullptr) {
+        *Mean = RowMean;
+    }
+
+    if (InvStdDev != nullptr) {
+        *InvStdDev = RowInvStdDev;
+    }
+}
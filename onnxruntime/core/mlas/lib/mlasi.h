@@ -1099,10 +1099,25 @@ extern "C" {
 #define MLAS_QGEMM_THREAD_COMPLEXITY                65536
 #define MLAS_HGEMM_THREAD_COMPLEXITY                65536
 
-#if defined(__aarch64__) && defined(__linux__)
+#if defined(MLAS_SBGEMM_SUPPORTED)
 #define MLAS_SBGEMM_THREAD_COMPLEXITY (size_t(64) * size_t(1024))
 #endif
 
+//
+// Winograd convolution operation, see MlasConvPrepareWinograd.
+//
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Single-threaded single precision matrix/matrix multiply operation.
 //
@@ -1224,6 +1239,16 @@ extern const MLAS_ROPE_DISPATCH MlasRopeDispatchAvx2;
 struct MLAS_HGEMM_DISPATCH;
 extern const MLAS_HGEMM_DISPATCH MlasHGemmDispatchNeon;
 
+//
+// bfloat16 gemm dispatch structure
+//
+struct MLAS_SBGEMM_DISPATCH;
+extern const MLAS_SBGEMM_DISPATCH MlasSBGemmDispatchNeon;
+extern const MLAS_SBGEMM_DISPATCH MlasSBGemmDispatchAmd64;
+#if defined(MLAS_AVX512BF16_SUPPORTED)
+extern const MLAS_SBGEMM_DISPATCH MlasSBGemmDispatchAvx512Bf16;
+#endif
+
 // softmax dispatch structure
 struct MLAS_SOFTMAX_DISPATCH;
 extern const MLAS_SOFTMAX_DISPATCH MlasSoftmaxDispatchNeon;
@@ -1408,6 +1433,7 @@ struct MLAS_PLATFORM {
     const MLAS_HGEMM_DISPATCH* HGemmDispatch{nullptr};
     const MLAS_SOFTMAX_DISPATCH* SoftmaxDispatch{nullptr};
     const MLAS_ELTWISE_DISPATCH* EltwiseDispatch{nullptr};
+    const MLAS_SBGEMM_DISPATCH* SBGemmDispatch{nullptr};
 };
 
 inline
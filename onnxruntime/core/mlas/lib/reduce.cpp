@@ -0,0 +1,588 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    reduce.cpp
+
+Abstract:
+
+    This module implements the reduction of the middle dimension of a
+    [OuterCount, ReduceCount, InnerCount] tensor.
+
+    Contiguous rows (InnerCount == 1) are reduced with several vector
+    accumulators to hide the latency of the additions. Columns are reduced by
+    strips of adjacent columns so that every input row is read sequentially
+    and the accumulators of the strip stay in the L1 cache, instead of
+    gathering one element per row and per output.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of elements to target per thread.
+//
+
+#define MLAS_REDUCE_MINIMUM_ELEMENTS_PER_THREAD (16 * 1024)
+
+//
+// Define the number of adjacent columns reduced as one strip.
+//
+
+#define MLAS_REDUCE_STRIP_COLUMNS 512
+
+//
+// Define the element operations of the reductions. Initial maps the first
+// element of the reduction, Accumulate adds an element to a partial result and
+// Combine merges two partial results.
+//
+
+struct MLAS_REDUCE_SUM_OPERATION {
+
+    static float Initial(float Value) { return Value; }
+
+    static MLAS_FLOAT32X4 Initial(MLAS_FLOAT32X4 Vector) { return Vector; }
+
+    static float Accumulate(float Accumulator, float Value) { return Accumulator + Value; }
+
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Vector)
+    {
+        return MlasAddFloat32x4(Accumulator, Vector);
+    }
+
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasAddFloat32x4(Vector1, Vector2);
+    }
+
+    static float Combine(MLAS_FLOAT32X4 Vector) { return MlasReduceAddFloat32x4(Vector); }
+};
+
+struct MLAS_REDUCE_SUM_SQUARE_OPERATION : MLAS_REDUCE_SUM_OPERATION {
+
+    static float Initial(float Value) { return Value * Value; }
+
+    static MLAS_FLOAT32X4 Initial(MLAS_FLOAT32X4 Vector) { return MlasMultiplyFloat32x4(Vector, Vector); }
+
+    static float Accumulate(float Accumulator, float Value) { return Accumulator + Value * Value; }
+
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Vector)
+    {
+        return MlasMultiplyAddFloat32x4(Vector, Vector, Accumulator);
+    }
+};
+
+struct MLAS_REDUCE_MAXIMUM_OPERATION {
+
+    static float Initial(float Value) { return Value; }
+
+    static MLAS_FLOAT32X4 Initial(MLAS_FLOAT32X4 Vector) { return Vector; }
+
+    static float Accumulate(float Accumulator, float Value) { return std::max(Accumulator, Value); }
+
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Vector)
+    {
+        return MlasMaximumFloat32x4(Accumulator, Vector);
+    }
+
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasMaximumFloat32x4(Vector1, Vector2);
+    }
+
+    static float Combine(MLAS_FLOAT32X4 Vector) { return MlasReduceMaximumFloat32x4(Vector); }
+};
+
+template<typename ReduceOperation>
+float
+MlasReduceRow(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a contiguous row.
+
+Arguments:
+
+    Input - Supplies the row to reduce.
+
+    N - Supplies the number of elements of the row, at least one.
+
+Return Value:
+
+    Returns the reduced value of the row.
+
+--*/
+{
+    if (N < 4) {
+
+        float Accumulator = ReduceOperation::Initial(Input[0]);
+
+        for (size_t n = 1; n < N; n++) {
+            Accumulator = ReduceOperation::Accumulate(Accumulator, Input[n]);
+        }
+
+        return Accumulator;
+    }
+
+    MLAS_FLOAT32X4 Accumulator0 = ReduceOperation::Initial(MlasLoadFloat32x4(Input));
+
+    Input += 4;
+    N -= 4;
+
+    if (N >= 12) {
+
+        MLAS_FLOAT32X4 Accumulator1 = ReduceOperation::Initial(MlasLoadFloat32x4(Input));
+        MLAS_FLOAT32X4 Accumulator2 = ReduceOperation::Initial(MlasLoadFloat32x4(Input + 4));
+        MLAS_FLOAT32X4 Accumulator3 = ReduceOperation::Initial(MlasLoadFloat32x4(Input + 8));
+
+        Input += 12;
+        N -= 12;
+
+        while (N >= 16) {
+
+            Accumulator0 = ReduceOperation::Accumulate(Accumulator0, MlasLoadFloat32x4(Input));
+            Accumulator1 = ReduceOperation::Accumulate(Accumulator1, MlasLoadFloat32x4(Input + 4));
+            Accumulator2 = ReduceOperation::Accumulate(Accumulator2, MlasLoadFloat32x4(Input + 8));
+            Accumulator3 = ReduceOperation::Accumulate(Accumulator3, MlasLoadFloat32x4(Input + 12));
+
+            Input += 16;
+            N -= 16;
+        }
+
+        Accumulator0 = ReduceOperation::Combine(Accumulator0, Accumulator1);
+        Accumulator2 = ReduceOperation::Combine(Accumulator2, Accumulator3);
+        Accumulator0 = ReduceOperation::Combine(Accumulator0, Accumulator2);
+    }
+
+    while (N >= 4) {
+
+        Accumulator0 = ReduceOperation::Accumulate(Accumulator0, MlasLoadFloat32x4(Input));
+
+        Input += 4;
+        N -= 4;
+    }
+
+    float Accumulator = ReduceOperation::Combine(Accumulator0);
+
+    while (N > 0) {
+
+        Accumulator = ReduceOperation::Accumulate(Accumulator, *Input++);
+        N -= 1;
+    }
+
+    return Accumulator;
+}
+
+template<typename ReduceOperation>
+void
+MlasReduceStrip(
+    const float* Input,
+    float* Output,
+    size_t ReduceCount,
+    size_t Stride,
+    size_t Columns
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a strip of adjacent columns.
+
+Arguments:
+
+    Input - Supplies the first row of the strip.
+
+    Output - Supplies the output buffer of the strip.
+
+    ReduceCount - Supplies the number of rows to reduce, at least one.
+
+    Stride - Supplies the number of elements between two rows.
+
+    Columns - Supplies the number of columns of the strip.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t n = 0;
+
+    for (; n + 4 <= Columns; n += 4) {
+        MlasStoreFloat32x4(Output + n, ReduceOperation::Initial(MlasLoadFloat32x4(Input + n)));
+    }
+
+    for (; n < Columns; n++) {
+        Output[n] = ReduceOperation::Initial(Input[n]);
+    }
+
+    //
+    // Accumulate four rows at a time to load and store the strip of
+    // accumulators less often.
+    //
+
+    size_t r = 1;
+
+    for (; r + 4 <= ReduceCount; r += 4) {
+
+        const float* Row0 = Input + r * Stride;
+        const float* Row1 = Row0 + Stride;
+        const float* Row2 = Row1 + Stride;
+        const float* Row3 = Row2 + Stride;
+
+        for (n = 0; n + 4 <= Columns; n += 4) {
+
+            MLAS_FLOAT32X4 Accumulator = MlasLoadFloat32x4(Output + n);
+
+            Accumulator = ReduceOperation::Accumulate(Accumulator, MlasLoadFloat32x4(Row0 + n));
+            Accumulator = ReduceOperation::Accumulate(Accumulator, MlasLoadFloat32x4(Row1 + n));
+            Accumulator = ReduceOperation::Accumulate(Accumulator, MlasLoadFloat32x4(Row2 + n));
+            Accumulator = ReduceOperation::Accumulate(Accumulator, MlasLoadFloat32x4(Row3 + n));
+
+            MlasStoreFloat32x4(Output + n, Accumulator);
+        }
+
+        for (; n < Columns; n++) {
+
+            float Accumulator = Output[n];
+
+            Accumulator = ReduceOperation::Accumulate(Accumulator, Row0[n]);
+            Accumulator = ReduceOperation::Accumulate(Accumulator, Row1[n]);
+            Accumulator = ReduceOperation::Accumulate(Accumulator, Row2[n]);
+            Accumulator = ReduceOperation::Accumulate(Accumulator, Row3[n]);
+
+            Output[n] = Accumulator;
+        }
+    }
+
+    for (; r < ReduceCount; r++) {
+
+        const float* Row = Input + r * Stride;
+
+        for (n = 0; n + 4 <= Columns; n += 4) {
+            MLAS_FLOAT32X4 Accumulator = MlasLoadFloat32x4(Output + n);
+            MlasStoreFloat32x4(Output + n, ReduceOperation::Accumulate(Accumulator, MlasLoadFloat32x4(Row + n)));
+        }
+
+        for (; n < Columns; n++) {
+            Output[n] = ReduceOperation::Accumulate(Output[n], Row[n]);
+        }
+    }
+}
+
+float
+MlasReduceLogSumExpNonFinite(
+    const float* Input,
+    size_t ReduceCount,
+    size_t Stride
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the log-sum-exp of a row or column that contains
+    infinite or NaN values. Only the finite values shift the exponentials, so
+    that an infinite value produces an infinite result instead of NaN.
+
+Arguments:
+
+    Input - Supplies the first element to reduce.
+
+    ReduceCount - Supplies the number of elements to reduce.
+
+    Stride - Supplies the number of elements between two reduced elements.
+
+Return Value:
+
+    Returns the log-sum-exp of the elements.
+
+--*/
+{
+    float Maximum = 0.0f;
+    bool HasFinite = false;
+
+    for (size_t r = 0; r < ReduceCount; r++) {
+        const float Value = Input[r * Stride];
+        if (std::isfinite(Value) && (!HasFinite || Value > Maximum)) {
+            Maximum = Value;
+            HasFinite = true;
+        }
+    }
+
+    float Accumulation = 0.0f;
+
+    for (size_t r = 0; r < ReduceCount; r++) {
+        Accumulation += std::exp(Input[r * Stride] - Maximum);
+    }
+
+    return std::log(Accumulation) + Maximum;
+}
+
+float
+MlasReduceLogSumExpRow(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the log-sum-exp of a contiguous row.
+
+Arguments:
+
+    Input - Supplies the row to reduce.
+
+    N - Supplies the number of elements of the row, at least one.
+
+Return Value:
+
+    Returns the log-sum-exp of the row.
+
+--*/
+{
+    const float Maximum = MlasReduceRow<MLAS_REDUCE_MAXIMUM_OPERATION>(Input, N);
+
+    if (!std::isfinite(Maximum)) {
+        return MlasReduceLogSumExpNonFinite(Input, N, 1);
+    }
+
+    const float NegativeMaximum = -Maximum;
+
+#if defined(MLAS_TARGET_AMD64)
+    float Accumulation = GetMlasPlatform().ComputeSumExpF32Kernel(Input, nullptr, N, &NegativeMaximum);
+#else
+    float Accumulation = MlasComputeSumExpF32Kernel(Input, nullptr, N, &NegativeMaximum);
+#endif
+
+    return std::log(Accumulation) + Maximum;
+}
+
+void
+MlasReduceLogSumExpStrip(
+    const float* Input,
+    float* Output,
+    size_t ReduceCount,
+    size_t Stride,
+    size_t Columns
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the log-sum-exp of a strip of adjacent columns.
+
+Arguments:
+
+    Input - Supplies the first row of the strip.
+
+    Output - Supplies the output buffer of the strip.
+
+    ReduceCount - Supplies the number of rows to reduce, at least one.
+
+    Stride - Supplies the number of elements between two rows.
+
+    Columns - Supplies the number of columns of the strip, at most
+        MLAS_REDUCE_STRIP_COLUMNS.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(float Accumulation[MLAS_REDUCE_STRIP_COLUMNS], 64);
+    MLAS_DECLSPEC_ALIGN(float Exponentials[MLAS_REDUCE_STRIP_COLUMNS], 64);
+
+    //
+    // Find the maximum of every column in the output buffer, then accumulate
+    // the exponentials of the rows shifted by these maximums.
+    //
+
+    MlasReduceStrip<MLAS_REDUCE_MAXIMUM_OPERATION>(Input, Output, ReduceCount, Stride, Columns);
+
+    std::fill_n(Accumulation, Columns, 0.0f);
+
+    for (size_t r = 0; r < ReduceCount; r++) {
+
+        const float* Row = Input + r * Stride;
+        size_t n = 0;
+
+        for (; n + 4 <= Columns; n += 4) {
+            MlasStoreFloat32x4(Exponentials + n,
+                               MlasSubtractFloat32x4(MlasLoadFloat32x4(Row + n), MlasLoadFloat32x4(Output + n)));
+        }
+
+        for (; n < Columns; n++) {
+            Exponentials[n] = Row[n] - Output[n];
+        }
+
+        MlasComputeExp(Exponentials, Exponentials, Columns);
+
+        for (n = 0; n + 4 <= Columns; n += 4) {
+            MlasStoreFloat32x4(Accumulation + n,
+                               MlasAddFloat32x4(MlasLoadFloat32x4(Accumulation + n), MlasLoadFloat32x4(Exponentials + n)));
+        }
+
+        for (; n < Columns; n++) {
+            Accumulation[n] += Exponentials[n];
+        }
+    }
+
+    for (size_t n = 0; n < Columns; n++) {
+        if (std::isfinite(Output[n])) {
+            Output[n] = std::log(Accumulation[n]) + Output[n];
+        } else {
+            Output[n] = MlasReduceLogSumExpNonFinite(Input + n, ReduceCount, Stride);
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND ReduceKind,
+    const float* Input,
+    float* Output,
+    size_t OuterCount,
+    size_t ReduceCount,
+    size_t InnerCount,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces the middle dimension of a tensor.
+
+Arguments:
+
+    ReduceKind - Supplies the kind of reduction.
+
+    Input - Supplies the input tensor of shape [OuterCount, ReduceCount,
+        InnerCount].
+
+    Output - Supplies the output tensor of shape [OuterCount, InnerCount].
+
+    OuterCount - Supplies the number of independent reductions.
+
+    ReduceCount - Supplies the number of elements to reduce, at least one.
+
+    InnerCount - Supplies the number of adjacent columns reduced
+        independently, 1 to reduce contiguous rows.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (OuterCount == 0 || InnerCount == 0) {
+        return;
+    }
+
+    //
+    // Split the work in rows for the contiguous reductions and in strips of
+    // columns otherwise.
+    //
+
+    const bool Contiguous = (InnerCount == 1);
+    const size_t StripCount = (InnerCount + MLAS_REDUCE_STRIP_COLUMNS - 1) / MLAS_REDUCE_STRIP_COLUMNS;
+    const size_t WorkCount = Contiguous ? OuterCount : OuterCount * StripCount;
+    const size_t ElementCount = OuterCount * ReduceCount * InnerCount;
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (size_t(ThreadCount) > WorkCount) {
+        ThreadCount = ptrdiff_t(WorkCount);
+    }
+
+    const size_t BlockCount = ElementCount / MLAS_REDUCE_MINIMUM_ELEMENTS_PER_THREAD + 1;
+
+    if (size_t(ThreadCount) > BlockCount) {
+        ThreadCount = ptrdiff_t(BlockCount);
+    }
+
+    MlasTrySimpleParallel(ThreadPool, ThreadCount, [&](ptrdiff_t tid) {
+
+        size_t WorkIndex;
+        size_t WorkRemaining;
+
+        MlasPartitionWork(tid, ThreadCount, WorkCount, &WorkIndex, &WorkRemaining);
+
+        for (; WorkRemaining > 0; WorkIndex++, WorkRemaining--) {
+
+            if (Contiguous) {
+
+                const float* Row = Input + WorkIndex * ReduceCount;
+                float& Value = Output[WorkIndex];
+
+                switch (ReduceKind) {
+                    case MlasReduceSum:
+                        Value = MlasReduceRow<MLAS_REDUCE_SUM_OPERATION>(Row, ReduceCount);
+                        break;
+                    case MlasReduceMean:
+                        Value = MlasReduceRow<MLAS_REDUCE_SUM_OPERATION>(Row, ReduceCount) / float(ReduceCount);
+                        break;
+                    case MlasReduceMaximum:
+                        Value = MlasReduceRow<MLAS_REDUCE_MAXIMUM_OPERATION>(Row, ReduceCount);
+                        break;
+                    case MlasReduceSumSquare:
+                        Value = MlasReduceRow<MLAS_REDUCE_SUM_SQUARE_OPERATION>(Row, ReduceCount);
+                        break;
+                    case MlasReduceLogSumExp:
+                        Value = MlasReduceLogSumExpRow(Row, ReduceCount);
+                        break;
+                }
+
+                continue;
+            }
+
+            const size_t OuterIndex = WorkIndex / StripCount;
+            const size_t Column = (WorkIndex % StripCount) * MLAS_REDUCE_STRIP_COLUMNS;
+            const size_t Columns = std::min(InnerCount - Column, size_t(MLAS_REDUCE_STRIP_COLUMNS));
+
+            const float* Strip = Input + OuterIndex * ReduceCount * InnerCount + Column;
+            float* OutputStrip = Output + OuterIndex * InnerCount + Column;
+
+            switch (ReduceKind) {
+                case MlasReduceSum:
+                    MlasReduceStrip<MLAS_REDUCE_SUM_OPERATION>(Strip, OutputStrip, ReduceCount, InnerCount, Columns);
+                    break;
+                case MlasReduceMean: {
+                    MlasReduceStrip<MLAS_REDUCE_SUM_OPERATION>(Strip, OutputStrip, ReduceCount, InnerCount, Columns);
+                    const MLAS_FLOAT32X4 CountVector = MlasBroadcastFloat32x4(float(ReduceCount));
+                    size_t n = 0;
+                    for (; n + 4 <= Columns; n += 4) {
+                        MlasStoreFloat32x4(OutputStrip + n,
+                                           MlasDivideFloat32x4(MlasLoadFloat32x4(OutputStrip + n), CountVector));
+                    }
+                    for (; n < Columns; n++) {
+                        OutputStrip[n] /= float(ReduceCount);
+                    }
+                    break;
+                }
+                case MlasReduceMaximum:
+                    MlasReduceStrip<MLAS_REDUCE_MAXIMUM_OPERATION>(Strip, OutputStrip, ReduceCount, InnerCount, Columns);
+                    break;
+                case MlasReduceSumSquare:
+                    MlasReduceStrip<MLAS_REDUCE_SUM_SQUARE_OPERATION>(Strip, OutputStrip, ReduceCount, InnerCount, Columns);
+                    break;
+                case MlasReduceLogSumExp:
+                    MlasReduceLogSumExpStrip(Strip, OutputStrip, ReduceCount, InnerCount, Columns);
+                    break;
+            }
+        }
+    });
+}
@@ -0,0 +1,209 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    resize.cpp
+
+Abstract:
+
+    This module implements the separable passes of the 2-D resize of an
+    image with interleaved channels.
+
+    The horizontal pass interpolates the pixels of an input row, with the
+    channels of a pixel processed as a vector. The vertical pass sums the
+    weighted rows of the horizontally resized image, with the elements of a
+    row processed as vectors, so that the per-element work is independent of
+    the channel count.
+
+    The products are summed in tap order without fused multiply-adds, so the
+    vertical pass matches a scalar loop over the taps.
+
+--*/
+
+#include "mlasi.h"
+
+void
+MLASCALL
+MlasResizeHorizontalLinear(
+    const float* Input,
+    size_t Channels,
+    size_t OutputWidth,
+    const int32_t* InputIndex1,
+    const int32_t* InputIndex2,
+    const float* Weight1,
+    const float* Weight2,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine linearly interpolates the pixels of an input row.
+
+Arguments:
+
+    Input - Supplies the input row.
+
+    Channels - Supplies the number of interleaved channels of a pixel.
+
+    OutputWidth - Supplies the number of pixels of the output row.
+
+    InputIndex1 - Supplies the index of the first input pixel of each output
+        pixel.
+
+    InputIndex2 - Supplies the index of the second input pixel of each output
+        pixel.
+
+    Weight1 - Supplies the weight of the first input pixel of each output
+        pixel.
+
+    Weight2 - Supplies the weight of the second input pixel of each output
+        pixel.
+
+    Output - Supplies the output row of OutputWidth * Channels elements.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Channels == 1) {
+
+        for (size_t x = 0; x < OutputWidth; x++) {
+            Output[x] = Weight1[x] * Input[InputIndex1[x]] + Weight2[x] * Input[InputIndex2[x]];
+        }
+
+        return;
+    }
+
+    for (size_t x = 0; x < OutputWidth; x++) {
+
+        const float* Input1 = Input + size_t(InputIndex1[x]) * Channels;
+        const float* Input2 = Input + size_t(InputIndex2[x]) * Channels;
+
+        const MLAS_FLOAT32X4 Weight1Vector = MlasBroadcastFloat32x4(Weight1[x]);
+        const MLAS_FLOAT32X4 Weight2Vector = MlasBroadcastFloat32x4(Weight2[x]);
+
+        size_t c = 0;
+
+        for (; c + 4 <= Channels; c += 4) {
+
+            MLAS_FLOAT32X4 Vector = MlasAddFloat32x4(
+                MlasMultiplyFloat32x4(Weight1Vector, MlasLoadFloat32x4(Input1 + c)),
+                MlasMultiplyFloat32x4(Weight2Vector, MlasLoadFloat32x4(Input2 + c)));
+
+            MlasStoreFloat32x4(Output + c, Vector);
+        }
+
+        for (; c < Channels; c++) {
+            Output[c] = Weight1[x] * Input1[c] + Weight2[x] * Input2[c];
+        }
+
+        Output += Channels;
+    }
+}
+
+void
+MLASCALL
+MlasResizeVerticalFilter(
+    const float* Input,
+    ptrdiff_t InputStride,
+    const float* Weights,
+    size_t Taps,
+    size_t Count,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine sums the weighted input rows of a tap window.
+
+Arguments:
+
+    Input - Supplies the first input row of the window.
+
+    InputStride - Supplies the distance in elements between two consecutive
+        input rows of the window, which may be zero or negative.
+
+    Weights - Supplies the weight of each input row of the window.
+
+    Taps - Supplies the number of input rows of the window.
+
+    Count - Supplies the number of elements of a row.
+
+    Output - Supplies the output row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t i = 0;
+
+    while (i + 16 <= Count) {
+
+        MLAS_FLOAT32X4 Accumulator0 = MlasZeroFloat32x4();
+        MLAS_FLOAT32X4 Accumulator1 = MlasZeroFloat32x4();
+        MLAS_FLOAT32X4 Accumulator2 = MlasZeroFloat32x4();
+        MLAS_FLOAT32X4 Accumulator3 = MlasZeroFloat32x4();
+
+        const float* Row = Input + i;
+
+        for (size_t t = 0; t < Taps; t++) {
+
+            const MLAS_FLOAT32X4 Weight = MlasBroadcastFloat32x4(Weights[t]);
+
+            Accumulator0 = MlasAddFloat32x4(Accumulator0, MlasMultiplyFloat32x4(MlasLoadFloat32x4(Row), Weight));
+            Accumulator1 = MlasAddFloat32x4(Accumulator1, MlasMultiplyFloat32x4(MlasLoadFloat32x4(Row + 4), Weight));
+            Accumulator2 = MlasAddFloat32x4(Accumulator2, MlasMultiplyFloat32x4(MlasLoadFloat32x4(Row + 8), Weight));
+            Accumulator3 = MlasAddFloat32x4(Accumulator3, MlasMultiplyFloat32x4(MlasLoadFloat32x4(Row + 12), Weight));
+
+            Row += InputStride;
+        }
+
+        MlasStoreFloat32x4(Output + i, Accumulator0);
+        MlasStoreFloat32x4(Output + i + 4, Accumulator1);
+        MlasStoreFloat32x4(Output + i + 8, Accumulator2);
+        MlasStoreFloat32x4(Output + i + 12, Accumulator3);
+
+        i += 16;
+    }
+
+    while (i + 4 <= Count) {
+
+        MLAS_FLOAT32X4 Accumulator = MlasZeroFloat32x4();
+
+        const float* Row = Input + i;
+
+        for (size_t t = 0; t < Taps; t++) {
+            Accumulator = MlasAddFloat32x4(Accumulator,
+                MlasMultiplyFloat32x4(MlasLoadFloat32x4(Row), MlasBroadcastFloat32x4(Weights[t])));
+            Row += InputStride;
+        }
+
+        MlasStoreFloat32x4(Output + i, Accumulator);
+
+        i += 4;
+    }
+
+    for (; i < Count; i++) {
+
+        float Accumulator = 0.0f;
+
+        const float* Row = Input + i;
+
+        for (size_t t = 0; t < Taps; t++) {
+            Accumulator += *Row * Weights[t];
+            Row += InputStride;
+        }
+
+        Output[i] = Accumulator;
+    }
+}
@@ -0,0 +1,209 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sbgemm_kernel_amd64.cpp
+
+Abstract:
+
+    This module implements the packing of the B matrix shared by the x86-64
+    bfloat16 precision GEMM kernels, and the portable kernel used by the
+    processors without the AVX512-BF16 instructions.
+
+    The portable kernel rounds both inputs to bfloat16 and accumulates in
+    single precision like the AVX512-BF16 kernel, so that the results only
+    differ by the order of the additions.
+
+--*/
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include "mlasi.h"
+#include "sbgemm.h"
+
+struct MLAS_SBGEMM_KERNEL_AMD64 {
+    static constexpr bool PackNeeded = true;
+    static constexpr size_t KernelMaxM = 1;  // max # rows the vectorized kernel can process
+    static constexpr size_t PackedK = 2;
+    static constexpr size_t PackedN = MLAS_SGEMM_STRIDEN_THREAD_ALIGN;
+    static constexpr MLAS_SBGEMM_STRIDES Strides{128, 128, 256};  // M:N:K
+};
+
+bool MLASCALL
+MlasBf16AccelerationSupported()
+{
+#if defined(MLAS_AVX512BF16_SUPPORTED)
+    return GetMlasPlatform().SBGemmDispatch == &MlasSBGemmDispatchAvx512Bf16;
+#else
+    return false;
+#endif
+}
+
+MLAS_FORCEINLINE
+bfloat16_t
+MlasSBGemmFloatToBfloat16(float Value)
+{
+    uint32_t Bits;
+    std::memcpy(&Bits, &Value, sizeof(Bits));
+
+    //
+    // Keep the NaNs quiet, else round to the nearest even value like the
+    // AVX512-BF16 conversion instructions.
+    //
+
+    if ((Bits & 0x7FFFFFFF) > 0x7F800000) {
+        return bfloat16_t((Bits >> 16) | 0x40);
+    }
+
+    Bits += 0x7FFF + ((Bits >> 16) & 1);
+    return bfloat16_t(Bits >> 16);
+}
+
+MLAS_FORCEINLINE
+float
+MlasSBGemmBfloat16ToFloat(bfloat16_t Value)
+{
+    const uint32_t Bits = uint32_t(Value) << 16;
+    float Result;
+    std::memcpy(&Result, &Bits, sizeof(Result));
+    return Result;
+}
+
+void
+MlasSBGemmConvertPackBAmd64(
+    bfloat16_t* PackedB, const float* B, size_t ldb, size_t CountN, size_t CountK
+)
+{
+    constexpr MLAS_SBGEMM_STRIDES Strides = MLAS_SBGEMM_KERNEL_AMD64::Strides;
+    constexpr size_t PackedN = MLAS_SBGEMM_KERNEL_AMD64::PackedN;
+
+    const size_t AlignedN = (CountN + PackedN - 1) & ~(PackedN - 1);
+
+    //
+    // Step through each slice of matrix B along the K dimension.
+    //
+
+    size_t CountSliceK;
+
+    for (size_t k = 0; k < CountK; k += CountSliceK) {
+
+        CountSliceK = std::min(CountK - k, Strides.K);
+
+        bfloat16_t* D = PackedB + AlignedN * k;
+
+        for (size_t n = 0; n < AlignedN; n += PackedN) {
+
+            const size_t CountPanelN = std::min(CountN - std::min(n, CountN), PackedN);
+
+            for (size_t kk = 0; kk < CountSliceK; kk += 2) {
+
+                const float* b = B + (k + kk) * ldb + n;
+                const bool HasSecondRow = (kk + 1 < CountSliceK);
+
+                for (size_t nn = 0; nn < PackedN; nn++) {
+                    const float Value0 = (nn < CountPanelN) ? b[nn] : 0.0f;
+                    const float Value1 = (nn < CountPanelN && HasSecondRow) ? b[ldb + nn] : 0.0f;
+                    D[0] = MlasSBGemmFloatToBfloat16(Value0);
+                    D[1] = MlasSBGemmFloatToBfloat16(Value1);
+                    D += 2;
+                }
+            }
+        }
+    }
+}
+
+template <>
+void
+MlasSBGemmConvertPackB<MLAS_SBGEMM_KERNEL_AMD64>(
+    bfloat16_t* PackedB, const float* B, size_t ldb, size_t CountN, size_t CountK
+)
+{
+    MlasSBGemmConvertPackBAmd64(PackedB, B, ldb, CountN, CountK);
+}
+
+template <>
+void
+MlasSBGemmKernel<MLAS_SBGEMM_KERNEL_AMD64>(
+    const size_t CountM,
+    const size_t CountN,
+    const size_t CountK,
+    const float* A,
+    const size_t lda,
+    const bfloat16_t* B,
+    float* C,
+    size_t ldc,
+    const float* Bias,
+    const bool ZeroMode
+)
+{
+    constexpr MLAS_SBGEMM_STRIDES Strides = MLAS_SBGEMM_KERNEL_AMD64::Strides;
+    constexpr size_t PackedN = MLAS_SBGEMM_KERNEL_AMD64::PackedN;
+
+    const size_t AlignedN = (CountN + PackedN - 1) & ~(PackedN - 1);
+
+    float RowA[Strides.K];
+
+    //
+    // Step through each slice of the packed matrix B along the K dimension,
+    // which is a single slice unless B is packed by the non packed operation.
+    //
+
+    size_t CountSliceK;
+
+    for (size_t k = 0; k < CountK; k += CountSliceK) {
+
+        CountSliceK = std::min(CountK - k, Strides.K);
+
+        const size_t AlignedSliceK = (CountSliceK + 1) & ~size_t(1);
+        const bfloat16_t* SliceB = B + AlignedN * k;
+        const bool StoreMode = ZeroMode && (k == 0);
+
+        for (size_t m = 0; m < CountM; m++) {
+
+            for (size_t kk = 0; kk < AlignedSliceK; kk++) {
+                const float Value = (kk < CountSliceK) ? A[m * lda + k + kk] : 0.0f;
+                RowA[kk] = MlasSBGemmBfloat16ToFloat(MlasSBGemmFloatToBfloat16(Value));
+            }
+
+            for (size_t n = 0; n < CountN; n += PackedN) {
+
+                const bfloat16_t* b = SliceB + n * AlignedSliceK;
+                float Accumulators[PackedN] = {};
+
+                for (size_t kk = 0; kk < AlignedSliceK; kk += 2) {
+                    for (size_t nn = 0; nn < PackedN; nn++) {
+                        Accumulators[nn] += RowA[kk] * MlasSBGemmBfloat16ToFloat(b[nn * 2]) +
+                                            RowA[kk + 1] * MlasSBGemmBfloat16ToFloat(b[nn * 2 + 1]);
+                    }
+                    b += PackedN * 2;
+                }
+
+                const size_t CountPanelN = std::min(CountN - n, PackedN);
+                float* c = C + m * ldc + n;
+
+                for (size_t nn = 0; nn < CountPanelN; nn++) {
+                    if (StoreMode) {
+                        c[nn] = Accumulators[nn] + ((Bias != nullptr) ? Bias[n + nn] : 0.0f);
+                    } else {
+                        c[nn] += Accumulators[nn];
+                    }
+                }
+            }
+        }
+    }
+}
+
+const MLAS_SBGEMM_DISPATCH MlasSBGemmDispatchAmd64 = {
+    MlasSBGemmOperation<MLAS_SBGEMM_KERNEL_AMD64>,
+    MlasSBGemmConvertPackB<MLAS_SBGEMM_KERNEL_AMD64>,
+    MLAS_SBGEMM_KERNEL_AMD64::PackedK,
+    MLAS_SBGEMM_KERNEL_AMD64::PackedN,
+    MLAS_SBGEMM_KERNEL_AMD64::KernelMaxM,
+    0  // kernel does not read beyond buffer end
+};
+
+#endif  // defined(__x86_64__) && defined(__linux__)
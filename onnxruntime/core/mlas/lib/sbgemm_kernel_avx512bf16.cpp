@@ -0,0 +1,314 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sbgemm_kernel_avx512bf16.cpp
+
+Abstract:
+
+    This module implements the bfloat16 precision GEMM kernel for the
+    processors supporting the AVX512-BF16 instructions.
+
+    Matrix B is packed by MlasSBGemmConvertPackBAmd64, so that each packed
+    row pair of a 16 column panel is consumed by a single VDPBF16PS.
+
+--*/
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <immintrin.h>
+
+#include "mlasi.h"
+#include "sbgemm.h"
+
+struct MLAS_SBGEMM_KERNEL_AVX512BF16 {
+    static constexpr bool PackNeeded = true;
+    static constexpr size_t KernelMaxM = 4;  // max # rows the vectorized kernel can process
+    static constexpr size_t PackedK = 2;
+    static constexpr size_t PackedN = MLAS_SGEMM_STRIDEN_THREAD_ALIGN;
+    static constexpr MLAS_SBGEMM_STRIDES Strides{128, 128, 256};  // M:N:K
+};
+
+template <>
+void
+MlasSBGemmConvertPackB<MLAS_SBGEMM_KERNEL_AVX512BF16>(
+    bfloat16_t* PackedB, const float* B, size_t ldb, size_t CountN, size_t CountK
+)
+{
+    MlasSBGemmConvertPackBAmd64(PackedB, B, ldb, CountN, CountK);
+}
+
+/*++
+
+Routine Description:
+
+    This routine converts rows of matrix A to bfloat16, with the row length
+    padded to an even count so that the kernel can broadcast the pairs of
+    consecutive elements.
+
+Arguments:
+
+    D - Supplies the address of the destination buffer, with a row stride of
+        the maximum K stride.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    CountM - Supplies the number of rows to convert.
+
+    CountK - Supplies the number of columns to convert.
+
+Return Value:
+
+    None.
+
+--*/
+MLAS_FORCEINLINE
+void
+MlasSBGemmConvertRowsAvx512Bf16(
+    uint16_t* D, const float* A, size_t lda, size_t CountM, size_t CountK
+)
+{
+    constexpr size_t StrideK = MLAS_SBGEMM_KERNEL_AVX512BF16::Strides.K;
+
+    for (size_t m = 0; m < CountM; m++) {
+
+        const float* a = A + m * lda;
+        uint16_t* d = D + m * StrideK;
+
+        for (size_t k = 0; k < CountK; k += 32) {
+
+            const size_t Remaining = CountK - k;
+            const __mmask16 MaskLo = (Remaining >= 16) ? __mmask16(0xFFFF) : __mmask16((1u << Remaining) - 1);
+            const __mmask16 MaskHi = (Remaining >= 32) ? __mmask16(0xFFFF) : (Remaining > 16) ? __mmask16((1u << (Remaining - 16)) - 1) : __mmask16(0);
+
+            const __m512 Lo = _mm512_maskz_loadu_ps(MaskLo, a + k);
+            const __m512 Hi = _mm512_maskz_loadu_ps(MaskHi, a + k + 16);
+            const __m512i Converted = (__m512i)_mm512_cvtne2ps_pbh(Hi, Lo);
+
+            //
+            // Store the padding element of an odd row length as zero.
+            //
+
+            const size_t StoreCount = std::min(Remaining + (Remaining & 1), size_t(32));
+            const __mmask32 StoreMask = (StoreCount >= 32) ? __mmask32(0xFFFFFFFF) : __mmask32((1u << StoreCount) - 1);
+            _mm512_mask_storeu_epi16(d + k, StoreMask, Converted);
+        }
+    }
+}
+
+template <size_t RowCount>
+MLAS_FORCEINLINE
+void
+MlasSBGemmStoreRowsAvx512Bf16(
+    const __m512 (&Accumulators)[RowCount][2],
+    size_t GroupCount,
+    size_t CountN,
+    float* C,
+    size_t ldc,
+    const float* Bias,
+    bool StoreMode
+)
+{
+    for (size_t g = 0; g < GroupCount; g++) {
+
+        const size_t CountPanelN = std::min(CountN - g * 16, size_t(16));
+        const __mmask16 Mask = (CountPanelN >= 16) ? __mmask16(0xFFFF) : __mmask16((1u << CountPanelN) - 1);
+
+        __m512 BiasVector = _mm512_setzero_ps();
+
+        if (StoreMode && Bias != nullptr) {
+            BiasVector = _mm512_maskz_loadu_ps(Mask, Bias + g * 16);
+        }
+
+        for (size_t r = 0; r < RowCount; r++) {
+
+            float* c = C + r * ldc + g * 16;
+            __m512 Value = Accumulators[r][g];
+
+            if (StoreMode) {
+                Value = _mm512_add_ps(Value, BiasVector);
+            } else {
+                Value = _mm512_add_ps(Value, _mm512_maskz_loadu_ps(Mask, c));
+            }
+
+            _mm512_mask_storeu_ps(c, Mask, Value);
+        }
+    }
+}
+
+/*++
+
+Routine Description:
+
+    This routine computes up to 4 rows by up to 32 columns of the output for
+    a slice of matrix B.
+
+Arguments:
+
+    RowsA - Supplies the address of the converted rows of matrix A.
+
+    B - Supplies the address of the first packed panel of the slice of
+        matrix B.
+
+    C - Supplies the address of matrix C.
+
+    PairCount - Supplies the number of row pairs of the slice of matrix B.
+
+    CountN - Supplies the number of columns of matrix C, at most 32.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    Bias - Supplies the bias for the columns, or nullptr.
+
+    StoreMode - Supplies true if matrix C is overwritten, else the results
+        are accumulated into matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+template <size_t RowCount>
+void
+MlasSBGemmComputeBlockAvx512Bf16(
+    const uint16_t* RowsA,
+    const bfloat16_t* B,
+    float* C,
+    size_t PairCount,
+    size_t CountN,
+    size_t ldc,
+    const float* Bias,
+    bool StoreMode
+)
+{
+    constexpr size_t StrideK = MLAS_SBGEMM_KERNEL_AVX512BF16::Strides.K;
+
+    const size_t GroupCount = (CountN > 16) ? 2 : 1;
+    const bfloat16_t* b0 = B;
+    const bfloat16_t* b1 = B + PairCount * 32;
+
+    __m512 Accumulators[RowCount][2];
+
+    for (size_t r = 0; r < RowCount; r++) {
+        Accumulators[r][0] = _mm512_setzero_ps();
+        Accumulators[r][1] = _mm512_setzero_ps();
+    }
+
+    for (size_t p = 0; p < PairCount; p++) {
+
+        const __m512bh B0 = (__m512bh)_mm512_loadu_si512(b0 + p * 32);
+
+        if (GroupCount == 2) {
+
+            const __m512bh B1 = (__m512bh)_mm512_loadu_si512(b1 + p * 32);
+
+            for (size_t r = 0; r < RowCount; r++) {
+                int32_t Pair;
+                std::memcpy(&Pair, RowsA + r * StrideK + p * 2, sizeof(Pair));
+                const __m512bh A = (__m512bh)_mm512_set1_epi32(Pair);
+                Accumulators[r][0] = _mm512_dpbf16_ps(Accumulators[r][0], A, B0);
+                Accumulators[r][1] = _mm512_dpbf16_ps(Accumulators[r][1], A, B1);
+            }
+
+        } else {
+
+            for (size_t r = 0; r < RowCount; r++) {
+                int32_t Pair;
+                std::memcpy(&Pair, RowsA + r * StrideK + p * 2, sizeof(Pair));
+                const __m512bh A = (__m512bh)_mm512_set1_epi32(Pair);
+                Accumulators[r][0] = _mm512_dpbf16_ps(Accumulators[r][0], A, B0);
+            }
+        }
+    }
+
+    MlasSBGemmStoreRowsAvx512Bf16<RowCount>(Accumulators, GroupCount, CountN, C, ldc, Bias, StoreMode);
+}
+
+template <>
+void
+MlasSBGemmKernel<MLAS_SBGEMM_KERNEL_AVX512BF16>(
+    const size_t CountM,
+    const size_t CountN,
+    const size_t CountK,
+    const float* A,
+    const size_t lda,
+    const bfloat16_t* B,
+    float* C,
+    size_t ldc,
+    const float* Bias,
+    const bool ZeroMode
+)
+{
+    constexpr size_t KernelMaxM = MLAS_SBGEMM_KERNEL_AVX512BF16::KernelMaxM;
+    constexpr MLAS_SBGEMM_STRIDES Strides = MLAS_SBGEMM_KERNEL_AVX512BF16::Strides;
+    constexpr size_t PackedN = MLAS_SBGEMM_KERNEL_AVX512BF16::PackedN;
+
+    const size_t AlignedN = (CountN + PackedN - 1) & ~(PackedN - 1);
+
+    MLAS_DECLSPEC_ALIGN(uint16_t RowsA[KernelMaxM * Strides.K], 64);
+
+    //
+    // Step through each slice of the packed matrix B along the K dimension,
+    // which is a single slice unless B is packed by the non packed operation.
+    //
+
+    size_t CountSliceK;
+
+    for (size_t k = 0; k < CountK; k += CountSliceK) {
+
+        CountSliceK = std::min(CountK - k, Strides.K);
+
+        const size_t PairCount = (CountSliceK + 1) / 2;
+        const bfloat16_t* SliceB = B + AlignedN * k;
+        const bool StoreMode = ZeroMode && (k == 0);
+
+        size_t CountRowsM;
+
+        for (size_t m = 0; m < CountM; m += CountRowsM) {
+
+            CountRowsM = std::min(CountM - m, KernelMaxM);
+
+            MlasSBGemmConvertRowsAvx512Bf16(RowsA, A + m * lda + k, lda, CountRowsM, CountSliceK);
+
+            for (size_t n = 0; n < CountN; n += 2 * PackedN) {
+
+                const bfloat16_t* b = SliceB + n * PairCount * 2;
+                float* c = C + m * ldc + n;
+                const float* bias = (Bias != nullptr) ? Bias + n : nullptr;
+                const size_t CountBlockN = std::min(CountN - n, 2 * PackedN);
+
+                switch (CountRowsM) {
+                    case 4:
+                        MlasSBGemmComputeBlockAvx512Bf16<4>(RowsA, b, c, PairCount, CountBlockN, ldc, bias, StoreMode);
+                        break;
+                    case 3:
+                        MlasSBGemmComputeBlockAvx512Bf16<3>(RowsA, b, c, PairCount, CountBlockN, ldc, bias, StoreMode);
+                        break;
+                    case 2:
+                        MlasSBGemmComputeBlockAvx512Bf16<2>(RowsA, b, c, PairCount, CountBlockN, ldc, bias, StoreMode);
+                        break;
+                    default:
+                        MlasSBGemmComputeBlockAvx512Bf16<1>(RowsA, b, c, PairCount, CountBlockN, ldc, bias, StoreMode);
+                        break;
+                }
+            }
+        }
+    }
+}
+
+const MLAS_SBGEMM_DISPATCH MlasSBGemmDispatchAvx512Bf16 = {
+    MlasSBGemmOperation<MLAS_SBGEMM_KERNEL_AVX512BF16>,
+    MlasSBGemmConvertPackB<MLAS_SBGEMM_KERNEL_AVX512BF16>,
+    MLAS_SBGEMM_KERNEL_AVX512BF16::PackedK,
+    MLAS_SBGEMM_KERNEL_AVX512BF16::PackedN,
+    MLAS_SBGEMM_KERNEL_AVX512BF16::KernelMaxM,
+    0  // kernel does not read beyond buffer end
+};
+
+#endif  // defined(__x86_64__) && defined(__linux__)
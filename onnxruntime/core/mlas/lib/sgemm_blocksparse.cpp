@@ -0,0 +1,522 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sgemm_blocksparse.cpp
+
+Abstract:
+
+    This module implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a constant block sparse B matrix.
+
+    The B matrix is packed as panels of 16 adjacent columns. A panel keeps only
+    the rows with at least one nonzero element in the panel, along with the
+    index of the row. The kernel multiplies a block of rows of A by a panel,
+    broadcasting the element of A matching each packed row, so the work scales
+    with the number of nonzero blocks instead of the size of B.
+
+    The packed buffer is laid out as:
+
+        size_t PanelOffsets[PanelCount + 1]     first block of each panel
+        uint32_t RowIndices[BlockCount]         row of B of each block
+        float Values[BlockCount][16]            64 byte aligned blocks
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of columns of B in a panel.
+//
+
+#define MLAS_BLOCK_SPARSE_PANEL_N 16
+
+//
+// Define the alignment of the packed values.
+//
+
+#define MLAS_BLOCK_SPARSE_VALUES_ALIGNMENT 64
+
+static
+size_t
+MlasBlockSparseSgemmValuesOffset(
+    size_t PanelCount,
+    size_t BlockCount
+    )
+{
+    const size_t Offset = (PanelCount + 1) * sizeof(size_t) + BlockCount * sizeof(uint32_t);
+
+    return (Offset + MLAS_BLOCK_SPARSE_VALUES_ALIGNMENT - 1) & ~size_t(MLAS_BLOCK_SPARSE_VALUES_ALIGNMENT - 1);
+}
+
+template<typename Callback>
+static
+void
+MlasBlockSparseSgemmForEachBlock(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    Callback BlockCallback
+    )
+/*++
+
+Routine Description:
+
+    This routine calls BlockCallback(Panel, Row, CountN, IsZero) for every
+    block of the B matrix, panel after panel.
+
+--*/
+{
+    for (size_t n = 0; n < N; n += MLAS_BLOCK_SPARSE_PANEL_N) {
+
+        const size_t CountN = std::min(N - n, size_t(MLAS_BLOCK_SPARSE_PANEL_N));
+
+        for (size_t k = 0; k < K; k++) {
+
+            bool IsZero = true;
+
+            for (size_t nn = 0; nn < CountN && IsZero; nn++) {
+                const float Value = (TransB == CblasNoTrans) ? B[k * ldb + n + nn] : B[(n + nn) * ldb + k];
+                IsZero = (Value == 0.0f);
+            }
+
+            BlockCallback(n / MLAS_BLOCK_SPARSE_PANEL_N, k, CountN, IsZero);
+        }
+    }
+}
+
+float
+MLASCALL
+MlasBlockSparseSgemmZeroBlockRatio(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the fraction of the blocks of the B matrix that only
+    contain zeros, which is the fraction of the multiply work skipped by
+    MlasBlockSparseSgemm.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+Return Value:
+
+    The fraction of zero blocks, 0 for an empty matrix.
+
+--*/
+{
+    size_t BlockCount = 0;
+    size_t ZeroBlockCount = 0;
+
+    MlasBlockSparseSgemmForEachBlock(TransB, N, K, B, ldb, [&](size_t, size_t, size_t, bool IsZero) {
+        BlockCount++;
+        ZeroBlockCount += IsZero ? 1 : 0;
+    });
+
+    return (BlockCount == 0) ? 0.0f : float(double(ZeroBlockCount) / double(BlockCount));
+}
+
+size_t
+MLASCALL
+MlasBlockSparseSgemmPackBSize(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the size of the buffer required to pack the B
+    matrix with MlasBlockSparseSgemmPackB.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+Return Value:
+
+    The size in bytes of the packed buffer, 0 if the matrix cannot be packed.
+
+--*/
+{
+    if (N == 0 || K == 0 || K > std::numeric_limits<uint32_t>::max()) {
+        return 0;
+    }
+
+    const size_t PanelCount = (N + MLAS_BLOCK_SPARSE_PANEL_N - 1) / MLAS_BLOCK_SPARSE_PANEL_N;
+    size_t BlockCount = 0;
+
+    MlasBlockSparseSgemmForEachBlock(TransB, N, K, B, ldb, [&](size_t, size_t, size_t, bool IsZero) {
+        BlockCount += IsZero ? 0 : 1;
+    });
+
+    return MlasBlockSparseSgemmValuesOffset(PanelCount, BlockCount) +
+           BlockCount * MLAS_BLOCK_SPARSE_PANEL_N * sizeof(float);
+}
+
+void
+MLASCALL
+MlasBlockSparseSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs the nonzero blocks of the B matrix.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer, of the size returned
+        by MlasBlockSparseSgemmPackBSize and aligned to 64 bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t PanelCount = (N + MLAS_BLOCK_SPARSE_PANEL_N - 1) / MLAS_BLOCK_SPARSE_PANEL_N;
+
+    //
+    // Count the nonzero blocks of each panel to place the arrays.
+    //
+
+    size_t* PanelOffsets = reinterpret_cast<size_t*>(PackedB);
+
+    std::fill_n(PanelOffsets, PanelCount + 1, size_t(0));
+
+    MlasBlockSparseSgemmForEachBlock(TransB, N, K, B, ldb, [&](size_t Panel, size_t, size_t, bool IsZero) {
+        PanelOffsets[Panel + 1] += IsZero ? 0 : 1;
+    });
+
+    for (size_t p = 0; p < PanelCount; p++) {
+        PanelOffsets[p + 1] += PanelOffsets[p];
+    }
+
+    const size_t BlockCount = PanelOffsets[PanelCount];
+
+    uint32_t* RowIndices = reinterpret_cast<uint32_t*>(PanelOffsets + PanelCount + 1);
+    float* Values = reinterpret_cast<float*>(
+        reinterpret_cast<uint8_t*>(PackedB) + MlasBlockSparseSgemmValuesOffset(PanelCount, BlockCount));
+
+    //
+    // Copy the nonzero blocks, padding the last panel with zeros.
+    //
+
+    size_t Block = 0;
+
+    MlasBlockSparseSgemmForEachBlock(TransB, N, K, B, ldb, [&](size_t Panel, size_t k, size_t CountN, bool IsZero) {
+
+        if (IsZero) {
+            return;
+        }
+
+        const size_t n = Panel * MLAS_BLOCK_SPARSE_PANEL_N;
+        float* BlockValues = Values + Block * MLAS_BLOCK_SPARSE_PANEL_N;
+
+        for (size_t nn = 0; nn < MLAS_BLOCK_SPARSE_PANEL_N; nn++) {
+            if (nn < CountN) {
+                BlockValues[nn] = (TransB == CblasNoTrans) ? B[k * ldb + n + nn] : B[(n + nn) * ldb + k];
+            } else {
+                BlockValues[nn] = 0.0f;
+            }
+        }
+
+        RowIndices[Block++] = uint32_t(k);
+    });
+}
+
+template<size_t RowCount>
+static
+void
+MlasBlockSparseSgemmKernel(
+    const float* A,
+    size_t lda,
+    const uint32_t* RowIndices,
+    const float* Values,
+    size_t BlockCount,
+    float* C,
+    size_t ldc,
+    size_t CountN,
+    float alpha,
+    float beta
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies RowCount rows of the A matrix by one panel of the
+    packed B matrix and accumulates the result into the C matrix.
+
+Arguments:
+
+    A - Supplies the address of the first row of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    RowIndices - Supplies the row index of each block of the panel.
+
+    Values - Supplies the values of the blocks of the panel.
+
+    BlockCount - Supplies the number of blocks of the panel.
+
+    C - Supplies the address of the first element of the panel in matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountN - Supplies the number of columns of the panel, up to 16.
+
+    alpha - Supplies the scalar multiplier (see SGEMM definition).
+
+    beta - Supplies the scalar beta multiplier (see SGEMM definition).
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 Accumulators[RowCount][4];
+
+    for (size_t r = 0; r < RowCount; r++) {
+        for (size_t j = 0; j < 4; j++) {
+            Accumulators[r][j] = MlasZeroFloat32x4();
+        }
+    }
+
+    for (size_t b = 0; b < BlockCount; b++) {
+
+        const float* BlockValues = Values + b * MLAS_BLOCK_SPARSE_PANEL_N;
+        const MLAS_FLOAT32X4 Vector0 = MlasLoadFloat32x4(BlockValues);
+        const MLAS_FLOAT32X4 Vector1 = MlasLoadFloat32x4(BlockValues + 4);
+        const MLAS_FLOAT32X4 Vector2 = MlasLoadFloat32x4(BlockValues + 8);
+        const MLAS_FLOAT32X4 Vector3 = MlasLoadFloat32x4(BlockValues + 12);
+        const size_t k = RowIndices[b];
+
+        for (size_t r = 0; r < RowCount; r++) {
+            const MLAS_FLOAT32X4 ABroadcast = MlasBroadcastFloat32x4(A[r * lda + k]);
+            Accumulators[r][0] = MlasMultiplyAddFloat32x4(ABroadcast, Vector0, Accumulators[r][0]);
+            Accumulators[r][1] = MlasMultiplyAddFloat32x4(ABroadcast, Vector1, Accumulators[r][1]);
+            Accumulators[r][2] = MlasMultiplyAddFloat32x4(ABroadcast, Vector2, Accumulators[r][2]);
+            Accumulators[r][3] = MlasMultiplyAddFloat32x4(ABroadcast, Vector3, Accumulators[r][3]);
+        }
+    }
+
+    //
+    // Scale the accumulators and update the C matrix, without reading it when
+    // beta is zero.
+    //
+
+    const MLAS_FLOAT32X4 AlphaBroadcast = MlasBroadcastFloat32x4(alpha);
+
+    for (size_t r = 0; r < RowCount; r++) {
+
+        float* c = C + r * ldc;
+
+        if (CountN == MLAS_BLOCK_SPARSE_PANEL_N) {
+
+            for (size_t j = 0; j < 4; j++) {
+
+                MLAS_FLOAT32X4 Result = MlasMultiplyFloat32x4(Accumulators[r][j], AlphaBroadcast);
+
+                if (beta != 0.0f) {
+                    Result = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(c + j * 4), beta, Result);
+                }
+
+                MlasStoreFloat32x4(c + j * 4, Result);
+            }
+
+        } else {
+
+            float Buffer[MLAS_BLOCK_SPARSE_PANEL_N];
+
+            for (size_t j = 0; j < 4; j++) {
+                MlasStoreFloat32x4(Buffer + j * 4, MlasMultiplyFloat32x4(Accumulators[r][j], AlphaBroadcast));
+            }
+
+            for (size_t n = 0; n < CountN; n++) {
+                c[n] = (beta != 0.0f) ? Buffer[n] + beta * c[n] : Buffer[n];
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasBlockSparseSgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation C = alpha * A * B + beta * C with a block sparse B matrix.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scalar multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A, not transposed.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of matrix B packed by
+        MlasBlockSparseSgemmPackB.
+
+    beta - Supplies the scalar beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(K);
+
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    const size_t PanelCount = (N + MLAS_BLOCK_SPARSE_PANEL_N - 1) / MLAS_BLOCK_SPARSE_PANEL_N;
+    const size_t* PanelOffsets = reinterpret_cast<const size_t*>(PackedB);
+    const size_t BlockCount = PanelOffsets[PanelCount];
+    const uint32_t* RowIndices = reinterpret_cast<const uint32_t*>(PanelOffsets + PanelCount + 1);
+    const float* Values = reinterpret_cast<const float*>(
+        reinterpret_cast<const uint8_t*>(PackedB) + MlasBlockSparseSgemmValuesOffset(PanelCount, BlockCount));
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // nonzero blocks, then split the threads over the panels first so that
+    // each thread streams its own panels while they stay in the cache.
+    //
+
+    const double Complexity = double(M) * double(BlockCount) * double(MLAS_BLOCK_SPARSE_PANEL_N);
+
+    ptrdiff_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * GetMlasPlatform().MaximumThreadCount)) {
+        TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = GetMlasPlatform().MaximumThreadCount;
+    }
+
+    ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    const ptrdiff_t ThreadCountN = std::min(TargetThreadCount, ptrdiff_t(PanelCount));
+    const ptrdiff_t ThreadCountM = std::min(TargetThreadCount / ThreadCountN, ptrdiff_t(M));
+
+    MlasTrySimpleParallel(ThreadPool, ThreadCountM * ThreadCountN, [&](ptrdiff_t tid) {
+
+        size_t RangeStartM;
+        size_t RangeCountM;
+        size_t RangeStartP;
+        size_t RangeCountP;
+
+        MlasPartitionWork(tid / ThreadCountN, ThreadCountM, M, &RangeStartM, &RangeCountM);
+        MlasPartitionWork(tid % ThreadCountN, ThreadCountN, PanelCount, &RangeStartP, &RangeCountP);
+
+        for (size_t p = RangeStartP; p < RangeStartP + RangeCountP; p++) {
+
+            const size_t n = p * MLAS_BLOCK_SPARSE_PANEL_N;
+            const size_t CountN = std::min(N - n, size_t(MLAS_BLOCK_SPARSE_PANEL_N));
+            const size_t PanelBlockStart = PanelOffsets[p];
+            const size_t PanelBlockCount = PanelOffsets[p + 1] - PanelBlockStart;
+            const uint32_t* PanelRowIndices = RowIndices + PanelBlockStart;
+            const float* PanelValues = Values + PanelBlockStart * MLAS_BLOCK_SPARSE_PANEL_N;
+
+            size_t m = RangeStartM;
+            size_t CountM = RangeCountM;
+
+            while (CountM >= 4) {
+                MlasBlockSparseSgemmKernel<4>(A + m * lda, lda, PanelRowIndices, PanelValues, PanelBlockCount,
+                                              C + m * ldc + n, ldc, CountN, alpha, beta);
+                m += 4;
+                CountM -= 4;
+            }
+
+            while (CountM > 0) {
+                MlasBlockSparseSgemmKernel<1>(A + m * lda, lda, PanelRowIndices, PanelValues, PanelBlockCount,
+                                              C + m * ldc + n, ldc, CountN, alpha, beta);
+                m += 1;
+                CountM -= 1;
+            }
+        }
+    });
+}
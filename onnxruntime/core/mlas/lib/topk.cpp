@@ -0,0 +1,327 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    topk.cpp
+
+Abstract:
+
+    This module implements the selection of the K largest or smallest
+    elements of a row.
+
+    The row is scanned by blocks of 16 elements that are compared to a
+    running threshold with vector instructions, and only the elements of the
+    blocks with a value beyond the threshold are appended to a candidate
+    buffer. When the candidate buffer is full, it is reduced to the best K
+    candidates and the threshold is raised to the K-th candidate. For the
+    rows of a large vocabulary, most blocks are rejected by a few vector
+    compares once the threshold settles, and the final selection is a small
+    partial sort of the candidates.
+
+    The candidates are ordered by value then by index, so that the result
+    matches the selection of the TopK operator, which keeps the lower index
+    of equal values.
+
+--*/
+
+#include "mlasi.h"
+
+#include <algorithm>
+
+//
+// Define the minimum number of candidates buffered beyond the K selected
+// elements before the candidate buffer is reduced.
+//
+
+#define MLAS_TOPK_MINIMUM_EXTRA_CANDIDATES 1024
+
+//
+// Define the minimum number of candidates buffered beyond the K selected
+// elements before the first reduction of the candidate buffer.
+//
+
+#define MLAS_TOPK_INITIAL_EXTRA_CANDIDATES 64
+
+//
+// Define the number of elements compared to the threshold at a time.
+//
+
+#define MLAS_TOPK_BLOCK_SIZE 16
+
+size_t
+MLASCALL
+MlasTopKGetWorkspaceCount(
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of elements of the workspace used by
+    MlasTopK.
+
+Arguments:
+
+    K - Supplies the number of elements to select.
+
+Return Value:
+
+    Returns the number of elements of the workspace.
+
+--*/
+{
+    return K + std::max(K, size_t(MLAS_TOPK_MINIMUM_EXTRA_CANDIDATES));
+}
+
+template <bool Largest>
+struct MLAS_TOPK_ORDER {
+
+    //
+    // Returns true if the value is beyond the threshold.
+    //
+
+    static
+    MLAS_FORCEINLINE
+    bool
+    Passes(
+        float Value,
+        float Threshold
+        )
+    {
+        return Largest ? (Value > Threshold) : (Value < Threshold);
+    }
+
+    //
+    // Returns a non-zero vector if any element of the vector is beyond the
+    // threshold. NaN elements never pass.
+    //
+
+    static
+    MLAS_FORCEINLINE
+    MLAS_FLOAT32X4
+    Passes(
+        MLAS_FLOAT32X4 Vector,
+        MLAS_FLOAT32X4 Threshold
+        )
+    {
+        return Largest ? MlasGreaterThanFloat32x4(Vector, Threshold) : MlasGreaterThanFloat32x4(Threshold, Vector);
+    }
+};
+
+/*++
+
+Routine Description:
+
+    This routine reduces the candidate buffer to the best K candidates,
+    with the K-th candidate at the last position.
+
+Arguments:
+
+    Input - Supplies the row.
+
+    Candidates - Supplies the indices of the candidates.
+
+    Count - Supplies the number of candidates.
+
+    K - Supplies the number of candidates to keep.
+
+Return Value:
+
+    None.
+
+--*/
+template <bool Largest>
+void
+MlasTopKSelectCandidates(
+    const float* Input,
+    uint32_t* Candidates,
+    size_t Count,
+    size_t K
+    )
+{
+    std::nth_element(Candidates, Candidates + (K - 1), Candidates + Count,
+        [Input](uint32_t Lhs, uint32_t Rhs) {
+            return MLAS_TOPK_ORDER<Largest>::Passes(Input[Lhs], Input[Rhs]) ||
+                   (Input[Lhs] == Input[Rhs] && Lhs < Rhs);
+        });
+}
+
+template <bool Largest>
+bool
+MlasTopKKernel(
+    const float* Input,
+    size_t N,
+    size_t K,
+    bool Sorted,
+    float* Values,
+    int64_t* Indices,
+    uint32_t* Workspace
+    )
+{
+    constexpr size_t BlockSize = MLAS_TOPK_BLOCK_SIZE;
+
+    const size_t Capacity = MlasTopKGetWorkspaceCount(K);
+
+    //
+    // Reduce the candidates early at first, so that the threshold settles
+    // after a short prefix of the row, then let the limit grow to the
+    // capacity of the workspace as fewer blocks pass the threshold.
+    //
+
+    size_t Limit = std::min(Capacity, K + std::max(K, size_t(MLAS_TOPK_INITIAL_EXTRA_CANDIDATES)));
+
+    uint32_t* Candidates = Workspace;
+    size_t Count = 0;
+
+    float Threshold = Largest ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+    MLAS_FLOAT32X4 ThresholdVector = MlasBroadcastFloat32x4(Threshold);
+    const MLAS_FLOAT32X4 OneVector = MlasBroadcastFloat32x4(1.0f);
+
+    //
+    // Reduces the candidates to the best K and raises the threshold to the
+    // K-th candidate. A later element equal to the threshold loses to the
+    // K-th candidate by its higher index, so the strict compares are exact.
+    //
+
+    auto Reduce = [&]() {
+        MlasTopKSelectCandidates<Largest>(Input, Candidates, Count, K);
+        Count = K;
+        Threshold = Input[Candidates[K - 1]];
+        ThresholdVector = MlasBroadcastFloat32x4(Threshold);
+        Limit = std::min(Capacity, Limit * 2);
+    };
+
+    size_t n = 0;
+
+    while (n + BlockSize <= N) {
+
+        MLAS_FLOAT32X4 Mask = MLAS_TOPK_ORDER<Largest>::Passes(MlasLoadFloat32x4(Input + n), ThresholdVector);
+        Mask = MlasOrFloat32x4(Mask, MLAS_TOPK_ORDER<Largest>::Passes(MlasLoadFloat32x4(Input + n + 4), ThresholdVector));
+        Mask = MlasOrFloat32x4(Mask, MLAS_TOPK_ORDER<Largest>::Passes(MlasLoadFloat32x4(Input + n + 8), ThresholdVector));
+        Mask = MlasOrFloat32x4(Mask, MLAS_TOPK_ORDER<Largest>::Passes(MlasLoadFloat32x4(Input + n + 12), ThresholdVector));
+
+        if (MlasReduceMaximumFloat32x4(MlasAndFloat32x4(Mask, OneVector)) != 0.0f) {
+
+            if (Count + BlockSize > Limit) {
+                Reduce();
+            }
+
+            for (size_t i = n; i < n + BlockSize; i++) {
+                if (MLAS_TOPK_ORDER<Largest>::Passes(Input[i], Threshold)) {
+                    Candidates[Count++] = uint32_t(i);
+                }
+            }
+        }
+
+        n += BlockSize;
+    }
+
+    for (; n < N; n++) {
+
+        if (MLAS_TOPK_ORDER<Largest>::Passes(Input[n], Threshold)) {
+
+            if (Count == Limit) {
+                Reduce();
+                if (!MLAS_TOPK_ORDER<Largest>::Passes(Input[n], Threshold)) {
+                    continue;
+                }
+            }
+
+            Candidates[Count++] = uint32_t(n);
+        }
+    }
+
+    //
+    // The rows with fewer than K elements beyond the initial threshold, such
+    // as the rows of infinities or NaNs, are left to the caller.
+    //
+
+    if (Count < K) {
+        return false;
+    }
+
+    if (Count > K) {
+        MlasTopKSelectCandidates<Largest>(Input, Candidates, Count, K);
+    }
+
+    if (Sorted) {
+        std::sort(Candidates, Candidates + K,
+            [Input](uint32_t Lhs, uint32_t Rhs) {
+                return MLAS_TOPK_ORDER<Largest>::Passes(Input[Lhs], Input[Rhs]) ||
+                       (Input[Lhs] == Input[Rhs] && Lhs < Rhs);
+            });
+    }
+
+    for (size_t k = 0; k < K; k++) {
+
+        if (Values != nullptr) {
+            Values[k] = Input[Candidates[k]];
+        }
+
+        Indices[k] = int64_t(Candidates[k]);
+    }
+
+    return true;
+}
+
+bool
+MLASCALL
+MlasTopK(
+    const float* Input,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    float* Values,
+    int64_t* Indices,
+    uint32_t* Workspace
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the K largest or smallest elements of a row. Equal
+    values are ordered by their index.
+
+Arguments:
+
+    Input - Supplies the row.
+
+    N - Supplies the number of elements of the row, which must be less than
+        2^32.
+
+    K - Supplies the number of elements to select, which must be between 1
+        and N.
+
+    Largest - Supplies true to select the largest elements, else the smallest
+        elements are selected.
+
+    Sorted - Supplies true to order the selected elements, else the order is
+        unspecified.
+
+    Values - Optionally supplies the buffer of K elements that receives the
+        selected values.
+
+    Indices - Supplies the buffer of K elements that receives the indices of
+        the selected elements.
+
+    Workspace - Supplies a buffer of MlasTopKGetWorkspaceCount(K) elements.
+
+Return Value:
+
+    Returns false if the row has fewer than K elements that compare beyond
+    the infinity of the opposite sign, in which case the outputs are not
+    written and the caller selects the elements with a full ordering.
+
+--*/
+{
+    if (Largest) {
+        return MlasTopKKernel<true>(Input, N, K, Sorted, Values, Indices, Workspace);
+    } else {
+        return MlasTopKKernel<false>(Input, N, K, Sorted, Values, Indices, Workspace);
+    }
+}
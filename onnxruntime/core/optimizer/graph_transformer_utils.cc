@@ -426,7 +426,8 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
 #ifndef DISABLE_CONTRIB_OPS
       // Register the NCHWc layout transformer if supported by the platform.
       if (MlasNchwcGetBlockSize() > 1) {
-        transformers.emplace_back(std::make_unique<NchwcTransformer>());
+        transformers.emplace_back(std::make_unique<NchwcTransformer>(
+            session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConvWinograd, "0")));
       }
 
       auto cpu_registry = cpu_execution_provider.GetKernelRegistry();
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <deque>
 #include "core/graph/graph_utils.h"
 #include "core/optimizer/initializer.h"
@@ -13,7 +14,8 @@ namespace onnxruntime {
 
 class NchwcTransformerImpl {
  public:
-  NchwcTransformerImpl(Graph& graph) noexcept : graph_(graph) {}
+  NchwcTransformerImpl(Graph& graph, const std::string& conv_winograd) noexcept
+      : graph_(graph), conv_winograd_(conv_winograd) {}
 
   void Transform(Node& node);
   void Finalize(bool& modified);
@@ -119,6 +121,8 @@ class NchwcTransformerImpl {
                               const ONNX_NAMESPACE::TensorProto* filter_shape);
   Node& InsertReshape(NodeArg* input_arg, NodeArg* output_arg, bool split_channels);
 
+  bool IsWinogradConv(const Node& node, int64_t input_channels, int64_t output_channels, int64_t group_count,
+                      const ONNX_NAMESPACE::TensorProto& conv_W_tensor_proto) const;
   void TransformConv(Node& node);
   void TransformPool(Node& node);
   void TransformBinary(Node& node, bool add_node);
@@ -130,6 +134,7 @@ class NchwcTransformerImpl {
   void TrackTransposeFromNhwc(Node& node);
 
   Graph& graph_;
+  const std::string& conv_winograd_;
 
   // Stores a queue of nodes to be removed after walking through the graph.
   std::deque<NodeIndex> removed_nodes_;
@@ -320,6 +325,34 @@ void NchwcTransformerImpl::ConvPoolShapeInference(const Node& node,
   }
 }
 
+// Matches the selection of the Winograd algorithm by the NCHW Conv kernel, see kOrtSessionOptionsConvWinograd.
+bool NchwcTransformerImpl::IsWinogradConv(const Node& node, int64_t input_channels, int64_t output_channels,
+                                          int64_t group_count,
+                                          const ONNX_NAMESPACE::TensorProto& conv_W_tensor_proto) const {
+  if (conv_winograd_ != "1" && conv_winograd_ != "4" && conv_winograd_ != "6") {
+    return false;
+  }
+
+  if (conv_W_tensor_proto.dims(2) != 3 || conv_W_tensor_proto.dims(3) != 3 ||
+      group_count <= 0 || (output_channels % group_count) != 0) {
+    return false;
+  }
+
+  for (const char* attr_name : {"strides", "dilations"}) {
+    const auto* attr = graph_utils::GetNodeAttribute(node, attr_name);
+    if (attr != nullptr &&
+        std::any_of(attr->ints().begin(), attr->ints().end(), [](int64_t value) { return value != 1; })) {
+      return false;
+    }
+  }
+
+  const size_t filter_count = static_cast<size_t>(output_channels / group_count);
+  if (conv_winograd_ == "1") {
+    return MlasConvWinogradPreferredOutputTile(static_cast<size_t>(input_channels), filter_count) != 0;
+  }
+  return MlasConvWinogradPackFilterSize(static_cast<size_t>(conv_winograd_[0] - '0'), 1, 1, 1) != 0;
+}
+
 void NchwcTransformerImpl::TransformConv(Node& node) {
   auto& input_defs = node.MutableInputDefs();
   auto& output_defs = node.MutableOutputDefs();
@@ -344,6 +377,10 @@ void NchwcTransformerImpl::TransformConv(Node& node) {
     group_count = 1;
   }
 
+  if (IsWinogradConv(node, input_channels, output_channels, group_count, *conv_W_tensor_proto)) {
+    return;
+  }
+
   const size_t nchwc_block_size = MlasNchwcGetBlockSize();
   const int64_t nchwc_output_channels = (output_channels + nchwc_block_size - 1) & ~(nchwc_block_size - 1);
 
@@ -1223,7 +1260,7 @@ void NchwcTransformerImpl::Finalize(bool& modified) {
 }
 
 Status NchwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const {
-  NchwcTransformerImpl impl(graph);
+  NchwcTransformerImpl impl(graph, conv_winograd_);
   GraphViewer graph_viewer(graph);
 
   for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
@@ -16,10 +16,15 @@ and inserts nodes to reorder tensors as needed.
 */
 class NchwcTransformer : public GraphTransformer {
  public:
-  NchwcTransformer() noexcept : GraphTransformer("NchwcTransformer") {}
+  // conv_winograd is the value of kOrtSessionOptionsConvWinograd, the convolutions selected for the Winograd
+  // algorithm are left to the NCHW Conv kernel.
+  explicit NchwcTransformer(std::string conv_winograd = "0") noexcept
+      : GraphTransformer("NchwcTransformer"), conv_winograd_(std::move(conv_winograd)) {}
 
  private:
   Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+
+  const std::string conv_winograd_;
 };
 
 }  // namespace onnxruntime
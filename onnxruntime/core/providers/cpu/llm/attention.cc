@@ -3,9 +3,12 @@
 
 #include "core/providers/cpu/llm/attention.h"
 
+#include "contrib_ops/cpu/bert/attention_common.h"
 #include "core/common/common.h"
 #include "core/common/safeint.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
+#include "core/platform/env_var_utils.h"
 #include "core/platform/threadpool.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
@@ -91,6 +94,12 @@ inline void ComputeAttentionSoftcapInplace(MLFloat16* scores, int sequence_lengt
   }
 }
 
+template <typename T>
+AttentionBase<T>::AttentionBase(const OpKernelInfo& info) : OpKernel(info) {
+  l2_cache_size_ = Env::Default().GetL2CacheSize();
+  disable_flash_ = ParseEnvironmentVariableWithDefault<bool>(contrib::attention::kDisableFlashAttention, false);
+}
+
 template <typename T>
 Attention<T>::Attention(const OpKernelInfo& info) : AttentionBase<T>(info) {
   is_causal_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("is_causal", 0)) == 1;
@@ -673,6 +682,133 @@ void AttentionBase<T>::ComputeVxAttentionScore(T* output,                  // bu
       });
 }
 
+template <typename T>
+void AttentionBase<T>::ApplyFlashAttention(const T* Q,
+                                           const T* K,
+                                           const T* V,
+                                           const Tensor* past_key,
+                                           const Tensor* past_value,
+                                           Tensor* output,
+                                           Tensor* present_key,
+                                           Tensor* present_value,
+                                           const AttentionParameters& parameters,
+                                           ThreadPool* tp) const {
+  const size_t head_size = static_cast<size_t>(parameters.head_size);
+  const size_t v_head_size = static_cast<size_t>(parameters.v_head_size);
+  const size_t q_num_heads = static_cast<size_t>(parameters.q_num_heads);
+  const size_t kv_num_heads = static_cast<size_t>(parameters.kv_num_heads);
+  const size_t q_sequence_length = static_cast<size_t>(parameters.q_sequence_length);
+  const size_t kv_sequence_length = static_cast<size_t>(parameters.kv_sequence_length);
+  const size_t total_sequence_length = static_cast<size_t>(parameters.total_sequence_length);
+
+  MlasGQAFlashAttentionArgs<T> args;
+
+  if (present_key != nullptr) {
+    // Concatenate the past and the new K and V of each KV head. The present state is always BxNxTxH.
+    const size_t past_chunk_length = static_cast<size_t>(parameters.past_sequence_length) * head_size;
+    const size_t v_past_chunk_length = static_cast<size_t>(parameters.past_sequence_length) * v_head_size;
+    const T* past_key_data = past_key != nullptr ? past_key->Data<T>() : nullptr;
+    const T* past_value_data = past_value != nullptr ? past_value->Data<T>() : nullptr;
+    T* present_key_data = present_key->MutableData<T>();
+    T* present_value_data = present_value->MutableData<T>();
+
+    TensorOpCost unit_cost;
+    unit_cost.bytes_loaded = static_cast<double>(total_sequence_length * (head_size + v_head_size) * sizeof(T));
+    unit_cost.bytes_stored = unit_cost.bytes_loaded;
+    ThreadPool::TryParallelFor(
+        tp, SafeInt<ptrdiff_t>(parameters.batch_size) * kv_num_heads, unit_cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            std::ptrdiff_t batch_i = i / parameters.kv_num_heads;
+            std::ptrdiff_t head_i = i % parameters.kv_num_heads;
+            ConcatStateChunk(past_key_data, K, present_key_data,
+                             past_chunk_length, kv_sequence_length * head_size, total_sequence_length * head_size,
+                             kv_num_heads, head_size, batch_i, head_i, parameters.transpose_output);
+            ConcatStateChunk(past_value_data, V, present_value_data,
+                             v_past_chunk_length, kv_sequence_length * v_head_size,
+                             total_sequence_length * v_head_size,
+                             kv_num_heads, v_head_size, batch_i, head_i, parameters.transpose_output);
+          }
+        });
+
+    args.key = present_key_data;
+    args.key_batch_stride = kv_num_heads * total_sequence_length * head_size;
+    args.key_head_stride = total_sequence_length * head_size;
+    args.key_sequence_stride = head_size;
+    args.value = present_value_data;
+    args.value_batch_stride = kv_num_heads * total_sequence_length * v_head_size;
+    args.value_head_stride = total_sequence_length * v_head_size;
+    args.value_sequence_stride = v_head_size;
+  } else if (parameters.transpose_output) {
+    args.key = K;
+    args.key_batch_stride = kv_sequence_length * kv_num_heads * head_size;
+    args.key_head_stride = head_size;
+    args.key_sequence_stride = kv_num_heads * head_size;
+    args.value = V;
+    args.value_batch_stride = kv_sequence_length * kv_num_heads * v_head_size;
+    args.value_head_stride = v_head_size;
+    args.value_sequence_stride = kv_num_heads * v_head_size;
+  } else {
+    args.key = K;
+    args.key_batch_stride = kv_num_heads * kv_sequence_length * head_size;
+    args.key_head_stride = kv_sequence_length * head_size;
+    args.key_sequence_stride = head_size;
+    args.value = V;
+    args.value_batch_stride = kv_num_heads * kv_sequence_length * v_head_size;
+    args.value_head_stride = kv_sequence_length * v_head_size;
+    args.value_sequence_stride = v_head_size;
+  }
+
+  args.query = Q;
+  args.output = output->MutableData<T>();
+  if (parameters.transpose_output) {
+    args.query_batch_stride = q_sequence_length * q_num_heads * head_size;
+    args.query_head_stride = head_size;
+    args.query_sequence_stride = q_num_heads * head_size;
+    args.output_batch_stride = q_sequence_length * q_num_heads * v_head_size;
+    args.output_head_stride = v_head_size;
+    args.output_sequence_stride = q_num_heads * v_head_size;
+  } else {
+    args.query_batch_stride = q_num_heads * q_sequence_length * head_size;
+    args.query_head_stride = q_sequence_length * head_size;
+    args.query_sequence_stride = head_size;
+    args.output_batch_stride = q_num_heads * q_sequence_length * v_head_size;
+    args.output_head_stride = q_sequence_length * v_head_size;
+    args.output_sequence_stride = v_head_size;
+  }
+
+  std::vector<int> kv_sequence_lengths(parameters.batch_size, parameters.total_sequence_length);
+  std::vector<int> past_sequence_lengths(parameters.batch_size, parameters.past_sequence_length);
+
+  args.batch_size = parameters.batch_size;
+  args.num_heads = parameters.q_num_heads;
+  args.kv_num_heads = parameters.kv_num_heads;
+  // The query head h attends the KV head h % kv_num_heads, as in ComputeAttentionProbs.
+  args.kv_heads_interleaved = true;
+  args.q_sequence_length = parameters.q_sequence_length;
+  args.qk_head_size = parameters.head_size;
+  args.v_head_size = parameters.v_head_size;
+  args.scale = parameters.scale;
+  args.softcap = parameters.softcap;
+  args.is_causal = parameters.is_causal;
+  args.local_window_size = -1;
+  args.kv_sequence_lengths = kv_sequence_lengths.data();
+  args.past_sequence_lengths = past_sequence_lengths.data();
+  args.head_sink = nullptr;
+
+  // The tiles of K, V, the scores and the output of a group of query heads are sized to fit in the L2 cache,
+  // as in the flash attention of MultiHeadAttention.
+  const int group_size = parameters.q_num_heads / parameters.kv_num_heads;
+  const int kv_block_size = std::max(l2_cache_size_ / (static_cast<int>(sizeof(float)) * 4 *
+                                                       (parameters.head_size + parameters.v_head_size)),
+                                     1);
+  args.q_block_size = std::max(std::min(kv_block_size, parameters.head_size + parameters.v_head_size) / group_size, 1);
+  args.q_block_size = std::min(args.q_block_size, parameters.q_sequence_length);
+  args.kv_block_size = std::min(kv_block_size, parameters.total_sequence_length);
+
+  MlasGQAFlashAttention(&args, tp);
+}
+
 template <typename T>
 Status AttentionBase<T>::ApplyAttention(OpKernelContext* context,
                                         const T* Q,                            // Q data with shape BxNxSxH
@@ -698,6 +834,16 @@ Status AttentionBase<T>::ApplyAttention(OpKernelContext* context,
   T* present_value_data = present_value != nullptr ? present_value->MutableData<T>() : nullptr;
   T* output_qk_data = output_qk != nullptr ? output_qk->MutableData<T>() : nullptr;
 
+  // The attention probs take BxNxSxT elements, which is only worth materializing for a single query or when they
+  // are needed beyond the softmax. The causal mask is not softcapped before the softmax in the tiled version.
+  const bool causal = parameters.is_causal && parameters.q_sequence_length > 1;
+  if (parameters.q_sequence_length > 1 && !disable_flash_ && l2_cache_size_ > 0 &&
+      mask_index == nullptr && output_qk == nullptr && (past_key == nullptr) == (present_key == nullptr) &&
+      !(causal && parameters.softcap > 0.0f)) {
+    ApplyFlashAttention(Q, K, V, past_key, past_value, output, present_key, present_value, parameters, tp);
+    return Status::OK();
+  }
+
   // Compute the attention score.
   size_t bytes = SafeInt<size_t>(parameters.batch_size) * parameters.q_num_heads *
                  parameters.q_sequence_length * parameters.total_sequence_length * sizeof(T);
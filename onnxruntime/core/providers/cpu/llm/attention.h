@@ -12,7 +12,7 @@ namespace onnxruntime {
 template <typename T>
 class AttentionBase : public OpKernel {
  public:
-  AttentionBase(const OpKernelInfo& info) : OpKernel(info) {}
+  AttentionBase(const OpKernelInfo& info);
 
   Status ApplyAttention(OpKernelContext* context,
                         const T* Q,                                              // Q data with shape BxNxSxH
@@ -29,6 +29,18 @@ class AttentionBase : public OpKernel {
   ) const;
 
  protected:
+  // Computes the attention by tiles of K and V with an online softmax, without the BxNxSxT attention probs.
+  void ApplyFlashAttention(const T* Q,                                              // Q data with shape BxNxSxH
+                           const T* K,                                              // K data with shape BxNxLxH
+                           const T* V,                                              // V value with size BxNxLxH_v
+                           const Tensor* past_key,                                  // past K input tensor
+                           const Tensor* past_value,                                // past V input tensor
+                           Tensor* output,                                          // output tensor
+                           Tensor* present_key,                                     // present K output tensor
+                           Tensor* present_value,                                   // present V output tensor
+                           const attention_helper::AttentionParameters& parameters,  // attention parameters
+                           concurrency::ThreadPool* tp) const;
+
   void ComputeVxAttentionScore(T* output,                  // buffer for the result with size BxSxNxH_v
                                const T* attention_probs,   // Attention probs with size BxNxSxT
                                const T* V,                 // V value with size BxNxLxH_v
@@ -67,6 +79,9 @@ class AttentionBase : public OpKernel {
                       std::ptrdiff_t batch_i,
                       std::ptrdiff_t head_i,
                       bool transposed) const;
+
+  int l2_cache_size_;
+  bool disable_flash_;  // whether to materialize the attention probs of the prompt instead of tiling them
 };
 
 template <typename T>
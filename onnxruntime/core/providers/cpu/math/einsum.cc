@@ -43,6 +43,34 @@ Status Einsum::Compute(OpKernelContext* context) const {
   return DeviceCompute(context, inputs, allocator, tp);
 }
 
+EinsumOp::ContractionPath Einsum::GetContractionPath(EinsumComputePreprocessor& einsum_compute_preprocessor) const {
+  const auto& homogenized_input_dims = einsum_compute_preprocessor.GetHomogenizedInputDims();
+  if (homogenized_input_dims.size() < 3) {
+    return {};
+  }
+
+  std::vector<int64_t> key;
+  for (const auto& dims : homogenized_input_dims) {
+    key.insert(key.end(), dims.GetDims().begin(), dims.GetDims().end());
+  }
+
+  std::lock_guard<std::mutex> lock(contraction_paths_mutex_);
+  auto it = contraction_paths_.find(key);
+  if (it != contraction_paths_.end()) {
+    return it->second;
+  }
+
+  auto contraction_path = EinsumOp::FindContractionPath(
+      homogenized_input_dims, einsum_compute_preprocessor.GetMappedSubscriptIndicesToOutputindices());
+
+  // The inputs of a model with dynamic shapes may take many shapes - stop caching the paths past a limit
+  if (contraction_paths_.size() < kMaxCachedContractionPaths) {
+    contraction_paths_.emplace(std::move(key), contraction_path);
+  }
+
+  return contraction_path;
+}
+
 Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const Tensor*>& inputs,
                              AllocatorPtr allocator, concurrency::ThreadPool* tp) const {
   // EinsumComputePreprocessor section -
@@ -54,6 +82,9 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
   // Compute all required metadata to be used at Einsum compute time and return error status code if one was generated
   ORT_RETURN_IF_ERROR(einsum_compute_preprocessor.Run());
 
+  // The order in which the operands are contracted
+  const EinsumOp::ContractionPath contraction_path = GetContractionPath(einsum_compute_preprocessor);
+
   // EinsumComputeProcessor section -
   if (inputs[0]->IsDataType<float>()) {
     auto einsum_compute_processor = EinsumTypedComputeProcessor<float>(context, allocator,
@@ -66,6 +97,9 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    // Let the Gemm read the operands that only need a transpose of their matrices in place
+    einsum_compute_processor.SetDeviceGemmHelper(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Gemm<float>);
+    einsum_compute_processor.SetContractionPath(&contraction_path);
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<int32_t>()) {
     auto einsum_compute_processor = EinsumTypedComputeProcessor<int32_t>(context,
@@ -79,6 +113,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionPath(&contraction_path);
 
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<double>()) {
@@ -93,6 +128,9 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    // Let the Gemm read the operands that only need a transpose of their matrices in place
+    einsum_compute_processor.SetDeviceGemmHelper(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Gemm<double>);
+    einsum_compute_processor.SetContractionPath(&contraction_path);
     return einsum_compute_processor.Run();
   } else if (inputs[0]->IsDataType<int64_t>()) {
     auto einsum_compute_processor = EinsumTypedComputeProcessor<int64_t>(context,
@@ -105,6 +143,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
+    einsum_compute_processor.SetContractionPath(&contraction_path);
 
     return einsum_compute_processor.Run();
   }
@@ -9,6 +9,10 @@
 #include "einsum_utils/einsum_typed_compute_processor.h"
 #endif
 #include "einsum_utils/einsum_compute_preprocessor.h"
+#include "einsum_utils/einsum_contraction_path.h"
+
+#include <map>
+#include <mutex>
 
 namespace onnxruntime {
 
@@ -27,8 +31,19 @@ class Einsum : public OpKernel {
   virtual Status DeviceCompute(OpKernelContext* context, const std::vector<const Tensor*>& inputs,
                                AllocatorPtr allocator, concurrency::ThreadPool* tp) const;
 
+#ifndef SHARED_PROVIDER
+  // Returns the order in which the operands are contracted, which is searched the first time
+  // the homogenized dims of the operands are seen
+  EinsumOp::ContractionPath GetContractionPath(EinsumComputePreprocessor& einsum_compute_preprocessor) const;
+#endif
+
   std::string equation_;
   std::unique_ptr<EinsumEquationPreprocessor> einsum_equation_preprocessor_;
+
+  // The contraction paths searched so far, keyed by the homogenized dims of the operands
+  static constexpr size_t kMaxCachedContractionPaths = 64;
+  mutable std::mutex contraction_paths_mutex_;
+  mutable std::map<std::vector<int64_t>, EinsumOp::ContractionPath> contraction_paths_;
 };
 
 }  // namespace onnxruntime
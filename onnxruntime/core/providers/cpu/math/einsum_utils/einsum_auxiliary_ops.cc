@@ -47,6 +47,29 @@ Status MatMul(const T* input_1_data, const T* input_2_data, T* output_data,
   return Status::OK();
 }
 
+// CPU specific Gemm helper
+template <typename T>
+Status Gemm(bool trans_a, bool trans_b, const T* input_1_data, const T* input_2_data, T* output_data,
+            size_t left_stride, size_t right_stride, size_t output_stride,
+            size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
+            void* /*einsum_cuda_assets*/) {
+  for (size_t i = 0; i < num_batches; ++i) {
+    math::Gemm<T, concurrency::ThreadPool>(
+        trans_a ? CblasTrans : CblasNoTrans,
+        trans_b ? CblasTrans : CblasNoTrans,
+        static_cast<ptrdiff_t>(M),
+        static_cast<ptrdiff_t>(N),
+        static_cast<ptrdiff_t>(K),
+        static_cast<T>(1),
+        input_1_data + i * left_stride,
+        input_2_data + i * right_stride,
+        static_cast<T>(0),
+        output_data + i * output_stride, tp);
+  }
+
+  return Status::OK();
+}
+
 // CPU specific ReduceSum helper
 template <typename T>
 std::unique_ptr<Tensor> ReduceSum(const Tensor& input, gsl::span<const int64_t> reduce_axes,
@@ -345,6 +368,39 @@ std::unique_ptr<Tensor> MatMul(const Tensor& input_1, const gsl::span<const int6
   return output;
 }
 
+template <typename T>
+std::unique_ptr<Tensor> Gemm(const Tensor& input_1, const gsl::span<const int64_t>& input_1_shape_override, bool trans_1,
+                             const Tensor& input_2, const gsl::span<const int64_t>& input_2_shape_override, bool trans_2,
+                             AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
+                             const DeviceHelpers::Gemm<T>& device_gemm_func) {
+  // Sanity checks before the actual Gemm
+  ORT_ENFORCE(input_1.DataType() == input_2.DataType(), "Data types of the inputs must match for Gemm");
+  ORT_ENFORCE(input_1_shape_override.size() == 3 && input_2_shape_override.size() == 3, "Only 1 batch dimension is allowed for Gemm");
+  ORT_ENFORCE(input_1_shape_override[0] == input_2_shape_override[0], "Batch dimension should match for Gemm");
+  ORT_ENFORCE(input_1_shape_override[2] == input_2_shape_override[1], "Incompatible matrix dimensions for Gemm");
+
+  size_t batches = static_cast<size_t>(input_1_shape_override[0]);
+  size_t M = static_cast<size_t>(input_1_shape_override[1]);
+  size_t K = static_cast<size_t>(input_1_shape_override[2]);
+  size_t N = static_cast<size_t>(input_2_shape_override[2]);
+
+  TensorShapeVector output_dims{static_cast<int64_t>(batches), static_cast<int64_t>(M), static_cast<int64_t>(N)};
+
+  // Pass in allocator as that will be used as an allocator deleter by the framework
+  // and it will de-allocate the memory for this intermediate tensor when it goes out of scope
+  std::unique_ptr<Tensor> output = std::make_unique<Tensor>(input_1.DataType(), output_dims, allocator);
+
+  auto status = device_gemm_func(trans_1, trans_2, input_1.Data<T>(), input_2.Data<T>(), output->MutableData<T>(),
+                                 M * K, K * N, M * N, batches, M, K, N, tp, einsum_cuda_assets);
+
+  if (!status.IsOK()) {
+    ORT_THROW(ONNXRUNTIME, FAIL, "Einsum op: Exception during Gemm operation: ",
+              status.ErrorMessage());
+  }
+
+  return output;
+}
+
 template <typename T>
 std::unique_ptr<Tensor> ReduceSum(const Tensor& input, const TensorShape& input_shape_override,
                                   gsl::span<const int64_t> reduce_axes, AllocatorPtr allocator,
@@ -368,6 +424,18 @@ template std::unique_ptr<Tensor> MatMul<float>(
     AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
     const DeviceHelpers::MatMul<float>& device_matmul_func);
 
+template Status DeviceHelpers::CpuDeviceHelpers::Gemm<float>(
+    bool trans_a, bool trans_b, const float* input_1_data, const float* input_2_data, float* output_data,
+    size_t left_stride, size_t right_stride, size_t output_stride,
+    size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
+    void* einsum_cuda_assets);
+
+template std::unique_ptr<Tensor> Gemm<float>(
+    const Tensor& input_1, const gsl::span<const int64_t>& input_1_shape_override, bool trans_1,
+    const Tensor& input_2, const gsl::span<const int64_t>& input_2_shape_override, bool trans_2,
+    AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
+    const DeviceHelpers::Gemm<float>& device_gemm_func);
+
 template std::unique_ptr<Tensor> DeviceHelpers::CpuDeviceHelpers::ReduceSum<float>(
     const Tensor& input, gsl::span<const int64_t> reduce_axes,
     bool keep_dims, AllocatorPtr allocator,
@@ -417,6 +485,18 @@ template std::unique_ptr<Tensor> MatMul<double>(
     AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
     const DeviceHelpers::MatMul<double>& device_matmul_func);
 
+template Status DeviceHelpers::CpuDeviceHelpers::Gemm<double>(
+    bool trans_a, bool trans_b, const double* input_1_data, const double* input_2_data, double* output_data,
+    size_t left_stride, size_t right_stride, size_t output_stride,
+    size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
+    void* einsum_cuda_assets);
+
+template std::unique_ptr<Tensor> Gemm<double>(
+    const Tensor& input_1, const gsl::span<const int64_t>& input_1_shape_override, bool trans_1,
+    const Tensor& input_2, const gsl::span<const int64_t>& input_2_shape_override, bool trans_2,
+    AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
+    const DeviceHelpers::Gemm<double>& device_gemm_func);
+
 template std::unique_ptr<Tensor> DeviceHelpers::CpuDeviceHelpers::ReduceSum<double>(
     const Tensor& input, gsl::span<const int64_t> reduce_axes,
     bool keep_dims, AllocatorPtr allocator,
@@ -39,6 +39,15 @@ using MatMul = std::function<Status(const T* input_1_data, const T* input_2_data
                                     size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
                                     void* einsum_cuda_assets)>;
 
+// Gemm op - Multiplies two inputs of shapes [num_batches, M, K] and [num_batches, K, N]
+// The matrices of the first input are stored as [K, M] if `trans_a` is set, and those of the second input are
+// stored as [N, K] if `trans_b` is set
+template <typename T>
+using Gemm = std::function<Status(bool trans_a, bool trans_b, const T* input_1_data, const T* input_2_data,
+                                  T* output_data, size_t left_stride, size_t right_stride, size_t output_stride,
+                                  size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
+                                  void* einsum_cuda_assets)>;
+
 // ReduceSum op - Reduces along `reduce_axes`
 template <typename T>
 using ReduceSum = std::function<std::unique_ptr<Tensor>(const Tensor& input, gsl::span<const int64_t> reduce_axes,
@@ -72,6 +81,12 @@ Status MatMul(const T* input_1_data, const T* input_2_data, T* output_data,
               size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
               void* einsum_cuda_assets);
 
+template <typename T>
+Status Gemm(bool trans_a, bool trans_b, const T* input_1_data, const T* input_2_data, T* output_data,
+            size_t left_stride, size_t right_stride, size_t output_stride,
+            size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
+            void* einsum_cuda_assets);
+
 template <typename T>
 std::unique_ptr<Tensor> ReduceSum(const Tensor& input, gsl::span<const int64_t> reduce_axes,
                                   bool keep_dims, AllocatorPtr allocator,
@@ -101,6 +116,14 @@ std::unique_ptr<Tensor> MatMul(const Tensor& input_1, const gsl::span<const int6
                                AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
                                const DeviceHelpers::MatMul<T>& device_matmul_func);
 
+// Same as MatMul, with the matrices of either input stored transposed as described by DeviceHelpers::Gemm
+// The shape overrides are the shapes of the untransposed inputs
+template <typename T>
+std::unique_ptr<Tensor> Gemm(const Tensor& input_1, const gsl::span<const int64_t>& input_1_shape_override, bool trans_1,
+                             const Tensor& input_2, const gsl::span<const int64_t>& input_2_shape_override, bool trans_2,
+                             AllocatorPtr allocator, concurrency::ThreadPool* tp, void* einsum_cuda_assets,
+                             const DeviceHelpers::Gemm<T>& device_gemm_func);
+
 // Thin wrapper over the ReduceSum op
 template <typename T>
 std::unique_ptr<Tensor> ReduceSum(const Tensor& input, const TensorShape& input_shape_override,
@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "einsum_contraction_path.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+
+namespace onnxruntime {
+
+namespace EinsumOp {
+
+namespace {
+
+// A set of subscript indices, one bit per subscript index
+using SubscriptMask = uint64_t;
+
+// Estimates the cost of the pair-wise contractions from the dim values of the subscript indices
+class ContractionCostModel {
+ public:
+  ContractionCostModel(std::vector<double> dim_values, SubscriptMask output_mask)
+      : dim_values_(std::move(dim_values)), output_mask_(output_mask) {}
+
+  // Number of elements of an operand with the given subscript indices
+  double Size(SubscriptMask mask) const {
+    double size = 1.0;
+    for (size_t i = 0; mask != 0; ++i, mask >>= 1) {
+      if (mask & 1) {
+        size *= dim_values_[i];
+      }
+    }
+    return size;
+  }
+
+  // Subscript indices of the result of contracting two operands, given the subscript indices of the operands
+  // that remain to be contracted
+  SubscriptMask ResultMask(SubscriptMask left, SubscriptMask right, SubscriptMask remaining) const {
+    return (left | right) & (output_mask_ | remaining);
+  }
+
+  // Number of multiply-adds of contracting two operands: one per combination of their subscript indices
+  double Cost(SubscriptMask left, SubscriptMask right) const {
+    return Size(left | right);
+  }
+
+  // Total cost of a contraction path
+  double PathCost(std::vector<SubscriptMask> masks, const ContractionPath& path) const {
+    std::vector<bool> contracted(masks.size() + path.size(), false);
+    double cost = 0.0;
+    for (const auto& [left, right] : path) {
+      contracted[left] = true;
+      contracted[right] = true;
+      SubscriptMask remaining = 0;
+      for (size_t i = 0; i < masks.size(); ++i) {
+        if (!contracted[i]) {
+          remaining |= masks[i];
+        }
+      }
+      cost += Cost(masks[left], masks[right]);
+      masks.push_back(ResultMask(masks[left], masks[right], remaining));
+    }
+    return cost;
+  }
+
+ private:
+  std::vector<double> dim_values_;
+  SubscriptMask output_mask_;
+};
+
+// Searches all the contraction trees of the operands by dynamic programming over the subsets of the operands
+ContractionPath FindOptimalContractionPath(const ContractionCostModel& model, const std::vector<SubscriptMask>& masks) {
+  const size_t num_inputs = masks.size();
+  const size_t num_subsets = size_t{1} << num_inputs;
+  const size_t all_inputs = num_subsets - 1;
+
+  std::vector<SubscriptMask> subset_labels(num_subsets, 0);
+  for (size_t subset = 1; subset < num_subsets; ++subset) {
+    const size_t lowest = subset & (~subset + 1);
+    size_t input = 0;
+    while ((size_t{1} << input) != lowest) {
+      ++input;
+    }
+    subset_labels[subset] = subset_labels[subset ^ lowest] | masks[input];
+  }
+
+  // the subscript indices of the result of contracting a subset of the operands
+  std::vector<SubscriptMask> subset_result(num_subsets, 0);
+  for (size_t subset = 1; subset < num_subsets; ++subset) {
+    subset_result[subset] = model.ResultMask(subset_labels[subset], 0, subset_labels[all_inputs ^ subset]);
+  }
+  for (size_t input = 0; input < num_inputs; ++input) {
+    subset_result[size_t{1} << input] = masks[input];
+  }
+
+  std::vector<double> cost(num_subsets, std::numeric_limits<double>::infinity());
+  std::vector<size_t> best_split(num_subsets, 0);
+  for (size_t input = 0; input < num_inputs; ++input) {
+    cost[size_t{1} << input] = 0.0;
+  }
+
+  // subsets are visited in increasing order, so that all the proper subsets of a subset are already visited
+  for (size_t subset = 1; subset < num_subsets; ++subset) {
+    const size_t lowest = subset & (~subset + 1);
+    if (subset == lowest) {
+      continue;
+    }
+    // enumerate the splits where the left part holds the lowest operand, to visit each split once
+    const size_t rest = subset ^ lowest;
+    for (size_t part = rest;; part = (part - 1) & rest) {
+      const size_t left = part | lowest;
+      const size_t right = subset ^ left;
+      if (right != 0) {
+        const double split_cost = cost[left] + cost[right] + model.Cost(subset_result[left], subset_result[right]);
+        if (split_cost < cost[subset]) {
+          cost[subset] = split_cost;
+          best_split[subset] = left;
+        }
+      }
+      if (part == 0) {
+        break;
+      }
+    }
+  }
+
+  // convert the contraction tree to a path
+  ContractionPath path;
+  path.reserve(num_inputs - 1);
+  std::vector<size_t> operand_of_subset(num_subsets, 0);
+  for (size_t input = 0; input < num_inputs; ++input) {
+    operand_of_subset[size_t{1} << input] = input;
+  }
+
+  std::vector<std::pair<size_t, bool>> stack{{all_inputs, false}};
+  while (!stack.empty()) {
+    auto [subset, expanded] = stack.back();
+    stack.pop_back();
+    if ((subset & (subset - 1)) == 0) {
+      continue;
+    }
+    const size_t left = best_split[subset];
+    const size_t right = subset ^ left;
+    if (!expanded) {
+      stack.push_back({subset, true});
+      stack.push_back({right, false});
+      stack.push_back({left, false});
+    } else {
+      path.emplace_back(operand_of_subset[left], operand_of_subset[right]);
+      operand_of_subset[subset] = num_inputs + path.size() - 1;
+    }
+  }
+
+  return path;
+}
+
+// Repeatedly contracts the pair of operands that shrinks the total size of the operands the most. Pairs without
+// common subscript indices (outer products) come last.
+ContractionPath FindGreedyContractionPath(const ContractionCostModel& model, const std::vector<SubscriptMask>& masks) {
+  std::vector<std::pair<size_t, SubscriptMask>> operands;
+  operands.reserve(masks.size());
+  for (size_t input = 0; input < masks.size(); ++input) {
+    operands.emplace_back(input, masks[input]);
+  }
+
+  ContractionPath path;
+  path.reserve(masks.size() - 1);
+
+  while (operands.size() > 1) {
+    size_t best_left = 0;
+    size_t best_right = 1;
+    bool best_is_outer = true;
+    double best_score = std::numeric_limits<double>::infinity();
+    double best_cost = std::numeric_limits<double>::infinity();
+
+    for (size_t left = 0; left < operands.size(); ++left) {
+      for (size_t right = left + 1; right < operands.size(); ++right) {
+        SubscriptMask remaining = 0;
+        for (size_t other = 0; other < operands.size(); ++other) {
+          if (other != left && other != right) {
+            remaining |= operands[other].second;
+          }
+        }
+
+        const SubscriptMask left_mask = operands[left].second;
+        const SubscriptMask right_mask = operands[right].second;
+        const bool is_outer = (left_mask & right_mask) == 0;
+        const double score = model.Size(model.ResultMask(left_mask, right_mask, remaining)) -
+                             model.Size(left_mask) - model.Size(right_mask);
+        const double cost = model.Cost(left_mask, right_mask);
+
+        if (std::make_tuple(is_outer, score, cost) < std::make_tuple(best_is_outer, best_score, best_cost)) {
+          best_left = left;
+          best_right = right;
+          best_is_outer = is_outer;
+          best_score = score;
+          best_cost = cost;
+        }
+      }
+    }
+
+    SubscriptMask remaining = 0;
+    for (size_t other = 0; other < operands.size(); ++other) {
+      if (other != best_left && other != best_right) {
+        remaining |= operands[other].second;
+      }
+    }
+
+    const SubscriptMask result = model.ResultMask(operands[best_left].second, operands[best_right].second, remaining);
+    path.emplace_back(operands[best_left].first, operands[best_right].first);
+
+    operands.erase(operands.begin() + best_right);
+    operands.erase(operands.begin() + best_left);
+    operands.emplace_back(masks.size() + path.size() - 1, result);
+  }
+
+  return path;
+}
+
+}  // namespace
+
+ContractionPath FindContractionPath(const std::vector<TensorShape>& homogenized_input_dims,
+                                    const std::vector<int64_t>& subscript_indices_to_output_indices) {
+  const size_t num_inputs = homogenized_input_dims.size();
+  const size_t num_subscript_indices = subscript_indices_to_output_indices.size();
+
+  // the order doesn't matter for 2 operands
+  if (num_inputs < 3 || num_subscript_indices > std::numeric_limits<SubscriptMask>::digits) {
+    return {};
+  }
+
+  std::vector<double> dim_values(num_subscript_indices, 1.0);
+  std::vector<SubscriptMask> masks(num_inputs, 0);
+  for (size_t input = 0; input < num_inputs; ++input) {
+    const auto dims = homogenized_input_dims[input].GetDims();
+    for (size_t i = 0; i < num_subscript_indices; ++i) {
+      // empty operands are left to the default order
+      if (dims[i] == 0) {
+        return {};
+      }
+      // dims with a value of 1 (missing or broadcasted) don't take part in the contractions
+      if (dims[i] > 1) {
+        masks[input] |= SubscriptMask{1} << i;
+        dim_values[i] = static_cast<double>(dims[i]);
+      }
+    }
+  }
+
+  SubscriptMask output_mask = 0;
+  for (size_t i = 0; i < num_subscript_indices; ++i) {
+    if (subscript_indices_to_output_indices[i] != -1) {
+      output_mask |= SubscriptMask{1} << i;
+    }
+  }
+
+  // the subscript indices that only one operand has and that are not in the output are reduced up front
+  for (size_t input = 0; input < num_inputs; ++input) {
+    SubscriptMask others = output_mask;
+    for (size_t other = 0; other < num_inputs; ++other) {
+      if (other != input) {
+        others |= masks[other];
+      }
+    }
+    masks[input] &= others;
+  }
+
+  ContractionCostModel model(std::move(dim_values), output_mask);
+
+  ContractionPath path = num_inputs <= kMaxOptimalContractionPathInputs ? FindOptimalContractionPath(model, masks)
+                                                                         : FindGreedyContractionPath(model, masks);
+
+  ContractionPath left_to_right;
+  left_to_right.reserve(num_inputs - 1);
+  left_to_right.emplace_back(0, 1);
+  for (size_t input = 2; input < num_inputs; ++input) {
+    left_to_right.emplace_back(num_inputs + input - 2, input);
+  }
+
+  if (path == left_to_right || model.PathCost(masks, path) >= model.PathCost(masks, left_to_right)) {
+    return {};
+  }
+
+  return path;
+}
+
+}  // namespace EinsumOp
+
+}  // namespace onnxruntime
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This module hosts the search of the order in which the operands of an Einsum equation are contracted pair-wise.
+// See numpy.einsum_path and opt_einsum for the background.
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#ifndef SHARED_PROVIDER
+#include "core/framework/tensor_shape.h"
+#endif
+
+namespace onnxruntime {
+
+namespace EinsumOp {
+
+// The pairs of operands contracted at each step. Operands are numbered from 0 in input order, and the result of
+// step 's' is numbered 'num_inputs + s'. Each operand is contracted once, and the last step produces the output.
+// (e.g.) for 3 inputs, the left-to-right order is {{0, 1}, {3, 2}}
+using ContractionPath = std::vector<std::pair<size_t, size_t>>;
+
+#ifndef SHARED_PROVIDER
+// The number of operands up to which the contraction path is searched exhaustively. The search is greedy beyond it.
+constexpr size_t kMaxOptimalContractionPathInputs = 8;
+
+// Finds the contraction path of the operands that minimizes the number of multiply-adds.
+// 'homogenized_input_dims' holds the dims of each operand in the homogenized axes order (one axis per subscript
+// index, with a dim value of 1 if the operand doesn't have the subscript index).
+// 'subscript_indices_to_output_indices' holds -1 for each subscript index that is not in the output.
+// The subscript indices that only one operand has and that are not in the output are assumed to be reduced
+// before the pair-wise contractions.
+// Returns an empty path if contracting the operands from left to right is as cheap as the best path found.
+ContractionPath FindContractionPath(const std::vector<TensorShape>& homogenized_input_dims,
+                                    const std::vector<int64_t>& subscript_indices_to_output_indices);
+#endif
+
+}  // namespace EinsumOp
+
+}  // namespace onnxruntime
@@ -204,20 +204,39 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
     left_permutation.push_back(onnxruntime::narrow<size_t>(a));
   }
   left_permutation.insert(left_permutation.end(), ro.begin(), ro.end());
-  if (EinsumOp::IsTransposeRequired(current_left ? current_left->Shape().NumDimensions() : left_dims.size(),
-                                    left_permutation)) {
-    if (current_left && IsTransposeReshapeForEinsum(left_permutation,
-                                                    current_left->Shape().GetDims(),
-                                                    reshaped_dims)) {
+
+  // If the device supports a transposed Gemm, the left operand may also be in the order [lro, reduce_dims, lo, ro]
+  InlinedVector<size_t> left_transposed_permutation;
+  if (device_gemm_func_) {
+    left_transposed_permutation.reserve(left_permutation.size());
+    left_transposed_permutation.insert(left_transposed_permutation.end(), lro.begin(), lro.end());
+    for (auto& a : reduce_dims) {
+      left_transposed_permutation.push_back(onnxruntime::narrow<size_t>(a));
+    }
+    left_transposed_permutation.insert(left_transposed_permutation.end(), lo.begin(), lo.end());
+    left_transposed_permutation.insert(left_transposed_permutation.end(), ro.begin(), ro.end());
+  }
+
+  bool trans_left = false;
+  const auto current_left_dims = current_left ? current_left->Shape().GetDims() : left_dims;
+  if (EinsumOp::IsTransposeRequired(current_left_dims.size(), left_permutation)) {
+    if (IsTransposeReshapeForEinsum(left_permutation, current_left_dims, reshaped_dims)) {
       // This can be done because current_* tensors (if they exist) and output tensors are
       // intermediate tensors and cannot be input tensors to the Einsum node itself
-      // (which are immutable).
+      // (which are immutable). The input tensors are read through the MatMul shape overrides as is.
       // Covered by ExplicitEinsumAsTensorContractionReshapeLeft.
-      current_left->Reshape(reshaped_dims);
+      if (current_left) {
+        current_left->Reshape(reshaped_dims);
+      }
+    } else if (device_gemm_func_ &&
+               IsTransposeReshapeForEinsum(left_transposed_permutation, current_left_dims, reshaped_dims)) {
+      // The Gemm below reads the matrices of the left operand transposed
+      // Covered by ExplicitEinsumAsMatmulNhcwTransposeA, ExplicitEinsumWithContractionPath_TransposedOperands_double.
+      trans_left = true;
     } else {
       // Covered by ExplicitEinsumAsTensorContraction, DiagonalWithMatmul, ...
       current_left = EinsumOp::Transpose(current_left ? *current_left : left,
-                                         current_left ? current_left->Shape().GetDims() : left_dims,
+                                         current_left_dims,
                                          left_permutation, allocator_, einsum_ep_assets_,
                                          device_transpose_func_);
     }
@@ -233,18 +252,37 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
   }
   right_permutation.insert(right_permutation.end(), ro.begin(), ro.end());
   right_permutation.insert(right_permutation.end(), lo.begin(), lo.end());
-  if (EinsumOp::IsTransposeRequired(current_right ? current_right->Shape().GetDims().size() : right_dims.size(),
-                                    right_permutation)) {
-    if (current_right && IsTransposeReshapeForEinsum(right_permutation,
-                                                     current_right->Shape().GetDims(),
-                                                     reshaped_dims)) {
+
+  // If the device supports a transposed Gemm, the right operand may also be in the order [lro, ro, reduce_dims, lo]
+  InlinedVector<size_t> right_transposed_permutation;
+  if (device_gemm_func_) {
+    right_transposed_permutation.reserve(right_permutation.size());
+    right_transposed_permutation.insert(right_transposed_permutation.end(), lro.begin(), lro.end());
+    right_transposed_permutation.insert(right_transposed_permutation.end(), ro.begin(), ro.end());
+    for (auto& a : reduce_dims) {
+      right_transposed_permutation.push_back(onnxruntime::narrow<size_t>(a));
+    }
+    right_transposed_permutation.insert(right_transposed_permutation.end(), lo.begin(), lo.end());
+  }
+
+  bool trans_right = false;
+  const auto current_right_dims = current_right ? current_right->Shape().GetDims() : right_dims;
+  if (EinsumOp::IsTransposeRequired(current_right_dims.size(), right_permutation)) {
+    if (IsTransposeReshapeForEinsum(right_permutation, current_right_dims, reshaped_dims)) {
       // See note following the previous call of function IsTransposeReshapeForEinsum.
       // Covered by ExplicitEinsumAsBatchedMatmulWithBroadcasting_1, ExplicitEinsumAsMatmul_2, ...
-      current_right->Reshape(reshaped_dims);
+      if (current_right) {
+        current_right->Reshape(reshaped_dims);
+      }
+    } else if (device_gemm_func_ &&
+               IsTransposeReshapeForEinsum(right_transposed_permutation, current_right_dims, reshaped_dims)) {
+      // The Gemm below reads the matrices of the right operand transposed
+      // (the right operand of a step of a contraction path may hold subscript indices seen before those of the left)
+      trans_right = true;
     } else {
       // Covered by DiagonalWithMatmul, ExplicitEinsumAsBatchedMatmul, ...
       current_right = EinsumOp::Transpose(current_right ? *current_right : right,
-                                          current_right ? current_right->Shape().GetDims() : right_dims,
+                                          current_right_dims,
                                           right_permutation, allocator_, einsum_ep_assets_,
                                           device_transpose_func_);
     }
@@ -306,9 +344,16 @@ std::unique_ptr<Tensor> EinsumTypedComputeProcessor<T>::PairwiseOperandProcess(c
   }
 
   // Multiply the mutated inputs
-  auto output = EinsumOp::MatMul<T>(current_left ? *current_left : left, TensorShapeVector{lro_size, lo_size, reduced_size},
-                                    current_right ? *current_right : right, TensorShapeVector{lro_size, reduced_size, ro_size},
-                                    allocator_, tp_, einsum_ep_assets_, device_matmul_func_);
+  std::unique_ptr<Tensor> output;
+  if (trans_left || trans_right) {
+    output = EinsumOp::Gemm<T>(current_left ? *current_left : left, TensorShapeVector{lro_size, lo_size, reduced_size}, trans_left,
+                               current_right ? *current_right : right, TensorShapeVector{lro_size, reduced_size, ro_size}, trans_right,
+                               allocator_, tp_, einsum_ep_assets_, device_gemm_func_);
+  } else {
+    output = EinsumOp::MatMul<T>(current_left ? *current_left : left, TensorShapeVector{lro_size, lo_size, reduced_size},
+                                 current_right ? *current_right : right, TensorShapeVector{lro_size, reduced_size, ro_size},
+                                 allocator_, tp_, einsum_ep_assets_, device_matmul_func_);
+  }
 
   output->Reshape(output_dims);
 
@@ -343,8 +388,110 @@ void EinsumTypedComputeProcessor<T>::SetDeviceHelpers(const EinsumOp::DeviceHelp
   device_data_copy_func_ = device_data_copy_func;
 }
 
+template <typename T>
+void EinsumTypedComputeProcessor<T>::SetDeviceGemmHelper(const EinsumOp::DeviceHelpers::Gemm<T>& device_gemm_func) {
+  device_gemm_func_ = device_gemm_func;
+}
+
+template <typename T>
+void EinsumTypedComputeProcessor<T>::SetContractionPath(const EinsumOp::ContractionPath* contraction_path) {
+  contraction_path_ = contraction_path;
+}
+
+template <typename T>
+Status EinsumTypedComputeProcessor<T>::ContractAlongPath(const EinsumOp::ContractionPath& contraction_path) {
+  const std::vector<int64_t>& subscript_indices_to_output_indices =
+      einsum_compute_preprocessor_.GetMappedSubscriptIndicesToOutputindices();
+
+  auto& preprocessed_inputs = einsum_compute_preprocessor_.GetPreprocessedInputTensors();
+
+  const auto& raw_inputs = einsum_compute_preprocessor_.GetRawInputTensors();
+
+  const auto& homogenized_input_dims = einsum_compute_preprocessor_.GetHomogenizedInputDims();
+
+  const size_t num_subscript_labels = onnxruntime::narrow<size_t>(einsum_compute_preprocessor_.GetNumSubscriptIndices());
+
+  const size_t num_inputs = raw_inputs.size();
+
+  // The operands are the inputs followed by the result of each step of the path
+  // An operand is released as soon as it is contracted
+  std::vector<std::unique_ptr<const Tensor>> owned_operands(num_inputs + contraction_path.size());
+  std::vector<const Tensor*> operands(num_inputs + contraction_path.size(), nullptr);
+  std::vector<TensorShape> operand_shapes(num_inputs + contraction_path.size());
+
+  // Pre-process each input so as to reduce any dims that only it has (and that are not in the output)
+  for (size_t input = 0; input < num_inputs; ++input) {
+    const auto input_dims = homogenized_input_dims[input].GetDims();
+
+    TensorShapeVector reduced_dims;
+    reduced_dims.reserve(num_subscript_labels);  // num_subscript_labels is the upper bound. No harm in over-reserving.
+    for (size_t dim = 0; dim < num_subscript_labels; ++dim) {
+      if (input_dims[dim] <= 1 || subscript_indices_to_output_indices[dim] != -1) {
+        continue;
+      }
+      bool is_exclusive = true;
+      for (size_t other = 0; other < num_inputs && is_exclusive; ++other) {
+        is_exclusive = other == input || homogenized_input_dims[other][dim] == 1;
+      }
+      if (is_exclusive) {
+        reduced_dims.push_back(static_cast<int64_t>(dim));
+      }
+    }
+
+    const Tensor& input_tensor = preprocessed_inputs[input] ? *preprocessed_inputs[input] : *raw_inputs[input];
+    if (reduced_dims.size() != 0) {
+      owned_operands[input] = EinsumOp::ReduceSum<T>(input_tensor, input_dims, reduced_dims, allocator_, tp_,
+                                                     einsum_ep_assets_, device_reduce_sum_func_);
+      operands[input] = owned_operands[input].get();
+      operand_shapes[input] = operands[input]->Shape();
+    } else {
+      operands[input] = &input_tensor;
+      operand_shapes[input] = homogenized_input_dims[input];
+    }
+  }
+
+  for (size_t step = 0; step < contraction_path.size(); ++step) {
+    const auto [left, right] = contraction_path[step];
+    const size_t result = num_inputs + step;
+
+    // Reduce the dims that none of the operands remaining after this step has (and that are not in the output)
+    TensorShapeVector reduced_dims;
+    reduced_dims.reserve(num_subscript_labels);  // num_subscript_labels is the upper bound. No harm in over-reserving.
+    for (size_t dim = 0; dim < num_subscript_labels; ++dim) {
+      if (subscript_indices_to_output_indices[dim] != -1 ||
+          (operand_shapes[left][dim] == 1 && operand_shapes[right][dim] == 1)) {
+        continue;
+      }
+      bool is_last_seen = true;
+      for (size_t other = 0; other < result && is_last_seen; ++other) {
+        is_last_seen = operands[other] == nullptr || other == left || other == right || operand_shapes[other][dim] == 1;
+      }
+      if (is_last_seen) {
+        reduced_dims.push_back(static_cast<int64_t>(dim));
+      }
+    }
+
+    owned_operands[result] = PairwiseOperandProcess(*operands[left], operand_shapes[left],
+                                                    *operands[right], operand_shapes[right],
+                                                    reduced_dims, step == contraction_path.size() - 1);
+    operands[result] = owned_operands[result].get();
+    operand_shapes[result] = operands[result]->Shape();
+
+    operands[left] = operands[right] = nullptr;
+    owned_operands[left].reset();
+    owned_operands[right].reset();
+  }
+
+  return Status::OK();
+}
+
 template <typename T>
 Status EinsumTypedComputeProcessor<T>::Run() {
+  // Contract the operands in the order of the contraction path if one is set
+  if (contraction_path_ != nullptr && !contraction_path_->empty()) {
+    return ContractAlongPath(*contraction_path_);
+  }
+
   const auto& mapped_indices_to_last_input_index = einsum_compute_preprocessor_.GetMappedSubscriptIndicesToLastInputIndex();
 
   auto& preprocessed_inputs = einsum_compute_preprocessor_.GetPreprocessedInputTensors();
@@ -9,6 +9,7 @@
 
 #include "einsum_auxiliary_ops.h"
 #include "einsum_compute_preprocessor.h"
+#include "einsum_contraction_path.h"
 
 namespace onnxruntime {
 
@@ -33,6 +34,14 @@ class EinsumTypedComputeProcessor {
                         const EinsumOp::DeviceHelpers::ReduceSum<T>& device_reduce_sum_func,
                         const EinsumOp::DeviceHelpers::DataCopy& device_data_copy_func);
 
+  // Pass-in a device specific Gemm that can read transposed operands (optional)
+  // If set, the operands that only need a transpose of their matrices are not transposed before the pair-wise products
+  void SetDeviceGemmHelper(const EinsumOp::DeviceHelpers::Gemm<T>& device_gemm_func);
+
+  // Pass-in the order in which the operands are contracted (optional - the default is the input order)
+  // The path must outlive Run()
+  void SetContractionPath(const EinsumOp::ContractionPath* contraction_path);
+
   Status Run();
 
  private:
@@ -48,6 +57,9 @@ class EinsumTypedComputeProcessor {
                                                  const gsl::span<const int64_t>& reduce_dims,
                                                  bool is_final_pair);
 
+  // Processes the operands pair-wise in the order of the contraction path
+  Status ContractAlongPath(const EinsumOp::ContractionPath& contraction_path);
+
   // Here we take a "candidate output"(candidate output is a tensor that is a permutation and / or a reshape away from the final output),
   // and after a few operations to get it to the required output structure, copy it to the op's output
   // The candidate output might contain dims that may not be part of the op's output (i.e.) the dims will have to be unsqueezed
@@ -64,6 +76,9 @@ class EinsumTypedComputeProcessor {
   EinsumOp::DeviceHelpers::MatMul<T> device_matmul_func_;
   EinsumOp::DeviceHelpers::ReduceSum<T> device_reduce_sum_func_;
   EinsumOp::DeviceHelpers::DataCopy device_data_copy_func_;
+  EinsumOp::DeviceHelpers::Gemm<T> device_gemm_func_;
+
+  const EinsumOp::ContractionPath* contraction_path_ = nullptr;
 
   // Holds EP-specific assets required for (auxiliary) ops that need to be executed on non-CPU EPs
   void* einsum_ep_assets_;
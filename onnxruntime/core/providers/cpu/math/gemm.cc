@@ -1,14 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <onnxruntime_config.h>
 #include "core/providers/cpu/math/gemm.h"
 #include "core/common/narrow.h"
+#include "core/common/parse_string.h"
 #include "core/common/safeint.h"
 #include "core/providers/cpu/math/gemm_matmul_common.h"
 #include "core/util/math_cpuonly.h"
 #include "gemm_helper.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 namespace onnxruntime {
 
@@ -140,6 +143,94 @@ bool GemmPackBFp32(AllocatorPtr& alloc,
   return true;
 }
 
+float GetBlockSparseWeightsMinZeroRatio(const OpKernelInfo& info) {
+  const std::string value =
+      info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsBlockSparseWeightsMinZeroRatio, "0");
+  float min_zero_ratio = 0.0f;
+  ORT_ENFORCE(TryParseStringWithClassicLocale(value, min_zero_ratio) && min_zero_ratio >= 0.0f &&
+                  min_zero_ratio <= 1.0f,
+              "Invalid value for ", kOrtSessionOptionsBlockSparseWeightsMinZeroRatio, ": ", value);
+  return min_zero_ratio;
+}
+
+// The block sparse kernel does the same work for each nonzero block as the dense kernels, with a slower inner loop, so
+// it can only be faster when most of the blocks are zeros. B stays dense when at least half of its blocks are occupied,
+// whatever the minimum ratio set in the session options.
+constexpr float kBlockSparseMinZeroBlockRatio = 0.5f;
+
+// Returns the size of the block sparse packing of B, 0 if B is not sparse enough to use it. This is the only place
+// where the packing is chosen, so that PrePack and RestorePrePackedState always agree.
+static size_t GemmPackBBlockSparseFp32Size(const Tensor& tensor_b, bool trans_b, float min_zero_ratio) {
+  if (min_zero_ratio <= 0.0f || tensor_b.Shape().NumDimensions() != 2) {
+    return 0;
+  }
+
+  const size_t K = trans_b ? static_cast<size_t>(tensor_b.Shape()[1]) : static_cast<size_t>(tensor_b.Shape()[0]);
+  const size_t N = trans_b ? static_cast<size_t>(tensor_b.Shape()[0]) : static_cast<size_t>(tensor_b.Shape()[1]);
+  const CBLAS_TRANSPOSE trans = trans_b ? CblasTrans : CblasNoTrans;
+  const float* b_data = tensor_b.Data<float>();
+  const size_t ldb = trans_b ? K : N;
+
+  if (MlasBlockSparseSgemmZeroBlockRatio(trans, N, K, b_data, ldb) <
+      std::max(min_zero_ratio, kBlockSparseMinZeroBlockRatio)) {
+    return 0;
+  }
+  return MlasBlockSparseSgemmPackBSize(trans, N, K, b_data, ldb);
+}
+
+bool GemmPackBBlockSparseFp32(AllocatorPtr& alloc,
+                              const Tensor& tensor_b,
+                              bool trans_b,
+                              float min_zero_ratio,
+                              IAllocatorUniquePtr<void>& packed_b,
+                              size_t& packed_b_size,
+                              TensorShape& b_shape) {
+  packed_b_size = GemmPackBBlockSparseFp32Size(tensor_b, trans_b, min_zero_ratio);
+  if (packed_b_size == 0) {
+    return false;
+  }
+  b_shape = tensor_b.Shape();
+
+  const size_t K = trans_b ? static_cast<size_t>(b_shape[1]) : static_cast<size_t>(b_shape[0]);
+  const size_t N = trans_b ? static_cast<size_t>(b_shape[0]) : static_cast<size_t>(b_shape[1]);
+  const CBLAS_TRANSPOSE trans = trans_b ? CblasTrans : CblasNoTrans;
+  const float* b_data = tensor_b.Data<float>();
+  const size_t ldb = trans_b ? K : N;
+
+  packed_b = IAllocator::MakeUniquePtr<void>(alloc, packed_b_size, true);
+  memset(packed_b.get(), 0, packed_b_size);
+
+  MlasBlockSparseSgemmPackB(trans, N, K, b_data, ldb, packed_b.get());
+  return true;
+}
+
+bool GemmRestorePackedBFp32(const Tensor& tensor_b,
+                            bool trans_a,
+                            bool trans_b,
+                            float min_zero_ratio,
+                            size_t packed_b_size,
+                            bool& block_sparse,
+                            TensorShape& b_shape) {
+  if (tensor_b.Shape().NumDimensions() != 2) {
+    return false;
+  }
+
+  // Same choice of packing as GemmPackBBlockSparseFp32 then GemmPackBFp32.
+  size_t expected_size = GemmPackBBlockSparseFp32Size(tensor_b, trans_b, min_zero_ratio);
+  block_sparse = expected_size != 0;
+  if (!block_sparse) {
+    const size_t K = trans_b ? static_cast<size_t>(tensor_b.Shape()[1]) : static_cast<size_t>(tensor_b.Shape()[0]);
+    const size_t N = trans_b ? static_cast<size_t>(tensor_b.Shape()[0]) : static_cast<size_t>(tensor_b.Shape()[1]);
+    expected_size = MlasGemmPackBSize(trans_a ? CblasTrans : CblasNoTrans, trans_b ? CblasTrans : CblasNoTrans, N, K);
+  }
+  if (expected_size == 0 || expected_size != packed_b_size) {
+    return false;
+  }
+
+  b_shape = tensor_b.Shape();
+  return true;
+}
+
 template <typename T>
 void Gemm<T>::ComputeGemm(CBLAS_TRANSPOSE trans_a, CBLAS_TRANSPOSE trans_b,
                           ptrdiff_t M, ptrdiff_t N, ptrdiff_t K,
@@ -276,7 +367,12 @@ Status Gemm<float>::PrePack(const Tensor& tensor, int input_idx,
   // only pack Matrix B
   if (input_idx == 1) {
     size_t packed_b_size;
-    is_packed = GemmPackBFp32(alloc, tensor, trans_A_ != CblasNoTrans, trans_B_ != CblasNoTrans, packed_b_, packed_b_size, b_shape_);
+    packed_b_block_sparse_ =
+        trans_A_ == CblasNoTrans &&
+        GemmPackBBlockSparseFp32(alloc, tensor, trans_B_ != CblasNoTrans, block_sparse_min_zero_ratio_,
+                                 packed_b_, packed_b_size, b_shape_);
+    is_packed = packed_b_block_sparse_ ||
+                GemmPackBFp32(alloc, tensor, trans_A_ != CblasNoTrans, trans_B_ != CblasNoTrans, packed_b_, packed_b_size, b_shape_);
     bool share_prepacked_weights = (prepacked_weights != nullptr);
     if (is_packed && share_prepacked_weights) {
       prepacked_weights->buffers_.push_back(std::move(packed_b_));
@@ -294,6 +390,28 @@ Status Gemm<T>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& /*prepac
   return Status::OK();
 }
 
+template <typename T>
+Status Gemm<T>::RestorePrePackedState(const Tensor& /*tensor*/, int /*input_idx*/,
+                                      gsl::span<const size_t> /*prepacked_buffer_sizes*/,
+                                      /*out*/ bool& is_restored) {
+  is_restored = false;
+  return Status::OK();
+}
+
+template <>
+Status Gemm<float>::RestorePrePackedState(const Tensor& tensor, int input_idx,
+                                          gsl::span<const size_t> prepacked_buffer_sizes,
+                                          /*out*/ bool& is_restored) {
+  is_restored = false;
+
+  if (input_idx == 1 && prepacked_buffer_sizes.size() == 1) {
+    const float min_zero_ratio = trans_A_ == CblasNoTrans ? block_sparse_min_zero_ratio_ : 0.0f;
+    is_restored = GemmRestorePackedBFp32(tensor, trans_A_ != CblasNoTrans, trans_B_ != CblasNoTrans, min_zero_ratio,
+                                         prepacked_buffer_sizes[0], packed_b_block_sparse_, b_shape_);
+  }
+  return Status::OK();
+}
+
 template <>
 Status Gemm<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
                                               int input_idx,
@@ -436,7 +554,11 @@ Status Gemm<float>::Compute(OpKernelContext* context) const {
                 c_data, c_shape, y_data, thread_pool);
   } else {
     GemmBroadcastBias(M, N, beta_, c_data, c_shape, y_data);
-    if (K > 0) {
+    if (packed_b_block_sparse_) {
+      MlasBlockSparseSgemm(static_cast<size_t>(M), static_cast<size_t>(N), static_cast<size_t>(K), alpha_,
+                           A->Data<float>(), static_cast<size_t>(K), packed_b_.get(),
+                           c_data != nullptr ? beta_ : 0.0f, y_data, static_cast<size_t>(N), thread_pool);
+    } else if (K > 0) {
       MlasGemm(
           trans_A_,
           static_cast<size_t>(M),
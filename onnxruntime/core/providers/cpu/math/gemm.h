@@ -9,6 +9,7 @@
 #include "core/common/common.h"
 #include "core/util/math.h"
 #include "core/providers/cpu/activation/activations.h"
+#include "core/providers/cpu/math/gemm_matmul_common.h"
 
 namespace onnxruntime {
 
@@ -25,6 +26,7 @@ template <typename T>
 class Gemm : protected GemmBase, public OpKernel {
  public:
   Gemm(const OpKernelInfo& info) : GemmBase(info), OpKernel(info) {
+    block_sparse_min_zero_ratio_ = GetBlockSparseWeightsMinZeroRatio(info);
   }
 
   Status Compute(OpKernelContext* context) const override;
@@ -37,6 +39,9 @@ class Gemm : protected GemmBase, public OpKernel {
                                    int input_idx,
                                    /*out*/ bool& used_shared_buffers) override;
 
+  Status RestorePrePackedState(const Tensor& tensor, int input_idx, gsl::span<const size_t> prepacked_buffer_sizes,
+                               /*out*/ bool& is_restored) override;
+
   static void ComputeGemm(CBLAS_TRANSPOSE trans_a, CBLAS_TRANSPOSE trans_b,
                           ptrdiff_t M, ptrdiff_t N, ptrdiff_t K,
                           T alpha,
@@ -50,6 +55,10 @@ class Gemm : protected GemmBase, public OpKernel {
   TensorShape b_shape_;
   IAllocatorUniquePtr<void> packed_b_;
 
+  // B is packed for MlasBlockSparseSgemm instead of MlasGemm
+  float block_sparse_min_zero_ratio_;
+  bool packed_b_block_sparse_ = false;
+
   // For fused gemm + activation
   std::unique_ptr<functors::ElementWiseRangedTransform<T>> activation_;
 
@@ -14,4 +14,27 @@ bool GemmPackBFp32(AllocatorPtr& alloc,
                    IAllocatorUniquePtr<void>& packed_b,
                    size_t& packed_b_size,
                    TensorShape& b_shape);
+
+// Returns the minimum fraction of zero blocks of a constant B to pack it in the MLAS block sparse format,
+// 0 when disabled. See kOrtSessionOptionsBlockSparseWeightsMinZeroRatio.
+float GetBlockSparseWeightsMinZeroRatio(const OpKernelInfo& info);
+
+// Packs a 2D B in the MLAS block sparse format if at least min_zero_ratio of its blocks are zeros.
+bool GemmPackBBlockSparseFp32(AllocatorPtr& alloc,
+                              const Tensor& tensor_b,
+                              bool trans_b,
+                              float min_zero_ratio,
+                              IAllocatorUniquePtr<void>& packed_b,
+                              size_t& packed_b_size,
+                              TensorShape& b_shape);
+
+// Checks that a buffer of packed_b_size bytes is the packing GemmPackBBlockSparseFp32 or GemmPackBFp32 would produce
+// for tensor_b, e.g. when it was found in a cache, and sets the state they set.
+bool GemmRestorePackedBFp32(const Tensor& tensor_b,
+                            bool trans_a,
+                            bool trans_b,
+                            float min_zero_ratio,
+                            size_t packed_b_size,
+                            bool& block_sparse,
+                            TensorShape& b_shape);
 };  // namespace onnxruntime
@@ -133,7 +133,7 @@ Status MatMul<T>::Compute(OpKernelContext* ctx) const {
 
   return Status::OK();
 }
-#if defined(__aarch64__) && defined(__linux__)
+#if defined(MLAS_SBGEMM_SUPPORTED)
 bool GemmPackBBfloat16(AllocatorPtr& alloc,
                        const Tensor& tensor_b,
                        bool trans_b,
@@ -180,7 +180,7 @@ Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ Alloc
   // only pack Matrix B
   if (input_idx == 1) {
     size_t packed_b_size;
-#if defined(__aarch64__) && defined(__linux__)
+#if defined(MLAS_SBGEMM_SUPPORTED)
     size_t dim1 = 0;
     size_t dim2 = 0;
     TensorShape b_shape = tensor.Shape();
@@ -189,7 +189,16 @@ Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ Alloc
       dim1 = static_cast<size_t>(b_shape[0]);
       dim2 = static_cast<size_t>(b_shape[1]);
     }
+#endif
 
+    packed_b_block_sparse_ =
+        trans_a_attr_ == 0 && !trans_batch_a_ && !trans_batch_b_ &&
+        GemmPackBBlockSparseFp32(alloc, tensor, trans_b_attr_ != 0, block_sparse_min_zero_ratio_,
+                                 packed_b_, packed_b_size, b_shape_);
+    if (packed_b_block_sparse_) {
+      is_packed = true;
+    } else
+#if defined(MLAS_SBGEMM_SUPPORTED)
     if (use_fastmath_mode_ && (trans_b_attr_ == 0) && ((dim1 * dim2) >= kFastMathModeKernelsizeThreshold)) {
       is_packed = GemmPackBBfloat16(alloc, tensor, trans_b_attr_ != 0, packed_b_, packed_b_size, b_shape_);
     } else
@@ -207,6 +216,26 @@ Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ Alloc
   return Status::OK();
 }
 
+Status MatMul<float>::RestorePrePackedState(const Tensor& tensor, int input_idx,
+                                            gsl::span<const size_t> prepacked_buffer_sizes,
+                                            /*out*/ bool& is_restored) {
+  is_restored = false;
+
+  if (input_idx == 1 && prepacked_buffer_sizes.size() == 1) {
+#if defined(MLAS_SBGEMM_SUPPORTED)
+    // The bfloat16 packing is not restored, PrePack() is called for it.
+    if (use_fastmath_mode_ && (trans_b_attr_ == 0)) {
+      return Status::OK();
+    }
+#endif
+    const float min_zero_ratio =
+        trans_a_attr_ == 0 && !trans_batch_a_ && !trans_batch_b_ ? block_sparse_min_zero_ratio_ : 0.0f;
+    is_restored = GemmRestorePackedBFp32(tensor, trans_a_attr_ != 0, trans_b_attr_ != 0, min_zero_ratio,
+                                         prepacked_buffer_sizes[0], packed_b_block_sparse_, b_shape_);
+  }
+  return Status::OK();
+}
+
 Status MatMul<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
                                                 int input_idx,
                                                 /*out*/ bool& used_shared_buffers) {
@@ -258,7 +287,13 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
   const size_t K = static_cast<size_t>(helper.K());
   const size_t lda = helper.Lda(trans_a);
   const size_t ldb = helper.Ldb(trans_b);
-#if defined(__aarch64__) && defined(__linux__)
+  if (packed_b_block_sparse_) {
+    for (size_t i = 0; i < max_len; i++) {
+      MlasBlockSparseSgemm(M, N, K, alpha_attr_, a_data + helper.LeftOffsets()[i], lda, packed_b_.get(),
+                           0.0f, y_data + helper.OutputOffsets()[i], N, thread_pool);
+    }
+  } else
+#if defined(MLAS_SBGEMM_SUPPORTED)
   if (use_fastmath_mode_ && !trans_b && ((N * K) >= kFastMathModeKernelsizeThreshold)) {
     std::vector<MLAS_SBGEMM_DATA_PARAMS> data(max_len);
     for (size_t i = 0; i < max_len; i++) {
@@ -5,6 +5,7 @@
 
 #include "core/framework/op_kernel.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/providers/cpu/math/gemm_matmul_common.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 
 namespace onnxruntime {
@@ -29,9 +30,14 @@ class MatMul<float> final : public OpKernel {
     info.GetAttrOrDefault<int64_t>("transBatchB", &trans_batch_b_attr, 0);
     trans_batch_a_ = trans_batch_a_attr != 0;
     trans_batch_b_ = trans_batch_b_attr != 0;
+    block_sparse_min_zero_ratio_ = GetBlockSparseWeightsMinZeroRatio(info);
 
-#if defined(__aarch64__) && defined(__linux__)
-    auto config_ops = info.GetConfigOptions().GetConfigEntry(kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16);
+#if defined(MLAS_SBGEMM_SUPPORTED)
+    const auto& config_options = info.GetConfigOptions();
+    auto config_ops = config_options.GetConfigEntry(kOrtSessionOptionsMlasGemmFastMathBfloat16);
+    if (!config_ops.has_value()) {
+      config_ops = config_options.GetConfigEntry(kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16);
+    }
     use_fastmath_mode_ = (config_ops == "1") && MlasBf16AccelerationSupported();
 #endif
   }
@@ -43,12 +49,19 @@ class MatMul<float> final : public OpKernel {
   Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers, int input_idx,
                                    /*out*/ bool& used_shared_buffers) override;
 
+  Status RestorePrePackedState(const Tensor& tensor, int input_idx, gsl::span<const size_t> prepacked_buffer_sizes,
+                               /*out*/ bool& is_restored) override;
+
   Status Compute(OpKernelContext* context) const override;
 
  private:
   TensorShape b_shape_;
   IAllocatorUniquePtr<void> packed_b_;
 
+  // B is packed for MlasBlockSparseSgemm instead of MlasGemm
+  float block_sparse_min_zero_ratio_;
+  bool packed_b_block_sparse_ = false;
+
   // For FusedMatMul contrib ops
   float alpha_attr_;
   int64_t trans_a_attr_;
@@ -56,10 +69,10 @@ class MatMul<float> final : public OpKernel {
   bool trans_batch_a_;
   bool trans_batch_b_;
 
-#if defined(__aarch64__) && defined(__linux__)
+#if defined(MLAS_SBGEMM_SUPPORTED)
   // fastmath mode state
   bool use_fastmath_mode_;
-  // sbgemm kernel is implemented as 8x8 blocks with weights pre-packed to 4 blocks of 4x2
+  // sbgemm kernels work on blocks of at least 4x2 pre-packed weights
   // so a minimum of 32 elements is defined to outweigh the additional prepacking overhead
   const size_t kFastMathModeKernelsizeThreshold = 32;
 #endif
@@ -20,11 +20,13 @@
 #include "core/common/exceptions.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensor.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 #include <queue>
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <core/common/safeint.h>
 
 namespace onnxruntime {
@@ -140,6 +142,14 @@ static void SelectTopK(const Comparator& comparer,
   // the data_holder now contains the indices of the top k elements in the first k elements
 }
 
+// Whether MlasTopK is used for a contiguous float row. The vectorized threshold filter of MlasTopK outperforms the
+// heap and nth_element selections once the row is long enough for the threshold to settle, with k small relative
+// to the row. MlasTopK stores 32-bit indices.
+static bool UseMlasTopK(int64_t num_blocks, int64_t k) {
+  return k != 1 && num_blocks >= 1024 && k * 4 <= num_blocks &&
+         num_blocks <= static_cast<int64_t>(std::numeric_limits<uint32_t>::max());
+}
+
 // Given an input tensor 'input' and metadata values - 'k' and 'axis_parsed',
 // this method will extract the sorted top k largest/smallest elements and place them in the output tensor 'values'
 // along with the metadata output 'indices'
@@ -179,9 +189,47 @@ static void FindTopKElements(const Tensor* input, const TensorShape& input_shape
   //            k = [ 1, 2, 4, 6, 8, 16, 24, 32, 48, 64, 128 ]
   bool use_priority_queue = k != 1 && (k < 4 || (std::log2(k) / std::log2(num_blocks)) < 0.725);
 
+  // contiguous float rows use the vectorized selection of MLAS
+  constexpr bool is_float = std::is_same_v<typename Comparator::DataType, float>;
+  const bool use_mlas_top_k = is_float && block_slice == 1 && UseMlasTopK(num_blocks, k);
+
   std::function<void(std::ptrdiff_t batch)> find_top_k;
 
-  if (k == 1) {
+  if (use_mlas_top_k) {
+    if constexpr (is_float) {
+      find_top_k =
+          [num_threads, rows, num_blocks, k, sorted,
+           input_data, cols, values_data, indices_data](std::ptrdiff_t batch) {
+            auto work = concurrency::ThreadPool::PartitionWork(batch, onnxruntime::narrow<size_t>(num_threads), onnxruntime::narrow<size_t>(rows));
+            Comparator comparer(input_data);
+            constexpr bool largest = std::is_same_v<Comparator, GreaterValueCmp<float>>;
+
+            std::vector<uint32_t> workspace(MlasTopKGetWorkspaceCount(k));
+            std::vector<int64_t> data_holder;
+
+            for (auto i = work.start; i < work.end; ++i) {
+              const auto row_offset = i * cols;
+              float* row_values = values_data + i * k;
+              int64_t* row_indices = indices_data + i * k;
+
+              if (MlasTopK(input_data + row_offset, onnxruntime::narrow<size_t>(num_blocks), k, largest, sorted,
+                           row_values, row_indices, workspace.data())) {
+                continue;
+              }
+
+              // rows with fewer than k values beyond the infinity of the opposite sign need the full ordering
+              data_holder.resize(onnxruntime::narrow<size_t>(num_blocks));
+              SelectTopK<Comparator>(comparer, row_offset, num_blocks, 1, 0, k, sorted, data_holder);
+
+              for (size_t l = 0; l < k; ++l) {
+                int64_t idx = data_holder[l];
+                row_values[l] = input_data[idx];
+                row_indices[l] = idx - row_offset;
+              }
+            }
+          };
+    }
+  } else if (k == 1) {
     // just need to compare values and not indexes as the first instance of the best value is always selected
     find_top_k =
         [num_threads, rows, block_slice, num_blocks, input_data, cols,
@@ -413,6 +461,48 @@ Status GetTopK(const Tensor* input, const int axis, const unsigned k, bool large
   return Status::OK();
 }
 
+void GetTopKIndicesOfRow(const float* data, size_t n, size_t k, bool largest, bool sorted, int64_t* indices) {
+  if (k == 0) {
+    return;
+  }
+
+  if (UseMlasTopK(static_cast<int64_t>(n), static_cast<int64_t>(k))) {
+    std::vector<uint32_t> workspace(MlasTopKGetWorkspaceCount(k));
+    if (MlasTopK(data, n, k, largest, sorted, nullptr, indices, workspace.data())) {
+      return;
+    }
+  }
+
+  // select in place when the whole row is ordered
+  std::vector<int64_t> data_holder;
+  int64_t* order = indices;
+  if (k < n) {
+    data_holder.resize(n);
+    order = data_holder.data();
+  }
+
+  std::iota(order, order + n, int64_t{0});
+
+  auto select = [&](const auto& comparer) {
+    if (k < n) {
+      std::nth_element(order, order + (k - 1), order + n, comparer);
+    }
+    if (sorted) {
+      std::sort(order, order + k, comparer);
+    }
+  };
+
+  if (largest) {
+    select(GreaterValueCmp<float>(data));
+  } else {
+    select(LesserValueCmp<float>(data));
+  }
+
+  if (order != indices) {
+    std::copy(order, order + k, indices);
+  }
+}
+
 // explicit instantiation
 template Status GetTopK<float>(const Tensor* input, const int axis, const unsigned k, bool largest, bool sorted,
                                AllocatorPtr allocator,
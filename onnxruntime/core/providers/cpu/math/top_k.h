@@ -26,4 +26,8 @@ Status GetTopK(const Tensor* input, const int axis, const unsigned k, bool large
                onnxruntime::concurrency::ThreadPool* threadpool,
                Tensor& output_values,
                Tensor& output_indices);
+
+// Writes the indices of the k largest (or smallest) values of a contiguous row of n values to 'indices', in order
+// if 'sorted' is set. Equal values are ordered by index like the TopK operator.
+void GetTopKIndicesOfRow(const float* data, size_t n, size_t k, bool largest, bool sorted, int64_t* indices);
 }  // namespace onnxruntime
\ No newline at end of file
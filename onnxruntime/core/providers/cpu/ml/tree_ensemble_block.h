@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+// Comparison rules supported by the block traversal.
+// They return true when the true branch must be followed.
+struct TreeBlockCompareLEQ {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val <= threshold; }
+};
+
+struct TreeBlockCompareLT {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val < threshold; }
+};
+
+struct TreeBlockCompareGTE {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val >= threshold; }
+};
+
+struct TreeBlockCompareGT {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val > threshold; }
+};
+
+struct TreeBlockCompareEQ {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val == threshold; }
+};
+
+struct TreeBlockCompareNEQ {
+  template <typename T1, typename T2>
+  static inline bool Compare(T1 val, T2 threshold) { return val != threshold; }
+};
+
+/**
+ * Alternative layout of the trees held by TreeEnsembleCommon::nodes_.
+ * Every tree is copied in breadth-first (level) order into separate arrays for feature ids,
+ * thresholds and children. A leaf points to itself for both branches. A block of rows can then
+ * be moved down one tree level at a time with the same instructions for every row:
+ * there is no data-dependent branch and the loads for all rows of the block are independent,
+ * which lets the processor overlap the cache misses the node-by-node walk serializes.
+ * The evaluation runs exactly depth(tree) iterations for every block of rows.
+ * The leaves are mapped back to the original TreeNodeElement so that the aggregators
+ * (TreeAggregatorSum, ...) are used unchanged.
+ */
+template <typename InputType, typename ThresholdType>
+class TreeEnsembleBlockLayout {
+ public:
+  // Number of rows moved together through a tree.
+  static constexpr int64_t kBlockSize = 16;
+
+  // Returns nullptr if the ensemble cannot be evaluated with this layout:
+  // mixed comparison rules, set membership rules or too many nodes.
+  static std::unique_ptr<TreeEnsembleBlockLayout> Create(const std::vector<TreeNodeElement<ThresholdType>>& nodes,
+                                                         const std::vector<TreeNodeElement<ThresholdType>*>& roots,
+                                                         bool has_missing_tracks) {
+    if (nodes.size() >= static_cast<size_t>(std::numeric_limits<int32_t>::max() / 2)) {
+      return nullptr;
+    }
+    NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+    for (const auto& node : nodes) {
+      if (!node.is_not_leaf()) continue;
+      if (mode == NODE_MODE_ORT::LEAF) {
+        mode = node.mode();
+      } else if (node.mode() != mode) {
+        return nullptr;
+      }
+    }
+    switch (mode) {
+      case NODE_MODE_ORT::LEAF:
+      case NODE_MODE_ORT::BRANCH_LEQ:
+      case NODE_MODE_ORT::BRANCH_LT:
+      case NODE_MODE_ORT::BRANCH_GTE:
+      case NODE_MODE_ORT::BRANCH_GT:
+      case NODE_MODE_ORT::BRANCH_EQ:
+      case NODE_MODE_ORT::BRANCH_NEQ:
+        break;
+      default:
+        return nullptr;
+    }
+
+    auto layout = std::unique_ptr<TreeEnsembleBlockLayout>(new TreeEnsembleBlockLayout());
+    layout->mode_ = mode;
+    layout->has_missing_tracks_ = has_missing_tracks;
+    layout->Build(nodes, roots);
+    return layout;
+  }
+
+  size_t n_trees() const { return roots_.size(); }
+  int32_t depth(size_t tree) const { return depths_[tree]; }
+
+  // Evaluates tree `tree` on rows [row_begin, row_end) of x_data and calls
+  // fct(row, leaf) for every row in increasing order.
+  template <typename FCT>
+  void ProcessTree(size_t tree, const InputType* x_data, int64_t stride,
+                   int64_t row_begin, int64_t row_end, FCT&& fct) const {
+    switch (mode_) {
+      case NODE_MODE_ORT::BRANCH_LEQ:
+        ProcessTreeDispatch<TreeBlockCompareLEQ>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::BRANCH_LT:
+        ProcessTreeDispatch<TreeBlockCompareLT>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::BRANCH_GTE:
+        ProcessTreeDispatch<TreeBlockCompareGTE>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::BRANCH_GT:
+        ProcessTreeDispatch<TreeBlockCompareGT>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::BRANCH_EQ:
+        ProcessTreeDispatch<TreeBlockCompareEQ>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::BRANCH_NEQ:
+        ProcessTreeDispatch<TreeBlockCompareNEQ>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      case NODE_MODE_ORT::LEAF:
+        // Every tree is a single leaf, depth is null, the comparison is never evaluated.
+        ProcessTreeDispatch<TreeBlockCompareLEQ>(tree, x_data, stride, row_begin, row_end, fct);
+        break;
+      default:
+        ORT_THROW("Unexpected node mode in TreeEnsembleBlockLayout::ProcessTree: ", static_cast<int>(mode_));
+    }
+  }
+
+ private:
+  TreeEnsembleBlockLayout() = default;
+
+  void Build(const std::vector<TreeNodeElement<ThresholdType>>& nodes,
+             const std::vector<TreeNodeElement<ThresholdType>*>& roots) {
+    const size_t n_nodes = nodes.size();
+    feature_ids_.reserve(n_nodes);
+    thresholds_.reserve(n_nodes);
+    children_.reserve(n_nodes * 2);
+    leaves_.reserve(n_nodes);
+    if (has_missing_tracks_) {
+      missing_tracks_true_.reserve(n_nodes);
+    }
+    roots_.reserve(roots.size());
+    depths_.reserve(roots.size());
+
+    // Position of every original node in the new layout, -1 if not added yet.
+    // Subtrees may be shared inside a tree (see TreeEnsembleCommon::AddNodes), they are copied only once.
+    std::vector<int32_t> new_index(n_nodes, -1);
+    const TreeNodeElement<ThresholdType>* first = nodes.data();
+    std::deque<const TreeNodeElement<ThresholdType>*> queue;
+
+    for (const TreeNodeElement<ThresholdType>* root : roots) {
+      const int32_t root_index = static_cast<int32_t>(feature_ids_.size());
+      roots_.push_back(root_index);
+
+      // Breadth-first numbering, all nodes of one level are contiguous.
+      new_index[root - first] = root_index;
+      AppendNode(*root);
+      queue.push_back(root);
+      while (!queue.empty()) {
+        const TreeNodeElement<ThresholdType>* node = queue.front();
+        queue.pop_front();
+        if (!node->is_not_leaf()) continue;
+        const TreeNodeElement<ThresholdType>* false_node = node + 1;
+        const TreeNodeElement<ThresholdType>* true_node = node->truenode_or_weight.ptr;
+        for (const TreeNodeElement<ThresholdType>* child : {false_node, true_node}) {
+          if (new_index[child - first] == -1) {
+            new_index[child - first] = static_cast<int32_t>(feature_ids_.size());
+            AppendNode(*child);
+            queue.push_back(child);
+          }
+        }
+        const int32_t pos = new_index[node - first];
+        children_[2 * static_cast<size_t>(pos)] = new_index[false_node - first];
+        children_[2 * static_cast<size_t>(pos) + 1] = new_index[true_node - first];
+      }
+      depths_.push_back(ComputeDepth(root_index));
+    }
+  }
+
+  void AppendNode(const TreeNodeElement<ThresholdType>& node) {
+    const int32_t pos = static_cast<int32_t>(feature_ids_.size());
+    if (node.is_not_leaf()) {
+      feature_ids_.push_back(node.feature_id);
+      thresholds_.push_back(node.value_or_unique_weight);
+      leaves_.push_back(nullptr);
+    } else {
+      // A leaf loops on itself, any feature can be read.
+      feature_ids_.push_back(0);
+      thresholds_.push_back(0);
+      leaves_.push_back(&node);
+    }
+    children_.push_back(pos);
+    children_.push_back(pos);
+    if (has_missing_tracks_) {
+      missing_tracks_true_.push_back(node.is_missing_track_true() ? 1 : 0);
+    }
+  }
+
+  // Longest path from the root to a leaf, the number of iterations needed
+  // to bring every row to a leaf.
+  int32_t ComputeDepth(int32_t root_index) {
+    const size_t n_tree_nodes = feature_ids_.size() - static_cast<size_t>(root_index);
+    std::vector<int32_t> heights(n_tree_nodes, -1);
+    InlinedVector<int32_t> stack;
+    stack.push_back(root_index);
+    while (!stack.empty()) {
+      const int32_t node = stack.back();
+      const size_t local = static_cast<size_t>(node - root_index);
+      if (heights[local] >= 0) {
+        stack.pop_back();
+        continue;
+      }
+      if (leaves_[node] != nullptr) {
+        heights[local] = 0;
+        stack.pop_back();
+        continue;
+      }
+      const int32_t false_child = children_[2 * static_cast<size_t>(node)];
+      const int32_t true_child = children_[2 * static_cast<size_t>(node) + 1];
+      const int32_t false_height = heights[static_cast<size_t>(false_child - root_index)];
+      const int32_t true_height = heights[static_cast<size_t>(true_child - root_index)];
+      if (false_height < 0) {
+        stack.push_back(false_child);
+      } else if (true_height < 0) {
+        stack.push_back(true_child);
+      } else {
+        heights[local] = 1 + std::max(false_height, true_height);
+        stack.pop_back();
+      }
+    }
+    return heights[0];
+  }
+
+  template <typename CMP, typename FCT>
+  void ProcessTreeDispatch(size_t tree, const InputType* x_data, int64_t stride,
+                           int64_t row_begin, int64_t row_end, FCT& fct) const {
+    if (has_missing_tracks_) {
+      ProcessTreeImpl<CMP, true>(tree, x_data, stride, row_begin, row_end, fct);
+    } else {
+      ProcessTreeImpl<CMP, false>(tree, x_data, stride, row_begin, row_end, fct);
+    }
+  }
+
+  template <typename CMP, bool has_missing_tracks, typename FCT>
+  void ProcessTreeImpl(size_t tree, const InputType* x_data, int64_t stride,
+                       int64_t row_begin, int64_t row_end, FCT& fct) const {
+    const int32_t root = roots_[tree];
+    const int32_t depth = depths_[tree];
+    const int32_t* feature_ids = feature_ids_.data();
+    const ThresholdType* thresholds = thresholds_.data();
+    const int32_t* children = children_.data();
+    const uint8_t* missing_tracks_true = missing_tracks_true_.data();
+    int32_t index[kBlockSize] = {};
+
+    for (int64_t begin = row_begin; begin < row_end; begin += kBlockSize) {
+      const int64_t n_rows = std::min<int64_t>(kBlockSize, row_end - begin);
+      const InputType* x_block = x_data + begin * stride;
+      for (int64_t r = 0; r < n_rows; ++r) {
+        index[r] = root;
+      }
+      for (int32_t level = 0; level < depth; ++level) {
+        for (int64_t r = 0; r < n_rows; ++r) {
+          const int32_t node = index[r];
+          const InputType val = x_block[r * stride + feature_ids[node]];
+          int32_t cond = static_cast<int32_t>(CMP::Compare(val, thresholds[node]));
+          if constexpr (has_missing_tracks) {
+            cond |= static_cast<int32_t>(missing_tracks_true[node]) & static_cast<int32_t>(_isnan_(val));
+          }
+          index[r] = children[2 * node + cond];
+        }
+      }
+      for (int64_t r = 0; r < n_rows; ++r) {
+        fct(begin + r, *leaves_[index[r]]);
+      }
+    }
+  }
+
+  NODE_MODE_ORT mode_;
+  bool has_missing_tracks_;
+  std::vector<int32_t> feature_ids_;
+  std::vector<ThresholdType> thresholds_;
+  // children_[2 * i] is the false branch of node i, children_[2 * i + 1] the true branch.
+  std::vector<int32_t> children_;
+  std::vector<uint8_t> missing_tracks_true_;
+  // Original leaf for every leaf of the layout, nullptr for the other nodes.
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+  std::vector<int32_t> roots_;
+  std::vector<int32_t> depths_;
+};
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -5,9 +5,12 @@
 
 #include <mutex>
 #include "core/platform/threadpool.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "tree_ensemble_helper.h"
 #include "tree_ensemble_attribute.h"
 #include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_block.h"
+#include "tree_ensemble_perfect.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -73,6 +76,11 @@ class TreeEnsembleCommonAttributes {
   int parallel_N_;       // starts parallelizing the computing by rows if n_rows <= parallel_N_
 };
 
+// Tells if the kernel should build the block layout (see TreeEnsembleBlockLayout).
+inline bool UseTreeEnsembleBlockTraversal(const OpKernelInfo& info) {
+  return info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsTreeEnsembleBlockTraversal, "0") == "1";
+}
+
 // TI: input type
 // TH: tree type (types of the node values and targets)
 // TO: output type, usually float
@@ -87,6 +95,10 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
   std::vector<TreeCategorySet<int32_t, InputType>> category_sets_;
+  // Not null if the trees are evaluated with the block traversal.
+  std::unique_ptr<TreeEnsembleBlockLayout<InputType, ThresholdType>> block_layout_;
+  // Not null if the trees are shallow enough to be packed as perfect binary trees.
+  std::unique_ptr<TreeEnsemblePerfectLayout<InputType, ThresholdType>> perfect_layout_;
 
  public:
   TreeEnsembleCommon() {}
@@ -99,10 +111,24 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
               int parallel_N,
               const TreeEnsembleAttributesV3<ThresholdType>& attributes);
 
+  // Builds the layout used by the block traversal once the trees are initialized.
+  // Returns false and keeps the node by node traversal if the ensemble is not eligible.
+  bool InitBlockTraversal();
+
  protected:
   TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(TreeNodeElement<ThresholdType>* root,
                                                        const InputType* x_data) const;
 
+  // Returns the leaf reached by x_data in tree j, uses the packed layout if available.
+  inline const TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(size_t j, const InputType* x_data) const {
+    return perfect_layout_ ? perfect_layout_->ProcessTree(j, x_data) : ProcessTreeNodeLeave(roots_[j], x_data);
+  }
+
+  // Evaluates tree j on rows [row_begin, row_end) and calls fct(row, leaf) for every row.
+  template <typename FCT>
+  void ProcessTreeNodeLeaves(size_t j, int64_t row_begin, int64_t row_end,
+                             const InputType* x_data, int64_t stride, FCT&& fct) const;
+
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 
@@ -156,7 +182,11 @@ std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t> bit_cast_i
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, false);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  if (UseTreeEnsembleBlockTraversal(info)) {
+    InitBlockTraversal();
+  }
+  return Status::OK();
 }
 
 template <typename InputType, typename ThresholdType, typename OutputType>
@@ -368,6 +398,12 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
     }
   }
 
+  // Shallow and balanced ensembles with a single comparison rule are evaluated on a packed copy of the trees.
+  perfect_layout_.reset();
+  if (same_mode_ && !nodes_.empty()) {
+    perfect_layout_ = TreeEnsemblePerfectLayout<InputType, ThresholdType>::Create(nodes_, roots_, has_missing_tracks_);
+  }
+
 #if defined(_TREE_DEBUG)
   std::cout << "TreeEnsemble:same_mode_=" << (same_mode_ ? 1 : 0) << "\n";
   for (auto& node : nodes_) {
@@ -377,6 +413,15 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
   return Status::OK();
 }
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+bool TreeEnsembleCommon<InputType, ThresholdType, OutputType>::InitBlockTraversal() {
+  block_layout_.reset();
+  if (same_mode_ && !nodes_.empty()) {
+    block_layout_ = TreeEnsembleBlockLayout<InputType, ThresholdType>::Create(nodes_, roots_, has_missing_tracks_);
+  }
+  return block_layout_ != nullptr;
+}
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 bool TreeEnsembleCommon<InputType, ThresholdType, OutputType>::CheckIfSubtreesAreEqual(
     const size_t left_id, const size_t right_id, const int64_t tree_id, const InlinedVector<NODE_MODE_ONNX>& cmodes,
@@ -547,6 +592,23 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::compute(OpKerne
   }
 }
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename FCT>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeaves(size_t j,
+                                                                                     int64_t row_begin,
+                                                                                     int64_t row_end,
+                                                                                     const InputType* x_data,
+                                                                                     int64_t stride,
+                                                                                     FCT&& fct) const {
+  if (block_layout_) {
+    block_layout_->ProcessTree(j, x_data, stride, row_begin, row_end, fct);
+  } else {
+    for (int64_t i = row_begin; i < row_end; ++i) {
+      fct(i, *ProcessTreeNodeLeave(static_cast<size_t>(j), x_data + i * stride));
+    }
+  }
+}
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 template <typename AGG>
 void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concurrency::ThreadPool* ttp,
@@ -572,7 +634,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       ScoreValue<ThresholdType> score = {0, 0};
       if (n_trees_ <= parallel_tree_ || max_num_threads == 1) { /* section A: 1 output, 1 row and not enough trees to parallelize */
         for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[onnxruntime::narrow<size_t>(j)], x_data));
+          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(onnxruntime::narrow<size_t>(j), x_data));
         }
       } else { /* section B: 1 output, 1 row and enough trees to parallelize */
         std::vector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_trees_), {0, 0});
@@ -580,7 +642,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             ttp,
             SafeInt<int32_t>(n_trees_),
             [this, &scores, &agg, x_data](ptrdiff_t j) {
-              agg.ProcessTreeNodePrediction1(scores[j], *ProcessTreeNodeLeave(roots_[j], x_data));
+              agg.ProcessTreeNodePrediction1(scores[j], *ProcessTreeNodeLeave(static_cast<size_t>(j), x_data));
             },
             max_num_threads);
 
@@ -610,9 +672,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           scores[SafeInt<ptrdiff_t>(i - batch)] = {0, 0};
         }
         for (j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-          }
+          ProcessTreeNodeLeaves(j, batch, batch_end, x_data, stride,
+                                [&agg, &scores, batch](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                                  agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(row - batch)], leaf);
+                                });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores1(z_data + i, scores[SafeInt<ptrdiff_t>(i - batch)],
@@ -634,10 +697,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i] = {0, 0};
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                 *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-                }
+                ProcessTreeNodeLeaves(j, begin_n, end_n, x_data, stride,
+                                      [&agg, &scores, batch_num, N](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                                        agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + row], leaf);
+                                      });
               }
             });
         begin_n = end_n;
@@ -662,7 +725,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           [this, &agg, x_data, z_data, stride, label_data](ptrdiff_t i) {
             ScoreValue<ThresholdType> score = {0, 0};
             for (size_t j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-              agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+              agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(static_cast<size_t>(j), x_data + i * stride));
             }
 
             agg.FinalizeScores1(z_data + i, score,
@@ -675,7 +738,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       if (n_trees_ <= parallel_tree_ || max_num_threads == 1) { /* section A2 */
         InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
         for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[onnxruntime::narrow<size_t>(j)], x_data), weights_);
+          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(onnxruntime::narrow<size_t>(j), x_data), weights_);
         }
         agg.FinalizeScores(scores, z_data, -1, label_data);
       } else { /* section B2: 2+ outputs, 1 row, enough trees to parallelize */
@@ -688,7 +751,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
               scores[batch_num].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<size_t>(n_trees_));
               for (auto j = work.start; j < work.end; ++j) {
-                agg.ProcessTreeNodePrediction(scores[batch_num], *ProcessTreeNodeLeave(roots_[j], x_data), weights_);
+                agg.ProcessTreeNodePrediction(scores[batch_num], *ProcessTreeNodeLeave(static_cast<size_t>(j), x_data), weights_);
               }
             });
         for (size_t i = 1, limit = scores.size(); i < limit; ++i) {
@@ -710,9 +773,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           std::fill(scores[SafeInt<ptrdiff_t>(i - batch)].begin(), scores[SafeInt<ptrdiff_t>(i - batch)].end(), ScoreValue<ThresholdType>({0, 0}));
         }
         for (j = 0, limit = roots_.size(); j < limit; ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-          }
+          ProcessTreeNodeLeaves(j, batch, batch_end, x_data, stride,
+                                [this, &agg, &scores, batch](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                                  agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(row - batch)], leaf, weights_);
+                                });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores(scores[SafeInt<ptrdiff_t>(i - batch)], z_data + i * n_targets_or_classes_, -1,
@@ -735,10 +799,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-                }
+                ProcessTreeNodeLeaves(j, begin_n, end_n, x_data, stride,
+                                      [this, &agg, &scores, batch_num, N](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                                        agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + row], leaf, weights_);
+                                      });
               }
             });
         begin_n = end_n;
@@ -769,7 +833,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             for (auto i = work.start; i < work.end; ++i) {
               std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
               for (j = 0, limit = roots_.size(); j < limit; ++j) {
-                agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
+                agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(static_cast<size_t>(j), x_data + i * stride), weights_);
               }
 
               agg.FinalizeScores(scores,
@@ -954,7 +1018,11 @@ class TreeEnsembleCommonClassifier : public TreeEnsembleCommon<InputType, Thresh
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommonClassifier<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, true);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  if (UseTreeEnsembleBlockTraversal(info)) {
+    this->InitBlockTraversal();
+  }
+  return Status::OK();
 }
 
 template <typename InputType, typename ThresholdType, typename OutputType>
@@ -1034,7 +1102,11 @@ class TreeEnsembleCommonV5 : public TreeEnsembleCommon<IOType, ThresholdType, IO
 template <typename IOType, typename ThresholdType>
 Status TreeEnsembleCommonV5<IOType, ThresholdType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV5<ThresholdType> attributes(info);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  if (UseTreeEnsembleBlockTraversal(info)) {
+    this->InitBlockTraversal();
+  }
+  return Status::OK();
 }
 
 template <typename IOType, typename ThresholdType>
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "core/common/common.h"
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+#include "tree_ensemble_block.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+/**
+ * Packed layout for ensembles of shallow trees sharing the same comparison rule.
+ * Every tree is stored as a perfect binary tree of depth `depth_` (the maximum depth of the ensemble):
+ * node i has its true child at 2i+1 and its false child at 2i+2, so no child pointer is stored.
+ * Feature ids and thresholds are kept in separate arrays, (2^depth - 1) entries per tree,
+ * followed by 2^depth leaf slots per tree pointing to the original TreeNodeElement.
+ * A leaf found above the last level is padded: the padding nodes below it lead to
+ * copies of the same leaf whatever the comparison returns.
+ * The traversal is a fixed number of iterations known at compile time, the compiler unrolls it
+ * and the next node index is computed without any branch.
+ * The layout is only built when the padding keeps it within kMaxPaddingRatio times the number of
+ * internal nodes of the ensemble, unbalanced trees keep the node by node traversal.
+ */
+template <typename InputType, typename ThresholdType>
+class TreeEnsemblePerfectLayout {
+ public:
+  // Beyond that depth, padding the trees costs too much memory.
+  static constexpr int kMaxDepth = 8;
+  // Maximum ratio between the number of internal nodes of the padded trees and of the original ones.
+  static constexpr size_t kMaxPaddingRatio = 4;
+
+  // Returns nullptr if one tree is deeper than kMaxDepth, if padding the trees would multiply their number
+  // of internal nodes by more than kMaxPaddingRatio, or if the comparison rule is not BRANCH_LEQ or BRANCH_LT,
+  // the two rules used by the common training libraries.
+  static std::unique_ptr<TreeEnsemblePerfectLayout> Create(const std::vector<TreeNodeElement<ThresholdType>>& nodes,
+                                                           const std::vector<TreeNodeElement<ThresholdType>*>& roots,
+                                                           bool has_missing_tracks) {
+    NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+    size_t n_internal = 0;
+    for (const auto& node : nodes) {
+      if (!node.is_not_leaf()) continue;
+      ++n_internal;
+      if (mode == NODE_MODE_ORT::LEAF) {
+        mode = node.mode();
+      } else if (node.mode() != mode) {
+        return nullptr;
+      }
+    }
+    if (mode != NODE_MODE_ORT::LEAF && mode != NODE_MODE_ORT::BRANCH_LEQ && mode != NODE_MODE_ORT::BRANCH_LT) {
+      return nullptr;
+    }
+
+    int depth = 0;
+    for (const TreeNodeElement<ThresholdType>* root : roots) {
+      const int tree_depth = ComputeDepth(root, 0);
+      if (tree_depth > kMaxDepth) {
+        return nullptr;
+      }
+      depth = std::max(depth, tree_depth);
+    }
+    if (roots.size() * ((size_t(1) << depth) - 1) > kMaxPaddingRatio * n_internal) {
+      return nullptr;
+    }
+
+    auto layout = std::unique_ptr<TreeEnsemblePerfectLayout>(new TreeEnsemblePerfectLayout());
+    layout->depth_ = depth;
+    layout->has_missing_tracks_ = has_missing_tracks;
+    layout->Build(roots);
+    layout->SelectKernel(mode);
+    return layout;
+  }
+
+  int depth() const { return depth_; }
+
+  // Returns the leaf reached by row x_data in tree `tree`.
+  inline const TreeNodeElement<ThresholdType>* ProcessTree(size_t tree, const InputType* x_data) const {
+    return (this->*process_tree_)(tree, x_data);
+  }
+
+ private:
+  using ProcessTreeFn = const TreeNodeElement<ThresholdType>* (TreeEnsemblePerfectLayout::*)(size_t, const InputType*) const;
+
+  TreeEnsemblePerfectLayout() = default;
+
+  // Depth of the subtree, stops as soon as it is known to exceed kMaxDepth.
+  static int ComputeDepth(const TreeNodeElement<ThresholdType>* node, int level) {
+    if (!node->is_not_leaf()) {
+      return level;
+    }
+    if (level >= kMaxDepth) {
+      return kMaxDepth + 1;
+    }
+    const int false_depth = ComputeDepth(node + 1, level + 1);
+    if (false_depth > kMaxDepth) {
+      return false_depth;
+    }
+    return std::max(false_depth, ComputeDepth(node->truenode_or_weight.ptr, level + 1));
+  }
+
+  void Build(const std::vector<TreeNodeElement<ThresholdType>*>& roots) {
+    const size_t n_internal = (size_t(1) << depth_) - 1;
+    const size_t n_leaves = size_t(1) << depth_;
+    feature_ids_.resize(roots.size() * n_internal, 0);
+    thresholds_.resize(roots.size() * n_internal, 0);
+    if (has_missing_tracks_) {
+      missing_tracks_true_.resize(roots.size() * n_internal, 0);
+    }
+    leaves_.resize(roots.size() * n_leaves, nullptr);
+    for (size_t tree = 0; tree < roots.size(); ++tree) {
+      AddNode(tree, roots[tree], 0, 0);
+    }
+  }
+
+  // Stores `node` at position `index` (breadth-first numbering) of tree `tree`.
+  void AddNode(size_t tree, const TreeNodeElement<ThresholdType>* node, size_t index, int level) {
+    const size_t n_internal = (size_t(1) << depth_) - 1;
+    if (level == depth_) {
+      leaves_[tree * (n_internal + 1) + index - n_internal] = node;
+      return;
+    }
+    if (!node->is_not_leaf()) {
+      // Padding node, both children lead to the same leaf.
+      AddNode(tree, node, 2 * index + 1, level + 1);
+      AddNode(tree, node, 2 * index + 2, level + 1);
+      return;
+    }
+    const size_t pos = tree * n_internal + index;
+    feature_ids_[pos] = node->feature_id;
+    thresholds_[pos] = node->value_or_unique_weight;
+    if (has_missing_tracks_) {
+      missing_tracks_true_[pos] = node->is_missing_track_true() ? 1 : 0;
+    }
+    AddNode(tree, node->truenode_or_weight.ptr, 2 * index + 1, level + 1);
+    AddNode(tree, node + 1, 2 * index + 2, level + 1);
+  }
+
+  template <int Depth, typename CMP, bool has_missing_tracks>
+  const TreeNodeElement<ThresholdType>* ProcessTreeImpl(size_t tree, const InputType* x_data) const {
+    constexpr size_t n_internal = (size_t(1) << Depth) - 1;
+    const int32_t* feature_ids = feature_ids_.data() + tree * n_internal;
+    const ThresholdType* thresholds = thresholds_.data() + tree * n_internal;
+    size_t index = 0;
+    for (int level = 0; level < Depth; ++level) {
+      const InputType val = x_data[feature_ids[index]];
+      size_t cond = static_cast<size_t>(CMP::Compare(val, thresholds[index]));
+      if constexpr (has_missing_tracks) {
+        cond |= static_cast<size_t>(missing_tracks_true_[tree * n_internal + index]) & static_cast<size_t>(_isnan_(val));
+      }
+      // true branch: 2i+1, false branch: 2i+2
+      index = 2 * index + 2 - cond;
+    }
+    return leaves_[tree * (n_internal + 1) + index - n_internal];
+  }
+
+  template <typename CMP, bool has_missing_tracks>
+  ProcessTreeFn SelectKernelForDepth() const {
+    switch (depth_) {
+      case 0:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<0, CMP, has_missing_tracks>;
+      case 1:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<1, CMP, has_missing_tracks>;
+      case 2:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<2, CMP, has_missing_tracks>;
+      case 3:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<3, CMP, has_missing_tracks>;
+      case 4:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<4, CMP, has_missing_tracks>;
+      case 5:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<5, CMP, has_missing_tracks>;
+      case 6:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<6, CMP, has_missing_tracks>;
+      case 7:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<7, CMP, has_missing_tracks>;
+      case 8:
+        return &TreeEnsemblePerfectLayout::ProcessTreeImpl<8, CMP, has_missing_tracks>;
+      default:
+        ORT_THROW("Unexpected depth ", depth_, " in TreeEnsemblePerfectLayout.");
+    }
+  }
+
+  template <typename CMP>
+  ProcessTreeFn SelectKernelForMissingTracks() const {
+    return has_missing_tracks_ ? SelectKernelForDepth<CMP, true>() : SelectKernelForDepth<CMP, false>();
+  }
+
+  void SelectKernel(NODE_MODE_ORT mode) {
+    // With only leaves, the depth is null and the comparison is never evaluated.
+    process_tree_ = mode == NODE_MODE_ORT::BRANCH_LT
+                        ? SelectKernelForMissingTracks<TreeBlockCompareLT>()
+                        : SelectKernelForMissingTracks<TreeBlockCompareLEQ>();
+  }
+
+  int depth_;
+  bool has_missing_tracks_;
+  ProcessTreeFn process_tree_;
+  std::vector<int32_t> feature_ids_;
+  std::vector<ThresholdType> thresholds_;
+  std::vector<uint8_t> missing_tracks_true_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+};
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -17,6 +17,8 @@
 
 #include "core/providers/cpu/nn/conv.h"
 
+#include <algorithm>
+
 #include "core/common/narrow.h"
 #include "core/common/safeint.h"
 #include "core/util/math_cpuonly.h"
@@ -153,20 +155,89 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                            /*out*/ bool& is_packed,
+                            /*out*/ PrePackedWeights* prepacked_weights) {
+  is_packed = false;
+
+  // only pack the filter, for the Winograd algorithm
+  if (input_idx != 1 || winograd_mode_ == 0) {
+    return Status::OK();
+  }
+
+  // the Winograd algorithm supports 2D convolutions with a 3x3 kernel and unit strides and dilations
+  const auto& w_shape = tensor.Shape();
+  TensorShapeVector kernel_shape;
+  if (w_shape.NumDimensions() != 4 || w_shape[2] != 3 || w_shape[3] != 3 ||
+      !conv_attrs_.ComputeKernelShape(w_shape, kernel_shape).IsOK() ||
+      kernel_shape[0] != 3 || kernel_shape[1] != 3) {
+    return Status::OK();
+  }
+
+  auto is_one = [](int64_t value) { return value == 1; };
+  if (!std::all_of(conv_attrs_.strides.begin(), conv_attrs_.strides.end(), is_one) ||
+      !std::all_of(conv_attrs_.dilations.begin(), conv_attrs_.dilations.end(), is_one) ||
+      conv_attrs_.group <= 0 || w_shape[0] % conv_attrs_.group != 0) {
+    return Status::OK();
+  }
+
+  const size_t group_count = narrow<size_t>(conv_attrs_.group);
+  const size_t input_channels = narrow<size_t>(w_shape[1]);
+  const size_t filter_count = narrow<size_t>(w_shape[0] / conv_attrs_.group);
+
+  const size_t output_tile = winograd_mode_ == kWinogradPreferred
+                                 ? MlasConvWinogradPreferredOutputTile(input_channels, filter_count)
+                                 : winograd_mode_;
+  const size_t packed_w_size =
+      output_tile == 0 ? 0 : MlasConvWinogradPackFilterSize(output_tile, group_count, input_channels, filter_count);
+  if (packed_w_size == 0) {
+    return Status::OK();
+  }
+
+  const size_t packed_w_bytes = SafeInt<size_t>(sizeof(float)) * packed_w_size;
+  packed_w_ = IAllocator::MakeUniquePtr<void>(alloc, packed_w_bytes, true);
+  MlasConvWinogradPackFilter(output_tile, group_count, input_channels, filter_count, tensor.Data<float>(),
+                             static_cast<float*>(packed_w_.get()));
+  w_shape_ = w_shape;
+  winograd_output_tile_ = output_tile;
+  is_packed = true;
+
+  if (prepacked_weights != nullptr) {
+    prepacked_weights->buffers_.push_back(std::move(packed_w_));
+    prepacked_weights->buffer_sizes_.push_back(packed_w_bytes);
+  }
+
+  return Status::OK();
+}
+
+Status Conv<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                              int input_idx,
+                                              /*out*/ bool& used_shared_buffers) {
+  used_shared_buffers = false;
+
+  if (input_idx == 1) {
+    used_shared_buffers = true;
+    packed_w_ = std::move(prepacked_buffers[0]);
+  }
+
+  return Status::OK();
+}
+
 Status Conv<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
   const Tensor* X = context->Input<Tensor>(0);
-  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* W = packed_w_ ? nullptr : context->Input<Tensor>(1);
+  const auto& W_shape = W ? W->Shape() : w_shape_;
   const Tensor* B = num_inputs >= 3 ? context->Input<Tensor>(2) : nullptr;
   const Tensor* Sum = num_inputs >= 4 ? context->Input<Tensor>(3) : nullptr;
   const int64_t N = X->Shape()[0];
   const int64_t C = X->Shape()[1];
-  const int64_t M = W->Shape()[0];
-  ORT_RETURN_IF_ERROR(conv_attrs_.ValidateInputShape(X, W));
+  const int64_t M = W_shape[0];
+  ORT_RETURN_IF_ERROR(conv_attrs_.ValidateInputShape(X->Shape(), W_shape));
 
   // kernel_shape is an optional attribute and has to be inferred from W if not provided
   TensorShapeVector kernel_shape;
-  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W->Shape(), kernel_shape));
+  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W_shape, kernel_shape));
 
   ConvPadVector pads(conv_attrs_.pads);
   if (pads.empty()) {
@@ -233,13 +304,18 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     Beta,
                     thread_pool);
 
+    if (packed_w_) {
+      ORT_RETURN_IF_NOT(MlasConvPrepareWinograd(&Parameters, winograd_output_tile_, &WorkingBufferSize, thread_pool),
+                        "The Winograd algorithm does not support this convolution.");
+    }
+
     auto* working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * SafeInt<size_t>(WorkingBufferSize))
                                                : nullptr;
     BufferUniquePtr working_buffer(working_data, BufferDeleter(std::move(alloc)));
 
     MlasConv(&Parameters,
              Xdata.data(),
-             W->Data<float>(),
+             packed_w_ ? static_cast<const float*>(packed_w_.get()) : W->Data<float>(),
              Bdata,
              static_cast<float*>(working_buffer.get()),
              Ydata.data(),
@@ -6,6 +6,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/nn/conv_attributes.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 namespace onnxruntime {
 
@@ -26,14 +27,38 @@ class Conv<float> : public OpKernel {
  public:
   Conv(const OpKernelInfo& info) : OpKernel(info), conv_attrs_(info) {
     activation_.ActivationKind = MlasIdentityActivation;
+
+    const auto winograd = info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsConvWinograd, "0");
+    if (winograd == "1") {
+      winograd_mode_ = kWinogradPreferred;
+    } else if (winograd == "4" || winograd == "6") {
+      winograd_mode_ = static_cast<size_t>(winograd[0] - '0');
+    }
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers, int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
   Status Compute(OpKernelContext* context) const override;
 
  protected:
   MLAS_ACTIVATION activation_;
 
   ConvAttributes conv_attrs_;
+
+ private:
+  // Winograd output tile requested by kOrtSessionOptionsConvWinograd, zero when disabled.
+  static constexpr size_t kWinogradPreferred = 1;
+  size_t winograd_mode_{0};
+
+  // Filter packed for the Winograd algorithm with the output tile, replacing the filter tensor.
+  IAllocatorUniquePtr<void> packed_w_;
+  TensorShape w_shape_;
+  size_t winograd_output_tile_{0};
 };
 
 }  // namespace onnxruntime
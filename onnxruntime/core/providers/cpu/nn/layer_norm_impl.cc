@@ -4,6 +4,8 @@
 #include "layer_norm_impl.h"
 #include "layer_norm_helper.h"
 
+#include <algorithm>
+
 #include "core/common/safeint.h"
 #include "core/framework/tensor.h"
 #include "core/mlas/inc/mlas.h"
@@ -41,42 +43,59 @@ void ComputeJob(
   const T* p_input = X_data + task_idx * norm_size;
   T* p_output = Y_data + task_idx * norm_size;
 
-  T mean(0.0f);
-  T mean_square(0.0f);
+  // Compute the offset of gamma and beta to support broadcasting.
+  int64_t i = LAYER_NORM_SCALE_BIAS_OFFSET(broadcast_param, task_idx, norm_size);
 
-  for (int64_t h = 0; h < norm_size; h++) {
-    p_output[h] = p_input[h];
-    mean += p_input[h];
-    mean_square += p_input[h] * p_input[h];
-  }
+  if constexpr (std::is_same_v<T, float>) {
+    float mean, inv_std_dev;
+    MlasLayerNormalizeOneRow<float>(p_input, nullptr, nullptr, scale_data + i,
+                                    bias_data == nullptr ? nullptr : bias_data + i,
+                                    static_cast<size_t>(norm_size), epsilon, simplified, p_output, nullptr,
+                                    &mean, &inv_std_dev);
 
-  mean = mean / norm_size;
-  if (simplified) {
-    mean_square = sqrt(mean_square / norm_size + epsilon);
+    if (mean_data != nullptr) {
+      mean_data[task_idx] = mean;
+    }
+
+    if (inv_std_dev_data != nullptr) {
+      inv_std_dev_data[task_idx] = inv_std_dev;
+    }
   } else {
-    mean_square = sqrt(mean_square / norm_size - mean * mean + epsilon);
-  }
+    T mean(0.0f);
+    T mean_square(0.0f);
 
-  // Compute the offset of gamma and beta to support broadcasting.
-  int64_t i = LAYER_NORM_SCALE_BIAS_OFFSET(broadcast_param, task_idx, norm_size);
+    for (int64_t h = 0; h < norm_size; h++) {
+      p_output[h] = p_input[h];
+      mean += p_input[h];
+      mean_square += p_input[h] * p_input[h];
+    }
 
-  for (int64_t h = 0; h < norm_size; h++, i++) {
+    mean = mean / norm_size;
     if (simplified) {
-      p_output[h] = p_output[h] / mean_square * scale_data[i];
-    } else if (nullptr == bias_data) {
-      p_output[h] = (p_output[h] - mean) / mean_square * scale_data[i];
+      mean_square = sqrt(mean_square / norm_size + epsilon);
     } else {
-      p_output[h] = (p_output[h] - mean) / mean_square * scale_data[i] + bias_data[i];
+      // The variance can come out slightly negative from rounding when the values are almost constant.
+      mean_square = sqrt(std::max(mean_square / norm_size - mean * mean, T(0)) + epsilon);
     }
-  }
 
-  if (mean_data != nullptr) {
-    // ONNX spec doesn't support 'double' for 'U' so when 'T' == double, 'U' == float and we need to narrow
-    mean_data[task_idx] = gsl::narrow_cast<float>(mean);
-  }
+    for (int64_t h = 0; h < norm_size; h++, i++) {
+      if (simplified) {
+        p_output[h] = p_output[h] / mean_square * scale_data[i];
+      } else if (nullptr == bias_data) {
+        p_output[h] = (p_output[h] - mean) / mean_square * scale_data[i];
+      } else {
+        p_output[h] = (p_output[h] - mean) / mean_square * scale_data[i] + bias_data[i];
+      }
+    }
 
-  if (inv_std_dev_data != nullptr) {
-    inv_std_dev_data[task_idx] = gsl::narrow_cast<float>(1 / mean_square);
+    if (mean_data != nullptr) {
+      // ONNX spec doesn't support 'double' for 'U' so when 'T' == double, 'U' == float and we need to narrow
+      mean_data[task_idx] = gsl::narrow_cast<float>(mean);
+    }
+
+    if (inv_std_dev_data != nullptr) {
+      inv_std_dev_data[task_idx] = gsl::narrow_cast<float>(1 / mean_square);
+    }
   }
 }
 
@@ -98,48 +117,19 @@ void ComputeJob(
     AllocatorPtr alloc) {
   ORT_UNUSED_PARAMETER(scale_data);  // only used in float/double overload
   ORT_UNUSED_PARAMETER(bias_data);   // only used in float/double overload
+  ORT_UNUSED_PARAMETER(alloc);
 
   const MLFloat16* p_input = X_data + task_idx * norm_size;
   MLFloat16* p_output = Y_data + task_idx * norm_size;
 
-  float mean(0.0f);
-  float mean_square(0.0f);
-
-  const size_t num_elems = static_cast<size_t>(norm_size);
-  IAllocatorUniquePtr<float> input_float_uptr = IAllocator::MakeUniquePtr<float>(alloc, num_elems);
-  MlasConvertHalfToFloatBuffer(p_input, input_float_uptr.get(), num_elems);
-
-  IAllocatorUniquePtr<float> output_float_uptr = IAllocator::MakeUniquePtr<float>(alloc, num_elems);
-  float* output_float_ptr = output_float_uptr.get();
-
-  const float* input_float_ptr = input_float_uptr.get();
-  for (size_t h = 0; h < num_elems; h++) {
-    output_float_ptr[h] = input_float_ptr[h];
-    mean += input_float_ptr[h];
-    mean_square += input_float_ptr[h] * input_float_ptr[h];
-  }
-
-  mean = mean / norm_size;
-  if (simplified) {
-    mean_square = sqrt(mean_square / norm_size + epsilon);
-  } else {
-    mean_square = sqrt(mean_square / norm_size - mean * mean + epsilon);
-  }
-
   // Compute the offset of gamma and beta to support broadcasting.
   int64_t i = LAYER_NORM_SCALE_BIAS_OFFSET(broadcast_param, task_idx, norm_size);
 
-  for (size_t h = 0; h < num_elems; h++, i++) {
-    if (simplified) {
-      output_float_ptr[h] = output_float_ptr[h] / mean_square * scale_float_ptr[i];
-    } else if (nullptr == bias_float_ptr) {
-      output_float_ptr[h] = (output_float_ptr[h] - mean) / mean_square * scale_float_ptr[i];
-    } else {
-      output_float_ptr[h] = (output_float_ptr[h] - mean) / mean_square * scale_float_ptr[i] + bias_float_ptr[i];
-    }
-  }
-
-  MlasConvertFloatToHalfBuffer(output_float_ptr, p_output, num_elems);
+  float mean, inv_std_dev;
+  MlasLayerNormalizeOneRow<MLFloat16>(p_input, nullptr, nullptr, scale_float_ptr + i,
+                                      bias_float_ptr == nullptr ? nullptr : bias_float_ptr + i,
+                                      static_cast<size_t>(norm_size), epsilon, simplified, p_output, nullptr,
+                                      &mean, &inv_std_dev);
 
   if (mean_data != nullptr) {
     // ONNX spec doesn't support 'double' for 'U' so when 'T' == double, 'U' == float and we need to narrow
@@ -147,7 +137,7 @@ void ComputeJob(
   }
 
   if (inv_std_dev_data != nullptr) {
-    inv_std_dev_data[task_idx] = MLFloat16(1 / mean_square);
+    inv_std_dev_data[task_idx] = MLFloat16(inv_std_dev);
   }
 }
 
@@ -13,10 +13,14 @@ limitations under the License.
 
 #include "non_max_suppression.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <queue>
 #include <utility>
 
 #include "core/common/narrow.h"
+#include "core/platform/threadpool.h"
 #include "non_max_suppression_helper.h"
 
 // TODO:fix the warnings
@@ -118,6 +122,203 @@ Status NonMaxSuppressionBase::GetThresholdsFromInputs(const PrepareContext& pc,
   return Status::OK();
 }
 
+namespace {
+
+struct BoxInfoPtr {
+  float score_{};
+  int64_t index_{};
+
+  BoxInfoPtr() = default;
+  explicit BoxInfoPtr(float score, int64_t idx) : score_(score), index_(idx) {}
+  inline bool operator<(const BoxInfoPtr& rhs) const {
+    return score_ < rhs.score_ || (score_ == rhs.score_ && index_ > rhs.index_);
+  }
+};
+
+// The corners of a box, computed as in SuppressByIOU
+struct BoxCorners {
+  float x_min;
+  float y_min;
+  float x_max;
+  float y_max;
+};
+
+BoxCorners GetBoxCorners(const float* box, int64_t center_point_box) {
+  BoxCorners corners;
+  // center_point_box_ only support 0 or 1
+  if (0 == center_point_box) {
+    // boxes data format [y1, x1, y2, x2],
+    MaxMin(box[1], box[3], corners.x_min, corners.x_max);
+    MaxMin(box[0], box[2], corners.y_min, corners.y_max);
+  } else {
+    // 1 == center_point_box_ => boxes data format [x_center, y_center, width, height]
+    const float width_half = box[2] / 2;
+    const float height_half = box[3] / 2;
+    corners.x_min = box[0] - width_half;
+    corners.x_max = box[0] + width_half;
+    corners.y_min = box[1] - height_half;
+    corners.y_max = box[1] + height_half;
+  }
+  return corners;
+}
+
+// Selects the boxes of a class in score order, suppressing the boxes that overlap a selected box.
+//
+// The candidates are sorted once by score, then each candidate is compared to the selected boxes by blocks. A block
+// is skipped when the candidate is beyond the bounding box of the block, and otherwise the IOUs of the block are
+// computed in a branch-free loop that the compiler vectorizes. The IOU is computed with the same operations as
+// SuppressByIOU, so the selection is the same as comparing the candidate to each selected box in turn.
+class NmsClassSelector {
+ public:
+  static constexpr size_t kBlockSize = 16;
+
+  NmsClassSelector(int64_t center_point_box, float iou_threshold)
+      : center_point_box_(center_point_box), iou_threshold_(iou_threshold) {}
+
+  // Appends the indices of the selected boxes of a class to 'selected', given the boxes of the batch and the scores
+  // of the class.
+  void Select(const float* boxes, const float* scores, int64_t num_boxes, bool use_score_threshold,
+              float score_threshold, int64_t max_output_boxes_per_class, std::vector<int64_t>& selected) {
+    candidates_.clear();
+    bool has_nan_score = false;
+    for (int64_t box_index = 0; box_index < num_boxes; ++box_index) {
+      if (!use_score_threshold || scores[box_index] > score_threshold) {
+        candidates_.emplace_back(scores[box_index], box_index);
+        has_nan_score |= std::isnan(scores[box_index]);
+      }
+    }
+
+    // The candidates are visited in the order of the pops of a max-heap. Without NaN scores, that's the order of
+    // (score descending, index ascending) that a sort gives faster. NaN scores don't have a defined order, so the
+    // heap is kept for them.
+    if (!has_nan_score) {
+      std::sort(candidates_.begin(), candidates_.end(),
+                [](const BoxInfoPtr& lhs, const BoxInfoPtr& rhs) { return rhs < lhs; });
+    } else {
+      std::priority_queue<BoxInfoPtr, std::vector<BoxInfoPtr>> sorted_boxes(std::less<BoxInfoPtr>(),
+                                                                           std::move(candidates_));
+      candidates_.clear();
+      while (!sorted_boxes.empty()) {
+        candidates_.push_back(sorted_boxes.top());
+        sorted_boxes.pop();
+      }
+    }
+
+    ClearSelected();
+    for (const auto& candidate : candidates_) {
+      if (static_cast<int64_t>(num_selected_) >= max_output_boxes_per_class) {
+        break;
+      }
+      const BoxCorners corners = GetBoxCorners(boxes + 4 * candidate.index_, center_point_box_);
+      if (!IsSuppressed(corners)) {
+        AddSelected(corners);
+        selected.push_back(candidate.index_);
+      }
+    }
+  }
+
+ private:
+  void ClearSelected() {
+    num_selected_ = 0;
+    x_min_.clear();
+    y_min_.clear();
+    x_max_.clear();
+    y_max_.clear();
+    area_.clear();
+    block_bounds_.clear();
+  }
+
+  void AddSelected(const BoxCorners& corners) {
+    if (num_selected_ % kBlockSize == 0) {
+      // grow the selected boxes by a block, with empty boxes that don't suppress any box
+      x_min_.resize(x_min_.size() + kBlockSize, 0.0f);
+      y_min_.resize(y_min_.size() + kBlockSize, 0.0f);
+      x_max_.resize(x_max_.size() + kBlockSize, 0.0f);
+      y_max_.resize(y_max_.size() + kBlockSize, 0.0f);
+      area_.resize(area_.size() + kBlockSize, 0.0f);
+      block_bounds_.push_back({std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()});
+    }
+
+    x_min_[num_selected_] = corners.x_min;
+    y_min_[num_selected_] = corners.y_min;
+    x_max_[num_selected_] = corners.x_max;
+    y_max_[num_selected_] = corners.y_max;
+    area_[num_selected_] = (corners.x_max - corners.x_min) * (corners.y_max - corners.y_min);
+
+    // The bounds ignore NaN corners, since a box with a NaN corner has a NaN area and doesn't suppress any box
+    BoxCorners& bounds = block_bounds_.back();
+    bounds.x_min = corners.x_min < bounds.x_min ? corners.x_min : bounds.x_min;
+    bounds.y_min = corners.y_min < bounds.y_min ? corners.y_min : bounds.y_min;
+    bounds.x_max = corners.x_max > bounds.x_max ? corners.x_max : bounds.x_max;
+    bounds.y_max = corners.y_max > bounds.y_max ? corners.y_max : bounds.y_max;
+
+    ++num_selected_;
+  }
+
+  bool IsSuppressed(const BoxCorners& box1) const {
+    const float area1 = (box1.x_max - box1.x_min) * (box1.y_max - box1.y_min);
+
+    for (size_t block = 0; block < block_bounds_.size(); ++block) {
+      // The intersection with any box of the block is empty if the candidate is beyond the bounds of the block
+      const BoxCorners& bounds = block_bounds_[block];
+      if (bounds.x_max <= box1.x_min || box1.x_max <= bounds.x_min ||
+          bounds.y_max <= box1.y_min || box1.y_max <= bounds.y_min) {
+        continue;
+      }
+
+      const size_t offset = block * kBlockSize;
+      const float* x2_min = x_min_.data() + offset;
+      const float* y2_min = y_min_.data() + offset;
+      const float* x2_max = x_max_.data() + offset;
+      const float* y2_max = y_max_.data() + offset;
+      const float* area2 = area_.data() + offset;
+
+      int suppressed = 0;
+      for (size_t i = 0; i < kBlockSize; ++i) {
+        // HelperMax(a, b) is (a < b) ? b : a, HelperMin(a, b) is (b < a) ? b : a
+        const float intersection_x_min = box1.x_min < x2_min[i] ? x2_min[i] : box1.x_min;
+        const float intersection_x_max = x2_max[i] < box1.x_max ? x2_max[i] : box1.x_max;
+        const float intersection_y_min = box1.y_min < y2_min[i] ? y2_min[i] : box1.y_min;
+        const float intersection_y_max = y2_max[i] < box1.y_max ? y2_max[i] : box1.y_max;
+        const float intersection_area = (intersection_x_max - intersection_x_min) *
+                                        (intersection_y_max - intersection_y_min);
+        const float union_area = area1 + area2[i] - intersection_area;
+
+        suppressed |= static_cast<int>(!(intersection_x_max <= intersection_x_min)) &
+                      static_cast<int>(!(intersection_y_max <= intersection_y_min)) &
+                      static_cast<int>(!(intersection_area <= .0f)) &
+                      static_cast<int>(!(area1 <= .0f)) &
+                      static_cast<int>(!(area2[i] <= .0f)) &
+                      static_cast<int>(!(union_area <= .0f)) &
+                      static_cast<int>(intersection_area / union_area > iou_threshold_);
+      }
+
+      if (suppressed) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  const int64_t center_point_box_;
+  const float iou_threshold_;
+
+  std::vector<BoxInfoPtr> candidates_;
+
+  // the corners and the areas of the selected boxes, by blocks of kBlockSize
+  size_t num_selected_ = 0;
+  std::vector<float> x_min_;
+  std::vector<float> y_min_;
+  std::vector<float> x_max_;
+  std::vector<float> y_max_;
+  std::vector<float> area_;
+  std::vector<BoxCorners> block_bounds_;
+};
+
+}  // namespace
+
 Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
   PrepareContext pc;
   ORT_RETURN_IF_ERROR(PrepareCompute(ctx, pc));
@@ -136,74 +337,43 @@ Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
   const auto* const boxes_data = pc.boxes_data_;
   const auto* const scores_data = pc.scores_data_;
 
-  struct BoxInfoPtr {
-    float score_{};
-    int64_t index_{};
-
-    BoxInfoPtr() = default;
-    explicit BoxInfoPtr(float score, int64_t idx) : score_(score), index_(idx) {}
-    inline bool operator<(const BoxInfoPtr& rhs) const {
-      return score_ < rhs.score_ || (score_ == rhs.score_ && index_ > rhs.index_);
-    }
-  };
-
   const auto center_point_box = GetCenterPointBox();
 
-  std::vector<SelectedIndex> selected_indices;
-  std::vector<BoxInfoPtr> selected_boxes_inside_class;
-  selected_boxes_inside_class.reserve(std::min<size_t>(static_cast<size_t>(max_output_boxes_per_class), pc.num_boxes_));
-
-  for (int64_t batch_index = 0; batch_index < pc.num_batches_; ++batch_index) {
-    for (int64_t class_index = 0; class_index < pc.num_classes_; ++class_index) {
-      int64_t box_score_offset = (batch_index * pc.num_classes_ + class_index) * pc.num_boxes_;
-      const float* batch_boxes = boxes_data + (batch_index * pc.num_boxes_ * 4);
-      std::vector<BoxInfoPtr> candidate_boxes;
-      candidate_boxes.reserve(pc.num_boxes_);
-
-      // Filter by score_threshold_
-      const auto* class_scores = scores_data + box_score_offset;
-      if (pc.score_threshold_ != nullptr) {
-        for (int64_t box_index = 0; box_index < pc.num_boxes_; ++box_index, ++class_scores) {
-          if (*class_scores > score_threshold) {
-            candidate_boxes.emplace_back(*class_scores, box_index);
-          }
-        }
-      } else {
-        for (int64_t box_index = 0; box_index < pc.num_boxes_; ++box_index, ++class_scores) {
-          candidate_boxes.emplace_back(*class_scores, box_index);
-        }
-      }
-      std::priority_queue<BoxInfoPtr, std::vector<BoxInfoPtr>> sorted_boxes(std::less<BoxInfoPtr>(), std::move(candidate_boxes));
-
-      selected_boxes_inside_class.clear();
-      // Get the next box with top score, filter by iou_threshold
-      while (!sorted_boxes.empty() && static_cast<int64_t>(selected_boxes_inside_class.size()) < max_output_boxes_per_class) {
-        const BoxInfoPtr& next_top_score = sorted_boxes.top();
-
-        bool selected = true;
-        // Check with existing selected boxes for this class, suppress if exceed the IOU (Intersection Over Union) threshold
-        for (const auto& selected_index : selected_boxes_inside_class) {
-          if (SuppressByIOU(batch_boxes, next_top_score.index_, selected_index.index_, center_point_box, iou_threshold)) {
-            selected = false;
-            break;
-          }
+  // The classes of the batches are selected in parallel, then the selected boxes are output in (batch, class) order
+  const int64_t num_batch_classes = pc.num_batches_ * pc.num_classes_;
+  std::vector<std::vector<int64_t>> selected_boxes(narrow<size_t>(num_batch_classes));
+
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), narrow<std::ptrdiff_t>(num_batch_classes),
+      static_cast<double>(pc.num_boxes_) * 64.0,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        NmsClassSelector selector(center_point_box, iou_threshold);
+        for (std::ptrdiff_t batch_class = first; batch_class < last; ++batch_class) {
+          const int64_t batch_index = batch_class / pc.num_classes_;
+          const float* batch_boxes = boxes_data + (batch_index * pc.num_boxes_ * 4);
+          int64_t box_score_offset = batch_class * pc.num_boxes_;
+          auto& selected = selected_boxes[narrow<size_t>(batch_class)];
+          selected.reserve(std::min<size_t>(static_cast<size_t>(max_output_boxes_per_class), pc.num_boxes_));
+          selector.Select(batch_boxes, scores_data + box_score_offset, pc.num_boxes_, pc.score_threshold_ != nullptr,
+                          score_threshold, max_output_boxes_per_class, selected);
         }
+      });
 
-        if (selected) {
-          selected_boxes_inside_class.push_back(next_top_score);
-          selected_indices.emplace_back(batch_index, class_index, next_top_score.index_);
-        }
-        sorted_boxes.pop();
-      }  // while
-    }  // for class_index
-  }  // for batch_index
+  size_t num_selected = 0;
+  for (const auto& selected : selected_boxes) {
+    num_selected += selected.size();
+  }
 
   constexpr auto last_dim = 3;
-  const auto num_selected = selected_indices.size();
   Tensor* output = ctx->Output(0, {static_cast<int64_t>(num_selected), last_dim});
   ORT_ENFORCE(output != nullptr);
   static_assert(last_dim * sizeof(int64_t) == sizeof(SelectedIndex), "Possible modification of SelectedIndex");
-  memcpy(output->MutableData<int64_t>(), selected_indices.data(), num_selected * sizeof(SelectedIndex));
+  auto* selected_indices = reinterpret_cast<SelectedIndex*>(output->MutableData<int64_t>());
+  for (int64_t batch_class = 0; batch_class < num_batch_classes; ++batch_class) {
+    for (int64_t box_index : selected_boxes[narrow<size_t>(batch_class)]) {
+      *selected_indices++ = SelectedIndex(batch_class / pc.num_classes_, batch_class % pc.num_classes_, box_index);
+    }
+  }
 
   return Status::OK();
 }
@@ -15,6 +15,15 @@ enum struct RoiAlignMode {
   max
 };
 
+#ifndef SHARED_PROVIDER
+// Computes the output of RoiAlign of the given shape [num_rois, C, output_height, output_width].
+template <typename T>
+void RoiAlignForward(const TensorShape& output_shape, const T* bottom_data, float spatial_scale, int64_t height,
+                     int64_t width, int64_t sampling_ratio, const T* bottom_rois, int64_t num_roi_cols, T* top_data,
+                     RoiAlignMode mode, bool half_pixel, const int64_t* batch_indices_ptr,
+                     concurrency::ThreadPool* ttp);
+#endif
+
 class RoiAlignBase {
  public:
   explicit RoiAlignBase(const OpKernelInfo& info) {
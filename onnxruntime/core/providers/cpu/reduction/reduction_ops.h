@@ -14,6 +14,7 @@
 #include "core/framework/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/platform/threadpool.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/cpu/reduction/reduction_kernel_base.h"
 #include "core/common/safeint.h"
 #include <cmath>
@@ -155,12 +156,22 @@ class ReduceAggregatorBase {
  public:
   // Fast reduction: see OptimizeShapeForFastReduce's comment.
   static inline FastReduceKind WhichFastReduce() { return FastReduceKind::kNone; }
+  // True if MLAS implements the fast reductions KR, RK and KRK, they are then faster than
+  // the generic implementation for any shape.
+  static inline bool UseMlasFastReduce() { return false; }
   static void FastReduceKR(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
   static void FastReduceRK(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
   static void FastReduceKRK(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
   static void FastReduceRKR(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
 };
 
+// Reduces the middle dimension of the input viewed as [outer, reduce, inner] with MLAS, see MlasReduce.
+inline void MlasFastReduce(MLAS_REDUCE_KIND kind, const Tensor& input, Tensor& output,
+                           int64_t outer, int64_t reduce, int64_t inner, concurrency::ThreadPool* tp) {
+  MlasReduce(kind, input.Data<float>(), output.MutableData<float>(), onnxruntime::narrow<size_t>(outer),
+             onnxruntime::narrow<size_t>(reduce), onnxruntime::narrow<size_t>(inner), tp);
+}
+
 template <typename T, typename TVAL = T>
 class ReduceAggregator : public ReduceAggregatorBase {
  public:
@@ -228,54 +239,67 @@ class ReduceAggregatorSum : public ReduceAggregator<T, T> {
   static inline FastReduceKind WhichFastReduce() {
     return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK | FastReduceKind::kRKR;
   }
+  static inline bool UseMlasFastReduce() { return std::is_same_v<T, float>; }
 
   static void FastReduceKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    const T* data = input.Data<T>();
-    T* out = output.MutableData<T>();
-    int64_t stridei = fast_shape[1];
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(1, stridei, sizeof(T), 6),
-        [data, stridei, out](ptrdiff_t first, ptrdiff_t last) {
-          for (ptrdiff_t d = first; d < last; ++d) {
-            out[d] = aggall(data + d * stridei, stridei);
-          }
-        });
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSum, input, output, fast_shape[0], fast_shape[1], 1, tp);
+    } else {
+      const T* data = input.Data<T>();
+      T* out = output.MutableData<T>();
+      int64_t stridei = fast_shape[1];
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(1, stridei, sizeof(T), 6),
+          [data, stridei, out](ptrdiff_t first, ptrdiff_t last) {
+            for (ptrdiff_t d = first; d < last; ++d) {
+              out[d] = aggall(data + d * stridei, stridei);
+            }
+          });
+    }
   }
 
   static void FastReduceRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    int64_t N = fast_shape[1];
-    const T* data = input.Data<T>();
-    T* out = output.MutableData<T>();
-
-    int64_t n_rows = fast_shape[0];
-    memcpy(out, data, SafeInt<size_t>(N) * sizeof(T));
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<std::ptrdiff_t>(N), ParallelReduceFastCost(1, n_rows, sizeof(T), 6),
-        [data, out, N, n_rows](ptrdiff_t begin, ptrdiff_t end) {
-          for (int64_t row = 1; row < n_rows; ++row) {
-            EigenVectorArrayMap<T>(out + begin, end - begin) += ConstEigenVectorArrayMap<T>(
-                data + row * N + begin, end - begin);
-          }
-        });
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSum, input, output, 1, fast_shape[0], fast_shape[1], tp);
+    } else {
+      int64_t N = fast_shape[1];
+      const T* data = input.Data<T>();
+      T* out = output.MutableData<T>();
+
+      int64_t n_rows = fast_shape[0];
+      memcpy(out, data, SafeInt<size_t>(N) * sizeof(T));
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<std::ptrdiff_t>(N), ParallelReduceFastCost(1, n_rows, sizeof(T), 6),
+          [data, out, N, n_rows](ptrdiff_t begin, ptrdiff_t end) {
+            for (int64_t row = 1; row < n_rows; ++row) {
+              EigenVectorArrayMap<T>(out + begin, end - begin) += ConstEigenVectorArrayMap<T>(
+                  data + row * N + begin, end - begin);
+            }
+          });
+    }
   }
 
   static void FastReduceKRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                             Tensor& output, concurrency::ThreadPool* tp) {
-    int64_t N = fast_shape[2];
-    const T* data = input.Data<T>();
-    int64_t stridei = fast_shape[1] * fast_shape[2];
-    int64_t strideo = fast_shape[2];
-    T* out = output.MutableData<T>();
-    std::vector<T> one(onnxruntime::narrow<size_t>(fast_shape[1]), 1);
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(fast_shape[1], fast_shape[2], sizeof(T), 6),
-        [one, data, fast_shape, stridei, strideo, out, N](ptrdiff_t begin, ptrdiff_t last) {
-          for (ptrdiff_t d = begin; d < last; ++d) {
-            math::MatMul<T>(1, onnxruntime::narrow<ptrdiff_t>(N), onnxruntime::narrow<ptrdiff_t>(fast_shape[1]), one.data(), data + stridei * d, out + strideo * d, nullptr);
-          }
-        });
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSum, input, output, fast_shape[0], fast_shape[1], fast_shape[2], tp);
+    } else {
+      int64_t N = fast_shape[2];
+      const T* data = input.Data<T>();
+      int64_t stridei = fast_shape[1] * fast_shape[2];
+      int64_t strideo = fast_shape[2];
+      T* out = output.MutableData<T>();
+      std::vector<T> one(onnxruntime::narrow<size_t>(fast_shape[1]), 1);
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(fast_shape[1], fast_shape[2], sizeof(T), 6),
+          [one, data, fast_shape, stridei, strideo, out, N](ptrdiff_t begin, ptrdiff_t last) {
+            for (ptrdiff_t d = begin; d < last; ++d) {
+              math::MatMul<T>(1, onnxruntime::narrow<ptrdiff_t>(N), onnxruntime::narrow<ptrdiff_t>(fast_shape[1]), one.data(), data + stridei * d, out + strideo * d, nullptr);
+            }
+          });
+    }
   }
 
   static void FastReduceRKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
@@ -300,6 +324,43 @@ class ReduceAggregatorSumSquare : public ReduceAggregator<T, TVAL> {
   static void fill_for_empty_set(Tensor& output) {
     EigenMap<T>(output).array() = static_cast<T>(0);
   }
+
+  // Fast reduction, only implemented for float.
+  static inline FastReduceKind WhichFastReduce() {
+    if constexpr (std::is_same_v<T, float>) {
+      return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK;
+    } else {
+      return FastReduceKind::kNone;
+    }
+  }
+  static inline bool UseMlasFastReduce() { return std::is_same_v<T, float>; }
+
+  static void FastReduceKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                           Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSumSquare, input, output, fast_shape[0], fast_shape[1], 1, tp);
+    } else {
+      ReduceAggregatorBase::FastReduceKR(input, fast_shape, output, tp);
+    }
+  }
+
+  static void FastReduceRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                           Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSumSquare, input, output, 1, fast_shape[0], fast_shape[1], tp);
+    } else {
+      ReduceAggregatorBase::FastReduceRK(input, fast_shape, output, tp);
+    }
+  }
+
+  static void FastReduceKRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                            Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceSumSquare, input, output, fast_shape[0], fast_shape[1], fast_shape[2], tp);
+    } else {
+      ReduceAggregatorBase::FastReduceKRK(input, fast_shape, output, tp);
+    }
+  }
 };
 
 template <typename T>
@@ -319,39 +380,51 @@ class ReduceAggregatorMean : public ReduceAggregatorSum<T> {
 
   static void FastReduceKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    ReduceAggregatorSum<T>::FastReduceKR(input, fast_shape, output, tp);
-    // TODO: use MLAS or BLAS
-    T* out = output.MutableData<T>();
-    T* end = out + fast_shape[0];
-    for (; out != end; ++out) {
-      *out /= static_cast<T>(fast_shape[1]);
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMean, input, output, fast_shape[0], fast_shape[1], 1, tp);
+    } else {
+      ReduceAggregatorSum<T>::FastReduceKR(input, fast_shape, output, tp);
+      // TODO: use MLAS or BLAS
+      T* out = output.MutableData<T>();
+      T* end = out + fast_shape[0];
+      for (; out != end; ++out) {
+        *out /= static_cast<T>(fast_shape[1]);
+      }
     }
   }
 
   static void FastReduceRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    ReduceAggregatorSum<T>::FastReduceRK(input, fast_shape, output, tp);
-    // TODO: use MLAS or BLAS
-    T* out = output.MutableData<T>();
-    T* end = out + fast_shape[1];
-    for (; out != end; ++out) {
-      *out /= static_cast<T>(fast_shape[0]);
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMean, input, output, 1, fast_shape[0], fast_shape[1], tp);
+    } else {
+      ReduceAggregatorSum<T>::FastReduceRK(input, fast_shape, output, tp);
+      // TODO: use MLAS or BLAS
+      T* out = output.MutableData<T>();
+      T* end = out + fast_shape[1];
+      for (; out != end; ++out) {
+        *out /= static_cast<T>(fast_shape[0]);
+      }
     }
   }
 
   static void FastReduceKRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                             Tensor& output, concurrency::ThreadPool* tp) {
-    ReduceAggregatorSum<T>::FastReduceKRK(input, fast_shape, output, tp);
-    int64_t strideo = fast_shape[2];
-    T* out = output.MutableData<T>();
-    T* begin;
-    T* end;
-    T div = static_cast<T>(fast_shape[1]);
-    for (int64_t d = 0; d < fast_shape[0]; ++d) {
-      begin = out + strideo * d;
-      end = begin + strideo;
-      for (; begin != end; ++begin) {
-        *begin /= div;
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMean, input, output, fast_shape[0], fast_shape[1], fast_shape[2], tp);
+    } else {
+      ReduceAggregatorSum<T>::FastReduceKRK(input, fast_shape, output, tp);
+      int64_t strideo = fast_shape[2];
+      T* out = output.MutableData<T>();
+      T* begin;
+      T* end;
+      T div = static_cast<T>(fast_shape[1]);
+      for (int64_t d = 0; d < fast_shape[0]; ++d) {
+        begin = out + strideo * d;
+        end = begin + strideo;
+        for (; begin != end; ++begin) {
+          *begin /= div;
+        }
       }
     }
   }
@@ -396,84 +469,97 @@ class ReduceAggregatorMax : public ReduceAggregator<T> {
   static inline FastReduceKind WhichFastReduce() {
     return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK | FastReduceKind::kRKR;
   }
+  static inline bool UseMlasFastReduce() { return std::is_same_v<T, float>; }
 
   static void FastReduceKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    const T* data = input.Data<T>();
-    T* out = output.MutableData<T>();
-    int64_t stridei = fast_shape[1];
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(1, stridei, sizeof(T), 6),
-        [data, stridei, out](std::ptrdiff_t first, std::ptrdiff_t last) {
-          if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
-            EigenVectorMap<bool>(out + first, last - first) = ConstEigenMatrixMap<bool>(
-                                                                  data + first * stridei, onnxruntime::narrow<size_t>(stridei), last - first)
-                                                                  .cast<unsigned char>()
-                                                                  .colwise()
-                                                                  .maxCoeff()
-                                                                  .cast<bool>();
-          } else {
-            EigenVectorMap<T>(out + first, last - first) = ConstEigenMatrixMap<T>(
-                                                               data + first * stridei, onnxruntime::narrow<size_t>(stridei), last - first)
-                                                               .colwise()
-                                                               .maxCoeff();
-          }
-        });
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMaximum, input, output, fast_shape[0], fast_shape[1], 1, tp);
+    } else {
+      const T* data = input.Data<T>();
+      T* out = output.MutableData<T>();
+      int64_t stridei = fast_shape[1];
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(1, stridei, sizeof(T), 6),
+          [data, stridei, out](std::ptrdiff_t first, std::ptrdiff_t last) {
+            if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
+              EigenVectorMap<bool>(out + first, last - first) = ConstEigenMatrixMap<bool>(
+                                                                    data + first * stridei, onnxruntime::narrow<size_t>(stridei), last - first)
+                                                                    .cast<unsigned char>()
+                                                                    .colwise()
+                                                                    .maxCoeff()
+                                                                    .cast<bool>();
+            } else {
+              EigenVectorMap<T>(out + first, last - first) = ConstEigenMatrixMap<T>(
+                                                                 data + first * stridei, onnxruntime::narrow<size_t>(stridei), last - first)
+                                                                 .colwise()
+                                                                 .maxCoeff();
+            }
+          });
+    }
   }
 
   static void FastReduceRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                            Tensor& output, concurrency::ThreadPool* tp) {
-    int64_t n_rows = fast_shape[0];
-    int64_t N = fast_shape[1];
-    const T* data = input.Data<T>();
-    T* out = output.MutableData<T>();
-    memcpy(out, data, SafeInt<size_t>(N) * sizeof(T));
-
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<std::ptrdiff_t>(N), ParallelReduceFastCost(1, n_rows, sizeof(T), 6),
-        [data, out, N, n_rows](ptrdiff_t begin, ptrdiff_t end) {
-          const T* p;
-          for (int64_t row = 1; row < n_rows; ++row) {
-            p = data + row * N;
-            for (int64_t j = begin; j < end; ++j) {
-              if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
-                out[j] = out[j] || p[j];
-              } else {
-                if (out[j] < p[j])
-                  out[j] = p[j];
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMaximum, input, output, 1, fast_shape[0], fast_shape[1], tp);
+    } else {
+      int64_t n_rows = fast_shape[0];
+      int64_t N = fast_shape[1];
+      const T* data = input.Data<T>();
+      T* out = output.MutableData<T>();
+      memcpy(out, data, SafeInt<size_t>(N) * sizeof(T));
+
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<std::ptrdiff_t>(N), ParallelReduceFastCost(1, n_rows, sizeof(T), 6),
+          [data, out, N, n_rows](ptrdiff_t begin, ptrdiff_t end) {
+            const T* p;
+            for (int64_t row = 1; row < n_rows; ++row) {
+              p = data + row * N;
+              for (int64_t j = begin; j < end; ++j) {
+                if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
+                  out[j] = out[j] || p[j];
+                } else {
+                  if (out[j] < p[j])
+                    out[j] = p[j];
+                }
               }
             }
-          }
-        });
+          });
+    }
   }
 
   static void FastReduceKRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                             Tensor& output, concurrency::ThreadPool* tp) {
-    const T* data = input.Data<T>();
-    T* out = output.MutableData<T>();
-    int64_t stridei = fast_shape[1] * fast_shape[2];
-    int64_t strideo = fast_shape[2];
-    concurrency::ThreadPool::TryParallelFor(
-        tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(fast_shape[1], fast_shape[2], sizeof(T), 6),
-        [data, fast_shape, stridei, strideo, out](ptrdiff_t begin, ptrdiff_t end) {
-          for (ptrdiff_t j = begin; j < end; ++j) {
-            if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
-              EigenVectorMap<bool>(out + j * strideo, onnxruntime::narrow<size_t>(strideo)) =
-                  ConstEigenMatrixMap<bool>(
-                      data + j * stridei, onnxruntime::narrow<size_t>(fast_shape[2]), onnxruntime::narrow<size_t>(fast_shape[1]))
-                      .cast<unsigned char>()
-                      .rowwise()
-                      .maxCoeff()
-                      .cast<bool>();
-            } else {
-              EigenVectorMap<T>(out + j * strideo, onnxruntime::narrow<size_t>(strideo)) =
-                  ConstEigenMatrixMap<T>(
-                      data + j * stridei, onnxruntime::narrow<size_t>(fast_shape[2]), onnxruntime::narrow<size_t>(fast_shape[1]))
-                      .rowwise()
-                      .maxCoeff();
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceMaximum, input, output, fast_shape[0], fast_shape[1], fast_shape[2], tp);
+    } else {
+      const T* data = input.Data<T>();
+      T* out = output.MutableData<T>();
+      int64_t stridei = fast_shape[1] * fast_shape[2];
+      int64_t strideo = fast_shape[2];
+      concurrency::ThreadPool::TryParallelFor(
+          tp, onnxruntime::narrow<std::ptrdiff_t>(fast_shape[0]), ParallelReduceFastCost(fast_shape[1], fast_shape[2], sizeof(T), 6),
+          [data, fast_shape, stridei, strideo, out](ptrdiff_t begin, ptrdiff_t end) {
+            for (ptrdiff_t j = begin; j < end; ++j) {
+              if constexpr (std::is_same_v<bool, T>) { /* bool specific impl */
+                EigenVectorMap<bool>(out + j * strideo, onnxruntime::narrow<size_t>(strideo)) =
+                    ConstEigenMatrixMap<bool>(
+                        data + j * stridei, onnxruntime::narrow<size_t>(fast_shape[2]), onnxruntime::narrow<size_t>(fast_shape[1]))
+                        .cast<unsigned char>()
+                        .rowwise()
+                        .maxCoeff()
+                        .cast<bool>();
+              } else {
+                EigenVectorMap<T>(out + j * strideo, onnxruntime::narrow<size_t>(strideo)) =
+                    ConstEigenMatrixMap<T>(
+                        data + j * stridei, onnxruntime::narrow<size_t>(fast_shape[2]), onnxruntime::narrow<size_t>(fast_shape[1]))
+                        .rowwise()
+                        .maxCoeff();
+              }
             }
-          }
-        });
+          });
+    }
   }
 
   static void FastReduceRKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
@@ -782,6 +868,43 @@ class ReduceAggregatorLogSumExp : public ReduceAggregator<T, T> {
   static void fill_for_empty_set(Tensor& output) {
     EigenMap<T>(output).array() = -std::numeric_limits<T>::infinity();
   }
+
+  // Fast reduction, only implemented for float.
+  static inline FastReduceKind WhichFastReduce() {
+    if constexpr (std::is_same_v<T, float>) {
+      return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK;
+    } else {
+      return FastReduceKind::kNone;
+    }
+  }
+  static inline bool UseMlasFastReduce() { return std::is_same_v<T, float>; }
+
+  static void FastReduceKR(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                           Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceLogSumExp, input, output, fast_shape[0], fast_shape[1], 1, tp);
+    } else {
+      ReduceAggregatorBase::FastReduceKR(input, fast_shape, output, tp);
+    }
+  }
+
+  static void FastReduceRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                           Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceLogSumExp, input, output, 1, fast_shape[0], fast_shape[1], tp);
+    } else {
+      ReduceAggregatorBase::FastReduceRK(input, fast_shape, output, tp);
+    }
+  }
+
+  static void FastReduceKRK(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                            Tensor& output, concurrency::ThreadPool* tp) {
+    if constexpr (std::is_same_v<T, float>) {
+      MlasFastReduce(MlasReduceLogSumExp, input, output, fast_shape[0], fast_shape[1], fast_shape[2], tp);
+    } else {
+      ReduceAggregatorBase::FastReduceKRK(input, fast_shape, output, tp);
+    }
+  }
 };
 
 void NoTransposePrepareForReduce(const TensorShape& new_input_shape,
@@ -109,22 +109,26 @@ T GsBicubicInterpolate(T p[4][4], T x, T y) {
 }
 
 template <typename T>
-T GridSample<T>::PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, T border[/* 4 */]) const {
-  T pixel = {};  // default 0
+int64_t GridSample<T>::PixelOffsetAtGrid(int64_t r, int64_t c, int64_t H, int64_t W, const T border[/* 4 */]) const {
   if (padding_mode_ == Zeros) {
     if (c >= 0 && c < W && r >= 0 && r < H) {
-      pixel = image[r * W + c];
+      return r * W + c;
     }
+    return -1;
   } else if (padding_mode_ == Border) {
     c = std::clamp<int64_t>(c, 0, W - 1);
     r = std::clamp<int64_t>(r, 0, H - 1);
-    pixel = image[r * W + c];
   } else {  // (padding_mode_ == Reflection)
     c = static_cast<int64_t>(GsReflect(static_cast<T>(c), border[0], border[2]));
     r = static_cast<int64_t>(GsReflect(static_cast<T>(r), border[1], border[3]));
-    pixel = image[r * W + c];
   }
-  return pixel;
+  return r * W + c;
+}
+
+template <typename T>
+T GridSample<T>::PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, const T border[/* 4 */]) const {
+  const int64_t offset = PixelOffsetAtGrid(r, c, H, W, border);
+  return offset >= 0 ? image[offset] : T{};  // default 0
 }
 
 template <typename T>
@@ -148,6 +152,123 @@ T GridSample<T>::PixelAtGrid3D(const T* image, int64_t d, int64_t h, int64_t w,
   return pixel;
 }
 
+// The output points are sampled by tiles. The pixel offsets and the weights of the points of a tile are computed
+// once, then shared by all the channels, so that the per-channel loops are only gathers and multiply-adds. The tiles
+// of all the images are processed in parallel, which also spreads the images with few channels over the threads.
+template <typename T>
+void GridSample<T>::Sample2D(const T* input, const T* grid, T* output, int64_t N, int64_t C, int64_t H_in, int64_t W_in,
+                             int64_t H_out, int64_t W_out, concurrency::ThreadPool* tp) const {
+  constexpr int64_t kTileSize = 256;
+
+  T x_min = -0.5f;
+  T x_max = W_in - 0.5f;
+  T y_min = -0.5f;
+  T y_max = H_in - 0.5f;
+
+  if (align_corners_) {
+    x_min = 0.f;
+    x_max = W_in - 1.f;
+    y_min = 0.f;
+    y_max = H_in - 1.f;
+  }
+  const T border[] = {x_min, y_min, x_max, y_max};  // l-t-r-b
+
+  const int64_t output_size = H_out * W_out;
+  const int64_t num_tiles = (output_size + kTileSize - 1) / kTileSize;
+  const double cost_per_point = mode_ == Cubic ? 64.0 : (mode_ == Linear ? 8.0 : 2.0);
+
+  concurrency::ThreadPool::TryParallelFor(
+      output_size > 64 ? tp : nullptr, onnxruntime::narrow<std::ptrdiff_t>(N * num_tiles),
+      static_cast<double>(kTileSize * C) * cost_per_point,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        // pixel offsets of the (top-left, top-right, bottom-left, bottom-right) neighbours, -1 for a zero padding
+        int64_t offsets[kTileSize][4];
+        // (dx1, dx2, dy1, dy2) in linear mode, the actual location (x, y) in cubic mode
+        T weights[kTileSize][4];
+
+        for (std::ptrdiff_t task = first; task < last; ++task) {
+          const int64_t n = task / num_tiles;
+          const int64_t tile_begin = (task % num_tiles) * kTileSize;
+          const int64_t tile_size = std::min(kTileSize, output_size - tile_begin);
+          const T* grid_data = grid + (n * output_size + tile_begin) * 2;
+
+          for (int64_t i = 0; i < tile_size; i++) {
+            const T* gridpoint = grid_data + i * 2;
+            auto nx = gridpoint[0];  // normalized location
+            auto ny = gridpoint[1];
+            auto x = GsDenormalize<T>(nx, W_in, align_corners_);  // actual location
+            auto y = GsDenormalize<T>(ny, H_in, align_corners_);
+
+            if (mode_ == Nearest) {
+              x = static_cast<T>(std::nearbyint(static_cast<T>(x)));
+              y = static_cast<T>(std::nearbyint(static_cast<T>(y)));
+              // x, y are integers in all padding modes
+              offsets[i][0] = PixelOffsetAtGrid(static_cast<int64_t>(y), static_cast<int64_t>(x), H_in, W_in, border);
+            } else if (mode_ == Linear) {
+              int64_t x1 = static_cast<int64_t>(std::floor(x));
+              int64_t y1 = static_cast<int64_t>(std::floor(y));
+              int64_t x2 = x1 + 1;
+              int64_t y2 = y1 + 1;
+
+              offsets[i][0] = PixelOffsetAtGrid(y1, x1, H_in, W_in, border);
+              offsets[i][1] = PixelOffsetAtGrid(y1, x2, H_in, W_in, border);
+              offsets[i][2] = PixelOffsetAtGrid(y2, x1, H_in, W_in, border);
+              offsets[i][3] = PixelOffsetAtGrid(y2, x2, H_in, W_in, border);
+
+              weights[i][0] = x - static_cast<T>(x1);
+              weights[i][1] = static_cast<T>(x2) - x;
+              weights[i][2] = y - static_cast<T>(y1);
+              weights[i][3] = static_cast<T>(y2) - y;
+            } else if (mode_ == Cubic) {
+              weights[i][0] = x;
+              weights[i][1] = y;
+            }
+          }
+
+          for (int64_t c = 0; c < C; c++) {
+            const T* X_data = input + (n * C + c) * (H_in * W_in);
+            T* Y_data = output + (n * C + c) * output_size + tile_begin;
+
+            if (mode_ == Nearest) {
+              for (int64_t i = 0; i < tile_size; i++) {
+                Y_data[i] = offsets[i][0] >= 0 ? X_data[offsets[i][0]] : T{};
+              }
+            } else if (mode_ == Linear) {
+              for (int64_t i = 0; i < tile_size; i++) {
+                const T p11 = offsets[i][0] >= 0 ? X_data[offsets[i][0]] : T{};
+                const T p12 = offsets[i][1] >= 0 ? X_data[offsets[i][1]] : T{};
+                const T p21 = offsets[i][2] >= 0 ? X_data[offsets[i][2]] : T{};
+                const T p22 = offsets[i][3] >= 0 ? X_data[offsets[i][3]] : T{};
+
+                const T dx1 = weights[i][0];
+                const T dx2 = weights[i][1];
+                const T dy1 = weights[i][2];
+                const T dy2 = weights[i][3];
+                Y_data[i] = dy2 * (dx2 * p11 + dx1 * p12) + dy1 * (dx2 * p21 + dx1 * p22);
+              }
+            } else if (mode_ == Cubic) {
+              for (int64_t i = 0; i < tile_size; i++) {
+                const T x = weights[i][0];
+                const T y = weights[i][1];
+                int64_t x0 = static_cast<int64_t>(std::floor(x)) - 1;  // top-left corner of the bbox
+                int64_t y0 = static_cast<int64_t>(std::floor(y)) - 1;
+
+                T p[4][4] = {};  // [H][W]
+                for (int64_t h = 0; h < 4; h++) {
+                  for (int64_t w = 0; w < 4; w++) {
+                    p[h][w] = PixelAtGrid(X_data, h + y0, w + x0, H_in, W_in, border);
+                  }
+                }
+                T dx = static_cast<T>(x - x0 - 1);
+                T dy = static_cast<T>(y - y0 - 1);
+                Y_data[i] = GsBicubicInterpolate(p, dx, dy);
+              }
+            }
+          }
+        }
+      });
+}
+
 // When grid sampling, padding is applied before interpolation.
 // For instance, in bilinear mode and zeros padding-mode, pixel p at actual
 // image location (-0.5, -0.5)
@@ -196,76 +317,8 @@ Status GridSample<T>::Compute(OpKernelContext* context) const {
       return Status::OK();
     }
 
-    T x_min = -0.5f;
-    T x_max = W_in - 0.5f;
-    T y_min = -0.5f;
-    T y_max = H_in - 0.5f;
-
-    if (align_corners_) {
-      x_min = 0.f;
-      x_max = W_in - 1.f;
-      y_min = 0.f;
-      y_max = H_in - 1.f;
-    }
-    T border[] = {x_min, y_min, x_max, y_max};  // l-t-r-b
-
-    concurrency::ThreadPool* tp = H_out * W_out > 64 ? context->GetOperatorThreadPool() : nullptr;
-    for (int64_t n = 0; n < N; n++) {
-      const T* grid_data = grid->Data<T>() + n * (H_out * W_out) * 2;
-      concurrency::ThreadPool::TrySimpleParallelFor(
-          tp, onnxruntime::narrow<std::ptrdiff_t>(C),
-          [&](std::ptrdiff_t c) {
-            const T* X_data = input->Data<T>() + (n * C + c) * (H_in * W_in);
-            T* Y_data = Y.MutableData<T>() + (n * C + c) * (H_out * W_out);
-
-            for (int64_t oy = 0; oy < H_out; oy++) {
-              for (int64_t ox = 0; ox < W_out; ox++) {
-                const T* gridpoint = grid_data + (oy * W_out + ox) * 2;
-                T* Y_gridpoint = Y_data + oy * W_out + ox;
-                auto nx = gridpoint[0];  // normalized location
-                auto ny = gridpoint[1];
-                auto x = GsDenormalize<T>(nx, W_in, align_corners_);  // actual location
-                auto y = GsDenormalize<T>(ny, H_in, align_corners_);
-
-                if (mode_ == Nearest) {
-                  x = static_cast<T>(std::nearbyint(static_cast<T>(x)));
-                  y = static_cast<T>(std::nearbyint(static_cast<T>(y)));
-                  // x, y are integers in all padding modes
-                  *Y_gridpoint = PixelAtGrid(X_data, static_cast<int64_t>(y), static_cast<int64_t>(x), H_in, W_in, border);
-                } else if (mode_ == Linear) {
-                  int64_t x1 = static_cast<int64_t>(std::floor(x));
-                  int64_t y1 = static_cast<int64_t>(std::floor(y));
-                  int64_t x2 = x1 + 1;
-                  int64_t y2 = y1 + 1;
-
-                  T p11 = PixelAtGrid(X_data, y1, x1, H_in, W_in, border);
-                  T p12 = PixelAtGrid(X_data, y1, x2, H_in, W_in, border);
-                  T p21 = PixelAtGrid(X_data, y2, x1, H_in, W_in, border);
-                  T p22 = PixelAtGrid(X_data, y2, x2, H_in, W_in, border);
-
-                  T dx2 = static_cast<T>(x2) - x;
-                  T dx1 = x - static_cast<T>(x1);
-                  T dy2 = static_cast<T>(y2) - y;
-                  T dy1 = y - static_cast<T>(y1);
-                  *Y_gridpoint = dy2 * (dx2 * p11 + dx1 * p12) + dy1 * (dx2 * p21 + dx1 * p22);
-                } else if (mode_ == Cubic) {
-                  int64_t x0 = static_cast<int64_t>(std::floor(x)) - 1;  // top-left corner of the bbox
-                  int64_t y0 = static_cast<int64_t>(std::floor(y)) - 1;
-
-                  T p[4][4] = {};  // [H][W]
-                  for (int64_t h = 0; h < 4; h++) {
-                    for (int64_t w = 0; w < 4; w++) {
-                      p[h][w] = PixelAtGrid(X_data, h + y0, w + x0, H_in, W_in, border);
-                    }
-                  }
-                  T dx = static_cast<T>(x - x0 - 1);
-                  T dy = static_cast<T>(y - y0 - 1);
-                  *Y_gridpoint = GsBicubicInterpolate(p, dx, dy);
-                }
-              }
-            }
-          });
-    }
+    Sample2D(input->Data<T>(), grid->Data<T>(), Y.MutableData<T>(), N, C, H_in, W_in, H_out, W_out,
+             context->GetOperatorThreadPool());
   } else if (data_dims == 3) {
     // sample 3d;
     auto D_in = input_dims[2];
@@ -367,4 +420,7 @@ Status GridSample<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
+template class GridSample<float>;
+template class GridSample<double>;
+
 }  // namespace onnxruntime
@@ -55,6 +55,11 @@ class GridSample final : public OpKernel {
 
   Status Compute(OpKernelContext* context) const override;
 
+  // Samples the 2-D images of input [N, C, H_in, W_in] at the locations of grid [N, H_out, W_out, 2] into
+  // output [N, C, H_out, W_out].
+  void Sample2D(const T* input, const T* grid, T* output, int64_t N, int64_t C, int64_t H_in, int64_t W_in,
+                int64_t H_out, int64_t W_out, concurrency::ThreadPool* tp) const;
+
  private:
   typedef enum {
     Linear,
@@ -68,7 +73,9 @@ class GridSample final : public OpKernel {
     Reflection
   };
 
-  T PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, T border[/* 4 */]) const;
+  // Returns the offset of the pixel at (r, c) after padding, or -1 if the pixel is a zero padding.
+  int64_t PixelOffsetAtGrid(int64_t r, int64_t c, int64_t H, int64_t W, const T border[/* 4 */]) const;
+  T PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, const T border[/* 4 */]) const;
   T PixelAtGrid3D(const T* image, int64_t d, int64_t h, int64_t w, int64_t D, int64_t H, int64_t W, T border[/* 6 */]) const;
 
   GridSampleInterpolationMode mode_{Linear};
@@ -7,6 +7,7 @@
 
 #include "core/common/inlined_containers.h"
 #include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 #include "core/providers/cpu/tensor/upsample_antialias.h"
 
@@ -556,6 +557,70 @@ BilinearParams SetupUpsampleBilinear(const int32_t input_height,
   return p;
 }
 
+void UpsampleBilinearSeparable(const BilinearParams& p,
+                               const int32_t input_height,
+                               const int32_t input_width,
+                               const int32_t output_width,
+                               const int32_t num_channels,
+                               const bool use_extrapolation,
+                               const float extrapolation_value,
+                               const float* const Xdata,
+                               float* const Ydata,
+                               const int32_t output_y_begin,
+                               const int32_t output_y_end,
+                               const int32_t output_x_begin,
+                               const int32_t output_x_end,
+                               float* const row_buffer) {
+  const size_t channels = narrow<size_t>(num_channels);
+  const size_t row_size = narrow<size_t>(output_x_end - output_x_begin) * channels;
+
+  // The buffer holds 2 horizontally interpolated input rows, tagged with their offset in the input
+  float* const rows[2] = {row_buffer, row_buffer + row_size};
+  int32_t row_offsets[2] = {-1, -1};
+
+  // Returns the horizontally interpolated input row, interpolating it in the slot that doesn't hold `keep_offset`
+  // if it isn't cached
+  auto get_row = [&](int32_t input_row_offset, int32_t keep_offset) -> const float* {
+    for (size_t slot = 0; slot < 2; ++slot) {
+      if (row_offsets[slot] == input_row_offset) {
+        return rows[slot];
+      }
+    }
+    const size_t slot = row_offsets[0] == keep_offset ? 1 : 0;
+    MlasResizeHorizontalLinear(Xdata + narrow<size_t>(input_row_offset) * channels, channels,
+                               narrow<size_t>(output_x_end - output_x_begin),
+                               p.in_x1 + output_x_begin, p.in_x2 + output_x_begin,
+                               p.dx2 + output_x_begin, p.dx1 + output_x_begin, rows[slot]);
+    row_offsets[slot] = input_row_offset;
+    return rows[slot];
+  };
+
+  for (int32_t y = output_y_begin; y < output_y_end; ++y) {
+    float* const Yrow = Ydata + (narrow<size_t>(y) * narrow<size_t>(output_width) + narrow<size_t>(output_x_begin)) * channels;
+
+    // when use_extrapolation is set and original index of x or y is out of the dim range
+    // then use extrapolation_value as the output value.
+    if (use_extrapolation &&
+        (p.y_original[y] < 0 || p.y_original[y] > static_cast<float>(input_height - 1))) {
+      std::fill_n(Yrow, row_size, extrapolation_value);
+      continue;
+    }
+
+    const float* const row1 = get_row(p.input_width_mul_y1[y], p.input_width_mul_y2[y]);
+    const float* const row2 = get_row(p.input_width_mul_y2[y], p.input_width_mul_y1[y]);
+    const float weights[2] = {p.dy2[y], p.dy1[y]};
+    MlasResizeVerticalFilter(row1, row2 - row1, weights, 2, row_size, Yrow);
+
+    if (use_extrapolation) {
+      for (int32_t x = output_x_begin; x < output_x_end; ++x) {
+        if (p.x_original[x] < 0 || p.x_original[x] > static_cast<float>(input_width - 1)) {
+          std::fill_n(Yrow + narrow<size_t>(x - output_x_begin) * channels, channels, extrapolation_value);
+        }
+      }
+    }
+  }
+}
+
 // Same as above, but doesn't use any floating-point for the coefficient (i.e., d*_scale_10) computation
 BilinearParamsInteger SetupUpsampleBilinearInteger(const int32_t input_height,
                                                    const int32_t input_width,
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 #ifndef SHARED_PROVIDER
 #include "core/framework/op_kernel.h"
@@ -81,6 +84,25 @@ BilinearParams SetupUpsampleBilinear(const int32_t input_height,
                                      const GetOriginalCoordinateFunc& get_original_coordinate,
                                      const bool is_nchw);
 
+// Computes the output pixels [output_x_begin, output_x_end) of the output rows [output_y_begin, output_y_end) of a
+// float image with interleaved channels (1 channel for a plane of a NCHW tensor). The input rows are interpolated
+// horizontally, then vertically, and an input row is interpolated horizontally once for consecutive output rows.
+// `row_buffer` holds 2 * (output_x_end - output_x_begin) * num_channels elements.
+void UpsampleBilinearSeparable(const BilinearParams& p,
+                               const int32_t input_height,
+                               const int32_t input_width,
+                               const int32_t output_width,
+                               const int32_t num_channels,
+                               const bool use_extrapolation,
+                               const float extrapolation_value,
+                               const float* const Xdata,
+                               float* const Ydata,
+                               const int32_t output_y_begin,
+                               const int32_t output_y_end,
+                               const int32_t output_x_begin,
+                               const int32_t output_x_end,
+                               float* const row_buffer);
+
 template <typename T>
 void UpsampleBilinear(const int32_t batch_size,
                       const int32_t num_channels,
@@ -101,34 +123,37 @@ void UpsampleBilinear(const int32_t batch_size,
   BilinearParams p = SetupUpsampleBilinear(input_height, input_width, output_height, output_width,
                                            height_scale, width_scale, roi,
                                            alloc, get_original_coordinate, true);
+  const SafeInt<size_t> input_size = SafeInt<size_t>(input_height) * input_width;
+  const SafeInt<size_t> output_size = SafeInt<size_t>(output_height) * output_width;
   for (int32_t n = 0; n < batch_size; ++n) {
     concurrency::ThreadPool::TrySimpleParallelFor(
         tp, num_channels,
         [&](std::ptrdiff_t c) {
-          const T* const Xdata =
-              XdataBase + (n * num_channels + static_cast<int32_t>(c)) * (input_height * input_width);
+          const T* const Xdata = XdataBase + (n * num_channels + static_cast<int32_t>(c)) * (input_height * input_width);
           T* const Ydata = YdataBase + (n * num_channels + static_cast<int32_t>(c)) * (output_height * output_width);
-          for (int32_t y = 0; y < output_height; ++y) {
-            for (int32_t x = 0; x < output_width; ++x) {
-              const int32_t output_offset = output_width * y + x;
-              // when use_extrapolation is set and original index of x or y is out of the dim range
-              // then use extrapolation_value as the output value.
-              if (use_extrapolation &&
-                  ((p.y_original[y] < 0 || p.y_original[y] > static_cast<float>(input_height - 1)) ||
-                   (p.x_original[x] < 0 || p.x_original[x] > static_cast<float>(input_width - 1)))) {
-                Ydata[output_offset] = static_cast<T>(extrapolation_value);
-                continue;
+          auto row_buffer = IAllocator::MakeUniquePtr<float>(alloc, SafeInt<size_t>(output_width) * 2);
+          if constexpr (std::is_same_v<T, float>) {
+            UpsampleBilinearSeparable(p, input_height, input_width, output_width, 1,
+                                      use_extrapolation, extrapolation_value, Xdata, Ydata,
+                                      0, output_height, 0, output_width, row_buffer.get());
+          } else {
+            // An integer plane is interpolated in float, then rounded to the nearest like the antialias path
+            auto input_plane = IAllocator::MakeUniquePtr<float>(alloc, input_size);
+            auto output_plane = IAllocator::MakeUniquePtr<float>(alloc, output_size);
+            for (size_t i = 0; i < static_cast<size_t>(input_size); ++i) {
+              input_plane.get()[i] = static_cast<float>(Xdata[i]);
+            }
+            UpsampleBilinearSeparable(p, input_height, input_width, output_width, 1,
+                                      use_extrapolation, extrapolation_value, input_plane.get(), output_plane.get(),
+                                      0, output_height, 0, output_width, row_buffer.get());
+            for (size_t i = 0; i < static_cast<size_t>(output_size); ++i) {
+              const float value = std::round(output_plane.get()[i]);
+              if constexpr (is_8bit_v<T>) {
+                Ydata[i] = static_cast<T>(std::clamp(value, static_cast<float>(std::numeric_limits<T>::lowest()),
+                                                     static_cast<float>(std::numeric_limits<T>::max())));
+              } else {
+                Ydata[i] = static_cast<T>(value);
               }
-
-              T X11 = Xdata[p.input_width_mul_y1[y] + p.in_x1[x]];
-              T X21 = Xdata[p.input_width_mul_y1[y] + p.in_x2[x]];
-              T X12 = Xdata[p.input_width_mul_y2[y] + p.in_x1[x]];
-              T X22 = Xdata[p.input_width_mul_y2[y] + p.in_x2[x]];
-
-              Ydata[output_offset] = static_cast<T>(p.dx2[x] * p.dy2[y] * X11 +
-                                                    p.dx1[x] * p.dy2[y] * X21 +
-                                                    p.dx2[x] * p.dy1[y] * X12 +
-                                                    p.dx1[x] * p.dy1[y] * X22);
             }
           }
         });
@@ -154,6 +179,34 @@ void NhwcUpsampleBilinear(const int32_t batch_size,
   BilinearParams p = SetupUpsampleBilinear(input_height, input_width, output_height, output_width,
                                            height_scale, width_scale, roi,
                                            alloc, get_original_coordinate, false);
+  if constexpr (std::is_same_v<T, float>) {
+    // Split the output rows in blocks of pixels, so that a few wide rows can also be processed in parallel
+    const int32_t x_block_size = std::max<int32_t>(1, 4096 / num_channels);
+    const int32_t num_x_blocks = (output_width + x_block_size - 1) / x_block_size;
+    for (int32_t n = 0; n < batch_size; ++n) {
+      const float* const Xdata = XdataBase + n * (input_height * input_width) * num_channels;
+      float* const Ydata = YdataBase + n * (output_height * output_width) * num_channels;
+      concurrency::ThreadPool::TryParallelFor(
+          tp, static_cast<std::ptrdiff_t>(num_x_blocks) * output_height,
+          static_cast<double>(x_block_size) * num_channels * 2,
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            auto row_buffer = IAllocator::MakeUniquePtr<float>(alloc, SafeInt<size_t>(x_block_size) * num_channels * 2);
+            // The work items of a block of pixels are consecutive output rows
+            for (std::ptrdiff_t i = first; i < last;) {
+              const int32_t x_block = static_cast<int32_t>(i / output_height);
+              const int32_t y_begin = static_cast<int32_t>(i % output_height);
+              const int32_t y_end = static_cast<int32_t>(std::min<std::ptrdiff_t>(output_height, y_begin + (last - i)));
+              UpsampleBilinearSeparable(p, input_height, input_width, output_width, num_channels,
+                                        UseExtrapolation, extrapolation_value, Xdata, Ydata, y_begin, y_end,
+                                        x_block * x_block_size, std::min(output_width, (x_block + 1) * x_block_size),
+                                        row_buffer.get());
+              i += y_end - y_begin;
+            }
+          });
+    }
+    return;
+  }
+
   for (int32_t n = 0; n < batch_size; ++n) {
     const T* const Xdata = XdataBase + n * (input_height * input_width) * num_channels;
     T* const Ydata = YdataBase + n * (output_height * output_width) * num_channels;
@@ -13,6 +13,7 @@
 #include <cmath>  // for round
 #include <vector>
 #include "core/framework/tensor.h"
+#include "core/mlas/inc/mlas.h"
 #include "gsl/span"
 #ifndef SHARED_PROVIDER
 #include "core/framework/op_kernel.h"
@@ -291,6 +292,53 @@ void ComputeInterpolationAtLevel1(int64_t num_channels, int64_t input_height, in
       });
 }
 
+/**
+ * @brief To calculate an output row of the interpolation along with penultimate axis.
+ * The input rows of the window are summed with a loop over the taps outside a loop over the row, so that the inner
+ * loop is a contiguous multiply-add that the compiler vectorizes. Float rows use the MLAS kernel.
+ * Each element is summed in tap order as before, so the results are unchanged.
+ * @param Xdata The input tensor data of the channel.
+ * @param output_width The number of W in CHW.
+ * @param ymin The first input row of the window.
+ * @param ymax The end of the input rows of the window.
+ * @param weight_coeff The weights of the input rows of the window.
+ * @param clip8_lookups The lookup table to clip the 8-bit results.
+ * @param Ydata The output row.
+ * @param accumulate_row A buffer of output_width elements to accumulate the non-float rows.
+ */
+template <typename InputType, typename AccumulateType>
+void ComputeInterpolationRowAtLevel2(const InputType* Xdata, int64_t output_width, int64_t ymin, int64_t ymax,
+                                     const AccumulateType* weight_coeff, const uint8_t* clip8_lookups,
+                                     InputType* Ydata, AccumulateType* accumulate_row) {
+  const size_t row_size = narrow<size_t>(output_width);
+  if constexpr (std::is_same<InputType, float>::value && std::is_same<AccumulateType, float>::value) {
+    ORT_UNUSED_PARAMETER(clip8_lookups);
+    ORT_UNUSED_PARAMETER(accumulate_row);
+    MlasResizeVerticalFilter(Xdata + ymin * output_width, narrow<ptrdiff_t>(output_width), weight_coeff,
+                             narrow<size_t>(ymax - ymin), row_size, Ydata);
+  } else {
+    std::fill_n(accumulate_row, row_size, is_8bit_v<InputType> ? ConstValue::mag_factor : AccumulateType{0});
+    for (auto idx = ymin; idx < ymax; ++idx) {
+      const InputType* Xdata_row = Xdata + idx * output_width;
+      const AccumulateType weight = *weight_coeff++;
+      for (size_t x = 0; x < row_size; ++x) {
+        accumulate_row[x] += Xdata_row[x] * weight;
+      }
+    }
+
+    for (size_t x = 0; x < row_size; ++x) {
+      const AccumulateType output = accumulate_row[x];
+      if constexpr (is_8bit_v<InputType>) {
+        Ydata[x] = static_cast<InputType>(clip8_lookups[output >> 22]);
+      } else if constexpr (std::is_same<InputType, int32_t>::value) {
+        Ydata[x] = narrow<int32_t>(std::round(output));
+      } else {  // float double
+        Ydata[x] = output;
+      }
+    }
+  }
+}
+
 /**
  * @brief To calculate interpolation along with penultimate axis.
  * For brief, we assume the input tensor has 3 dimensions and we all it CHW for each character represent a dim.
@@ -335,30 +383,14 @@ void ComputeInterpolationAtLevel2(int64_t num_channels, int64_t input_height, in
             return;
           }
 
+          std::vector<AccumulateType> accumulate_row(narrow<size_t>(output_width));
           const auto* y_bound = p_dim.bound.data();
           for (size_t y = 0; y < narrow<size_t>(output_height); ++y) {
             const auto* weight_coeff = p_dim.weight_coefficients.get() + p_dim.window_size * y;
             int64_t ymin = *y_bound++;
             int64_t ymax = *y_bound++;
-            auto* Ydata_offset = Ydata + output_width * y;
-            for (size_t x = 0; x < narrow<size_t>(output_width); ++x) {
-              AccumulateType output = is_8bit_v<InputType> ? ConstValue::mag_factor : 0;
-              auto* weight_coeff_start = weight_coeff;
-
-              const auto* Xdata_offset = Xdata + ymin * output_width + x;
-              for (auto idx = ymin; idx < ymax; ++idx) {
-                output += *Xdata_offset * (*weight_coeff_start++);
-                Xdata_offset += output_width;
-              }
-
-              if constexpr (is_8bit_v<InputType>) {
-                *Ydata_offset++ = static_cast<InputType>(clip8_lookups[output >> 22]);
-              } else if constexpr (std::is_same<InputType, int32_t>::value) {
-                *Ydata_offset++ = narrow<int32_t>(std::round(output));
-              } else {  // float double
-                *Ydata_offset++ = output;
-              }
-            }
+            ComputeInterpolationRowAtLevel2(Xdata, output_width, ymin, ymax, weight_coeff, clip8_lookups,
+                                            Ydata + output_width * y, accumulate_row.data());
           }
         });
   } else {
@@ -373,6 +405,7 @@ void ComputeInterpolationAtLevel2(int64_t num_channels, int64_t input_height, in
             return;
           }
 
+          std::vector<AccumulateType> accumulate_row(narrow<size_t>(output_width));
           for (auto start = first; start != last; start++) {
             auto c = start / output_height;
             auto y = start % output_height;
@@ -387,25 +420,8 @@ void ComputeInterpolationAtLevel2(int64_t num_channels, int64_t input_height, in
             const auto* weight_coeff = p_dim.weight_coefficients.get() + p_dim.window_size * y;
             int64_t ymin = y_bound[2 * narrow<size_t>(y)];
             int64_t ymax = y_bound[2 * narrow<size_t>(y) + 1];
-            auto* Ydata_offset = Ydata + output_width * y;
-            for (size_t x = 0; x < narrow<size_t>(output_width); ++x) {
-              AccumulateType output = is_8bit_v<InputType> ? ConstValue::mag_factor : 0;
-              auto* weight_coeff_start = weight_coeff;
-
-              const auto* Xdata_offset = Xdata + ymin * output_width + x;
-              for (auto idx = ymin; idx < ymax; ++idx) {
-                output += *Xdata_offset * (*weight_coeff_start++);
-                Xdata_offset += output_width;
-              }
-
-              if constexpr (is_8bit_v<InputType>) {
-                *Ydata_offset++ = static_cast<InputType>(clip8_lookups[output >> 22]);
-              } else if constexpr (std::is_same<InputType, int32_t>::value) {
-                *Ydata_offset++ = narrow<int32_t>(std::round(output));
-              } else {  // float double
-                *Ydata_offset++ = output;
-              }
-            }
+            ComputeInterpolationRowAtLevel2(Xdata, output_width, ymin, ymax, weight_coeff, clip8_lookups,
+                                            Ydata + output_width * y, accumulate_row.data());
           }
         });
   }
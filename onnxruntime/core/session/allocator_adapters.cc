@@ -102,6 +102,10 @@ std::unordered_map<std::string, std::string> OrtAllocatorImplWrappingIAllocator:
     entries.insert_or_assign("NumArenaExtensions", std::to_string(stats.num_arena_extensions));
     entries.insert_or_assign("NumArenaShrinkages", std::to_string(stats.num_arena_shrinkages));
     entries.insert_or_assign("MaxAllocSize", std::to_string(stats.max_alloc_size));
+    if (stats.num_cache_hits > 0 || stats.num_cache_misses > 0) {
+      entries.insert_or_assign("NumCacheHits", std::to_string(stats.num_cache_hits));
+      entries.insert_or_assign("NumCacheMisses", std::to_string(stats.num_cache_misses));
+    }
   }
   return entries;
 }
@@ -183,6 +187,10 @@ void IAllocatorImplWrappingOrtAllocator::GetStats(AllocatorStats* stats) {
         stats->num_arena_shrinkages = std::stoll(values[i]);
       } else if (strcmp(keys[i], "MaxAllocSize") == 0) {
         stats->max_alloc_size = std::stoll(values[i]);
+      } else if (strcmp(keys[i], "NumCacheHits") == 0) {
+        stats->num_cache_hits = std::stoll(values[i]);
+      } else if (strcmp(keys[i], "NumCacheMisses") == 0) {
+        stats->num_cache_misses = std::stoll(values[i]);
       }
     }
   }
@@ -1021,6 +1021,15 @@ common::Status InferenceSession::LoadOnnxModel(const PathString& model_uri) {
 
     const bool strict_shape_type_inference = session_options_.config_options.GetConfigOrDefault(
                                                  kOrtSessionOptionsConfigStrictShapeTypeInference, "0") == "1";
+    if (session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsLoadModelWithMappedInitializers,
+                                                           "0") == "1") {
+      ModelProto model_proto;
+      ORT_RETURN_IF_ERROR(onnxruntime::Model::LoadWithMappedInitializers(model_location_, model_proto));
+      return onnxruntime::Model::Load(std::move(model_proto), model_location_, model,
+                                      HasLocalSchema() ? &custom_schema_registries_ : nullptr, *session_logger_,
+                                      ModelOptions(true, strict_shape_type_inference,
+                                                   check_load_cancellation_fn_));
+    }
     return onnxruntime::Model::Load(model_location_, model, HasLocalSchema() ? &custom_schema_registries_ : nullptr,
                                     *session_logger_,
                                     ModelOptions(true, strict_shape_type_inference,
@@ -2510,6 +2519,15 @@ common::Status InferenceSession::Initialize() {
     // Resolve memory pattern flags of the main graph and subgraph session states
     ResolveMemoryPatternFlags(*session_state_);
 
+    ORT_RETURN_IF_ERROR_SESSIONID_(MicroBatcher::Create(
+        session_options_.config_options,
+        [this](const RunOptions& run_options, gsl::span<const std::string> feed_names,
+               gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+               std::vector<OrtValue>& fetches) {
+          return RunImpl(run_options, feed_names, feeds, output_names, &fetches, nullptr);
+        },
+        session_state_->GetAllocator(OrtDevice()), micro_batcher_));
+
     is_inited_ = true;
 
     if (!using_ort_model_bytes_for_initializers_) {
@@ -2928,6 +2946,17 @@ Status InferenceSession::Run(const RunOptions& run_options,
                              gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
                              gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
                              const std::vector<OrtDevice>* p_fetches_device_info) {
+  if (micro_batcher_ != nullptr &&
+      micro_batcher_->CanBatch(run_options, feed_names, feeds, p_fetches, p_fetches_device_info)) {
+    return micro_batcher_->Run(run_options, feed_names, feeds, output_names, *p_fetches);
+  }
+  return RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info);
+}
+
+Status InferenceSession::RunImpl(const RunOptions& run_options,
+                                 gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                 gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
+                                 const std::vector<OrtDevice>* p_fetches_device_info) {
   TimePoint tp = std::chrono::high_resolution_clock::now();
   if (session_profiler_.IsEnabled()) {
     tp = session_profiler_.Start();
@@ -3163,7 +3192,7 @@ Status InferenceSession::Run(const RunOptions& run_options,
       cached_execution_provider_for_graph_replay_.AllowGraphCaptureOnRun(graph_annotation_id) &&
       !cached_execution_provider_for_graph_replay_.IsGraphCaptured(graph_annotation_id)) {
     LOGS(*session_logger_, INFO) << "Start another run for necessary memory allocation or graph capture.";
-    ORT_RETURN_IF_ERROR(Run(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
+    ORT_RETURN_IF_ERROR(RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
   }
 
   // Log runtime error telemetry if the return value is not OK
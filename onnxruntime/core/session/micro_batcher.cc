@@ -0,0 +1,282 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/micro_batcher.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "core/common/parse_string.h"
+#include "core/framework/tensor.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+
+namespace onnxruntime {
+
+namespace {
+
+bool IsBatchableTensor(const OrtValue& value, size_t batch_axis) {
+  if (!value.IsTensor()) {
+    return false;
+  }
+  const Tensor& tensor = value.Get<Tensor>();
+  return tensor.Location().device.Type() == OrtDevice::CPU &&
+         !tensor.IsDataTypeString() &&
+         tensor.Shape().NumDimensions() > batch_axis;
+}
+
+// Copies `rows` rows of the batch axis between a tensor and a batched tensor, in `outer` blocks.
+// `row_bytes` is the size of one row, all the dimensions after the batch axis.
+void CopyRows(const char* src, int64_t src_rows, int64_t src_offset,
+              char* dst, int64_t dst_rows, int64_t dst_offset,
+              int64_t rows, int64_t outer, size_t row_bytes) {
+  for (int64_t o = 0; o < outer; ++o) {
+    std::memcpy(dst + (o * dst_rows + dst_offset) * row_bytes,
+                src + (o * src_rows + src_offset) * row_bytes,
+                static_cast<size_t>(rows) * row_bytes);
+  }
+}
+
+}  // namespace
+
+MicroBatcher::MicroBatcher(int64_t max_batch_size, std::chrono::microseconds max_latency, size_t batch_axis,
+                           RunFn run_fn, AllocatorPtr cpu_allocator)
+    : max_batch_size_(max_batch_size),
+      max_latency_(max_latency),
+      batch_axis_(batch_axis),
+      run_fn_(std::move(run_fn)),
+      cpu_allocator_(std::move(cpu_allocator)) {
+}
+
+Status MicroBatcher::Create(const ConfigOptions& config_options, RunFn run_fn, AllocatorPtr cpu_allocator,
+                            std::unique_ptr<MicroBatcher>& micro_batcher) {
+  micro_batcher.reset();
+
+  const std::string max_batch_size_str =
+      config_options.GetConfigOrDefault(kOrtSessionOptionsMicroBatchingMaxBatchSize, "0");
+  int64_t max_batch_size = 0;
+  ORT_RETURN_IF_NOT(TryParseStringWithClassicLocale(max_batch_size_str, max_batch_size) && max_batch_size >= 0,
+                    "Invalid value for ", kOrtSessionOptionsMicroBatchingMaxBatchSize, ": ", max_batch_size_str);
+  if (max_batch_size <= 1) {
+    return Status::OK();
+  }
+
+  const std::string max_latency_str =
+      config_options.GetConfigOrDefault(kOrtSessionOptionsMicroBatchingMaxLatencyUs, "1000");
+  int64_t max_latency_us = 0;
+  ORT_RETURN_IF_NOT(TryParseStringWithClassicLocale(max_latency_str, max_latency_us) && max_latency_us >= 0,
+                    "Invalid value for ", kOrtSessionOptionsMicroBatchingMaxLatencyUs, ": ", max_latency_str);
+
+  const std::string batch_axis_str = config_options.GetConfigOrDefault(kOrtSessionOptionsMicroBatchingBatchAxis, "0");
+  size_t batch_axis = 0;
+  ORT_RETURN_IF_NOT(TryParseStringWithClassicLocale(batch_axis_str, batch_axis),
+                    "Invalid value for ", kOrtSessionOptionsMicroBatchingBatchAxis, ": ", batch_axis_str);
+
+  micro_batcher = std::make_unique<MicroBatcher>(max_batch_size, std::chrono::microseconds(max_latency_us),
+                                                 batch_axis, std::move(run_fn), std::move(cpu_allocator));
+  return Status::OK();
+}
+
+bool MicroBatcher::CanBatch(const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                            gsl::span<const OrtValue> feeds, const std::vector<OrtValue>* p_fetches,
+                            const std::vector<OrtDevice>* p_fetches_device_info) const {
+  // The batch runs with the options of its leader, requests with specific options run alone.
+  if (run_options.terminate || run_options.only_execute_path_to_fetches ||
+      !run_options.config_options.configurations.empty() || !run_options.active_adapters.empty()) {
+    return false;
+  }
+  if (p_fetches_device_info != nullptr || p_fetches == nullptr || feeds.empty() ||
+      feed_names.size() != feeds.size()) {
+    return false;
+  }
+  for (const auto& fetch : *p_fetches) {
+    if (fetch.IsAllocated()) {
+      return false;
+    }
+  }
+
+  int64_t rows = -1;
+  for (const auto& feed : feeds) {
+    if (!IsBatchableTensor(feed, batch_axis_)) {
+      return false;
+    }
+    const int64_t feed_rows = feed.Get<Tensor>().Shape()[batch_axis_];
+    if (rows != -1 && feed_rows != rows) {
+      return false;
+    }
+    rows = feed_rows;
+  }
+  return rows > 0 && rows < max_batch_size_;
+}
+
+std::string MicroBatcher::Signature(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                    gsl::span<const std::string> output_names) const {
+  std::ostringstream signature;
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    const Tensor& tensor = feeds[i].Get<Tensor>();
+    signature << feed_names[i] << ':' << tensor.GetElementType();
+    const auto dims = tensor.Shape().GetDims();
+    for (size_t d = 0; d < dims.size(); ++d) {
+      signature << ',';
+      if (d == batch_axis_) {
+        signature << '*';
+      } else {
+        signature << dims[d];
+      }
+    }
+    signature << ';';
+  }
+  signature << '|';
+  for (const auto& name : output_names) {
+    signature << name << ';';
+  }
+  return signature.str();
+}
+
+Status MicroBatcher::Run(const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                         gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                         std::vector<OrtValue>& fetches) {
+  Request request{&run_options, feed_names, feeds, output_names, &fetches,
+                  feeds[0].Get<Tensor>().Shape()[batch_axis_], Status::OK()};
+  const std::string signature = Signature(feed_names, feeds, output_names);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = open_batches_.find(signature);
+  if (it != open_batches_.end() && it->second->rows + request.rows <= max_batch_size_) {
+    // Join the batch, its leader runs it.
+    std::shared_ptr<Batch> batch = it->second;
+    batch->requests.push_back(&request);
+    batch->rows += request.rows;
+    if (batch->rows == max_batch_size_) {
+      batch->full = true;
+      open_batches_.erase(it);
+      batch->cv.notify_all();
+    }
+    batch->cv.wait(lock, [&request]() { return request.done; });
+    return request.status;
+  }
+
+  if (it != open_batches_.end()) {
+    // The open batch cannot take this request, dispatch it now and lead the next one.
+    it->second->full = true;
+    it->second->cv.notify_all();
+  }
+
+  // Lead a new batch.
+  auto batch = std::make_shared<Batch>();
+  batch->requests.push_back(&request);
+  batch->rows = request.rows;
+  open_batches_[signature] = batch;
+  batch->cv.wait_for(lock, max_latency_, [&batch]() { return batch->full; });
+  it = open_batches_.find(signature);
+  if (it != open_batches_.end() && it->second == batch) {
+    open_batches_.erase(it);
+  }
+  lock.unlock();
+
+  // No request joins the batch anymore, it runs without holding the lock.
+  Execute(*batch);
+
+  lock.lock();
+  for (Request* member : batch->requests) {
+    member->done = true;
+  }
+  batch->cv.notify_all();
+  return request.status;
+}
+
+void MicroBatcher::Execute(Batch& batch) {
+  num_requests_.fetch_add(static_cast<int64_t>(batch.requests.size()), std::memory_order_relaxed);
+
+  if (batch.requests.size() > 1) {
+    Status status;
+    ORT_TRY {
+      status = ExecuteBatched(batch);
+    }
+    ORT_CATCH(const std::exception& e) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, e.what());
+      });
+    }
+    if (status.IsOK()) {
+      return;
+    }
+    // Isolate the requests, each one gets its own outputs and status.
+    for (Request* request : batch.requests) {
+      request->fetches->clear();
+    }
+  }
+
+  for (Request* request : batch.requests) {
+    num_executions_.fetch_add(1, std::memory_order_relaxed);
+    request->status = run_fn_(*request->run_options, request->feed_names, request->feeds, request->output_names,
+                              *request->fetches);
+  }
+}
+
+Status MicroBatcher::ExecuteBatched(Batch& batch) {
+  const Request& leader = *batch.requests.front();
+
+  std::vector<OrtValue> batched_feeds(leader.feeds.size());
+  for (size_t i = 0; i < batched_feeds.size(); ++i) {
+    ORT_RETURN_IF_ERROR(Concatenate(batch, i, batched_feeds[i]));
+  }
+
+  num_executions_.fetch_add(1, std::memory_order_relaxed);
+  std::vector<OrtValue> batched_fetches;
+  ORT_RETURN_IF_ERROR(run_fn_(*leader.run_options, leader.feed_names, batched_feeds, leader.output_names,
+                              batched_fetches));
+
+  for (Request* request : batch.requests) {
+    request->fetches->assign(batched_fetches.size(), OrtValue());
+  }
+  for (size_t i = 0; i < batched_fetches.size(); ++i) {
+    ORT_RETURN_IF_ERROR(Split(batched_fetches[i], batch, i));
+  }
+  return Status::OK();
+}
+
+Status MicroBatcher::Concatenate(const Batch& batch, size_t feed_index, OrtValue& batched) const {
+  const Tensor& first = batch.requests.front()->feeds[feed_index].Get<Tensor>();
+  TensorShape shape = first.Shape();
+  shape[batch_axis_] = batch.rows;
+  Tensor::InitOrtValue(first.DataType(), shape, cpu_allocator_, batched);
+
+  Tensor& dst = *batched.GetMutable<Tensor>();
+  const int64_t outer = shape.SizeToDimension(batch_axis_);
+  const size_t row_bytes = static_cast<size_t>(shape.SizeFromDimension(batch_axis_ + 1)) * first.DataType()->Size();
+  int64_t offset = 0;
+  for (const Request* request : batch.requests) {
+    const Tensor& src = request->feeds[feed_index].Get<Tensor>();
+    CopyRows(static_cast<const char*>(src.DataRaw()), request->rows, 0,
+             static_cast<char*>(dst.MutableDataRaw()), batch.rows, offset,
+             request->rows, outer, row_bytes);
+    offset += request->rows;
+  }
+  return Status::OK();
+}
+
+Status MicroBatcher::Split(const OrtValue& batched, Batch& batch, size_t output_index) const {
+  ORT_RETURN_IF_NOT(IsBatchableTensor(batched, batch_axis_), "Output ", output_index,
+                    " cannot be split on the batch axis.");
+  const Tensor& src = batched.Get<Tensor>();
+  const TensorShape& shape = src.Shape();
+  ORT_RETURN_IF_NOT(shape[batch_axis_] == batch.rows, "Output ", output_index, " has ", shape[batch_axis_],
+                    " rows on the batch axis, expected ", batch.rows);
+
+  const int64_t outer = shape.SizeToDimension(batch_axis_);
+  const size_t row_bytes = static_cast<size_t>(shape.SizeFromDimension(batch_axis_ + 1)) * src.DataType()->Size();
+  int64_t offset = 0;
+  for (Request* request : batch.requests) {
+    TensorShape request_shape = shape;
+    request_shape[batch_axis_] = request->rows;
+    OrtValue& output = (*request->fetches)[output_index];
+    Tensor::InitOrtValue(src.DataType(), request_shape, cpu_allocator_, output);
+    CopyRows(static_cast<const char*>(src.DataRaw()), batch.rows, offset,
+             static_cast<char*>(output.GetMutable<Tensor>()->MutableDataRaw()), request->rows, 0,
+             request->rows, outer, row_bytes);
+    offset += request->rows;
+  }
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
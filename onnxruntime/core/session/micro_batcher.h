@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/config_options.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/run_options.h"
+
+namespace onnxruntime {
+
+/**
+ * Coalesces concurrent InferenceSession::Run calls into a single execution, see
+ * kOrtSessionOptionsMicroBatchingMaxBatchSize.
+ *
+ * The first request for a given signature (feed names, element types, dimensions other than the batch axis
+ * and output names) becomes the leader of a batch. It waits up to the latency window, or until the batch is full,
+ * for other requests to join, then concatenates the feeds on the batch axis, runs the batch and splits the
+ * outputs back. Requests arriving while a batch executes start the next one, so batches are pipelined.
+ * If the batched run fails or an output cannot be split on the batch axis, every request is run on its own
+ * so that one invalid request does not fail the others.
+ *
+ * Only CPU tensors are batched and only when the caller does not pre-allocate the outputs.
+ */
+class MicroBatcher {
+ public:
+  using RunFn = std::function<Status(const RunOptions& run_options,
+                                     gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches)>;
+
+  MicroBatcher(int64_t max_batch_size, std::chrono::microseconds max_latency, size_t batch_axis,
+               RunFn run_fn, AllocatorPtr cpu_allocator);
+
+  // Creates a MicroBatcher from the session configuration, `micro_batcher` is null when micro-batching is disabled.
+  static Status Create(const ConfigOptions& config_options, RunFn run_fn, AllocatorPtr cpu_allocator,
+                       std::unique_ptr<MicroBatcher>& micro_batcher);
+
+  // Whether the request can be coalesced with other requests.
+  bool CanBatch(const RunOptions& run_options, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                const std::vector<OrtValue>* p_fetches, const std::vector<OrtDevice>* p_fetches_device_info) const;
+
+  // Runs the request, possibly as part of a batch. CanBatch() must be true.
+  Status Run(const RunOptions& run_options, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+             gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  // Number of executions of the model and number of requests they served.
+  int64_t NumExecutions() const { return num_executions_.load(std::memory_order_relaxed); }
+  int64_t NumRequests() const { return num_requests_.load(std::memory_order_relaxed); }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(MicroBatcher);
+
+  struct Request {
+    const RunOptions* run_options;
+    gsl::span<const std::string> feed_names;
+    gsl::span<const OrtValue> feeds;
+    gsl::span<const std::string> output_names;
+    std::vector<OrtValue>* fetches;
+    int64_t rows;
+    Status status;
+    bool done{false};
+  };
+
+  struct Batch {
+    std::vector<Request*> requests;
+    int64_t rows{0};
+    bool full{false};
+    std::condition_variable cv;
+  };
+
+  std::string Signature(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                        gsl::span<const std::string> output_names) const;
+
+  void Execute(Batch& batch);
+  Status ExecuteBatched(Batch& batch);
+  Status Concatenate(const Batch& batch, size_t feed_index, OrtValue& batched) const;
+  Status Split(const OrtValue& batched, Batch& batch, size_t output_index) const;
+
+  const int64_t max_batch_size_;
+  const std::chrono::microseconds max_latency_;
+  const size_t batch_axis_;
+  const RunFn run_fn_;
+  const AllocatorPtr cpu_allocator_;
+
+  std::mutex mutex_;
+  // Batches waiting for requests, by signature.
+  std::unordered_map<std::string, std::shared_ptr<Batch>> open_batches_;
+
+  std::atomic<int64_t> num_executions_{0};
+  std::atomic<int64_t> num_requests_{0};
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,438 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "contrib_ops/cpu/bert/attention_common.h"
+#include "contrib_ops/cpu/bert/attention_helper.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/contrib_ops/grouped_query_attention_test_helper.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+#include "test/util/include/scoped_env_vars.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+constexpr int kHeadSize = 16;
+
+// Packs signed values of kv_cache_bit_width bits, two 4-bit values per byte with the low nibble first.
+std::vector<uint8_t> PackCache(const std::vector<int>& values, int bits) {
+  std::vector<uint8_t> packed;
+  for (size_t i = 0; i < values.size(); i += (bits == 8 ? 1 : 2)) {
+    packed.push_back(bits == 8 ? static_cast<uint8_t>(static_cast<int8_t>(values[i]))
+                               : static_cast<uint8_t>((values[i] & 0xF) | ((values[i + 1] & 0xF) << 4)));
+  }
+  return packed;
+}
+
+template <typename T>
+std::vector<T> Convert(const std::vector<float>& data) {
+  if constexpr (std::is_same_v<T, float>) {
+    return data;
+  } else {
+    return ToFloat16(data);
+  }
+}
+
+struct QuantizedKVCacheTestCase {
+  int bits;
+  int past_length;
+  int sequence_length;
+  bool per_tensor_scale = false;  // k_scale and v_scale of shape (1)
+  int max_length = 0;             // tokens of the past and present state of a shared buffer, if positive
+  int local_window_size = -1;
+  float softcap = 0.0f;
+};
+
+// Attention of a sequence of a single batch over a quantized cache of past_length tokens. The new key and value are
+// quantized into the present cache, K with a scale per channel and V with a scale per head unless per_tensor_scale.
+template <typename T>
+void RunQuantizedKVCacheTest(const QuantizedKVCacheTestCase& test_case) {
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+  const int bits = test_case.bits;
+  const int past_length = test_case.past_length;
+  const int sequence_length = test_case.sequence_length;
+  const int total_length = past_length + sequence_length;
+  const int past_buffer_length = test_case.max_length > 0 ? test_case.max_length : past_length;
+  const int present_buffer_length = test_case.max_length > 0 ? test_case.max_length : total_length;
+  const int max_value = (1 << (bits - 1)) - 1;
+
+  std::vector<float> k_scale;
+  std::vector<float> v_scale;
+  if (test_case.per_tensor_scale) {
+    k_scale = {1.1f / static_cast<float>(max_value)};
+    v_scale = {0.9f / static_cast<float>(max_value)};
+  } else {
+    for (int c = 0; c < kv_hidden_size; c++) {
+      k_scale.push_back((1.0f + 0.25f * static_cast<float>(c % 3)) / static_cast<float>(max_value));
+    }
+    v_scale = {0.8f / static_cast<float>(max_value), 1.2f / static_cast<float>(max_value)};
+  }
+  auto scale_of = [&](bool is_key, int kv_h, int i) {
+    const std::vector<float>& scale = is_key ? k_scale : v_scale;
+    if (scale.size() == 1) {
+      return scale[0];
+    }
+    return scale.size() == static_cast<size_t>(kGroupedKvNumHeads) ? scale[kv_h] : scale[kv_h * kHeadSize + i];
+  };
+
+  const std::vector<T> query = Convert<T>(
+      MakeAttentionData(static_cast<size_t>(sequence_length) * hidden_size, kQueryFrequency));
+  const std::vector<T> key = Convert<T>(
+      MakeAttentionData(static_cast<size_t>(sequence_length) * kv_hidden_size, kKeyFrequency));
+  const std::vector<T> value = Convert<T>(
+      MakeAttentionData(static_cast<size_t>(sequence_length) * kv_hidden_size, kValueFrequency));
+
+  // The quantized caches in BNSH layout, with the past tokens followed by the new ones and zeros up to the length of
+  // the buffer.
+  std::vector<int> present[2];
+  std::vector<int> past[2];
+  for (int is_key = 0; is_key < 2; is_key++) {
+    const std::vector<T>& input = is_key ? key : value;
+    for (int kv_h = 0; kv_h < kGroupedKvNumHeads; kv_h++) {
+      for (int t = 0; t < present_buffer_length; t++) {
+        for (int i = 0; i < kHeadSize; i++) {
+          int q = 0;
+          if (t < past_length) {
+            q = static_cast<int>((kv_h * 31 + t * 7 + i * (is_key ? 5 : 3)) % (2 * max_value + 2)) - max_value - 1;
+          } else if (t < total_length) {
+            const float x = input[static_cast<size_t>(t - past_length) * kv_hidden_size + kv_h * kHeadSize + i];
+            q = static_cast<int>(std::clamp(std::nearbyint(x / scale_of(is_key, kv_h, i)),
+                                            static_cast<float>(-max_value - 1), static_cast<float>(max_value)));
+          }
+          if (t < past_buffer_length) {
+            past[is_key].push_back(t < past_length ? q : 0);
+          }
+          present[is_key].push_back(q);
+        }
+      }
+    }
+  }
+
+  CausalAttentionParams params;
+  params.head_size = kHeadSize;
+  params.local_window_size = test_case.local_window_size;
+  params.softcap = test_case.softcap;
+  auto cache_element = [&](int is_key, int kv_h, int t, int i) {
+    const size_t index = (static_cast<size_t>(kv_h) * present_buffer_length + t) * kHeadSize + i;
+    return static_cast<float>(present[is_key][index]) * scale_of(is_key, kv_h, i);
+  };
+  const std::vector<float> query_data(query.begin(), query.end());
+  std::vector<float> output(static_cast<size_t>(sequence_length) * hidden_size);
+  ComputeCausalAttention(
+      params, query_data.data(), past_length, sequence_length,
+      [&](int kv_h, int t, int i) { return cache_element(1, kv_h, t, i); },
+      [&](int kv_h, int t, int i) { return cache_element(0, kv_h, t, i); }, output.data());
+
+  OpTester tester("GroupQueryAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", kGroupedNumHeads);
+  tester.AddAttribute<int64_t>("kv_num_heads", kGroupedKvNumHeads);
+  tester.AddAttribute<int64_t>("kv_cache_bit_width", bits);
+  tester.AddAttribute<int64_t>("local_window_size", test_case.local_window_size);
+  tester.AddAttribute<float>("softcap", test_case.softcap);
+
+  const int cache_head_size = bits == 8 ? kHeadSize : kHeadSize / 2;
+  const std::vector<int64_t> past_dims = {1, kGroupedKvNumHeads, past_buffer_length, cache_head_size};
+  const std::vector<int64_t> present_dims = {1, kGroupedKvNumHeads, present_buffer_length, cache_head_size};
+
+  tester.AddInput<T>("query", {1, sequence_length, hidden_size}, query);
+  tester.AddInput<T>("key", {1, sequence_length, kv_hidden_size}, key);
+  tester.AddInput<T>("value", {1, sequence_length, kv_hidden_size}, value);
+  if (past_buffer_length == 0) {
+    tester.AddOptionalInputEdge<int8_t>();
+    tester.AddOptionalInputEdge<int8_t>();
+  } else if (bits == 8) {
+    tester.AddInput<int8_t>("past_key", past_dims, std::vector<int8_t>(past[1].begin(), past[1].end()));
+    tester.AddInput<int8_t>("past_value", past_dims, std::vector<int8_t>(past[0].begin(), past[0].end()));
+  } else {
+    tester.AddInput<uint8_t>("past_key", past_dims, PackCache(past[1], bits));
+    tester.AddInput<uint8_t>("past_value", past_dims, PackCache(past[0], bits));
+  }
+  tester.AddInput<int32_t>("seqlens_k", {1}, {total_length - 1});
+  tester.AddInput<int32_t>("total_sequence_length", {1}, {total_length});
+  tester.AddOptionalInputEdge<T>();        // cos_cache
+  tester.AddOptionalInputEdge<T>();        // sin_cache
+  tester.AddOptionalInputEdge<int64_t>();  // position_ids
+  tester.AddOptionalInputEdge<T>();        // attention_bias
+  tester.AddOptionalInputEdge<T>();        // head_sink
+  if (test_case.per_tensor_scale) {
+    tester.AddInput<float>("k_scale", {1}, k_scale);
+    tester.AddInput<float>("v_scale", {1}, v_scale);
+  } else {
+    tester.AddInput<float>("k_scale", {kGroupedKvNumHeads, kHeadSize}, k_scale);
+    tester.AddInput<float>("v_scale", {kGroupedKvNumHeads}, v_scale);
+  }
+
+  tester.AddOutput<T>("output", {1, sequence_length, hidden_size}, Convert<T>(output));
+  if (bits == 8) {
+    tester.AddOutput<int8_t>("present_key", present_dims, std::vector<int8_t>(present[1].begin(), present[1].end()));
+    tester.AddOutput<int8_t>("present_value", present_dims,
+                             std::vector<int8_t>(present[0].begin(), present[0].end()));
+  } else {
+    tester.AddOutput<uint8_t>("present_key", present_dims, PackCache(present[1], bits));
+    tester.AddOutput<uint8_t>("present_value", present_dims, PackCache(present[0], bits));
+  }
+  tester.SetOutputTolerance(std::is_same_v<T, float> ? 0.0001f : 0.005f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+struct PromptTestCase {
+  int batch_size;
+  int sequence_length;
+  int past_length;  // past tokens of a subsequent prompt, batch_size must be 1 then
+  int local_window_size = -1;
+  float softcap = 0.0f;
+  bool smooth_softmax = false;  // with a head_sink input
+  bool packed_qkv = false;
+};
+
+// Runs a prompt with the materialized attention probs of ORT_DISABLE_FLASH_ATTENTION, then checks that the tiled
+// kernel produces the same output and present state.
+template <typename T>
+void RunPromptFlashAttentionTest(const PromptTestCase& test_case) {
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+  const int batch_size = test_case.batch_size;
+  const int sequence_length = test_case.sequence_length;
+  const int past_length = test_case.past_length;
+  const int total_length = past_length + sequence_length;
+  const size_t tokens = static_cast<size_t>(batch_size) * sequence_length;
+
+  const std::vector<int64_t> output_dims = {batch_size, sequence_length, hidden_size};
+  const std::vector<int64_t> past_dims = {batch_size, kGroupedKvNumHeads, past_length, kHeadSize};
+  const std::vector<int64_t> present_dims = {batch_size, kGroupedKvNumHeads, total_length, kHeadSize};
+  const size_t output_size = tokens * hidden_size;
+  const size_t present_size = static_cast<size_t>(batch_size) * kGroupedKvNumHeads * total_length * kHeadSize;
+
+  std::vector<OrtValue> expected;
+  for (const char* disable_flash_attention : {"1", "0"}) {
+    SCOPED_TRACE(std::string("disable_flash_attention=") + disable_flash_attention);
+    ScopedEnvironmentVariables scoped_env_vars{
+        EnvVarMap{{onnxruntime::contrib::attention::kDisableFlashAttention, disable_flash_attention}}};
+    const bool is_reference = expected.empty();
+
+    OpTester tester("GroupQueryAttention", 1, onnxruntime::kMSDomain, !is_reference);
+    tester.AddAttribute<int64_t>("num_heads", kGroupedNumHeads);
+    tester.AddAttribute<int64_t>("kv_num_heads", kGroupedKvNumHeads);
+    tester.AddAttribute<int64_t>("local_window_size", test_case.local_window_size);
+    tester.AddAttribute<float>("softcap", test_case.softcap);
+    tester.AddAttribute<int64_t>("smooth_softmax", test_case.smooth_softmax ? 1 : 0);
+
+    if (test_case.packed_qkv) {
+      tester.AddInput<T>("query", {batch_size, sequence_length, hidden_size + 2 * kv_hidden_size},
+                         Convert<T>(MakeAttentionData(tokens * (hidden_size + 2 * kv_hidden_size), kQueryFrequency)));
+      tester.AddOptionalInputEdge<T>();
+      tester.AddOptionalInputEdge<T>();
+    } else {
+      tester.AddInput<T>("query", {batch_size, sequence_length, hidden_size},
+                         Convert<T>(MakeAttentionData(tokens * hidden_size, kQueryFrequency)));
+      tester.AddInput<T>("key", {batch_size, sequence_length, kv_hidden_size},
+                         Convert<T>(MakeAttentionData(tokens * kv_hidden_size, kKeyFrequency)));
+      tester.AddInput<T>("value", {batch_size, sequence_length, kv_hidden_size},
+                         Convert<T>(MakeAttentionData(tokens * kv_hidden_size, kValueFrequency)));
+    }
+    if (past_length == 0) {
+      tester.AddOptionalInputEdge<T>();
+      tester.AddOptionalInputEdge<T>();
+    } else {
+      const size_t past_size = static_cast<size_t>(batch_size) * kGroupedKvNumHeads * past_length * kHeadSize;
+      tester.AddInput<T>("past_key", past_dims, Convert<T>(MakeAttentionData(past_size, kPastKeyFrequency)));
+      tester.AddInput<T>("past_value", past_dims, Convert<T>(MakeAttentionData(past_size, kPastValueFrequency)));
+    }
+    tester.AddInput<int32_t>("seqlens_k", {batch_size}, std::vector<int32_t>(batch_size, total_length - 1));
+    tester.AddInput<int32_t>("total_sequence_length", {1}, {total_length});
+    tester.AddOptionalInputEdge<T>();        // cos_cache
+    tester.AddOptionalInputEdge<T>();        // sin_cache
+    tester.AddOptionalInputEdge<int64_t>();  // position_ids
+    tester.AddOptionalInputEdge<T>();        // attention_bias
+    if (test_case.smooth_softmax) {
+      tester.AddInput<T>("head_sink", {kGroupedNumHeads}, Convert<T>({0.5f, -0.3f, 1.0f, 0.0f}));
+    } else {
+      tester.AddOptionalInputEdge<T>();
+    }
+
+    if (is_reference) {
+      tester.AddOutput<T>("output", output_dims, std::vector<T>(output_size));
+      tester.AddOutput<T>("present_key", present_dims, std::vector<T>(present_size));
+      tester.AddOutput<T>("present_value", present_dims, std::vector<T>(present_size));
+    } else {
+      tester.AddOutput<T>("output", output_dims, expected[0].Get<Tensor>().Data<T>(), output_size);
+      tester.AddOutput<T>("present_key", present_dims, expected[1].Get<Tensor>().Data<T>(), present_size);
+      tester.AddOutput<T>("present_value", present_dims, expected[2].Get<Tensor>().Data<T>(), present_size);
+      tester.SetOutputTolerance(std::is_same_v<T, float> ? 0.0001f : 0.005f);
+    }
+
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+
+    if (is_reference) {
+      expected = tester.GetFetches();
+    }
+  }
+}
+
+}  // namespace
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionPrompt) {
+  RunPromptFlashAttentionTest<float>({2, 37, 0});
+}
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionPromptPackedQKV) {
+  PromptTestCase test_case{2, 19, 0};
+  test_case.packed_qkv = true;
+  RunPromptFlashAttentionTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionSubsequentPrompt) {
+  RunPromptFlashAttentionTest<float>({1, 9, 6});
+}
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionLocalWindowSoftcap) {
+  PromptTestCase test_case{2, 25, 0};
+  test_case.local_window_size = 7;
+  test_case.softcap = 2.0f;
+  RunPromptFlashAttentionTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionSmoothSoftmax) {
+  PromptTestCase test_case{1, 13, 4};
+  test_case.smooth_softmax = true;
+  RunPromptFlashAttentionTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuFlashAttentionPromptFloat16) {
+  PromptTestCase test_case{2, 21, 0};
+  test_case.local_window_size = 9;
+  RunPromptFlashAttentionTest<MLFloat16>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCachePrompt) {
+  RunQuantizedKVCacheTest<float>({8, 0, 5});
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCacheDecode) {
+  RunQuantizedKVCacheTest<float>({8, 6, 1});
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCachePrompt) {
+  RunQuantizedKVCacheTest<float>({4, 0, 5});
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCacheDecode) {
+  RunQuantizedKVCacheTest<float>({4, 6, 1});
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCachePerTensorScale) {
+  QuantizedKVCacheTestCase test_case{8, 6, 1};
+  test_case.per_tensor_scale = true;
+  RunQuantizedKVCacheTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCachePerTensorScale) {
+  QuantizedKVCacheTestCase test_case{4, 0, 5};
+  test_case.per_tensor_scale = true;
+  RunQuantizedKVCacheTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCacheShareBuffer) {
+  QuantizedKVCacheTestCase test_case{8, 6, 1};
+  test_case.max_length = 11;
+  RunQuantizedKVCacheTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCacheShareBuffer) {
+  QuantizedKVCacheTestCase test_case{4, 3, 2};
+  test_case.max_length = 8;
+  RunQuantizedKVCacheTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCacheDecodeFloat16) {
+  RunQuantizedKVCacheTest<MLFloat16>({8, 6, 1});
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCachePromptFloat16) {
+  QuantizedKVCacheTestCase test_case{4, 0, 5};
+  test_case.max_length = 9;
+  RunQuantizedKVCacheTest<MLFloat16>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt8KVCacheDecodeLocalWindowSoftcap) {
+  QuantizedKVCacheTestCase test_case{8, 9, 1};
+  test_case.local_window_size = 4;
+  test_case.softcap = 2.0f;
+  RunQuantizedKVCacheTest<float>(test_case);
+}
+
+TEST(GroupQueryAttentionTest, CpuInt4KVCacheDecodeLocalWindowFloat16) {
+  QuantizedKVCacheTestCase test_case{4, 9, 1};
+  test_case.local_window_size = 5;
+  RunQuantizedKVCacheTest<MLFloat16>(test_case);
+}
+
+// OpTester allocates the present state apart from the past, so the append to a past and present state that share a
+// buffer is checked on the quantization of the state chunks.
+TEST(GroupQueryAttentionTest, CpuQuantizeStateChunkSharedBuffer) {
+  constexpr size_t head_size = 4;
+  constexpr size_t past_length = 2;
+  constexpr size_t buffer_length = 6;
+  const std::vector<float> scales = {0.25f, 0.5f, 0.25f, 0.5f};
+  const std::vector<float> chunk = {0.5f, -1.0f, 1.0f, -2.0f, 0.25f, 1.5f, -0.5f, 3.0f};
+  const std::vector<int> quantized = {2, -2, 4, -4, 1, 3, -2, 6};
+
+  for (int bits : {4, 8}) {
+    SCOPED_TRACE(bits);
+    // Two KV heads of buffer_length tokens, the second one holding past_length tokens.
+    std::vector<int> state(2 * buffer_length * head_size, 0);
+    for (size_t j = 0; j < past_length * head_size; j++) {
+      state[buffer_length * head_size + j] = static_cast<int>(j % 7) - 3;
+    }
+    std::vector<uint8_t> buffer = PackCache(state, bits);
+    std::copy(quantized.begin(), quantized.end(), state.begin() + (buffer_length + past_length) * head_size);
+
+    contrib::QuantizeStateChunkGQA(buffer.data(), chunk.data(), buffer.data(), buffer_length * head_size,
+                                   buffer_length * head_size, past_length * head_size, chunk.size(), true, 1,
+                                   head_size, scales.data(), bits);
+    EXPECT_EQ(buffer, PackCache(state, bits));
+  }
+}
+
+TEST(GroupQueryAttentionTest, CpuQuantizedKVCacheMissingScale) {
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+
+  OpTester tester("GroupQueryAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", kGroupedNumHeads);
+  tester.AddAttribute<int64_t>("kv_num_heads", kGroupedKvNumHeads);
+  tester.AddAttribute<int64_t>("kv_cache_bit_width", 8);
+  tester.AddInput<float>("query", {1, 1, hidden_size}, std::vector<float>(hidden_size, 0.0f));
+  tester.AddInput<float>("key", {1, 1, kv_hidden_size}, std::vector<float>(kv_hidden_size, 0.0f));
+  tester.AddInput<float>("value", {1, 1, kv_hidden_size}, std::vector<float>(kv_hidden_size, 0.0f));
+  tester.AddOptionalInputEdge<int8_t>();
+  tester.AddOptionalInputEdge<int8_t>();
+  tester.AddInput<int32_t>("seqlens_k", {1}, {0});
+  tester.AddInput<int32_t>("total_sequence_length", {1}, {1});
+  tester.AddOutput<float>("output", {1, 1, hidden_size}, std::vector<float>(hidden_size, 0.0f));
+  tester.AddOutput<int8_t>("present_key", {1, kGroupedKvNumHeads, 1, kHeadSize},
+                           std::vector<int8_t>(kv_hidden_size, 0));
+  tester.AddOutput<int8_t>("present_value", {1, kGroupedKvNumHeads, 1, kHeadSize},
+                           std::vector<int8_t>(kv_hidden_size, 0));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectFailure, "are required when kv_cache_bit_width is", {}, nullptr,
+             &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
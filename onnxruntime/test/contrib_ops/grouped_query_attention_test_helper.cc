@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test/contrib_ops/grouped_query_attention_test_helper.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+std::vector<float> MakeAttentionData(size_t size, float frequency) {
+  std::vector<float> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = std::sin(frequency * static_cast<float>(i + 1));
+  }
+  return data;
+}
+
+void ComputeCausalAttention(const CausalAttentionParams& params, const float* query, int past_length,
+                            int sequence_length, const KvElementFunction& key, const KvElementFunction& value,
+                            float* output) {
+  const int hidden_size = params.num_heads * params.head_size;
+  const int group_size = params.num_heads / params.kv_num_heads;
+  const double scale = 1.0 / std::sqrt(static_cast<double>(params.head_size));
+
+  for (int s = 0; s < sequence_length; s++) {
+    const int t_q = past_length + s;
+    const int begin = params.local_window_size >= 0 ? std::max(0, t_q - params.local_window_size) : 0;
+    for (int h = 0; h < params.num_heads; h++) {
+      const int kv_h = h / group_size;
+      const float* q = query + static_cast<size_t>(s) * hidden_size + h * params.head_size;
+
+      std::vector<double> scores;
+      for (int t = begin; t <= t_q; t++) {
+        double dot = 0.0;
+        for (int i = 0; i < params.head_size; i++) {
+          dot += static_cast<double>(q[i]) * key(kv_h, t, i);
+        }
+        double score = dot * scale;
+        if (params.softcap > 0.0f) {
+          score = params.softcap * std::tanh(score / params.softcap);
+        }
+        scores.push_back(score);
+      }
+
+      const double max_score = *std::max_element(scores.begin(), scores.end());
+      double sum = 0.0;
+      for (double& score : scores) {
+        score = std::exp(score - max_score);
+        sum += score;
+      }
+
+      float* out = output + static_cast<size_t>(s) * hidden_size + h * params.head_size;
+      for (int i = 0; i < params.head_size; i++) {
+        double o = 0.0;
+        for (int t = begin; t <= t_q; t++) {
+          o += scores[t - begin] * value(kv_h, t, i);
+        }
+        out[i] = static_cast<float>(o / sum);
+      }
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+#pragma once
+#include <functional>
+#include <vector>
+
+namespace onnxruntime {
+namespace test {
+
+// Heads of the GroupQueryAttention and PagedAttention tests, two query heads per KV head.
+constexpr int kGroupedNumHeads = 4;
+constexpr int kGroupedKvNumHeads = 2;
+
+// Frequencies of the data of the query, new key and value, and past key and value of the tests.
+constexpr float kQueryFrequency = 0.37f;
+constexpr float kKeyFrequency = 0.53f;
+constexpr float kValueFrequency = 0.71f;
+constexpr float kPastKeyFrequency = 0.29f;
+constexpr float kPastValueFrequency = 0.43f;
+
+// Returns sin(frequency * (i + 1)) for each element i.
+std::vector<float> MakeAttentionData(size_t size, float frequency);
+
+// Returns the element i of token t of a KV head, so that the reference reads any layout of the cache.
+using KvElementFunction = std::function<float(int kv_head, int t, int i)>;
+
+struct CausalAttentionParams {
+  int num_heads = kGroupedNumHeads;
+  int kv_num_heads = kGroupedKvNumHeads;
+  int head_size;
+  int local_window_size = -1;  // attends all the past tokens if negative
+  float softcap = 0.0f;
+};
+
+// Computes the causal attention of the sequence_length query rows of a sequence, which are at positions past_length
+// and after, over the keys of the sequence. Query head h attends KV head h / (num_heads / kv_num_heads). The rows of
+// query and output have num_heads * head_size elements.
+void ComputeCausalAttention(const CausalAttentionParams& params, const float* query, int past_length,
+                            int sequence_length, const KvElementFunction& key, const KvElementFunction& value,
+                            float* output);
+
+}  // namespace test
+}  // namespace onnxruntime
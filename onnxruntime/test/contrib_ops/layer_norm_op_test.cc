@@ -428,6 +428,21 @@ TEST(LayerNormTest, LayerNorm17_double) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kDnnlExecutionProvider});
 }
 
+// A constant row whose variance rounds to slightly below zero, with an epsilon too small to cover it.
+TEST(LayerNormTest, LayerNorm17_double_ConstantRow) {
+  OpTester test("LayerNormalization", 17);
+  test.AddAttribute<float>("epsilon", 1e-15f);
+
+  std::vector<int64_t> dims{1, 3};
+  test.AddInput<double>("x", dims, {7.7, 7.7, 7.7});
+  test.AddInput<double>("gamma", {3}, {1.0, 1.0, 1.0});
+  test.AddInput<double>("bias", {3}, {0.5, 0.5, 0.5});
+  test.AddOutput<double>("output", dims, {0.5, 0.5, 0.5});
+
+  // DNNL does not support double
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kDnnlExecutionProvider});
+}
+
 // Test normalize size shall be larger than 1.
 TEST(LayerNormTest, LayerNorm_InvalidNormSize) {
   OpTester test("LayerNormalization");
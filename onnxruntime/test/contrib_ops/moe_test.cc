@@ -1532,8 +1532,12 @@ TEST(MoETest, QMoETest_CPU_SwiGLU_Int4) {
   std::vector<float> fc2_scales(num_experts * hidden_size, 0.05f);
   std::vector<float> fc3_scales;
 
-  // Expected output should be small but non-zero due to SwiGLU nonlinearity
-  std::vector<float> output(num_rows * hidden_size, 0.0f);
+  // Each FC1 output of a row is x . w with w = (0.1, 0.05, 0.1, ...), i.e. 0.28 and 0.32 for the two rows, and
+  // SwiGLU of the interleaved (0.28, 0.28) is 0.2211 (0.2673 for 0.32). Each FC2 output sums 16 of them times -0.05,
+  // and the routing weights of both experts sum to 1.
+  std::vector<float> output(num_rows * hidden_size);
+  std::fill_n(output.begin(), hidden_size, -0.17689f);
+  std::fill_n(output.begin() + hidden_size, hidden_size, -0.21387f);
 
   OpTester cpu_tester("QMoE", 1, onnxruntime::kMSDomain);
   cpu_tester.AddAttribute<int64_t>("k", 2);
@@ -1642,9 +1646,9 @@ TEST(MoETest, QMoETest_CPU_Float32) {
   const int fc1_weight_size_per_expert = hidden_size * inter_size;
   const int fc2_weight_size_per_expert = inter_size * hidden_size;
 
-  // Generate test weights at zero point (128 for 8-bit) to produce zero output
-  std::vector<uint8_t> fc1_experts_weights(num_experts * fc1_weight_size_per_expert, 128);
-  std::vector<uint8_t> fc2_experts_weights(num_experts * fc2_weight_size_per_expert, 128);
+  // Generate test weights at zero (for symmetric quantization) to produce zero output
+  std::vector<uint8_t> fc1_experts_weights(num_experts * fc1_weight_size_per_expert, 0);
+  std::vector<uint8_t> fc2_experts_weights(num_experts * fc2_weight_size_per_expert, 0);
 
   // Scales
   std::vector<float> fc1_scales(num_experts * inter_size, 0.1f);
@@ -1686,6 +1690,85 @@ TEST(MoETest, QMoETest_CPU_Float32) {
   cpu_tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &cpu_execution_providers);
 }
 
+// Test the routing of rows to different top-k experts, with hidden_size != inter_size
+TEST(MoETest, QMoETest_CPU_Int8_TopK_Routing) {
+  int num_rows = 3;
+  int num_experts = 4;
+  int hidden_size = 16;
+  int inter_size = 32;
+
+  std::vector<float> input(num_rows * hidden_size);
+  for (int r = 0; r < num_rows; ++r) {
+    for (int c = 0; c < hidden_size; ++c) {
+      input[r * hidden_size + c] = static_cast<float>((r * 5 + c * 3) % 7 - 3) * 0.25f;
+    }
+  }
+
+  // Rows 0, 1 and 2 are routed to experts {1, 3}, {0, 3} and {3, 2}
+  const std::vector<float> router_probs = {0.1f, 1.2f, -0.5f, 0.7f,
+                                           2.0f, -1.0f, 0.3f, 0.4f,
+                                           -0.2f, -0.1f, 0.9f, 1.5f};
+
+  // Signed 8-bit weights of shape (num_experts, N, K)
+  std::vector<uint8_t> fc1_experts_weights(num_experts * inter_size * hidden_size);
+  std::vector<uint8_t> fc2_experts_weights(num_experts * hidden_size * inter_size);
+  for (int e = 0; e < num_experts; ++e) {
+    for (int n = 0; n < inter_size; ++n) {
+      for (int c = 0; c < hidden_size; ++c) {
+        fc1_experts_weights[(e * inter_size + n) * hidden_size + c] = static_cast<uint8_t>((e * 7 + n * 3 + c) % 11 - 5);
+      }
+    }
+    for (int n = 0; n < hidden_size; ++n) {
+      for (int c = 0; c < inter_size; ++c) {
+        fc2_experts_weights[(e * hidden_size + n) * inter_size + c] = static_cast<uint8_t>((e * 5 + n + c * 2) % 9 - 4);
+      }
+    }
+  }
+
+  std::vector<float> fc1_scales(num_experts * inter_size, 0.1f);
+  std::vector<float> fc2_scales(num_experts * hidden_size, 0.1f);
+
+  const std::vector<float> output = {
+      -0.08440f, -0.06360f, 0.16872f, 0.34250f, 0.15951f, -0.15264f, -0.23756f, -0.08145f,
+      -0.05108f, -0.08440f, -0.06360f, 0.16872f, 0.34250f, 0.15951f, -0.15264f, -0.23756f,
+      -0.04603f, 0.18230f, 0.13952f, -0.24455f, -0.20445f, 0.16058f, 0.29058f, -0.00785f,
+      -0.27011f, -0.04603f, 0.18230f, 0.13952f, -0.24455f, -0.20445f, 0.16058f, 0.29058f,
+      -0.16425f, -0.13068f, -0.01537f, 0.10113f, 0.07175f, -0.00687f, 0.04306f, 0.07653f,
+      0.02469f, -0.16425f, -0.13068f, -0.01537f, 0.10113f, 0.07175f, -0.00687f, 0.04306f};
+
+  OpTester cpu_tester("QMoE", 1, onnxruntime::kMSDomain);
+  cpu_tester.AddAttribute<int64_t>("k", 2);
+  cpu_tester.AddAttribute<std::string>("activation_type", "silu");
+  cpu_tester.AddAttribute<int64_t>("normalize_routing_weights", 1);
+  cpu_tester.AddAttribute<int64_t>("expert_weight_bits", 8);
+
+  std::vector<int64_t> input_dims = {num_rows, hidden_size};
+  std::vector<int64_t> router_probs_dims = {num_rows, num_experts};
+  std::vector<int64_t> fc1_experts_weights_dims = {num_experts, inter_size, hidden_size};
+  std::vector<int64_t> fc2_experts_weights_dims = {num_experts, hidden_size, inter_size};
+  std::vector<int64_t> fc1_scales_dims = {num_experts, inter_size};
+  std::vector<int64_t> fc2_scales_dims = {num_experts, hidden_size};
+  std::vector<int64_t> output_dims = {num_rows, hidden_size};
+
+  cpu_tester.AddInput<float>("input", input_dims, input);
+  cpu_tester.AddInput<float>("router_probs", router_probs_dims, router_probs);
+  cpu_tester.AddInput<uint8_t>("fc1_experts_weights", fc1_experts_weights_dims, fc1_experts_weights);
+  cpu_tester.AddInput<float>("fc1_scales", fc1_scales_dims, fc1_scales);
+  cpu_tester.AddOptionalInputEdge<float>();  // fc1_experts_bias
+  cpu_tester.AddInput<uint8_t>("fc2_experts_weights", fc2_experts_weights_dims, fc2_experts_weights);
+  cpu_tester.AddInput<float>("fc2_scales", fc2_scales_dims, fc2_scales);
+  cpu_tester.AddOptionalInputEdge<float>();    // fc2_experts_bias
+  cpu_tester.AddOptionalInputEdge<uint8_t>();  // fc3_experts_weights
+  cpu_tester.AddOptionalInputEdge<float>();    // fc3_scales
+  cpu_tester.AddOptionalInputEdge<float>();    // fc3_experts_bias
+  cpu_tester.AddOutput<float>("output", output_dims, output);
+  cpu_tester.SetOutputTolerance(0.01f);  // The 8-bit GEMM may quantize the activations to 8 bits
+
+  std::vector<std::unique_ptr<IExecutionProvider>> cpu_execution_providers;
+  cpu_execution_providers.push_back(DefaultCpuExecutionProvider());
+  cpu_tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &cpu_execution_providers);
+}
+
 #endif
 
 }  // namespace test
@@ -0,0 +1,264 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/contrib_ops/grouped_query_attention_test_helper.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+constexpr int kHeadSize = 16;  // a multiple of 16 for the rotary embedding
+constexpr int kBlockSize = 4;
+constexpr int kNumBlocks = 8;
+constexpr int kMaxBlocksPerSequence = 3;
+constexpr int kMaxPositions = 12;
+
+// Rotates the heads of each token row by the absolute position of the token, with the cos and sin caches of shape
+// (kMaxPositions, kHeadSize / 2). The halves of a head are rotated together, or its pairs of elements if interleaved.
+void ApplyRotaryEmbedding(std::vector<float>& data, int num_heads, const std::vector<int>& positions,
+                          const std::vector<float>& cos_cache, const std::vector<float>& sin_cache, bool interleaved) {
+  constexpr int half = kHeadSize / 2;
+  for (size_t t = 0; t < positions.size(); t++) {
+    const float* cos_row = &cos_cache[static_cast<size_t>(positions[t]) * half];
+    const float* sin_row = &sin_cache[static_cast<size_t>(positions[t]) * half];
+    for (int h = 0; h < num_heads; h++) {
+      float* x = &data[(t * num_heads + h) * kHeadSize];
+      for (int i = 0; i < half; i++) {
+        const int i1 = interleaved ? 2 * i : i;
+        const int i2 = interleaved ? 2 * i + 1 : i + half;
+        const float x1 = x[i1];
+        const float x2 = x[i2];
+        x[i1] = x1 * cos_row[i] - x2 * sin_row[i];
+        x[i2] = x2 * cos_row[i] + x1 * sin_row[i];
+      }
+    }
+  }
+}
+
+// Causal attention of each sequence over its past tokens in the blocks of the cache and its new tokens.
+std::vector<float> ComputeReference(const std::vector<float>& query, const std::vector<float>& key,
+                                    const std::vector<float>& value, const std::vector<float>& key_cache,
+                                    const std::vector<float>& value_cache, const std::vector<int32_t>& cumulative_seqlens,
+                                    const std::vector<int32_t>& past_seqlens, const std::vector<int32_t>& block_table,
+                                    int local_window_size) {
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+  const int batch_size = static_cast<int>(past_seqlens.size());
+  std::vector<float> output(static_cast<size_t>(cumulative_seqlens.back()) * hidden_size, 0.0f);
+
+  CausalAttentionParams params;
+  params.head_size = kHeadSize;
+  params.local_window_size = local_window_size;
+
+  for (int b = 0; b < batch_size; b++) {
+    const int q_begin = cumulative_seqlens[b];
+    const int past = past_seqlens[b];
+
+    auto kv_element = [&](const std::vector<float>& input, const std::vector<float>& cache, int kv_h, int t, int i) {
+      if (t >= past) {
+        return input[static_cast<size_t>(q_begin + t - past) * kv_hidden_size + kv_h * kHeadSize + i];
+      }
+      const int block = block_table[b * kMaxBlocksPerSequence + t / kBlockSize];
+      return cache[(static_cast<size_t>(block) * kBlockSize + t % kBlockSize) * kv_hidden_size + kv_h * kHeadSize + i];
+    };
+
+    ComputeCausalAttention(
+        params, &query[static_cast<size_t>(q_begin) * hidden_size], past, cumulative_seqlens[b + 1] - q_begin,
+        [&](int kv_h, int t, int i) { return kv_element(key, key_cache, kv_h, t, i); },
+        [&](int kv_h, int t, int i) { return kv_element(value, value_cache, kv_h, t, i); },
+        &output[static_cast<size_t>(q_begin) * hidden_size]);
+  }
+
+  return output;
+}
+
+// A prompt of 5 tokens, a decoded token after 6 past tokens, and 2 tokens after 3 past tokens share one pool of
+// blocks, each sequence in shuffled blocks. With do_rotary, the new query and key of each token are rotated by its
+// position after the past tokens of its sequence, while the cache holds keys that are already rotated.
+void RunPagedAttentionTest(bool packed_qkv, int local_window_size, bool use_float16, bool do_rotary = false,
+                           bool rotary_interleaved = false) {
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+  const std::vector<int32_t> cumulative_seqlens = {0, 5, 6, 8};
+  const std::vector<int32_t> past_seqlens = {0, 6, 3};
+  const std::vector<int32_t> block_table = {5, 2, 0,
+                                            1, 7, 0,
+                                            6, 3, 0};
+  const int token_count = cumulative_seqlens.back();
+
+  const size_t cache_size = static_cast<size_t>(kNumBlocks) * kBlockSize * kv_hidden_size;
+
+  const std::vector<float> query = MakeAttentionData(static_cast<size_t>(token_count) * hidden_size, kQueryFrequency);
+  const std::vector<float> key = MakeAttentionData(static_cast<size_t>(token_count) * kv_hidden_size, kKeyFrequency);
+  const std::vector<float> value = MakeAttentionData(static_cast<size_t>(token_count) * kv_hidden_size,
+                                                     kValueFrequency);
+  const std::vector<float> key_cache = MakeAttentionData(cache_size, kPastKeyFrequency);
+  const std::vector<float> value_cache = MakeAttentionData(cache_size, kPastValueFrequency);
+
+  std::vector<float> cos_cache;
+  std::vector<float> sin_cache;
+  std::vector<float> rotated_query = query;
+  std::vector<float> rotated_key = key;
+  if (do_rotary) {
+    for (int position = 0; position < kMaxPositions; position++) {
+      for (int i = 0; i < kHeadSize / 2; i++) {
+        const float angle = static_cast<float>(position) * std::pow(10000.0f, -2.0f * i / kHeadSize);
+        cos_cache.push_back(std::cos(angle));
+        sin_cache.push_back(std::sin(angle));
+      }
+    }
+
+    std::vector<int> positions;
+    for (size_t b = 0; b < past_seqlens.size(); b++) {
+      for (int t = cumulative_seqlens[b]; t < cumulative_seqlens[b + 1]; t++) {
+        positions.push_back(past_seqlens[b] + t - cumulative_seqlens[b]);
+      }
+    }
+    ApplyRotaryEmbedding(rotated_query, kGroupedNumHeads, positions, cos_cache, sin_cache, rotary_interleaved);
+    ApplyRotaryEmbedding(rotated_key, kGroupedKvNumHeads, positions, cos_cache, sin_cache, rotary_interleaved);
+  }
+
+  const std::vector<float> output = ComputeReference(rotated_query, rotated_key, value, key_cache, value_cache,
+                                                     cumulative_seqlens, past_seqlens, block_table, local_window_size);
+
+  std::vector<float> packed_query;
+  if (packed_qkv) {
+    for (int t = 0; t < token_count; t++) {
+      packed_query.insert(packed_query.end(), query.begin() + t * hidden_size, query.begin() + (t + 1) * hidden_size);
+      packed_query.insert(packed_query.end(), key.begin() + t * kv_hidden_size, key.begin() + (t + 1) * kv_hidden_size);
+      packed_query.insert(packed_query.end(), value.begin() + t * kv_hidden_size,
+                          value.begin() + (t + 1) * kv_hidden_size);
+    }
+  }
+
+  OpTester tester("PagedAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", kGroupedNumHeads);
+  tester.AddAttribute<int64_t>("kv_num_heads", kGroupedKvNumHeads);
+  tester.AddAttribute<int64_t>("local_window_size", local_window_size);
+  tester.AddAttribute<int64_t>("do_rotary", do_rotary ? 1 : 0);
+  tester.AddAttribute<int64_t>("rotary_interleaved", rotary_interleaved ? 1 : 0);
+
+  const std::vector<int64_t> query_dims = {token_count, packed_qkv ? hidden_size + 2 * kv_hidden_size : hidden_size};
+  const std::vector<int64_t> kv_dims = {token_count, kv_hidden_size};
+  const std::vector<int64_t> cache_dims = {kNumBlocks, kBlockSize, kGroupedKvNumHeads, kHeadSize};
+  const std::vector<int64_t> output_dims = {token_count, hidden_size};
+
+  if (use_float16) {
+    tester.AddInput<MLFloat16>("query", query_dims, ToFloat16(packed_qkv ? packed_query : query));
+    if (packed_qkv) {
+      tester.AddOptionalInputEdge<MLFloat16>();
+      tester.AddOptionalInputEdge<MLFloat16>();
+    } else {
+      tester.AddInput<MLFloat16>("key", kv_dims, ToFloat16(key));
+      tester.AddInput<MLFloat16>("value", kv_dims, ToFloat16(value));
+    }
+    tester.AddInput<MLFloat16>("key_cache", cache_dims, ToFloat16(key_cache));
+    tester.AddInput<MLFloat16>("value_cache", cache_dims, ToFloat16(value_cache));
+  } else {
+    tester.AddInput<float>("query", query_dims, packed_qkv ? packed_query : query);
+    if (packed_qkv) {
+      tester.AddOptionalInputEdge<float>();
+      tester.AddOptionalInputEdge<float>();
+    } else {
+      tester.AddInput<float>("key", kv_dims, key);
+      tester.AddInput<float>("value", kv_dims, value);
+    }
+    tester.AddInput<float>("key_cache", cache_dims, key_cache);
+    tester.AddInput<float>("value_cache", cache_dims, value_cache);
+  }
+  tester.AddInput<int32_t>("cumulative_sequence_length", {static_cast<int64_t>(cumulative_seqlens.size())},
+                           cumulative_seqlens);
+  tester.AddInput<int32_t>("past_seqlens", {static_cast<int64_t>(past_seqlens.size())}, past_seqlens);
+  tester.AddInput<int32_t>("block_table", {static_cast<int64_t>(past_seqlens.size()), kMaxBlocksPerSequence},
+                           block_table);
+  if (do_rotary) {
+    const std::vector<int64_t> rotary_cache_dims = {kMaxPositions, kHeadSize / 2};
+    if (use_float16) {
+      tester.AddInput<MLFloat16>("cos_cache", rotary_cache_dims, ToFloat16(cos_cache));
+      tester.AddInput<MLFloat16>("sin_cache", rotary_cache_dims, ToFloat16(sin_cache));
+    } else {
+      tester.AddInput<float>("cos_cache", rotary_cache_dims, cos_cache);
+      tester.AddInput<float>("sin_cache", rotary_cache_dims, sin_cache);
+    }
+  }
+
+  if (use_float16) {
+    tester.AddOutput<MLFloat16>("output", output_dims, ToFloat16(output));
+    tester.SetOutputTolerance(0.005f);
+  } else {
+    tester.AddOutput<float>("output", output_dims, output);
+    tester.SetOutputTolerance(0.0001f);
+  }
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+}  // namespace
+
+TEST(PagedAttentionTest, CpuMixedPromptAndDecode) {
+  RunPagedAttentionTest(false, -1, false);
+}
+
+TEST(PagedAttentionTest, CpuPackedQKV) {
+  RunPagedAttentionTest(true, -1, false);
+}
+
+TEST(PagedAttentionTest, CpuLocalWindow) {
+  RunPagedAttentionTest(false, 2, false);
+}
+
+TEST(PagedAttentionTest, CpuMixedPromptAndDecode_Float16) {
+  RunPagedAttentionTest(false, -1, true);
+}
+
+TEST(PagedAttentionTest, CpuRotary) {
+  RunPagedAttentionTest(false, -1, false, true);
+}
+
+TEST(PagedAttentionTest, CpuRotaryPackedQKV) {
+  RunPagedAttentionTest(true, -1, false, true);
+}
+
+TEST(PagedAttentionTest, CpuRotaryInterleaved) {
+  RunPagedAttentionTest(false, -1, false, true, true);
+}
+
+TEST(PagedAttentionTest, CpuRotaryPackedQKV_Float16) {
+  RunPagedAttentionTest(true, 3, true, true);
+}
+
+TEST(PagedAttentionTest, CpuBlockOutOfRange) {
+  OpTester tester("PagedAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", kGroupedNumHeads);
+  tester.AddAttribute<int64_t>("kv_num_heads", kGroupedKvNumHeads);
+
+  constexpr int hidden_size = kGroupedNumHeads * kHeadSize;
+  constexpr int kv_hidden_size = kGroupedKvNumHeads * kHeadSize;
+  const std::vector<int64_t> cache_dims = {kNumBlocks, kBlockSize, kGroupedKvNumHeads, kHeadSize};
+  tester.AddInput<float>("query", {1, hidden_size}, std::vector<float>(hidden_size, 0.0f));
+  tester.AddInput<float>("key", {1, kv_hidden_size}, std::vector<float>(kv_hidden_size, 0.0f));
+  tester.AddInput<float>("value", {1, kv_hidden_size}, std::vector<float>(kv_hidden_size, 0.0f));
+  tester.AddInput<float>("key_cache", cache_dims, std::vector<float>(kNumBlocks * kBlockSize * kv_hidden_size, 0.0f));
+  tester.AddInput<float>("value_cache", cache_dims, std::vector<float>(kNumBlocks * kBlockSize * kv_hidden_size, 0.0f));
+  tester.AddInput<int32_t>("cumulative_sequence_length", {2}, {0, 1});
+  tester.AddInput<int32_t>("past_seqlens", {1}, {4});
+  tester.AddInput<int32_t>("block_table", {1, 2}, {0, kNumBlocks});
+  tester.AddOutput<float>("output", {1, hidden_size}, std::vector<float>(hidden_size, 0.0f));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectFailure, "is out of the range", {}, nullptr, &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
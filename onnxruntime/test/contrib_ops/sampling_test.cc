@@ -1,12 +1,19 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/framework/allocator.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/util/include/asserts.h"
 
 #ifdef USE_CUDA
 #include "core/providers/cuda/cuda_provider_options.h"
@@ -17,6 +24,124 @@ extern std::unique_ptr<Ort::Env> ort_env;
 namespace onnxruntime {
 namespace test {
 
+namespace {
+// Top-p filtering of one row by sorting the whole vocabulary and accumulating the probabilities in double precision.
+std::vector<float> FilterTopPByFullSort(const std::vector<float>& scores,
+                                        const contrib::transformers::IGenerationParameters& parameters) {
+  std::vector<size_t> order(scores.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&scores](size_t a, size_t b) { return scores[a] > scores[b]; });
+
+  const double max_score = scores[order[0]];
+  double sum = 0.0;
+  for (float score : scores) {
+    sum += std::exp(score - max_score);
+  }
+
+  const size_t min_keep = parameters.custom_sampling ? 1 : static_cast<size_t>(parameters.min_tokens_to_keep);
+  std::vector<float> filtered(scores.size(), parameters.filter_value);
+  double cumulative_prob = 0.0;
+  for (size_t i = 0; i < order.size(); i++) {
+    const bool is_filtered = parameters.custom_sampling ? cumulative_prob > parameters.top_p
+                                                        : cumulative_prob >= parameters.top_p;
+    if (i >= min_keep && is_filtered) {
+      break;
+    }
+    filtered[order[i]] = scores[order[i]];
+    cumulative_prob += std::exp(scores[order[i]] - max_score) / sum;
+  }
+
+  return filtered;
+}
+
+// Checks the scores filtered by SamplingCpuHelper::Sample and the sampled tokens against the full sort.
+void RunTopPFilteringTest(const std::vector<std::vector<float>>& rows, float top_p, int min_tokens_to_keep,
+                          size_t expected_kept_count, size_t expected_custom_kept_count) {
+  for (bool custom_sampling : {false, true}) {
+    SCOPED_TRACE(::testing::Message() << "top_p: " << top_p << ", min_tokens_to_keep: " << min_tokens_to_keep
+                                      << ", custom_sampling: " << custom_sampling);
+    const size_t batch_size = rows.size();
+    const size_t vocab_size = rows[0].size();
+
+    contrib::transformers::IGenerationParameters parameters{};
+    parameters.batch_size = static_cast<int>(batch_size);
+    parameters.vocab_size = static_cast<int>(vocab_size);
+    parameters.filter_value = -std::numeric_limits<float>::infinity();
+    parameters.top_p = top_p;
+    parameters.min_tokens_to_keep = min_tokens_to_keep;
+    parameters.custom_sampling = custom_sampling;
+
+    std::vector<float> scores;
+    for (const auto& row : rows) {
+      scores.insert(scores.end(), row.begin(), row.end());
+    }
+    std::vector<float> sorted_scores(scores.size());
+    std::vector<float> cumulative_probs(scores.size());
+    std::vector<int32_t> next_tokens(batch_size);
+
+    contrib::transformers::ISamplingState<float> sampling_state;
+    sampling_state.sorted_scores = gsl::make_span(sorted_scores);
+    sampling_state.cumulative_probs = gsl::make_span(cumulative_probs);
+    contrib::transformers::IGreedySearchState<float> greedy_state;
+    greedy_state.next_tokens = gsl::make_span(next_tokens);
+
+    AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+    gsl::span<float> next_token_scores = gsl::make_span(scores);
+    ASSERT_STATUS_OK(contrib::SamplingCpuHelper::Sample<float>(allocator, nullptr, next_token_scores,
+                                                               &sampling_state, &greedy_state, &parameters,
+                                                               nullptr));
+
+    const size_t expected_count = custom_sampling ? expected_custom_kept_count : expected_kept_count;
+    for (size_t b = 0; b < batch_size; b++) {
+      const std::vector<float> expected = FilterTopPByFullSort(rows[b], parameters);
+      const float* actual = scores.data() + b * vocab_size;
+      size_t kept_count = 0;
+      for (size_t j = 0; j < vocab_size; j++) {
+        EXPECT_EQ(actual[j], expected[j]) << "row " << b << ", token " << j;
+        kept_count += expected[j] != parameters.filter_value ? 1 : 0;
+      }
+      EXPECT_EQ(kept_count, expected_count) << "row " << b;
+      ASSERT_GE(next_tokens[b], 0);
+      ASSERT_LT(static_cast<size_t>(next_tokens[b]), vocab_size);
+      EXPECT_NE(actual[next_tokens[b]], parameters.filter_value) << "row " << b;
+    }
+  }
+}
+
+// Rows of distinct scores that are almost equal, so that every token has a probability of about 1 / vocab_size.
+// Each row orders the tokens differently.
+std::vector<std::vector<float>> FlatRows(size_t vocab_size, float peak) {
+  std::vector<std::vector<float>> rows;
+  for (size_t stride : {7919, 104729}) {
+    std::vector<float> row(vocab_size);
+    for (size_t j = 0; j < vocab_size; j++) {
+      row[j] = -1e-7f * static_cast<float>((j * stride) % vocab_size);
+    }
+    row[(3 * stride) % vocab_size] += peak;
+    rows.push_back(std::move(row));
+  }
+  return rows;
+}
+}  // namespace
+
+TEST(SamplingTest, TopPFilteringMatchesFullSort) {
+  // The first 64 candidates hold about 6% of a flat distribution, well short of top_p.
+  RunTopPFilteringTest(FlatRows(1000, 0.0f), 0.5005f, 1, 501, 501);
+  RunTopPFilteringTest(FlatRows(1000, 0.0f), 0.9985f, 0, 999, 999);
+
+  // One token holds about 96% of the probability. Without custom sampling, min_tokens_to_keep keeps more tokens
+  // than the first candidates.
+  RunTopPFilteringTest(FlatRows(1000, 10.0f), 0.5f, 100, 100, 1);
+  RunTopPFilteringTest(FlatRows(1000, 10.0f), 0.5f, 1, 1, 1);
+
+  // A top_p of 1 keeps the whole vocabulary.
+  RunTopPFilteringTest(FlatRows(1000, 0.0f), 1.0f, 1, 1000, 1000);
+  RunTopPFilteringTest(FlatRows(1000, 10.0f), 1.0f, 1, 1000, 1000);
+
+  // A vocabulary smaller than the first candidates.
+  RunTopPFilteringTest(FlatRows(40, 0.0f), 0.5125f, 1, 21, 21);
+}
+
 #if defined(__linux__) && !defined(__ANDROID__)
 #if defined(USE_CUDA) || defined(USE_ROCM)
 TEST(SamplingTest, Gpt2Sampling_GPU) {
@@ -6,7 +6,10 @@
 #include "core/framework/allocator_utils.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <thread>
 #include "core/framework/stream_handles.h"
 
 namespace onnxruntime {
@@ -482,5 +485,145 @@ TEST(BFCArenaTest, TestExtendStrategy) {
   ASSERT_EQ(extend_delta_bytes, extend_limit);
 }
 
+static std::shared_ptr<BFCArena> CreateArenaWithThreadCache(int64_t thread_cache_max_bytes) {
+  OrtArenaCfg config(0, -1, -1, -1, -1, -1L, thread_cache_max_bytes);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config};
+  return std::static_pointer_cast<BFCArena>(CreateAllocator(device_info));
+}
+
+TEST(BFCArenaTest, ThreadCacheReusesFreedChunks) {
+  auto a = CreateArenaWithThreadCache(1 << 20);
+  AllocatorStats stats;
+
+  void* p = a->Alloc(1000);
+  a->Free(p);
+  // The chunk stays in use while it is held by the cache.
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 1024);
+
+  // Same bin, the cached chunk is returned.
+  void* q = a->Alloc(900);
+  EXPECT_EQ(p, q);
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.num_cache_hits, 1);
+  EXPECT_EQ(stats.num_cache_misses, 1);
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_DOUBLE_EQ(stats.CacheHitRatio(), 0.5);
+
+  // Larger bin, the cache cannot serve it.
+  a->Free(q);
+  void* r = a->Alloc(4096);
+  EXPECT_NE(q, r);
+  a->Free(r);
+
+  // Shrink gives the cached chunks back to the arena.
+  EXPECT_EQ(a->Shrink(), Status::OK());
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.num_cache_hits, 1);
+  EXPECT_EQ(stats.num_cache_misses, 2);
+}
+
+TEST(BFCArenaTest, ThreadCacheFlushesOverLimit) {
+  auto a = CreateArenaWithThreadCache(4096);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(a->Alloc(1024));
+  }
+  for (void* p : ptrs) {
+    a->Free(p);
+  }
+
+  // Only 4096 bytes are kept by the cache, the other chunks went back to the bins.
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 4096);
+
+  // Chunks too large for the cache are never kept.
+  void* large = a->Alloc(4 << 20);
+  a->Free(large);
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 4096);
+}
+
+TEST(BFCArenaTest, ThreadCacheFlushedWhenOutOfMemory) {
+  // A single region of 4096 bytes.
+  OrtArenaCfg config(4096, static_cast<int>(ArenaExtendStrategy::kNextPowerOfTwo), 4096, -1, -1, -1L, 1 << 20);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config};
+  auto a = std::static_pointer_cast<BFCArena>(CreateAllocator(device_info));
+
+  void* p = a->Alloc(2048);
+  a->Free(p);
+
+  // Too large for the cached chunk and for the free half of the region, the cache is given back to the bins.
+  void* q = a->Alloc(3072);
+  ASSERT_NE(q, nullptr);
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 4096);
+  EXPECT_EQ(stats.num_cache_misses, 2);
+  a->Free(q);
+}
+
+TEST(BFCArenaTest, ThreadCacheWithReserve) {
+  auto a = CreateArenaWithThreadCache(1 << 20);
+  void* p = a->Alloc(256);
+  void* reserved = a->Reserve(1024);
+  a->Free(reserved);
+  a->Free(p);
+
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.num_reserves, 1);
+  EXPECT_EQ(stats.bytes_in_use, 256);
+}
+
+TEST(BFCArenaTest, ThreadCacheMultiThreaded) {
+  auto a = CreateArenaWithThreadCache(1 << 20);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIterations = 500;
+  std::atomic<int> errors{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&a, &errors, t]() {
+      std::vector<std::pair<uint8_t*, size_t>> buffers;
+      for (int i = 0; i < kNumIterations; ++i) {
+        const size_t size = static_cast<size_t>(256 + (i * 7919 + t * 104729) % 65536);
+        auto* p = static_cast<uint8_t*>(a->Alloc(size));
+        memset(p, t, size);
+        buffers.emplace_back(p, size);
+        // Keeps a few buffers alive so that chunks of different sizes are freed in a different order.
+        if (buffers.size() > 4 || i + 1 == kNumIterations) {
+          for (auto& [ptr, len] : buffers) {
+            for (size_t k = 0; k < len; ++k) {
+              if (ptr[k] != static_cast<uint8_t>(t)) {
+                ++errors;
+                break;
+              }
+            }
+            a->Free(ptr);
+          }
+          buffers.clear();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(errors, 0);
+
+  EXPECT_EQ(a->Shrink(), Status::OK());
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.num_cache_hits + stats.num_cache_misses, kNumThreads * kNumIterations);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
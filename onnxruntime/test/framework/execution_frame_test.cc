@@ -3,11 +3,13 @@
 
 #include "core/common/span_utils.h"
 #include "core/framework/execution_frame.h"
+#include "core/framework/mem_pattern_shape_buckets.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
 #include "core/graph/model.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test_utils.h"
 #include "test/test_environment.h"
 #include "test/framework/TestAllocatorManager.h"
@@ -370,6 +372,139 @@ TEST_F(ExecutionFrameTest, MemPatternTest) {
   ASSERT_EQ(p->GetBlock(4)->offset_, kAllocAlignment);
 }
 
+// Training builds generate the patterns from the symbolic shapes instead of tracing them.
+#ifndef ENABLE_TRAINING
+TEST_F(ExecutionFrameTest, MemPatternShapeBucketsTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           domain_to_version, {}, DefaultLoggingManager().DefaultLogger());
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto* input_shape = tensor_float.mutable_tensor_type()->mutable_shape();
+  input_shape->add_dim()->set_dim_param("batch");
+  input_shape->add_dim()->set_dim_param("seq");
+  onnxruntime::NodeArg input_def("X", &tensor_float), relu_out_def("T1", nullptr), output_def("Y", nullptr);
+
+  graph.AddNode("node1", "Relu", "relu1", ArgMap{&input_def}, ArgMap{&relu_out_def}).SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "Relu", "relu2", ArgMap{&relu_out_def}, ArgMap{&output_def}).SetExecutionProviderType(xp_type);
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  KernelRegistryManager kernel_registry_manager;
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(xp_type, std::move(cpu_xp)));
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  DataTransferManager dtm;
+  ExternalDataLoaderManager edlm;
+  profiling::Profiler profiler;
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  ASSERT_STATUS_OK(sess_options.config_options.AddConfigEntry(kOrtSessionOptionsMemoryPatternShapeBuckets, "pow2"));
+
+  SessionState state(graph, execution_providers, &tp_, nullptr, dtm, edlm,
+                     DefaultLoggingManager().DefaultLogger(), profiler, sess_options);
+  ASSERT_STATUS_OK(state.FinalizeSessionState(ORT_TSTR(""), kernel_registry_manager));
+  ASSERT_TRUE(state.GetMemoryPatternShapeBuckets().IsEnabled());
+
+  const OrtValueNameIdxMap& mlvalue_name_idx_map(state.GetOrtValueNameIdxMap());
+  int x_idx = -1, t1_idx = -1, y_idx = -1;
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X", x_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("T1", t1_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("Y", y_idx));
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->CreatePreferredAllocators()[0];
+  const OrtDevice& device = cpu_allocator->Info().device;
+  auto create_input = [&](int64_t seq) {
+    OrtValue value;
+    CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{2, seq}, std::vector<float>(static_cast<size_t>(2 * seq), 1.0f), &value);
+    return value;
+  };
+
+  // The first run of the bucket (32, 64] traces a pattern planned for seq = 64.
+  MemoryPatternGroup pattern;
+  OrtValue x37 = create_input(37);
+  {
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(AsSpan({x_idx}), AsSpan({x37}), AsSpan({y_idx}), outputs, {},
+#ifdef ORT_ENABLE_STREAM
+                         {},
+#endif
+                         state);
+    ASSERT_TRUE(frame.HasMemoryPatternPlanner());
+
+    OrtValue t1;
+    ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(t1, t1_idx, DataTypeImpl::GetType<float>(), device,
+                                                              TensorShape({2, 37})));
+    ASSERT_STATUS_OK(frame.GeneratePatterns(pattern));
+  }
+
+  auto p = pattern.GetPatterns(device);
+  ASSERT_NE(p, nullptr);
+  ASSERT_EQ(p->GetBlock(t1_idx)->size_, 2u * 64u * sizeof(float));
+  ASSERT_STATUS_OK(state.UpdateMemoryPatternGroupCache(AsSpan({x37}), std::move(pattern)));
+
+  // Every sequence length of the bucket shares the pattern.
+  const InlinedHashMap<int, TensorShape>* inferred_shapes = nullptr;
+  OrtValue x50 = create_input(50);
+  OrtValue x65 = create_input(65);
+  const MemoryPatternGroup* cached = state.GetMemoryPatternGroup(AsSpan({x37}), AsSpan({x_idx}), inferred_shapes);
+  ASSERT_NE(cached, nullptr);
+  ASSERT_EQ(state.GetMemoryPatternGroup(AsSpan({x50}), AsSpan({x_idx}), inferred_shapes), cached);
+  ASSERT_EQ(state.GetMemoryPatternGroup(AsSpan({x65}), AsSpan({x_idx}), inferred_shapes), nullptr);
+
+  {
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(AsSpan({x_idx}), AsSpan({x50}), AsSpan({y_idx}), outputs, {},
+#ifdef ORT_ENABLE_STREAM
+                         {},
+#endif
+                         state);
+    ASSERT_FALSE(frame.HasMemoryPatternPlanner());
+
+    // Placed in the block planned for seq = 64 instead of being allocated.
+    OrtValue t1;
+    ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(t1, t1_idx, DataTypeImpl::GetType<float>(), device,
+                                                              TensorShape({2, 50})));
+    ASSERT_FALSE(t1.Get<Tensor>().OwnsBuffer());
+  }
+}
+#endif
+
+TEST(MemoryPatternShapeBucketsTest, RoundUp) {
+  MemoryPatternShapeBuckets buckets;
+  ASSERT_STATUS_OK(MemoryPatternShapeBuckets::Parse("", buckets));
+  ASSERT_FALSE(buckets.IsEnabled());
+  ASSERT_EQ(buckets.RoundUp(37), 37);
+
+  ASSERT_STATUS_OK(MemoryPatternShapeBuckets::Parse("pow2", buckets));
+  ASSERT_TRUE(buckets.IsEnabled());
+  ASSERT_EQ(buckets.RoundUp(0), 0);
+  ASSERT_EQ(buckets.RoundUp(1), 1);
+  ASSERT_EQ(buckets.RoundUp(37), 64);
+  ASSERT_EQ(buckets.RoundUp(512), 512);
+  ASSERT_EQ(buckets.RoundUp(513), 1024);
+
+  ASSERT_STATUS_OK(MemoryPatternShapeBuckets::Parse("16,128,384", buckets));
+  ASSERT_EQ(buckets.RoundUp(1), 16);
+  ASSERT_EQ(buckets.RoundUp(16), 16);
+  ASSERT_EQ(buckets.RoundUp(17), 128);
+  ASSERT_EQ(buckets.RoundUp(300), 384);
+  ASSERT_EQ(buckets.RoundUp(385), 385);
+
+  ASSERT_FALSE(MemoryPatternShapeBuckets::Parse("128,16", buckets).IsOK());
+  ASSERT_FALSE(MemoryPatternShapeBuckets::Parse("16,-4", buckets).IsOK());
+  ASSERT_FALSE(MemoryPatternShapeBuckets::Parse("pow3", buckets).IsOK());
+  ASSERT_FALSE(MemoryPatternShapeBuckets::Parse(",", buckets).IsOK());
+}
+
 #ifdef ENABLE_TRAINING
 TEST_F(ExecutionFrameTest, MemPatternWithExternalOutputsTest) {
   auto cpu_xp = CreateCPUExecutionProvider();
@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <cstring>
+#include <filesystem>
 #include <functional>
 #include <future>
 #include <iterator>
@@ -716,6 +718,194 @@ TEST(InferenceSessionTests, CheckRunLogger) {
 #endif
 }
 
+TEST(InferenceSessionTests, MemoryPatternCacheFile) {
+  const std::filesystem::path cache_file{"inference_session_test_mem_pattern.bin"};
+  std::filesystem::remove(cache_file);
+
+  SessionOptions so;
+  so.session_logid = "MemoryPatternCacheFile";
+  so.enable_mem_pattern = true;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsMemoryPatternCacheFile,
+                                                    cache_file.string().c_str()));
+
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  OrtValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], dims_mul_x, values_mul_x,
+                       &ml_value);
+  std::vector<OrtValue> feeds{ml_value};
+  std::vector<int> feed_idxs{0};
+  const InlinedHashMap<int, TensorShape>* inferred_shapes = nullptr;
+
+  {
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    ASSERT_TRUE(session_object.GetSessionState().GetEnableMemoryPattern());
+#ifndef ENABLE_TRAINING
+    // Training builds generate the pattern on demand.
+    ASSERT_EQ(session_object.GetSessionState().GetMemoryPatternGroup(feeds, feed_idxs, inferred_shapes), nullptr);
+#endif
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+    ASSERT_NE(session_object.GetSessionState().GetMemoryPatternGroup(feeds, feed_idxs, inferred_shapes), nullptr);
+  }
+  ASSERT_TRUE(std::filesystem::exists(cache_file));
+
+  {
+    // The pattern generated by the first session is available before the first Run.
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+    ASSERT_STATUS_OK(session_object.Initialize());
+    ASSERT_NE(session_object.GetSessionState().GetMemoryPatternGroup(feeds, feed_idxs, inferred_shapes), nullptr);
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+
+  {
+    // A corrupted file is ignored.
+    std::ofstream(cache_file, std::ios::binary | std::ios::trunc) << "not a memory pattern cache file";
+    InferenceSessionWrapper session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+    ASSERT_STATUS_OK(session_object.Initialize());
+#ifndef ENABLE_TRAINING
+    ASSERT_EQ(session_object.GetSessionState().GetMemoryPatternGroup(feeds, feed_idxs, inferred_shapes), nullptr);
+#endif
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+
+  std::filesystem::remove(cache_file);
+}
+
+namespace {
+
+// Saves a model computing Y = X + W, padding the model doc string so that the raw data of W starts at an offset of
+// the file equal to payload_remainder modulo 64.
+void SaveMappedInitializerModel(const PathString& model_file_name, const std::vector<float>& weights,
+                                size_t payload_remainder) {
+  const int64_t size = static_cast<int64_t>(weights.size());
+  onnxruntime::Model model("mapped_initializers", false, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(size);
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& w = graph.GetOrCreateNodeArg("W", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("add", "Add", "X + W", {&x, &w}, {&y});
+
+  ONNX_NAMESPACE::TensorProto w_proto;
+  w_proto.set_name("W");
+  w_proto.add_dims(size);
+  w_proto.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  w_proto.set_raw_data(weights.data(), weights.size() * sizeof(float));
+  graph.AddInitializedTensor(w_proto);
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  const std::string_view payload(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+  for (size_t padding = 128; padding < 128 + 64; ++padding) {
+    model.SetDocString(std::string(padding, ' '));
+    ASSERT_STATUS_OK(onnxruntime::Model::Save(model, model_file_name));
+    std::ifstream file(std::filesystem::path(model_file_name), std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t offset = content.find(payload);
+    ASSERT_NE(offset, std::string::npos);
+    if (offset % 64 == payload_remainder) {
+      return;
+    }
+  }
+  FAIL() << "No padding puts the raw data at the requested offset.";
+}
+
+// Runs the model saved by SaveMappedInitializerModel with mapped initializers, and returns the address of W.
+void RunMappedInitializerModel(const PathString& model_file_name, const std::vector<float>& weights,
+                               uintptr_t& w_address) {
+  SessionOptions so;
+  so.session_logid = "LoadModelWithMappedInitializers";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsLoadModelWithMappedInitializers, "1"));
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_file_name));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  const SessionState& session_state = session_object.GetSessionState();
+  int w_index = -1;
+  ASSERT_STATUS_OK(session_state.GetOrtValueNameIdxMap().GetIdx("W", w_index));
+  const auto& initializers = session_state.GetInitializedTensors();
+  ASSERT_NE(initializers.find(w_index), initializers.end());
+  w_address = reinterpret_cast<uintptr_t>(initializers.at(w_index).Get<Tensor>().DataRaw());
+
+  const int64_t size = static_cast<int64_t>(weights.size());
+  OrtValue x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], std::vector<int64_t>{size},
+                       std::vector<float>(weights.size(), 1.0f), &x);
+  NameMLValMap feeds{{"X", x}};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(RunOptions(), feeds, std::vector<std::string>{"Y"}, &fetches));
+  ASSERT_EQ(fetches.size(), 1u);
+  const auto y = fetches[0].Get<Tensor>().DataAsSpan<float>();
+  ASSERT_EQ(y.size(), weights.size());
+  for (size_t i = 0; i < weights.size(); ++i) {
+    ASSERT_EQ(y[i], 1.0f + weights[i]);
+  }
+}
+
+}  // namespace
+
+TEST(InferenceSessionTests, LoadModelWithMappedInitializers) {
+  const PathString model_file_name = ORT_TSTR("inference_session_test_mapped_initializers.onnx");
+  std::vector<float> weights(256);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = 0.5f * static_cast<float>(i);
+  }
+  ASSERT_NO_FATAL_FAILURE(SaveMappedInitializerModel(model_file_name, weights, 0));
+
+  // The raw data of the initializer is replaced by a reference to the model file.
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ASSERT_STATUS_OK(onnxruntime::Model::LoadWithMappedInitializers(model_file_name, model_proto));
+  ASSERT_EQ(model_proto.graph().initializer_size(), 1);
+  const auto& w_proto = model_proto.graph().initializer(0);
+  ASSERT_TRUE(utils::HasExternalData(w_proto));
+  ASSERT_FALSE(w_proto.has_raw_data());
+  std::vector<uint8_t> w_data;
+  ASSERT_STATUS_OK(utils::UnpackInitializerData(w_proto, std::filesystem::path(model_file_name), w_data));
+  ASSERT_EQ(w_data.size(), weights.size() * sizeof(float));
+  ASSERT_EQ(std::memcmp(w_data.data(), weights.data(), w_data.size()), 0);
+
+  uintptr_t w_address = 0;
+  ASSERT_NO_FATAL_FAILURE(RunMappedInitializerModel(model_file_name, weights, w_address));
+  ASSERT_EQ(w_address % 64, 0u);
+
+  std::filesystem::remove(model_file_name);
+}
+
+TEST(InferenceSessionTests, LoadModelWithMisalignedMappedInitializers) {
+  const PathString model_file_name = ORT_TSTR("inference_session_test_misaligned_mapped_initializers.onnx");
+  std::vector<float> weights(256);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = 0.25f * static_cast<float>(i);
+  }
+  // The raw data is not even aligned to the size of a float.
+  ASSERT_NO_FATAL_FAILURE(SaveMappedInitializerModel(model_file_name, weights, 2));
+
+  // The raw data stays inline instead of referring to a misaligned offset of the file.
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ASSERT_STATUS_OK(onnxruntime::Model::LoadWithMappedInitializers(model_file_name, model_proto));
+  ASSERT_EQ(model_proto.graph().initializer_size(), 1);
+  const auto& w_proto = model_proto.graph().initializer(0);
+  ASSERT_FALSE(utils::HasExternalData(w_proto));
+  ASSERT_EQ(w_proto.raw_data().size(), weights.size() * sizeof(float));
+
+  uintptr_t w_address = 0;
+  ASSERT_NO_FATAL_FAILURE(RunMappedInitializerModel(model_file_name, weights, w_address));
+  ASSERT_EQ(w_address % alignof(float), 0u);
+
+  std::filesystem::remove(model_file_name);
+}
+
 // WebAssembly will emit profiling data into console
 #if !defined(__wasm__)
 TEST(InferenceSessionTests, CheckRunProfilerWithSessionOptions) {
@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <fstream>
+
+#include "core/framework/intra_op_cost_table.h"
+#include "core/platform/path_lib.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/temp_dir.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+using Sample = IntraOpCostTable::Decision::Sample;
+
+constexpr int kMaxNumThreads = 8;
+constexpr int64_t kMinWork = IntraOpCostTable::kMinWorkPerThreadNs;
+
+// Runs the calibration of `key` with sequential runs of `sequential_ns`, returns the final decision.
+IntraOpCostTable::Decision Calibrate(IntraOpCostTable& table, uint64_t key, int64_t parallel_ns,
+                                     int64_t sequential_ns) {
+  auto decision = table.Decide(key);
+  EXPECT_EQ(decision.sample, Sample::kParallel);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 0);
+  table.Record(key, decision, parallel_ns, "MatMul");
+
+  for (int i = 0; i < IntraOpCostTable::kNumSequentialSamples; ++i) {
+    decision = table.Decide(key);
+    EXPECT_EQ(decision.sample, Sample::kSequential);
+    EXPECT_EQ(decision.degree_of_parallelism_limit, 1);
+    // the fastest sample is kept
+    table.Record(key, decision, sequential_ns + (i == 0 ? kMinWork : 0), "MatMul");
+  }
+  return table.Decide(key);
+}
+
+}  // namespace
+
+TEST(IntraOpCostTableTest, Calibration) {
+  IntraOpCostTable table(kMaxNumThreads, true, PathString());
+
+  // A small node runs on one thread per kMinWorkPerThreadNs of work.
+  auto decision = Calibrate(table, 1, kMinWork, 3 * kMinWork - 1);
+  EXPECT_EQ(decision.sample, Sample::kNone);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 3);
+
+  // A tiny node runs sequentially.
+  decision = Calibrate(table, 2, kMinWork / 4, kMinWork / 2);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 1);
+
+  // A node with enough work for the whole pool is not limited.
+  decision = Calibrate(table, 3, kMinWork, kMinWork * kMaxNumThreads);
+  EXPECT_EQ(decision.sample, Sample::kNone);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 0);
+
+  // A long parallel run skips the sequential samples.
+  decision = table.Decide(4);
+  table.Record(4, decision, kMinWork * kMaxNumThreads, "Conv");
+  decision = table.Decide(4);
+  EXPECT_EQ(decision.sample, Sample::kNone);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 0);
+}
+
+TEST(IntraOpCostTableTest, NoCalibration) {
+  IntraOpCostTable table(kMaxNumThreads, false, PathString());
+  const auto decision = table.Decide(1);
+  EXPECT_EQ(decision.sample, Sample::kNone);
+  EXPECT_EQ(decision.degree_of_parallelism_limit, 0);
+}
+
+TEST(IntraOpCostTableTest, SaveAndLoad) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("intra_op_cost_table_test_tmp_dir")};
+  const PathString path = ConcatPathComponent(tmp_dir.Path(), ORT_TSTR("costs.txt"));
+
+  {
+    IntraOpCostTable table(kMaxNumThreads, true, path);
+    // The file does not exist yet.
+    ASSERT_STATUS_OK(table.Load());
+    Calibrate(table, 1, kMinWork, 2 * kMinWork);
+    Calibrate(table, 0xfedcba9876543210, kMinWork, kMinWork * kMaxNumThreads);
+    ASSERT_STATUS_OK(table.SaveIfModified());
+  }
+
+  // The limits are computed from the degree of parallelism of the loading session.
+  IntraOpCostTable table(4, false, path);
+  ASSERT_STATUS_OK(table.Load());
+  EXPECT_EQ(table.Decide(1).degree_of_parallelism_limit, 2);
+  EXPECT_EQ(table.Decide(0xfedcba9876543210).degree_of_parallelism_limit, 0);
+  EXPECT_EQ(table.Decide(2).sample, Sample::kNone);
+
+  {
+    std::ofstream file(path, std::ios::trunc);
+    file << "not a cost table\n";
+  }
+  IntraOpCostTable invalid(kMaxNumThreads, true, path);
+  ASSERT_STATUS_NOT_OK(invalid.Load());
+}
+
+}  // namespace test
+}  // namespace onnxruntime
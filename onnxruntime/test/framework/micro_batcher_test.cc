@@ -0,0 +1,207 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "core/framework/allocator.h"
+#include "core/framework/tensor.h"
+#include "core/session/micro_batcher.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "test/util/include/asserts.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+OrtValue CreateFloatValue(const TensorShape& shape, const std::vector<float>& values) {
+  OrtValue value;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), shape, CPUAllocator::DefaultInstance(), value);
+  std::copy(values.begin(), values.end(), value.GetMutable<Tensor>()->MutableData<float>());
+  return value;
+}
+
+// Doubles the feed "X" into the fetch "Y", fails when the feed contains a negative value.
+struct DoublingModel {
+  Status operator()(const RunOptions& /*run_options*/, gsl::span<const std::string> /*feed_names*/,
+                    gsl::span<const OrtValue> feeds, gsl::span<const std::string> /*output_names*/,
+                    std::vector<OrtValue>& fetches) {
+    ++num_runs;
+    const Tensor& x = feeds[0].Get<Tensor>();
+    max_size = std::max(max_size.load(), x.Shape().Size());
+    auto x_data = x.DataAsSpan<float>();
+    std::vector<float> y_data(x_data.size());
+    for (size_t i = 0; i < x_data.size(); ++i) {
+      ORT_RETURN_IF(x_data[i] < 0.f, "Negative input");
+      y_data[i] = 2.f * x_data[i];
+    }
+    fetches.resize(1);
+    fetches[0] = CreateFloatValue(x.Shape(), y_data);
+    return Status::OK();
+  }
+
+  std::atomic<int> num_runs{0};
+  std::atomic<int64_t> max_size{0};
+};
+
+}  // namespace
+
+TEST(MicroBatcherTest, CreateFromConfig) {
+  std::unique_ptr<MicroBatcher> micro_batcher;
+  ConfigOptions config_options;
+  ASSERT_STATUS_OK(MicroBatcher::Create(config_options, nullptr, CPUAllocator::DefaultInstance(), micro_batcher));
+  EXPECT_EQ(micro_batcher, nullptr);
+
+  ASSERT_STATUS_OK(config_options.AddConfigEntry(kOrtSessionOptionsMicroBatchingMaxBatchSize, "1"));
+  ASSERT_STATUS_OK(MicroBatcher::Create(config_options, nullptr, CPUAllocator::DefaultInstance(), micro_batcher));
+  EXPECT_EQ(micro_batcher, nullptr);
+
+  ASSERT_STATUS_OK(config_options.AddConfigEntry(kOrtSessionOptionsMicroBatchingMaxBatchSize, "8"));
+  ASSERT_STATUS_OK(MicroBatcher::Create(config_options, nullptr, CPUAllocator::DefaultInstance(), micro_batcher));
+  EXPECT_NE(micro_batcher, nullptr);
+
+  ASSERT_STATUS_OK(config_options.AddConfigEntry(kOrtSessionOptionsMicroBatchingMaxLatencyUs, "-5"));
+  ASSERT_STATUS_NOT_OK(MicroBatcher::Create(config_options, nullptr, CPUAllocator::DefaultInstance(), micro_batcher));
+
+  ASSERT_STATUS_OK(config_options.AddConfigEntry(kOrtSessionOptionsMicroBatchingMaxBatchSize, "many"));
+  ASSERT_STATUS_NOT_OK(MicroBatcher::Create(config_options, nullptr, CPUAllocator::DefaultInstance(), micro_batcher));
+}
+
+TEST(MicroBatcherTest, CanBatch) {
+  MicroBatcher micro_batcher(4, std::chrono::microseconds(0), 0, nullptr, CPUAllocator::DefaultInstance());
+  const std::vector<std::string> feed_names{"X", "Z"};
+  std::vector<OrtValue> feeds{CreateFloatValue({2, 3}, std::vector<float>(6)),
+                              CreateFloatValue({2}, std::vector<float>(2))};
+  std::vector<OrtValue> fetches;
+  RunOptions run_options;
+
+  EXPECT_TRUE(micro_batcher.CanBatch(run_options, feed_names, feeds, &fetches, nullptr));
+
+  // Pre-allocated outputs.
+  std::vector<OrtValue> preallocated_fetches{CreateFloatValue({2, 3}, std::vector<float>(6))};
+  EXPECT_FALSE(micro_batcher.CanBatch(run_options, feed_names, feeds, &preallocated_fetches, nullptr));
+
+  // Run specific configuration.
+  RunOptions configured_run_options;
+  ASSERT_STATUS_OK(configured_run_options.config_options.AddConfigEntry("run.key", "value"));
+  EXPECT_FALSE(micro_batcher.CanBatch(configured_run_options, feed_names, feeds, &fetches, nullptr));
+
+  // Feeds with a different number of rows.
+  feeds[1] = CreateFloatValue({3}, std::vector<float>(3));
+  EXPECT_FALSE(micro_batcher.CanBatch(run_options, feed_names, feeds, &fetches, nullptr));
+
+  // A request filling a batch on its own.
+  feeds = {CreateFloatValue({4, 3}, std::vector<float>(12))};
+  EXPECT_FALSE(micro_batcher.CanBatch(run_options, gsl::make_span(feed_names).first(1), feeds, &fetches, nullptr));
+
+  // Scalars have no batch axis.
+  feeds = {CreateFloatValue({}, std::vector<float>(1))};
+  EXPECT_FALSE(micro_batcher.CanBatch(run_options, gsl::make_span(feed_names).first(1), feeds, &fetches, nullptr));
+}
+
+TEST(MicroBatcherTest, CoalesceConcurrentRequests) {
+  DoublingModel model;
+  // The latency window is long enough for every request to join, the batch runs as soon as it is full.
+  MicroBatcher micro_batcher(6, std::chrono::seconds(60), 1, std::ref(model), CPUAllocator::DefaultInstance());
+
+  constexpr int kNumRequests = 3;
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<std::vector<OrtValue>> fetches(kNumRequests);
+  std::vector<Status> statuses(kNumRequests);
+  std::vector<std::thread> threads;
+  for (int r = 0; r < kNumRequests; ++r) {
+    threads.emplace_back([&, r]() {
+      // Shape {2, 2, 3}, batched on axis 1, the values encode the request, the row and the column.
+      std::vector<float> values;
+      for (int o = 0; o < 2; ++o) {
+        for (int row = 0; row < 2; ++row) {
+          for (int c = 0; c < 3; ++c) {
+            values.push_back(static_cast<float>(100 * r + 10 * (2 * o + row) + c));
+          }
+        }
+      }
+      std::vector<OrtValue> feeds{CreateFloatValue({2, 2, 3}, values)};
+      RunOptions run_options;
+      statuses[r] = micro_batcher.Run(run_options, feed_names, feeds, output_names, fetches[r]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(model.num_runs, 1);
+  EXPECT_EQ(model.max_size, kNumRequests * 12);
+  EXPECT_EQ(micro_batcher.NumExecutions(), 1);
+  EXPECT_EQ(micro_batcher.NumRequests(), kNumRequests);
+  for (int r = 0; r < kNumRequests; ++r) {
+    ASSERT_STATUS_OK(statuses[r]);
+    ASSERT_EQ(fetches[r].size(), 1u);
+    const Tensor& y = fetches[r][0].Get<Tensor>();
+    ASSERT_EQ(y.Shape(), TensorShape({2, 2, 3}));
+    auto y_data = y.DataAsSpan<float>();
+    for (int i = 0; i < 12; ++i) {
+      EXPECT_EQ(y_data[i], 2.f * static_cast<float>(100 * r + 10 * (i / 3) + i % 3));
+    }
+  }
+}
+
+TEST(MicroBatcherTest, FailedRequestIsIsolated) {
+  DoublingModel model;
+  MicroBatcher micro_batcher(2, std::chrono::seconds(60), 0, std::ref(model), CPUAllocator::DefaultInstance());
+
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches_ok;
+  std::vector<OrtValue> fetches_failed;
+  Status status_ok;
+  Status status_failed;
+  std::thread ok_thread([&]() {
+    std::vector<OrtValue> feeds{CreateFloatValue({1, 2}, {1.f, 2.f})};
+    status_ok = micro_batcher.Run(RunOptions(), feed_names, feeds, output_names, fetches_ok);
+  });
+  std::thread failed_thread([&]() {
+    std::vector<OrtValue> feeds{CreateFloatValue({1, 2}, {-1.f, 2.f})};
+    status_failed = micro_batcher.Run(RunOptions(), feed_names, feeds, output_names, fetches_failed);
+  });
+  ok_thread.join();
+  failed_thread.join();
+
+  // The batch fails, then each request runs on its own.
+  EXPECT_EQ(model.num_runs, 3);
+  ASSERT_STATUS_OK(status_ok);
+  ASSERT_EQ(fetches_ok.size(), 1u);
+  auto y_data = fetches_ok[0].Get<Tensor>().DataAsSpan<float>();
+  EXPECT_EQ(std::vector<float>(y_data.begin(), y_data.end()), std::vector<float>({2.f, 4.f}));
+  EXPECT_FALSE(status_failed.IsOK());
+  EXPECT_TRUE(fetches_failed.empty());
+}
+
+TEST(MicroBatcherTest, DifferentShapesAreNotCoalesced) {
+  DoublingModel model;
+  MicroBatcher micro_batcher(4, std::chrono::milliseconds(10), 0, std::ref(model), CPUAllocator::DefaultInstance());
+
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<std::thread> threads;
+  std::vector<std::vector<OrtValue>> fetches(2);
+  for (int r = 0; r < 2; ++r) {
+    threads.emplace_back([&, r]() {
+      std::vector<OrtValue> feeds{CreateFloatValue({1, r + 1}, std::vector<float>(r + 1, 1.f))};
+      ASSERT_STATUS_OK(micro_batcher.Run(RunOptions(), feed_names, feeds, output_names, fetches[r]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(model.num_runs, 2);
+  EXPECT_EQ(fetches[0][0].Get<Tensor>().Shape(), TensorShape({1, 1}));
+  EXPECT_EQ(fetches[1][0].Get<Tensor>().Shape(), TensorShape({1, 2}));
+}
+
+}  // namespace test
+}  // namespace onnxruntime
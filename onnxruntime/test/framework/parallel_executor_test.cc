@@ -3,7 +3,12 @@
 
 #include "core/framework/data_types.h"
 #include "core/framework/op_kernel.h"
+#include "core/graph/model.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
 #include "test_utils.h"
 #include "core/session/inference_session.h"
 
@@ -145,5 +150,87 @@ TEST_P(ParallelExecutorThreadPoolTest, TestNullInterOpThreadPool) {
 
 INSTANTIATE_TEST_SUITE_P(ParallelExecutorThreadPoolTests, ParallelExecutorThreadPoolTest,
                          testing::Values(1, 0));
+
+// Wide graph: independent Add -> Mul branches of X, summed into Y = kNumBranches * 2 * X * X.
+TEST(ParallelExecutor, WorkStealing) {
+  constexpr int kNumBranches = 8;
+  Model model("work_stealing", false, DefaultLoggingManager().DefaultLogger());
+  Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  std::vector<NodeArg*> branch_outputs;
+  for (int i = 0; i < kNumBranches; ++i) {
+    const std::string suffix = std::to_string(i);
+    auto& sum = graph.GetOrCreateNodeArg("sum_" + suffix, &tensor_float);
+    auto& product = graph.GetOrCreateNodeArg("product_" + suffix, &tensor_float);
+    graph.AddNode("add_" + suffix, "Add", "", {&x, &x}, {&sum});
+    graph.AddNode("mul_" + suffix, "Mul", "", {&sum, &x}, {&product});
+    branch_outputs.push_back(&product);
+  }
+  auto& y = graph.GetOrCreateNodeArg("Y", &tensor_float);
+  graph.AddNode("sum", "Sum", "", branch_outputs, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+  std::string serialized_model;
+  ASSERT_TRUE(model.ToProto().SerializeToString(&serialized_model));
+
+  SessionOptions so;
+  so.execution_mode = ExecutionMode::ORT_PARALLEL;
+  so.graph_optimization_level = TransformerLevel::Default;
+  so.inter_op_param.thread_pool_size = 4;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsInterOpWorkStealing, "1"));
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  std::stringstream model_stream(serialized_model);
+  ASSERT_STATUS_OK(session.Load(model_stream));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  const WorkStealingPlan* plan = session.GetSessionState().GetWorkStealingPlan();
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->roots.size(), static_cast<size_t>(kNumBranches));
+  EXPECT_EQ(plan->num_dependencies.size(), static_cast<size_t>(2 * kNumBranches + 1));
+
+  OrtValue x_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], std::vector<int64_t>{3},
+                       std::vector<float>{1.f, 2.f, 3.f}, &x_value);
+  NameMLValMap feeds{{"X", x_value}};
+  std::vector<std::string> output_names{"Y"};
+  for (int run = 0; run < 20; ++run) {
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.Run(RunOptions(), feeds, output_names, &fetches));
+    ASSERT_EQ(fetches.size(), 1u);
+    auto y_data = fetches[0].Get<Tensor>().DataAsSpan<float>();
+    EXPECT_EQ(std::vector<float>(y_data.begin(), y_data.end()),
+              std::vector<float>({2.f * kNumBranches, 8.f * kNumBranches, 18.f * kNumBranches}));
+  }
+}
+
+TEST(ParallelExecutor, WorkStealingStatusPropagation) {
+  auto registry = std::make_shared<CustomRegistry>();
+  std::vector<OpSchema> schemas{TestOp::OpSchema()};
+  ASSERT_STATUS_OK(registry->RegisterOpSet(schemas, TestOp::OpDomain, 10, 11));
+  KernelCreateFn kernel_create_fn = [](FuncManager&, const OpKernelInfo& info, std::unique_ptr<OpKernel>& out) { out = std::make_unique<typename TestOp::OpKernelImpl>(info); return Status::OK(); };
+  auto kernel_def = TestOp::KernelDef();
+  ASSERT_STATUS_OK(registry->RegisterCustomKernel(kernel_def, kernel_create_fn));
+
+  for (int64_t action : {0, 1, 2}) {
+    OpTester tester{"TestOp", 10, TestOp::OpDomain};
+    tester.AddCustomOpRegistry(registry);
+    tester.AddInput<int64_t>("action", {1}, {action});
+    tester.AddOutput<int64_t>("action_out", {1}, {action});
+
+    onnxruntime::SessionOptions so;
+    so.execution_mode = ExecutionMode::ORT_PARALLEL;
+    so.inter_op_param.thread_pool_size = 2;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsInterOpWorkStealing, "1"));
+    if (action == 0) {
+      tester.Run(so, OpTester::ExpectResult::kExpectSuccess, {}, {kTensorrtExecutionProvider}, nullptr, nullptr);
+    } else {
+      tester.Run(so, OpTester::ExpectResult::kExpectFailure, action == 1 ? "Action was 1" : "Throwing as action was 2",
+                 {kTensorrtExecutionProvider}, nullptr, nullptr);
+    }
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <filesystem>
 #include <iostream>
 #include <absl/base/config.h>
 
@@ -26,6 +27,7 @@
 #include "test/util/include/test_environment.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/file_util.h"
+#include "test/util/include/temp_dir.h"
 #include "core/optimizer/layout_transformation/layout_transformation.h"
 #include "core/optimizer/graph_optimizer_registry.h"
 
@@ -601,12 +603,21 @@ class PrePackingTestOpKernel : public OpKernel {
     return Status::OK();
   }
 
+  Status RestorePrePackedState(const Tensor& tensor, int input_idx, gsl::span<const size_t> prepacked_buffer_sizes,
+                               /*out*/ bool& is_restored) override {
+    ORT_UNUSED_PARAMETER(tensor);
+    ORT_UNUSED_PARAMETER(input_idx);
+
+    is_restored = prepacked_buffer_sizes.size() == 1 && prepacked_buffer_sizes[0] == weight_packed_len;
+    ++restore_calls_count;
+    return Status::OK();
+  }
+
   Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
                  /*out*/ bool& is_packed, /*out*/ PrePackedWeights* prepacked_weights) override {
     ORT_UNUSED_PARAMETER(tensor);
     ORT_UNUSED_PARAMETER(input_idx);
 
-    constexpr const size_t weight_packed_len = sizeof(float) * 2;
     weight_packed_ = IAllocator::MakeUniquePtr<void>(alloc, weight_packed_len, true);
     float* data_weights_packed = reinterpret_cast<float*>(weight_packed_.get());
     data_weights_packed[0] = 1.2345f;
@@ -622,7 +633,9 @@ class PrePackingTestOpKernel : public OpKernel {
     return Status::OK();
   }
 
+  static constexpr size_t weight_packed_len = sizeof(float) * 2;
   int prepack_calls_count = 0;
+  int restore_calls_count = 0;
   int store_pre_packed_weight_calls_count = 0;
   IAllocatorUniquePtr<void> weight_packed_;
 };
@@ -1420,6 +1433,61 @@ TEST_F(SessionStateTestSharedInitalizersWithPrePacking, TestPrepackedSerializati
 }
 #endif  // __wasm__
 
+// Pre-packing enabled + pre-packed weights cache directory = the sessions share the mapped cache entry
+TEST_F(SessionStateTestSharedInitalizersWithPrePacking, TestPrepackedWeightsDiskCache) {
+  TemporaryDirectory cache_dir(ORT_TSTR("prepacked_weights_disk_cache_test"));
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+  sess_options.config_options.configurations[kOrtSessionOptionsPrepackedWeightsCacheDir] =
+      PathToUTF8String(cache_dir.Path());
+
+  for (int i = 0; i < 2; ++i) {
+    Model model("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+
+    CreateSimpleGraph(model.MainGraph());
+    PlaceAllNodesToCPUEP(model.MainGraph());
+    SessionState session_state(model.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               edlm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options);
+
+    ASSERT_STATUS_OK(session_state.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+    // The first session packs the weight and writes the entry, the second one restores the kernel from the entry
+    // without packing.
+    const auto* kernel = reinterpret_cast<const PrePackingTestOpKernel*>(session_state.GetKernel(0));
+    ASSERT_EQ(kernel->prepack_calls_count, i == 0 ? 1 : 0);
+    ASSERT_EQ(kernel->restore_calls_count, i == 0 ? 0 : 1);
+    ASSERT_EQ(kernel->store_pre_packed_weight_calls_count, 1);
+
+    const auto* data = static_cast<const float*>(kernel->weight_packed_.get());
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(data[0], 1.2345f);
+    EXPECT_EQ(data[1], 1.2345f * 2.f);
+  }
+
+  // Both sessions wrote or mapped the same entry.
+  size_t num_entries = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(cache_dir.Path())) {
+    EXPECT_EQ(entry.path().extension(), ORT_TSTR(".bin"));
+    ++num_entries;
+  }
+  ASSERT_EQ(num_entries, 1U);
+}
+
 INSTANTIATE_TEST_SUITE_P(SessionStateTests,
                          SessionStatePrepackingTest,
                          testing::Values(PrepackingTestParam{false, false},
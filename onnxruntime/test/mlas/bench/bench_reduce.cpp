@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/common/narrow.h"
+#include "core/util/thread_utils.h"
+
+#include <stdexcept>
+
+using onnxruntime::narrow;
+
+//
+// Reduces the middle dimension of an [Outer, Reduce, Inner] tensor, Inner == 1 reduces contiguous rows.
+//
+void REDUCE(benchmark::State& state, MLAS_REDUCE_KIND reduce_kind) {
+  const auto outer = narrow<size_t>(state.range(0));
+  const auto reduce = narrow<size_t>(state.range(1));
+  const auto inner = narrow<size_t>(state.range(2));
+  const auto threads = narrow<int>(state.range(3));
+
+  if (outer == 0 || reduce == 0 || inner == 0 || threads <= 0) {
+    throw std::invalid_argument("Outer, Reduce, Inner and Threads must be greater than 0!");
+  }
+
+  OrtThreadPoolParams tpo;
+  tpo.thread_pool_size = threads;
+  tpo.auto_set_affinity = true;
+
+  std::unique_ptr<onnxruntime::concurrency::ThreadPool> tp(
+      onnxruntime::concurrency::CreateThreadPool(
+          &onnxruntime::Env::Default(), tpo, onnxruntime::concurrency::ThreadPoolType::INTRA_OP));
+
+  auto input = RandomVectorUniform<float>(outer * reduce * inner, -4.0f, 4.0f);
+  std::vector<float> output(outer * inner);
+
+  // warming up run
+  MlasReduce(reduce_kind, input.data(), output.data(), outer, reduce, inner, tp.get());
+
+  for (auto _ : state) {
+    MlasReduce(reduce_kind, input.data(), output.data(), outer, reduce, inner, tp.get());
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size() * sizeof(float)));
+}
+
+static void ReduceArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"Outer", "Reduce", "Inner", "Threads"});
+  for (int64_t threads : {1, 8}) {
+    // Rows, e.g. ReduceMean over the last axis of [batch * sequence, hidden].
+    b->Args({4096, 768, 1, threads});
+    b->Args({64, 32768, 1, threads});
+    // Columns, e.g. ReduceMean over the spatial axes of NHWC [1, 56 * 56, 256].
+    b->Args({1, 3136, 256, threads});
+    b->Args({8, 49, 2048, threads});
+    // Middle axis of [batch, heads, sequence].
+    b->Args({16, 12, 4096, threads});
+    // Narrow columns.
+    b->Args({1, 4096, 7, threads});
+  }
+}
+
+BENCHMARK_CAPTURE(REDUCE, Sum, MlasReduceSum)->Apply(ReduceArgs)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Mean, MlasReduceMean)->Apply(ReduceArgs)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Maximum, MlasReduceMaximum)->Apply(ReduceArgs)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, SumSquare, MlasReduceSumSquare)->Apply(ReduceArgs)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, LogSumExp, MlasReduceLogSumExp)->Apply(ReduceArgs)->UseRealTime();
@@ -245,3 +245,111 @@ static void General_Conv2d(benchmark::internal::Benchmark* b) {
 }
 
 BENCHMARK_CAPTURE(SCONV_NCHW, 2d, "")->Apply(General_Conv2d)->UseRealTime();
+
+// Winograd algorithm on the same convolutions, with the filter packed once outside of the timed loop.
+void SCONV_NCHW_WINOGRAD(benchmark::State& state, size_t output_tile) {
+  const int64_t rank = state.range(0);                       // Rank
+  const int64_t batch_size = state.range(1);                 // N
+  const int64_t groups = state.range(2);                     // G
+  const int64_t input_channels_per_group = state.range(3);   // Cpg
+  const int64_t output_channels_per_group = state.range(4);  // Fpg
+
+  size_t arg_position = 5;
+  const auto input_shape = BenchArgsVector(state, arg_position, rank);
+  const auto kernel_shape = BenchArgsVector(state, arg_position, rank);
+  const auto paddings = BenchArgsVector(state, arg_position, rank * 2);
+  const auto strides = BenchArgsVector(state, arg_position, rank);
+  const auto dilations = BenchArgsVector(state, arg_position, rank);
+
+  const int64_t GC = groups * input_channels_per_group;
+  const int64_t GF = groups * output_channels_per_group;
+  std::vector<int64_t> x_shape = {batch_size, GC};
+  x_shape.insert(x_shape.end(), input_shape.begin(), input_shape.end());
+  std::vector<int64_t> f_shape = {GF, input_channels_per_group};
+  f_shape.insert(f_shape.end(), kernel_shape.begin(), kernel_shape.end());
+
+  std::vector<int64_t> output_shape((size_t)rank);
+  for (int64_t i = 0; i < rank; ++i) {
+    auto km = 1 + dilations[i] * (kernel_shape[i] - 1);
+    output_shape[i] = (paddings[i] + paddings[i + rank] + input_shape[i] - km) / strides[i] + 1;
+  }
+  std::vector<int64_t> y_shape = {batch_size, GF};
+  y_shape.insert(y_shape.end(), output_shape.begin(), output_shape.end());
+
+  MLAS_ACTIVATION activation;
+  activation.ActivationKind = MlasIdentityActivation;
+  MLAS_CONV_PARAMETERS Parameters;
+  size_t WorkingBufferSize = 0;
+  MlasConvPrepare(&Parameters,
+                  static_cast<size_t>(rank),
+                  static_cast<size_t>(batch_size),
+                  static_cast<size_t>(groups),
+                  static_cast<size_t>(input_channels_per_group),
+                  input_shape.data(),
+                  kernel_shape.data(),
+                  dilations.data(),
+                  paddings.data(),
+                  strides.data(),
+                  output_shape.data(),
+                  static_cast<size_t>(output_channels_per_group),
+                  &activation,
+                  &WorkingBufferSize,
+                  0.0f,
+                  nullptr);
+  if (!MlasConvPrepareWinograd(&Parameters, output_tile, &WorkingBufferSize, nullptr)) {
+    state.SkipWithError("The Winograd algorithm does not support this convolution.");
+    return;
+  }
+
+  auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
+  auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
+  std::vector<float> packed_f(MlasConvWinogradPackFilterSize(output_tile,
+                                                             static_cast<size_t>(groups),
+                                                             static_cast<size_t>(input_channels_per_group),
+                                                             static_cast<size_t>(output_channels_per_group)));
+  MlasConvWinogradPackFilter(output_tile,
+                             static_cast<size_t>(groups),
+                             static_cast<size_t>(input_channels_per_group),
+                             static_cast<size_t>(output_channels_per_group),
+                             F.data(),
+                             packed_f.data());
+  int64_t y_size = std::accumulate(y_shape.begin(), y_shape.end(), 1LL, std::multiplies<int64_t>());
+  std::vector<float> Y(static_cast<size_t>(y_size));
+  std::vector<float> working_buffer(WorkingBufferSize);
+
+  // warm up first round.
+  MlasConv(&Parameters,
+           X.data(),
+           packed_f.data(),
+           nullptr,
+           working_buffer.data(),
+           Y.data(),
+           nullptr);
+
+  for (auto _ : state) {
+    MlasConv(&Parameters,
+             X.data(),
+             packed_f.data(),
+             nullptr,
+             working_buffer.data(),
+             Y.data(),
+             nullptr);
+  }
+}
+
+// Stride 1 3x3 convolutions of vision models, run by the GEMM based algorithms and the Winograd algorithm.
+static void Conv3x3Stride1(benchmark::internal::Benchmark* b) {
+  b->ArgNames(ArgNamesForConv(2));
+  //    Rank, N, G,Cpg,Fpg,  I,   , K, , P, , , , S, , D, ,
+  b->Args({2, 1, 1, 64, 64, 56, 56, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});    // ResNet50 Conv 2.X
+  b->Args({2, 1, 1, 128, 128, 28, 28, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});  // ResNet50 Conv 3.X
+  b->Args({2, 1, 1, 256, 256, 14, 14, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});  // ResNet50 Conv 4.X
+  b->Args({2, 1, 1, 512, 512, 7, 7, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});    // ResNet50 Conv 5.X
+  b->Args({2, 1, 1, 32, 64, 160, 160, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});  // YOLO backbone
+  b->Args({2, 1, 1, 128, 128, 40, 40, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});  // YOLO neck
+  b->Args({2, 1, 1, 40, 24, 24, 40, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});    // TeamsModel conv_349
+}
+
+BENCHMARK_CAPTURE(SCONV_NCHW, Conv3x3Stride1, "")->Apply(Conv3x3Stride1)->UseRealTime();
+BENCHMARK_CAPTURE(SCONV_NCHW_WINOGRAD, F4x4_Conv3x3Stride1, 4)->Apply(Conv3x3Stride1)->UseRealTime();
+BENCHMARK_CAPTURE(SCONV_NCHW_WINOGRAD, F6x6_Conv3x3Stride1, 6)->Apply(Conv3x3Stride1)->UseRealTime();
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/common/narrow.h"
+#include "core/util/thread_utils.h"
+
+#include <random>
+#include <stdexcept>
+
+using onnxruntime::narrow;
+
+//
+// Multiplies by a constant B with the given percentage of zero blocks, packed either in the block sparse format or
+// in the dense format for comparison.
+//
+void SGEMM_BLOCKSPARSE(benchmark::State& state, bool block_sparse) {
+  const auto M = narrow<size_t>(state.range(0));
+  const auto N = narrow<size_t>(state.range(1));
+  const auto K = narrow<size_t>(state.range(2));
+  const auto zero_percent = narrow<int>(state.range(3));
+  const auto threads = narrow<int>(state.range(4));
+
+  if (M == 0 || N == 0 || K == 0 || threads <= 0) {
+    throw std::invalid_argument("M, N, K and Threads must be greater than 0!");
+  }
+
+  OrtThreadPoolParams tpo;
+  tpo.thread_pool_size = threads;
+  tpo.auto_set_affinity = true;
+
+  std::unique_ptr<onnxruntime::concurrency::ThreadPool> tp(
+      onnxruntime::concurrency::CreateThreadPool(
+          &onnxruntime::Env::Default(), tpo, onnxruntime::concurrency::ThreadPoolType::INTRA_OP));
+
+  auto A = RandomVectorUniform<float>(M * K, -1.0f, 1.0f);
+  auto B = RandomVectorUniform<float>(K * N, -1.0f, 1.0f);
+  std::vector<float> C(M * N);
+
+  std::default_random_engine generator(static_cast<unsigned>(zero_percent));
+  std::uniform_int_distribution<int> distribution(0, 99);
+  for (size_t k = 0; k < K; k++) {
+    for (size_t n = 0; n < N; n += 16) {
+      if (distribution(generator) < zero_percent) {
+        std::fill_n(B.data() + k * N + n, std::min(N - n, size_t(16)), 0.0f);
+      }
+    }
+  }
+
+  std::vector<uint8_t> packed_b;
+
+  if (block_sparse) {
+    packed_b.resize(MlasBlockSparseSgemmPackBSize(CblasNoTrans, N, K, B.data(), N));
+    MlasBlockSparseSgemmPackB(CblasNoTrans, N, K, B.data(), N, packed_b.data());
+  } else {
+    packed_b.resize(MlasGemmPackBSize(CblasNoTrans, CblasNoTrans, N, K));
+    MlasGemmPackB(CblasNoTrans, CblasNoTrans, N, K, B.data(), N, packed_b.data());
+  }
+
+  auto run = [&]() {
+    if (block_sparse) {
+      MlasBlockSparseSgemm(M, N, K, 1.0f, A.data(), K, packed_b.data(), 0.0f, C.data(), N, tp.get());
+    } else {
+      MlasGemm(CblasNoTrans, M, N, K, 1.0f, A.data(), K, packed_b.data(), 0.0f, C.data(), N, tp.get());
+    }
+  };
+
+  // warming up run
+  run();
+
+  for (auto _ : state) {
+    run();
+  }
+}
+
+static void SGemmBlockSparseArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"M", "N", "K", "ZeroPercent", "Threads"});
+  for (int64_t threads : {1, 8}) {
+    for (int64_t zero_percent : {0, 50, 70, 90}) {
+      // Projections of a pruned transformer layer.
+      b->Args({1, 768, 768, zero_percent, threads});
+      b->Args({128, 3072, 768, zero_percent, threads});
+      b->Args({128, 768, 3072, zero_percent, threads});
+    }
+  }
+}
+
+BENCHMARK_CAPTURE(SGEMM_BLOCKSPARSE, BlockSparse, true)->Apply(SGemmBlockSparseArgs)->UseRealTime();
+BENCHMARK_CAPTURE(SGEMM_BLOCKSPARSE, Dense, false)->Apply(SGemmBlockSparseArgs)->UseRealTime();
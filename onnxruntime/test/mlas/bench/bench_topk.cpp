@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/common/narrow.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using onnxruntime::narrow;
+
+//
+// Selects the sorted top K of rows of logits, either with the vectorized threshold filter or with the nth_element
+// and sort selection of the TopK operator for comparison.
+//
+void TOPK(benchmark::State& state, bool filter) {
+  const auto N = narrow<size_t>(state.range(0));
+  const auto K = narrow<size_t>(state.range(1));
+
+  if (N == 0 || K == 0 || K > N) {
+    throw std::invalid_argument("N and K must be greater than 0, and K must not be greater than N!");
+  }
+
+  auto input = RandomVectorUniform<float>(N, -10.0f, 10.0f);
+  std::vector<float> values(K);
+  std::vector<int64_t> indices(K);
+  std::vector<uint32_t> workspace(MlasTopKGetWorkspaceCount(K));
+  std::vector<int64_t> data_holder(N);
+
+  auto run = [&]() {
+    if (filter) {
+      MlasTopK(input.data(), N, K, true, true, values.data(), indices.data(), workspace.data());
+    } else {
+      const float* data = input.data();
+      auto cmp = [data](int64_t lhs, int64_t rhs) {
+        return data[lhs] > data[rhs] || (data[lhs] == data[rhs] && lhs < rhs);
+      };
+      std::iota(data_holder.begin(), data_holder.end(), int64_t{0});
+      std::nth_element(data_holder.begin(), data_holder.begin() + (K - 1), data_holder.end(), cmp);
+      std::sort(data_holder.begin(), data_holder.begin() + K, cmp);
+      for (size_t k = 0; k < K; k++) {
+        values[k] = data[data_holder[k]];
+        indices[k] = data_holder[k];
+      }
+    }
+  };
+
+  // warming up run
+  run();
+
+  for (auto _ : state) {
+    run();
+  }
+}
+
+static void TopKArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"N", "K"});
+  // Vocabulary sizes of language models.
+  for (int64_t n : {1000, 32000, 128000}) {
+    for (int64_t k : {1, 4, 16, 50, 256}) {
+      b->Args({n, k});
+    }
+  }
+}
+
+BENCHMARK_CAPTURE(TOPK, Filter, true)->Apply(TopKArgs)->UseRealTime();
+BENCHMARK_CAPTURE(TOPK, Select, false)->Apply(TopKArgs)->UseRealTime();
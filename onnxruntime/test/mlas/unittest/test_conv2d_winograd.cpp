@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <bool Threaded>
+class MlasConv2DWinogradTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferFilter;
+  MatrixGuardBuffer<float> BufferPackedFilter;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+  MatrixGuardBuffer<float> BufferWorking;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  void Test(size_t OutputTile,
+            size_t BatchCount,
+            size_t GroupCount,
+            size_t InputChannels,
+            size_t FilterCount,
+            size_t InputHeight,
+            size_t InputWidth,
+            size_t Padding,
+            float Beta,
+            MLAS_ACTIVATION_KIND ActivationKind) {
+    if (MlasConvWinogradPackFilterSize(OutputTile, GroupCount, InputChannels, FilterCount) == 0) {
+      return;
+    }
+
+    const size_t OutputHeight = InputHeight + 2 * Padding - 2;
+    const size_t OutputWidth = InputWidth + 2 * Padding - 2;
+    const size_t InputSize = InputHeight * InputWidth;
+    const size_t OutputSize = OutputHeight * OutputWidth;
+
+    const size_t InputElements = BatchCount * GroupCount * InputChannels * InputSize;
+    const size_t FilterElements = GroupCount * FilterCount * InputChannels * 9;
+    const size_t OutputElements = BatchCount * GroupCount * FilterCount * OutputSize;
+
+    const float* Input = BufferInput.GetBuffer(InputElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterElements);
+    const float* Bias = BufferBias.GetBuffer(GroupCount * FilterCount);
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputElements + FilterElements));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (size_t i = 0; i < OutputElements; i++) {
+      Output[i] = OutputReference[i] = distribution(generator);
+    }
+
+    //
+    // Compute the reference with a direct convolution.
+    //
+
+    for (size_t bg = 0; bg < BatchCount * GroupCount; bg++) {
+      const size_t g = bg % GroupCount;
+      for (size_t f = 0; f < FilterCount; f++) {
+        const float* filter = Filter + (g * FilterCount + f) * InputChannels * 9;
+        float* output = OutputReference + (bg * FilterCount + f) * OutputSize;
+        for (size_t oh = 0; oh < OutputHeight; oh++) {
+          for (size_t ow = 0; ow < OutputWidth; ow++) {
+            float Sum = Bias[g * FilterCount + f];
+            for (size_t c = 0; c < InputChannels; c++) {
+              const float* input = Input + (bg * InputChannels + c) * InputSize;
+              for (size_t kh = 0; kh < 3; kh++) {
+                for (size_t kw = 0; kw < 3; kw++) {
+                  const size_t ih = oh + kh - Padding;
+                  const size_t iw = ow + kw - Padding;
+                  if (ih < InputHeight && iw < InputWidth) {
+                    Sum += input[ih * InputWidth + iw] * filter[c * 9 + kh * 3 + kw];
+                  }
+                }
+              }
+            }
+            float& Value = output[oh * OutputWidth + ow];
+            Value = Sum + Beta * Value;
+            if (ActivationKind == MlasReluActivation) {
+              Value = std::max(Value, 0.0f);
+            }
+          }
+        }
+      }
+    }
+
+    int64_t InputShape[] = {int64_t(InputHeight), int64_t(InputWidth)};
+    int64_t KernelShape[] = {3, 3};
+    int64_t DilationShape[] = {1, 1};
+    int64_t Paddings[] = {int64_t(Padding), int64_t(Padding), int64_t(Padding), int64_t(Padding)};
+    int64_t StrideShape[] = {1, 1};
+    int64_t OutputShape[] = {int64_t(OutputHeight), int64_t(OutputWidth)};
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = ActivationKind;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters, 2, BatchCount, GroupCount, InputChannels, InputShape, KernelShape,
+                    DilationShape, Paddings, StrideShape, OutputShape, FilterCount, &Activation,
+                    &WorkingBufferSize, Beta, threadpool_);
+    ASSERT_TRUE(MlasConvPrepareWinograd(&Parameters, OutputTile, &WorkingBufferSize, threadpool_));
+
+    float* PackedFilter =
+        BufferPackedFilter.GetBuffer(MlasConvWinogradPackFilterSize(OutputTile, GroupCount, InputChannels, FilterCount));
+    MlasConvWinogradPackFilter(OutputTile, GroupCount, InputChannels, FilterCount, Filter, PackedFilter);
+
+    MlasConv(&Parameters, Input, PackedFilter, Bias, BufferWorking.GetBuffer(WorkingBufferSize), Output, threadpool_);
+
+    //
+    // The transforms round differently than the direct convolution, more so for the larger tiles.
+    //
+
+    for (size_t i = 0; i < OutputElements; i++) {
+      ASSERT_NEAR(Output[i], OutputReference[i], 1e-3f * (1.0f + std::fabs(OutputReference[i])))
+          << "@" << i << " of " << OutputElements << " F(" << OutputTile << "x" << OutputTile << ",3x3)"
+          << "/B" << BatchCount << "/G" << GroupCount << "/Cpg" << InputChannels << "/Fpg" << FilterCount
+          << "/H" << InputHeight << "/W" << InputWidth << "/Pad" << Padding << "/Beta" << Beta;
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "Conv2dWinograd_Threaded" : "Conv2dWinograd_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasConv2DWinogradTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (size_t OutputTile : {4, 6}) {
+      for (size_t Size : {3, 4, 7, 13, 24}) {
+        for (size_t Padding : {0, 1}) {
+          Test(OutputTile, 1, 1, 16, 16, Size, Size + 3, Padding, 0.0f, MlasIdentityActivation);
+          Test(OutputTile, 2, 3, 5, 7, Size, Size, Padding, 0.0f, MlasReluActivation);
+          Test(OutputTile, 1, 2, 32, 24, Size + 5, Size, Padding, 1.0f, MlasReluActivation);
+        }
+      }
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasConv2DWinogradTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasConv2DWinogradTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
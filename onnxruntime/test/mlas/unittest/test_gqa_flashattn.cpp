@@ -0,0 +1,242 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+#include "core/mlas/lib/mlasi.h"
+
+template <typename T, bool Threaded>
+class MlasGQAFlashAttentionTest : public MlasTestBase {
+ public:
+  struct Params {
+    size_t BatchSize;
+    size_t NumHeads;
+    size_t KvNumHeads;
+    bool KvHeadsInterleaved;
+    size_t SequenceLength;
+    size_t PastLength;  // past length of batch 0, batch b has PastLength + 3 * b
+    size_t HeadSize;
+    size_t VHeadSize;
+    size_t QBlockSize;
+    size_t KvBlockSize;
+    bool IsCausal = true;
+    int LocalWindowSize = -1;
+    float Softcap = 0.0f;
+    bool HeadSink = false;
+  };
+
+ private:
+  MatrixGuardBuffer<T> BufferQuery;
+  MatrixGuardBuffer<T> BufferKey;
+  MatrixGuardBuffer<T> BufferValue;
+  MatrixGuardBuffer<T> BufferOutput;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  static float ToFloat(T Value) {
+    if constexpr (std::is_same_v<T, float>) {
+      return Value;
+    } else {
+      return Value.ToFloat();
+    }
+  }
+
+  // Computes softmax(Q K^T) V of a query row directly, with the same masking rules as the kernel.
+  static void Reference(const Params& p, const float* Query, const T* Key, const T* Value, size_t KeyStride,
+                        size_t ValueStride, size_t KvLength, size_t PastLength, size_t Position, float Scale,
+                        const float* Sink, double* Output) {
+    size_t Begin = 0;
+    size_t End = KvLength;
+    if (p.IsCausal) {
+      const size_t CausalLength = PastLength + Position + 1;
+      End = std::min(End, CausalLength);
+      if (p.LocalWindowSize >= 0 && CausalLength > size_t(p.LocalWindowSize) + 1) {
+        Begin = CausalLength - size_t(p.LocalWindowSize) - 1;
+      }
+    }
+
+    std::vector<double> Scores;
+    double Maximum = Sink != nullptr ? *Sink : -std::numeric_limits<double>::infinity();
+    for (size_t t = Begin; t < End; t++) {
+      double Dot = 0.0;
+      for (size_t i = 0; i < p.HeadSize; i++) {
+        Dot += double(Query[i]) * ToFloat(Key[t * KeyStride + i]);
+      }
+      Dot *= Scale;
+      if (p.Softcap > 0.0f) {
+        Dot = std::tanh(Dot / p.Softcap) * p.Softcap;
+      }
+      Scores.push_back(Dot);
+      Maximum = std::max(Maximum, Dot);
+    }
+
+    double Sum = Sink != nullptr ? std::exp(*Sink - Maximum) : 0.0;
+    for (double& Score : Scores) {
+      Score = std::exp(Score - Maximum);
+      Sum += Score;
+    }
+
+    for (size_t i = 0; i < p.VHeadSize; i++) {
+      double Accumulator = 0.0;
+      for (size_t t = Begin; t < End; t++) {
+        Accumulator += Scores[t - Begin] * ToFloat(Value[t * ValueStride + i]);
+      }
+      Output[i] = End > Begin ? Accumulator / Sum : 0.0;
+    }
+  }
+
+ public:
+  void Test(const Params& p) {
+    // Q and the output are BxSxNxH as in GroupQueryAttention, K and V are BxN_kvxLxH with room past the
+    // longest sequence.
+    const size_t MaxPastLength = p.PastLength + 3 * (p.BatchSize - 1);
+    const size_t KvCapacity = MaxPastLength + p.SequenceLength + 2;
+
+    T* Query = BufferQuery.GetBuffer(p.BatchSize * p.SequenceLength * p.NumHeads * p.HeadSize);
+    T* Key = BufferKey.GetBuffer(p.BatchSize * p.KvNumHeads * KvCapacity * p.HeadSize);
+    T* Value = BufferValue.GetBuffer(p.BatchSize * p.KvNumHeads * KvCapacity * p.VHeadSize);
+    T* Output = BufferOutput.GetBuffer(p.BatchSize * p.SequenceLength * p.NumHeads * p.VHeadSize);
+
+    std::default_random_engine generator(static_cast<unsigned>(p.SequenceLength * 131 + p.HeadSize));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    auto Fill = [&](T* Buffer, size_t Count) {
+      for (size_t i = 0; i < Count; i++) {
+        Buffer[i] = T(distribution(generator));
+      }
+    };
+    Fill(Query, p.BatchSize * p.SequenceLength * p.NumHeads * p.HeadSize);
+    Fill(Key, p.BatchSize * p.KvNumHeads * KvCapacity * p.HeadSize);
+    Fill(Value, p.BatchSize * p.KvNumHeads * KvCapacity * p.VHeadSize);
+
+    std::vector<int> KvLengths(p.BatchSize);
+    std::vector<int> PastLengths(p.BatchSize);
+    for (size_t b = 0; b < p.BatchSize; b++) {
+      PastLengths[b] = int(p.PastLength + 3 * b);
+      // Cross attention attends a key sequence of its own length.
+      KvLengths[b] = p.IsCausal ? PastLengths[b] + int(p.SequenceLength) : int(KvCapacity - b);
+    }
+
+    std::vector<float> Sinks(p.NumHeads);
+    for (size_t h = 0; h < p.NumHeads; h++) {
+      Sinks[h] = 0.5f * float(h) - 1.0f;
+    }
+
+    const float Scale = 1.0f / std::sqrt(float(p.HeadSize));
+
+    MlasGQAFlashAttentionArgs<T> args{};
+    args.batch_size = int(p.BatchSize);
+    args.num_heads = int(p.NumHeads);
+    args.kv_num_heads = int(p.KvNumHeads);
+    args.kv_heads_interleaved = p.KvHeadsInterleaved;
+    args.q_sequence_length = int(p.SequenceLength);
+    args.qk_head_size = int(p.HeadSize);
+    args.v_head_size = int(p.VHeadSize);
+    args.q_block_size = int(p.QBlockSize);
+    args.kv_block_size = int(p.KvBlockSize);
+    args.scale = Scale;
+    args.softcap = p.Softcap;
+    args.is_causal = p.IsCausal;
+    args.local_window_size = p.LocalWindowSize;
+    args.kv_sequence_lengths = KvLengths.data();
+    args.past_sequence_lengths = PastLengths.data();
+    args.head_sink = p.HeadSink ? Sinks.data() : nullptr;
+    args.query = Query;
+    args.query_batch_stride = p.SequenceLength * p.NumHeads * p.HeadSize;
+    args.query_head_stride = p.HeadSize;
+    args.query_sequence_stride = p.NumHeads * p.HeadSize;
+    args.key = Key;
+    args.key_batch_stride = p.KvNumHeads * KvCapacity * p.HeadSize;
+    args.key_head_stride = KvCapacity * p.HeadSize;
+    args.key_sequence_stride = p.HeadSize;
+    args.value = Value;
+    args.value_batch_stride = p.KvNumHeads * KvCapacity * p.VHeadSize;
+    args.value_head_stride = KvCapacity * p.VHeadSize;
+    args.value_sequence_stride = p.VHeadSize;
+    args.output = Output;
+    args.output_batch_stride = p.SequenceLength * p.NumHeads * p.VHeadSize;
+    args.output_head_stride = p.VHeadSize;
+    args.output_sequence_stride = p.NumHeads * p.VHeadSize;
+
+    MlasGQAFlashAttention(&args, threadpool_);
+
+    // The fp16 inputs are exact in the reference, the tolerance covers the rounding of the output.
+    const double Tolerance = std::is_same_v<T, float> ? 1e-4 : 4e-3;
+    const size_t GroupSize = p.NumHeads / p.KvNumHeads;
+
+    std::vector<float> QueryRow(p.HeadSize);
+    std::vector<double> Expected(p.VHeadSize);
+
+    for (size_t b = 0; b < p.BatchSize; b++) {
+      for (size_t h = 0; h < p.NumHeads; h++) {
+        const size_t KvHead = p.KvHeadsInterleaved ? h % p.KvNumHeads : h / GroupSize;
+        const size_t KvOffset = (b * p.KvNumHeads + KvHead) * KvCapacity;
+        for (size_t s = 0; s < p.SequenceLength; s++) {
+          const T* q = Query + ((b * p.SequenceLength + s) * p.NumHeads + h) * p.HeadSize;
+          for (size_t i = 0; i < p.HeadSize; i++) {
+            QueryRow[i] = ToFloat(q[i]);
+          }
+
+          Reference(p, QueryRow.data(), Key + KvOffset * p.HeadSize, Value + KvOffset * p.VHeadSize,
+                    p.HeadSize, p.VHeadSize, size_t(KvLengths[b]), size_t(PastLengths[b]), s, Scale,
+                    p.HeadSink ? &Sinks[h] : nullptr, Expected.data());
+
+          const T* o = Output + ((b * p.SequenceLength + s) * p.NumHeads + h) * p.VHeadSize;
+          for (size_t i = 0; i < p.VHeadSize; i++) {
+            ASSERT_NEAR(ToFloat(o[i]), Expected[i], Tolerance)
+                << "N" << p.NumHeads << "/Nkv" << p.KvNumHeads << (p.KvHeadsInterleaved ? "/interleaved" : "")
+                << "/S" << p.SequenceLength << "/P" << p.PastLength << "/H" << p.HeadSize << "/Hv" << p.VHeadSize
+                << "/Br" << p.QBlockSize << "/Bc" << p.KvBlockSize << "/W" << p.LocalWindowSize
+                << "/cap" << p.Softcap << (p.HeadSink ? "/sink" : "") << (p.IsCausal ? "" : "/noncausal")
+                << " @" << b << "," << h << "," << s << "," << i;
+          }
+        }
+      }
+    }
+  }
+
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(std::string("GQAFlashAttention") +
+                                        (std::is_same_v<T, float> ? "Fp32" : "Fp16") +
+                                        (Threaded ? "_Threaded" : "_SingleThread"));
+    return suite_name.c_str();
+  }
+
+  MlasGQAFlashAttentionTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (bool KvHeadsInterleaved : {false, true}) {
+      // Block sizes leaving partial tiles of queries and keys.
+      Test({1, 4, 2, KvHeadsInterleaved, 13, 0, 16, 16, 4, 5});
+      Test({2, 6, 2, KvHeadsInterleaved, 9, 0, 8, 12, 2, 3});
+      // Past keys, of different lengths per batch.
+      Test({3, 4, 2, KvHeadsInterleaved, 7, 5, 16, 8, 3, 4});
+      // Local window, softcap and attention sinks.
+      Test({2, 4, 2, KvHeadsInterleaved, 17, 2, 8, 8, 5, 3, true, 4});
+      Test({2, 4, 2, KvHeadsInterleaved, 11, 3, 8, 8, 4, 6, true, -1, 2.0f});
+      Test({2, 4, 2, KvHeadsInterleaved, 11, 3, 8, 8, 4, 6, true, -1, 0.0f, true});
+      Test({2, 6, 3, KvHeadsInterleaved, 19, 4, 12, 10, 4, 7, true, 5, 1.5f, true});
+    }
+
+    // Multi-head and multi-query attention.
+    Test({2, 3, 3, false, 10, 2, 8, 8, 4, 4});
+    Test({2, 8, 1, false, 10, 2, 8, 8, 4, 4});
+    // Odd head sizes, blocks larger than the sequences.
+    Test({1, 2, 1, false, 6, 1, 7, 5, 16, 64});
+    // A single key per tile and a single query per block.
+    Test({1, 4, 2, true, 5, 3, 8, 8, 1, 1});
+    // Without causal mask the queries attend every key of the batch.
+    Test({2, 4, 2, false, 6, 0, 8, 8, 4, 5, false});
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasGQAFlashAttentionTest<float, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasGQAFlashAttentionTest<MLAS_FP16, false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasGQAFlashAttentionTest<float, true>>::RegisterShortExecute();
+      count += MlasDirectShortExecuteTests<MlasGQAFlashAttentionTest<MLAS_FP16, true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
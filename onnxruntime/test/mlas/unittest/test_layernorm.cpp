@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+#include "core/mlas/lib/mlasi.h"
+
+template <typename T>
+class MlasLayerNormTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<T> BufferInput;
+  MatrixGuardBuffer<T> BufferSkip;
+  MatrixGuardBuffer<T> BufferOutput;
+  MatrixGuardBuffer<T> BufferSumOutput;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferScale;
+  MatrixGuardBuffer<float> BufferShift;
+
+  static float ToFloat(T Value) {
+    if constexpr (std::is_same_v<T, MLAS_FP16>) {
+      return Value.ToFloat();
+    } else {
+      return Value;
+    }
+  }
+
+  void Test(size_t N, bool HasSkip, bool HasBias, bool HasShift, bool Simplified) {
+    T* Input = BufferInput.GetBuffer(N);
+    T* Skip = HasSkip ? BufferSkip.GetBuffer(N) : nullptr;
+    T* Output = BufferOutput.GetBuffer(N);
+    T* SumOutput = HasSkip ? BufferSumOutput.GetBuffer(N) : nullptr;
+    float* Bias = HasBias ? BufferBias.GetBuffer(N) : nullptr;
+    float* Scale = BufferScale.GetBuffer(N);
+    float* Shift = HasShift ? BufferShift.GetBuffer(N) : nullptr;
+
+    std::default_random_engine generator(static_cast<unsigned>(N));
+    std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+    for (size_t n = 0; n < N; n++) {
+      // Offset the row to check the precision of the variance.
+      Input[n] = T(distribution(generator) + 3.0f);
+      if (Skip != nullptr) {
+        Skip[n] = T(distribution(generator));
+      }
+      if (Bias != nullptr) {
+        Bias[n] = distribution(generator);
+      }
+      Scale[n] = distribution(generator);
+      if (Shift != nullptr) {
+        Shift[n] = distribution(generator);
+      }
+    }
+
+    std::vector<double> Sum(N);
+    double Mean = 0.0;
+    double MeanSquare = 0.0;
+    for (size_t n = 0; n < N; n++) {
+      Sum[n] = ToFloat(Input[n]) + (Skip != nullptr ? ToFloat(Skip[n]) : 0.0f) + (Bias != nullptr ? Bias[n] : 0.0f);
+      Mean += Sum[n];
+      MeanSquare += Sum[n] * Sum[n];
+    }
+    Mean /= double(N);
+    MeanSquare /= double(N);
+
+    constexpr float Epsilon = 1e-5f;
+    const double Variance = Simplified ? MeanSquare : MeanSquare - Mean * Mean;
+    const double InvStdDevExpected = 1.0 / std::sqrt(Variance + Epsilon);
+
+    float RowMean;
+    float RowInvStdDev;
+    MlasLayerNormalizeOneRow<T>(Input, Skip, Bias, Scale, Shift, N, Epsilon, Simplified, Output, SumOutput,
+                                &RowMean, &RowInvStdDev);
+
+    const double Tolerance = std::is_same_v<T, MLAS_FP16> ? 1e-2 : 1e-4;
+
+    ASSERT_NEAR(RowMean, Mean, 1e-4 * (1.0 + std::fabs(Mean))) << "N" << N;
+    ASSERT_NEAR(RowInvStdDev, InvStdDevExpected, 1e-3 * InvStdDevExpected) << "N" << N;
+
+    for (size_t n = 0; n < N; n++) {
+      double Expected = (Sum[n] - (Simplified ? 0.0 : Mean)) * InvStdDevExpected * Scale[n];
+      if (Shift != nullptr && !Simplified) {
+        Expected += Shift[n];
+      }
+      ASSERT_NEAR(ToFloat(Output[n]), Expected, Tolerance * (1.0 + std::fabs(Expected)))
+          << "N" << N << "/Skip" << HasSkip << "/Bias" << HasBias << "/Shift" << HasShift
+          << "/Simplified" << Simplified << " @" << n;
+      if (SumOutput != nullptr) {
+        ASSERT_NEAR(ToFloat(SumOutput[n]), Sum[n], Tolerance * (1.0 + std::fabs(Sum[n]))) << "N" << N << " @" << n;
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(std::is_same_v<T, float> ? "LayerNorm_Float" : "LayerNorm_Half");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t N : {1, 3, 8, 15, 64, 255, 256, 257, 768, 1000, 4096}) {
+      for (bool Simplified : {false, true}) {
+        Test(N, false, false, !Simplified, Simplified);
+        Test(N, true, true, !Simplified, Simplified);
+        Test(N, true, false, false, Simplified);
+      }
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<MLAS_FP16>>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <bool Threaded>
+class MlasReduceTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferOutput;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  static double Reference(MLAS_REDUCE_KIND ReduceKind, const float* Input, size_t ReduceCount, size_t Stride) {
+    double Sum = 0.0;
+    double Maximum = Input[0];
+    for (size_t r = 0; r < ReduceCount; r++) {
+      const double Value = Input[r * Stride];
+      Sum += (ReduceKind == MlasReduceSumSquare) ? Value * Value : Value;
+      Maximum = std::max(Maximum, Value);
+    }
+
+    switch (ReduceKind) {
+      case MlasReduceMean:
+        return Sum / double(ReduceCount);
+      case MlasReduceMaximum:
+        return Maximum;
+      case MlasReduceLogSumExp: {
+        double SumExp = 0.0;
+        for (size_t r = 0; r < ReduceCount; r++) {
+          SumExp += std::exp(Input[r * Stride] - Maximum);
+        }
+        return std::log(SumExp) + Maximum;
+      }
+      default:
+        return Sum;
+    }
+  }
+
+  void Test(MLAS_REDUCE_KIND ReduceKind, size_t OuterCount, size_t ReduceCount, size_t InnerCount) {
+    const size_t InputElements = OuterCount * ReduceCount * InnerCount;
+    const size_t OutputElements = OuterCount * InnerCount;
+
+    float* Input = BufferInput.GetBuffer(InputElements);
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputElements));
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    for (size_t i = 0; i < InputElements; i++) {
+      Input[i] = distribution(generator);
+    }
+
+    MlasReduce(ReduceKind, Input, Output, OuterCount, ReduceCount, InnerCount, threadpool_);
+
+    for (size_t o = 0; o < OuterCount; o++) {
+      for (size_t i = 0; i < InnerCount; i++) {
+        const double Expected = Reference(ReduceKind, Input + o * ReduceCount * InnerCount + i, ReduceCount, InnerCount);
+        ASSERT_NEAR(Output[o * InnerCount + i], Expected, 1e-4 * (1.0 + std::fabs(Expected)))
+            << "Kind" << ReduceKind << "/O" << OuterCount << "/R" << ReduceCount << "/I" << InnerCount
+            << " @" << o << "," << i;
+      }
+    }
+  }
+
+  void TestNonFinite() {
+    constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+    // Rows of [1, -inf], [inf, 2], [-inf, -inf] and [1, 1], reduced as rows then as columns.
+    const float Input[] = {1.0f, -Infinity, Infinity, 2.0f, -Infinity, -Infinity, 1.0f, 1.0f};
+    float Output[4];
+
+    MlasReduce(MlasReduceLogSumExp, Input, Output, 4, 2, 1, threadpool_);
+    EXPECT_EQ(Output[0], 1.0f);
+    EXPECT_EQ(Output[1], Infinity);
+    EXPECT_EQ(Output[2], -Infinity);
+    EXPECT_NEAR(Output[3], 1.0f + std::log(2.0f), 1e-6f);
+
+    MlasReduce(MlasReduceLogSumExp, Input, Output, 1, 4, 2, threadpool_);
+    EXPECT_EQ(Output[0], Infinity);
+    EXPECT_NEAR(Output[1], 2.0f + std::log1p(std::exp(-1.0f)), 1e-5f);
+
+    MlasReduce(MlasReduceMaximum, Input + 4, Output, 1, 2, 1, threadpool_);
+    EXPECT_EQ(Output[0], -Infinity);
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "Reduce_Threaded" : "Reduce_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasReduceTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (MLAS_REDUCE_KIND ReduceKind :
+         {MlasReduceSum, MlasReduceMean, MlasReduceMaximum, MlasReduceSumSquare, MlasReduceLogSumExp}) {
+      for (size_t ReduceCount : {1, 3, 4, 7, 16, 33, 1000}) {
+        for (size_t InnerCount : {1, 2, 5, 16, 37, 600}) {
+          Test(ReduceKind, 1, ReduceCount, InnerCount);
+          Test(ReduceKind, 3, ReduceCount, InnerCount);
+        }
+      }
+      Test(ReduceKind, 100, 3000, 1);
+    }
+    TestNonFinite();
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasReduceTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasReduceTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+class MlasResizeTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferOutput;
+
+  void TestHorizontal(size_t Channels, size_t InputWidth, size_t OutputWidth) {
+    const float* Input = BufferInput.GetBuffer(InputWidth * Channels);
+    float* Output = BufferOutput.GetBuffer(OutputWidth * Channels);
+
+    std::vector<int32_t> InputIndex1(OutputWidth);
+    std::vector<int32_t> InputIndex2(OutputWidth);
+    std::vector<float> Weight1(OutputWidth);
+    std::vector<float> Weight2(OutputWidth);
+
+    for (size_t x = 0; x < OutputWidth; x++) {
+      const float Original = std::min(float(x) * float(InputWidth) / float(OutputWidth), float(InputWidth - 1));
+      InputIndex1[x] = int32_t(Original);
+      InputIndex2[x] = std::min(InputIndex1[x] + 1, int32_t(InputWidth - 1));
+      Weight2[x] = Original - float(InputIndex1[x]);
+      Weight1[x] = 1.0f - Weight2[x];
+    }
+
+    MlasResizeHorizontalLinear(Input, Channels, OutputWidth, InputIndex1.data(), InputIndex2.data(),
+                               Weight1.data(), Weight2.data(), Output);
+
+    for (size_t x = 0; x < OutputWidth; x++) {
+      for (size_t c = 0; c < Channels; c++) {
+        const float Expected = Weight1[x] * Input[InputIndex1[x] * Channels + c] +
+                               Weight2[x] * Input[InputIndex2[x] * Channels + c];
+        ASSERT_NEAR(Output[x * Channels + c], Expected, 1e-5f * (1.0f + std::fabs(Expected)))
+            << "Channels" << Channels << "/InputWidth" << InputWidth << "/OutputWidth" << OutputWidth
+            << " @" << x << "," << c;
+      }
+    }
+  }
+
+  void TestVertical(size_t Taps, size_t Count, ptrdiff_t Stride) {
+    const size_t InputSize = Taps * size_t(std::abs(Stride)) + Count;
+    const float* Buffer = BufferInput.GetBuffer(InputSize);
+    const float* Input = Stride < 0 ? Buffer + (Taps - 1) * size_t(-Stride) : Buffer;
+    float* Output = BufferOutput.GetBuffer(Count);
+
+    std::vector<float> Weights(Taps);
+    for (size_t t = 0; t < Taps; t++) {
+      Weights[t] = float(t + 1) / float(Taps * (Taps + 1) / 2);
+    }
+
+    MlasResizeVerticalFilter(Input, Stride, Weights.data(), Taps, Count, Output);
+
+    for (size_t i = 0; i < Count; i++) {
+      float Expected = 0.0f;
+      for (size_t t = 0; t < Taps; t++) {
+        Expected += Input[ptrdiff_t(t) * Stride + ptrdiff_t(i)] * Weights[t];
+      }
+      // The products are summed in tap order without fused multiply-adds.
+      ASSERT_NEAR(Output[i], Expected, 1e-6f * (1.0f + std::fabs(Expected)))
+          << "Taps" << Taps << "/Count" << Count << "/Stride" << Stride << " @" << i;
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("Resize");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t Channels : {1, 2, 3, 4, 7, 16, 33}) {
+      for (size_t InputWidth : {1, 5, 32}) {
+        for (size_t OutputWidth : {1, 3, 17, 64}) {
+          TestHorizontal(Channels, InputWidth, OutputWidth);
+        }
+      }
+    }
+
+    for (size_t Taps : {1, 2, 3, 7, 12}) {
+      for (size_t Count : {1, 3, 4, 15, 16, 17, 35, 100}) {
+        TestVertical(Taps, Count, ptrdiff_t(Count));
+        TestVertical(Taps, Count, ptrdiff_t(Count + 5));
+        TestVertical(Taps, Count, -ptrdiff_t(Count + 1));
+      }
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasResizeTest>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -15,10 +15,10 @@ Abstract:
 
 --*/
 
-#if defined(__aarch64__) && defined(__linux__)
-
 #include "test_sbgemm.h"
 
+#if defined(MLAS_SBGEMM_SUPPORTED)
+
 //
 // Short Execute() test helper to register each test separately by all parameters.
 //
@@ -129,13 +129,15 @@ static size_t SBGemmRegistShortExecute() {
 }
 
 static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+#if defined(__aarch64__)
   if (!MlasBf16AccelerationSupported()) {
     return false;
   }
+#endif
 
   if (is_short_execute) {
     return SBGemmRegistShortExecute() > 0;
   }
   return SBGemmRegistLongExecute() > 0;
 });
-#endif  // defined(__aarch64__) && defined(__linux__)
+#endif  // defined(MLAS_SBGEMM_SUPPORTED)
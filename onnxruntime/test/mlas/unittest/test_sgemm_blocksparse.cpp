@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <bool Threaded>
+class MlasBlockSparseSgemmTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferA;
+  MatrixGuardBuffer<float> BufferB;
+  MatrixGuardBuffer<uint8_t> BufferPackedB;
+  MatrixGuardBuffer<float> BufferC;
+  MatrixGuardBuffer<float> BufferCReference;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  void Test(size_t M, size_t N, size_t K, bool TransB, float ZeroRowRatio, float alpha, float beta) {
+    const float* A = BufferA.GetBuffer(M * K);
+    float* B = BufferB.GetBuffer(N * K);
+    float* C = BufferC.GetBuffer(M * N);
+    float* CReference = BufferCReference.GetBuffer(M * N);
+
+    //
+    // Zero whole 16 column blocks of the rows of B, plus scattered elements
+    // of the remaining blocks.
+    //
+
+    std::default_random_engine generator(static_cast<unsigned>(M * N * K));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> selection(0.0f, 1.0f);
+
+    for (size_t k = 0; k < K; k++) {
+      for (size_t n = 0; n < N; n += 16) {
+        const bool ZeroBlock = selection(generator) < ZeroRowRatio;
+        for (size_t nn = n; nn < std::min(n + 16, N); nn++) {
+          const float Value = (ZeroBlock || selection(generator) < 0.25f) ? 0.0f : distribution(generator);
+          B[TransB ? nn * K + k : k * N + nn] = Value;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < M * N; i++) {
+      C[i] = CReference[i] = distribution(generator);
+    }
+
+    for (size_t m = 0; m < M; m++) {
+      for (size_t n = 0; n < N; n++) {
+        double Sum = 0.0;
+        for (size_t k = 0; k < K; k++) {
+          Sum += double(A[m * K + k]) * double(B[TransB ? n * K + k : k * N + n]);
+        }
+        CReference[m * N + n] = float(alpha * Sum + (beta != 0.0f ? beta * CReference[m * N + n] : 0.0f));
+      }
+    }
+
+    const CBLAS_TRANSPOSE TransposeB = TransB ? CblasTrans : CblasNoTrans;
+    const size_t ldb = TransB ? K : N;
+
+    const float ZeroBlockRatio = MlasBlockSparseSgemmZeroBlockRatio(TransposeB, N, K, B, ldb);
+    ASSERT_GE(ZeroBlockRatio, 0.0f);
+    ASSERT_LE(ZeroBlockRatio, 1.0f);
+
+    const size_t PackedBSize = MlasBlockSparseSgemmPackBSize(TransposeB, N, K, B, ldb);
+    ASSERT_GT(PackedBSize, size_t(0));
+
+    void* PackedB = BufferPackedB.GetBuffer(PackedBSize, true);
+    MlasBlockSparseSgemmPackB(TransposeB, N, K, B, ldb, PackedB);
+
+    MlasBlockSparseSgemm(M, N, K, alpha, A, K, PackedB, beta, C, N, threadpool_);
+
+    for (size_t i = 0; i < M * N; i++) {
+      ASSERT_NEAR(C[i], CReference[i], 1e-4f * (1.0f + std::fabs(CReference[i])))
+          << "@" << i << "/M" << M << "/N" << N << "/K" << K << "/TransB" << TransB
+          << "/ZeroRowRatio" << ZeroRowRatio << "/Alpha" << alpha << "/Beta" << beta;
+    }
+  }
+
+  void TestZeroBlockRatio() {
+    // 2 panels of 16 columns by 4 rows, with 3 of the 8 blocks nonzero.
+    float* B = BufferB.GetBuffer(4 * 32);
+    std::fill_n(B, 4 * 32, 0.0f);
+    B[0 * 32 + 5] = 1.0f;
+    B[2 * 32 + 31] = -2.0f;
+    B[3 * 32 + 16] = std::numeric_limits<float>::quiet_NaN();
+
+    EXPECT_EQ(MlasBlockSparseSgemmZeroBlockRatio(CblasNoTrans, 32, 4, B, 32), 5.0f / 8.0f);
+    EXPECT_EQ(MlasBlockSparseSgemmZeroBlockRatio(CblasNoTrans, 32, 0, B, 32), 0.0f);
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "BlockSparseSgemm_Threaded" : "BlockSparseSgemm_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasBlockSparseSgemmTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (bool TransB : {false, true}) {
+      for (float ZeroRowRatio : {0.0f, 0.5f, 0.9f, 1.0f}) {
+        for (size_t M : {1, 3, 4, 9}) {
+          for (size_t N : {1, 15, 16, 17, 40}) {
+            for (size_t K : {1, 7, 64}) {
+              Test(M, N, K, TransB, ZeroRowRatio, 1.0f, 0.0f);
+            }
+          }
+        }
+        Test(64, 96, 256, TransB, ZeroRowRatio, 0.5f, 1.0f);
+        Test(33, 130, 77, TransB, ZeroRowRatio, -1.0f, 0.5f);
+      }
+    }
+    TestZeroBlockRatio();
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasBlockSparseSgemmTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasBlockSparseSgemmTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+#include <numeric>
+
+class MlasTopKTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+
+  void Test(size_t N, size_t K, bool Largest, bool Sorted, int Distinct) {
+    float* Input = BufferInput.GetBuffer(N);
+
+    // A small number of distinct values checks the order of equal values.
+    std::default_random_engine generator(static_cast<unsigned>(N * 31 + K));
+    std::uniform_int_distribution<int> distribution(0, Distinct - 1);
+    for (size_t n = 0; n < N; n++) {
+      Input[n] = float(distribution(generator)) * 0.25f - 8.0f;
+    }
+
+    std::vector<int64_t> Expected(N);
+    std::iota(Expected.begin(), Expected.end(), int64_t{0});
+    std::stable_sort(Expected.begin(), Expected.end(), [&](int64_t Lhs, int64_t Rhs) {
+      return Largest ? Input[Lhs] > Input[Rhs] : Input[Lhs] < Input[Rhs];
+    });
+
+    std::vector<float> Values(K);
+    std::vector<int64_t> Indices(K);
+    std::vector<uint32_t> Workspace(MlasTopKGetWorkspaceCount(K));
+
+    ASSERT_TRUE(MlasTopK(Input, N, K, Largest, Sorted, Values.data(), Indices.data(), Workspace.data()));
+
+    if (!Sorted) {
+      std::vector<int64_t> Order(K);
+      std::iota(Order.begin(), Order.end(), int64_t{0});
+      std::sort(Order.begin(), Order.end(), [&](int64_t Lhs, int64_t Rhs) {
+        const float L = Values[Lhs];
+        const float R = Values[Rhs];
+        return (Largest ? L > R : L < R) || (L == R && Indices[Lhs] < Indices[Rhs]);
+      });
+      std::vector<float> SortedValues(K);
+      std::vector<int64_t> SortedIndices(K);
+      for (size_t k = 0; k < K; k++) {
+        SortedValues[k] = Values[Order[k]];
+        SortedIndices[k] = Indices[Order[k]];
+      }
+      Values = SortedValues;
+      Indices = SortedIndices;
+    }
+
+    for (size_t k = 0; k < K; k++) {
+      ASSERT_EQ(Indices[k], Expected[k]) << "N" << N << "/K" << K << "/Largest" << Largest << "/Sorted" << Sorted
+                                         << "/Distinct" << Distinct << " @" << k;
+      ASSERT_EQ(Values[k], Input[Expected[k]]) << "N" << N << "/K" << K << " @" << k;
+    }
+  }
+
+  void TestInfinities(bool Largest) {
+    constexpr size_t N = 100;
+    float* Input = BufferInput.GetBuffer(N);
+
+    const float Infinity = std::numeric_limits<float>::infinity();
+    std::fill_n(Input, N, Largest ? -Infinity : Infinity);
+    Input[17] = 1.0f;
+    Input[60] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<int64_t> Indices(2, -1);
+    std::vector<uint32_t> Workspace(MlasTopKGetWorkspaceCount(2));
+
+    ASSERT_FALSE(MlasTopK(Input, N, 2, Largest, true, nullptr, Indices.data(), Workspace.data()));
+    ASSERT_EQ(Indices[0], -1);
+
+    ASSERT_TRUE(MlasTopK(Input, N, 1, Largest, true, nullptr, Indices.data(), Workspace.data()));
+    ASSERT_EQ(Indices[0], 17);
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("TopK");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t N : {1, 7, 16, 33, 1000, 5000, 32000}) {
+      for (size_t K : {1, 2, 5, 16, 50, 300, 2000}) {
+        if (K > N) {
+          continue;
+        }
+        for (bool Largest : {true, false}) {
+          Test(N, K, Largest, true, 1 << 20);
+          Test(N, K, Largest, false, 1 << 20);
+          Test(N, K, Largest, true, 7);
+        }
+      }
+    }
+    TestInfinities(true);
+    TestInfinities(false);
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasTopKTest>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <memory>
+
+#include "core/framework/allocator.h"
+#include "core/framework/bfc_arena.h"
+
+using namespace onnxruntime;
+
+namespace {
+
+// Shared by all the benchmark threads, one arena with the thread cache and one without.
+BFCArena& GetArena(bool thread_cache) {
+  static BFCArena arena(std::make_unique<CPUAllocator>(), BFCArena::DEFAULT_MAX_MEM);
+  static BFCArena cached_arena(std::make_unique<CPUAllocator>(), BFCArena::DEFAULT_MAX_MEM,
+                               BFCArena::DEFAULT_ARENA_EXTEND_STRATEGY,
+                               BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
+                               BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+                               BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
+                               BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+                               16 * 1024 * 1024);
+  return thread_cache ? cached_arena : arena;
+}
+
+}  // namespace
+
+// Every iteration allocates the buffers of a small sequence of kernels and frees them,
+// as an inference run does. Sizes go from 256 bytes to 512 KB.
+// range(0): 1 to enable the thread cache.
+static void BM_BFCArenaAllocFree(benchmark::State& state) {
+  const bool thread_cache = state.range(0) != 0;
+  BFCArena& arena = GetArena(thread_cache);
+  static constexpr size_t sizes[] = {256, 4096, 1000, 65536, 300, 524288, 12000, 4096};
+  void* ptrs[std::size(sizes)];
+
+  AllocatorStats before;
+  if (state.thread_index() == 0) {
+    arena.GetStats(&before);
+  }
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < std::size(sizes); ++i) {
+      ptrs[i] = arena.Alloc(sizes[i]);
+    }
+    benchmark::DoNotOptimize(ptrs);
+    for (size_t i = 0; i < std::size(sizes); ++i) {
+      arena.Free(ptrs[i]);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * std::size(sizes)));
+
+  if (state.thread_index() == 0) {
+    AllocatorStats after;
+    arena.GetStats(&after);
+    const int64_t hits = after.num_cache_hits - before.num_cache_hits;
+    const int64_t lookups = hits + after.num_cache_misses - before.num_cache_misses;
+    state.counters["cache_hit_ratio"] = lookups == 0 ? 0. : static_cast<double>(hits) / lookups;
+  }
+}
+
+BENCHMARK(BM_BFCArenaAllocFree)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kNanosecond)
+    ->ArgNames({"cache"})
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 32);
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+
+#include "core/framework/allocator.h"
+#include "core/framework/config_options.h"
+#include "core/framework/data_transfer_manager.h"
+#include "core/framework/op_kernel_info.h"
+#include "core/framework/ort_value_name_idx_map.h"
+#include "core/providers/cpu/cpu_provider_factory_creator.h"
+#include "core/providers/cpu/object_detection/roialign.h"
+#include "core/providers/cpu/tensor/grid_sample.h"
+#include "core/util/thread_utils.h"
+
+using namespace onnxruntime;
+
+// Samples a [1, C, 64, 64] feature map at a [1, 64, 64, 2] grid, as in the warping of optical flow models.
+// The arguments are the number of channels, the padding mode (0: zeros, 1: border, 2: reflection) and align_corners.
+static void BM_GridSampleBilinear(benchmark::State& state) {
+  const int64_t C = state.range(0);
+  static const char* const padding_modes[] = {"zeros", "border", "reflection"};
+  constexpr int64_t N = 1, H_in = 64, W_in = 64, H_out = 64, W_out = 64;
+
+  onnxruntime::Node node;
+  node.AddAttribute("mode", std::string("bilinear"));
+  node.AddAttribute("padding_mode", std::string(padding_modes[state.range(1)]));
+  node.AddAttribute("align_corners", static_cast<int64_t>(state.range(2)));
+
+  KernelDef kernel_def;
+  std::unique_ptr<IExecutionProvider> execution_provider = CPUProviderFactoryCreator::Create(true)->CreateProvider();
+  std::unordered_map<int, OrtValue> constant_initialized_tensors;
+  OrtValueNameIdxMap mlvalue_name_idx_map;
+  DataTransferManager data_transfer_mgr;
+  AllocatorMap allocators;
+  ConfigOptions config_options;
+
+  OpKernelInfo op_kernel_info(node, kernel_def, *execution_provider, constant_initialized_tensors, mlvalue_name_idx_map,
+                              data_transfer_mgr, allocators, config_options);
+  GridSample<float> grid_sample(op_kernel_info);
+
+  float* input = GenerateArrayWithRandomValue<float>(N * C * H_in * W_in, -1.0f, 1.0f);
+  // Locations slightly beyond the borders, so that the padding mode is exercised
+  float* grid = GenerateArrayWithRandomValue<float>(N * H_out * W_out * 2, -1.1f, 1.1f);
+  float* output = static_cast<float*>(aligned_alloc(sizeof(float) * N * C * H_out * W_out, 64));
+
+  OrtThreadPoolParams tpo;
+  tpo.auto_set_affinity = true;
+  std::unique_ptr<concurrency::ThreadPool> tp(
+      concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP));
+
+  for (auto _ : state) {
+    grid_sample.Sample2D(input, grid, output, N, C, H_in, W_in, H_out, W_out, tp.get());
+  }
+
+  aligned_free(input);
+  aligned_free(grid);
+  aligned_free(output);
+}
+
+BENCHMARK(BM_GridSampleBilinear)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({2, 0, 0})
+    ->Args({2, 0, 1})
+    ->Args({2, 1, 0})
+    ->Args({2, 2, 0})
+    ->Args({2, 2, 1})
+    ->Args({64, 0, 0})
+    ->Args({64, 0, 1})
+    ->Args({64, 1, 0})
+    ->Args({64, 2, 0});
+
+// Pools 7x7 bins of rois from a [1, 256, 50, 68] feature map, as in the second stage of a detector.
+// The arguments are the number of rois and the mode (0: avg, 1: max).
+static void BM_RoiAlign(benchmark::State& state) {
+  const int64_t num_rois = state.range(0);
+  const RoiAlignMode mode = state.range(1) == 0 ? RoiAlignMode::avg : RoiAlignMode::max;
+  constexpr int64_t N = 1, C = 256, H = 50, W = 68, pooled_height = 7, pooled_width = 7, sampling_ratio = 2;
+  constexpr float spatial_scale = 1.0f / 16;
+
+  float* input = GenerateArrayWithRandomValue<float>(N * C * H * W, -1.0f, 1.0f);
+  std::vector<float> rois(num_rois * 4);
+  std::vector<int64_t> batch_indices(num_rois, 0);
+  float* corners = GenerateArrayWithRandomValue<float>(num_rois * 4, 0.0f, 1.0f);
+  for (int64_t i = 0; i < num_rois; ++i) {
+    // boxes from 32 to 512 pixels in an image of 800x1088 pixels
+    const float x1 = corners[i * 4] * (W * 16 - 512);
+    const float y1 = corners[i * 4 + 1] * (H * 16 - 512);
+    rois[i * 4] = x1;
+    rois[i * 4 + 1] = y1;
+    rois[i * 4 + 2] = x1 + 32 + corners[i * 4 + 2] * 480;
+    rois[i * 4 + 3] = y1 + 32 + corners[i * 4 + 3] * 480;
+  }
+  const TensorShape output_shape{num_rois, C, pooled_height, pooled_width};
+  float* output = static_cast<float*>(aligned_alloc(sizeof(float) * output_shape.Size(), 64));
+
+  OrtThreadPoolParams tpo;
+  tpo.auto_set_affinity = true;
+  std::unique_ptr<concurrency::ThreadPool> tp(
+      concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP));
+
+  for (auto _ : state) {
+    RoiAlignForward<float>(output_shape, input, spatial_scale, H, W, sampling_ratio, rois.data(), 4, output, mode,
+                           /*half_pixel*/ true, batch_indices.data(), tp.get());
+  }
+
+  aligned_free(input);
+  aligned_free(corners);
+  aligned_free(output);
+}
+
+BENCHMARK(BM_RoiAlign)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({4, 0})
+    ->Args({100, 0})
+    ->Args({1000, 0})
+    ->Args({100, 1});
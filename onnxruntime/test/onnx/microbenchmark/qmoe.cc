@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef DISABLE_CONTRIB_OPS
+
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+
+#include "contrib_ops/cpu/quantization/moe_quantization_cpu.h"
+#include "core/framework/allocator.h"
+#include "core/util/thread_utils.h"
+
+using namespace onnxruntime;
+using namespace onnxruntime::contrib;
+
+// Runs the experts of a QMoE layer with 32 experts of hidden size 1024 and intermediate size 2048, routing each row
+// to its top-4 experts, with a fused SwiGLU as in mixtral and gpt-oss models.
+// The arguments are the number of rows (1 for a decoded token, more for a prompt) and the bits of the weights.
+static void BM_QMoE(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const size_t bits = static_cast<size_t>(state.range(1));
+  constexpr int64_t num_experts = 32, k = 4, hidden_size = 1024, inter_size = 2048;
+  constexpr int64_t fc1_output_size = 2 * inter_size;
+
+  const size_t fc1_weights_size = static_cast<size_t>(num_experts * fc1_output_size * hidden_size) * bits / 8;
+  const size_t fc2_weights_size = static_cast<size_t>(num_experts * hidden_size * inter_size) * bits / 8;
+  uint8_t* fc1_quantized = GenerateArrayWithRandomValue<uint8_t>(fc1_weights_size, 0, 255);
+  uint8_t* fc2_quantized = GenerateArrayWithRandomValue<uint8_t>(fc2_weights_size, 0, 255);
+  float* fc1_scales = GenerateArrayWithRandomValue<float>(num_experts * fc1_output_size, 0.001f, 0.01f);
+  float* fc2_scales = GenerateArrayWithRandomValue<float>(num_experts * hidden_size, 0.001f, 0.01f);
+  float* input = GenerateArrayWithRandomValue<float>(num_rows * hidden_size, -1.0f, 1.0f);
+  float* router_logits = GenerateArrayWithRandomValue<float>(num_rows * num_experts, -2.0f, 2.0f);
+  float* output = static_cast<float*>(aligned_alloc(sizeof(float) * num_rows * hidden_size, 64));
+
+  OrtThreadPoolParams tpo;
+  tpo.auto_set_affinity = true;
+  std::unique_ptr<concurrency::ThreadPool> tp(
+      concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP));
+
+  AllocatorPtr alloc = CPUAllocator::DefaultInstance();
+  QMoEExpertWeights fc1_weights;
+  QMoEExpertWeights fc2_weights;
+  Status status = fc1_weights.Prepack(fc1_quantized, fc1_scales, num_experts, fc1_output_size, hidden_size, bits,
+                                      alloc, tp.get());
+  if (status.IsOK()) {
+    status = fc2_weights.Prepack(fc2_quantized, fc2_scales, num_experts, hidden_size, inter_size, bits, alloc, tp.get());
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+  }
+  state.SetLabel(fc1_weights.IsQNBitGemm() ? "qnbit" : "dequantized");
+
+  for (auto _ : state) {
+    status = ComputeQMoEExperts(input, router_logits, fc1_weights, nullptr, fc2_weights, nullptr,
+                                num_rows, num_experts, hidden_size, inter_size, k, true, ActivationType::SwiGLU,
+                                output, alloc, tp.get());
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  aligned_free(fc1_quantized);
+  aligned_free(fc2_quantized);
+  aligned_free(fc1_scales);
+  aligned_free(fc2_scales);
+  aligned_free(input);
+  aligned_free(router_logits);
+  aligned_free(output);
+}
+
+BENCHMARK(BM_QMoE)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1, 4})
+    ->Args({16, 4})
+    ->Args({256, 4})
+    ->Args({1, 8})
+    ->Args({16, 8})
+    ->Args({256, 8});
+
+#endif  // DISABLE_CONTRIB_OPS
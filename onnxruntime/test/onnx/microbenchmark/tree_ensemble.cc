@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "core/framework/allocator.h"
+#include "core/framework/tensor.h"
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+#include "core/util/thread_utils.h"
+
+using namespace onnxruntime;
+using namespace onnxruntime::ml;
+using namespace onnxruntime::ml::detail;
+
+namespace {
+
+// Gives access to TreeEnsembleCommon::ComputeAgg without an OpKernelContext.
+class TreeEnsembleRegressorForBenchmark : public TreeEnsembleCommon<float, float, float> {
+ public:
+  void Compute(concurrency::ThreadPool* tp, const Tensor* X, Tensor* Y) const {
+    ComputeAgg(tp, X, Y, nullptr,
+               TreeAggregatorSum<float, float, float>(roots_.size(), n_targets_or_classes_,
+                                                      post_transform_, base_values_));
+  }
+};
+
+// Ensemble of random perfect binary trees, nodes are numbered in breadth-first order.
+void CreateRandomEnsemble(int64_t n_trees, int64_t depth, int64_t n_features,
+                          TreeEnsembleAttributesV3<float>& attributes) {
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int64_t> feature(0, n_features - 1);
+  std::uniform_real_distribution<float> value(-1.f, 1.f);
+  const int64_t n_nodes = (int64_t(1) << (depth + 1)) - 1;
+  const int64_t first_leaf = (int64_t(1) << depth) - 1;
+
+  attributes.aggregate_function = "SUM";
+  attributes.post_transform = "NONE";
+  attributes.n_targets_or_classes = 1;
+  for (int64_t t = 0; t < n_trees; ++t) {
+    for (int64_t k = 0; k < n_nodes; ++k) {
+      attributes.nodes_treeids.push_back(t);
+      attributes.nodes_nodeids.push_back(k);
+      if (k < first_leaf) {
+        attributes.nodes_modes.push_back(NODE_MODE_ONNX::BRANCH_LEQ);
+        attributes.nodes_truenodeids.push_back(2 * k + 1);
+        attributes.nodes_falsenodeids.push_back(2 * k + 2);
+        attributes.nodes_featureids.push_back(feature(gen));
+        attributes.nodes_values.push_back(value(gen));
+      } else {
+        attributes.nodes_modes.push_back(NODE_MODE_ONNX::LEAF);
+        attributes.nodes_truenodeids.push_back(0);
+        attributes.nodes_falsenodeids.push_back(0);
+        attributes.nodes_featureids.push_back(0);
+        attributes.nodes_values.push_back(0.f);
+        attributes.target_class_treeids.push_back(t);
+        attributes.target_class_nodeids.push_back(k);
+        attributes.target_class_ids.push_back(0);
+        attributes.target_class_weights.push_back(value(gen));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// range(0): number of trees, range(1): depth of every tree, range(2): number of rows,
+// range(3): 1 for the block traversal, 0 for the default traversal
+// (trees of depth <= 8 are packed as perfect binary trees, deeper ones are walked node by node).
+static void BM_TreeEnsembleRegressor(benchmark::State& state) {
+  const int64_t n_trees = state.range(0);
+  const int64_t depth = state.range(1);
+  const int64_t n_rows = state.range(2);
+  const bool block_traversal = state.range(3) != 0;
+  constexpr int64_t n_features = 64;
+
+  TreeEnsembleAttributesV3<float> attributes;
+  CreateRandomEnsemble(n_trees, depth, n_features, attributes);
+  TreeEnsembleRegressorForBenchmark ensemble;
+  ORT_THROW_IF_ERROR(ensemble.Init(80, 128, 50, attributes));
+  if (block_traversal && !ensemble.InitBlockTraversal()) {
+    state.SkipWithError("The ensemble cannot use the block traversal.");
+    return;
+  }
+
+  AllocatorPtr alloc = CPUAllocator::DefaultInstance();
+  Tensor X(DataTypeImpl::GetType<float>(), TensorShape({n_rows, n_features}), alloc);
+  Tensor Y(DataTypeImpl::GetType<float>(), TensorShape({n_rows, 1}), alloc);
+  float* x_data = GenerateArrayWithRandomValue<float>(static_cast<size_t>(n_rows * n_features), -1.f, 1.f);
+  std::copy(x_data, x_data + n_rows * n_features, X.MutableData<float>());
+  aligned_free(x_data);
+
+  OrtThreadPoolParams tpo;
+  tpo.auto_set_affinity = true;
+  std::unique_ptr<concurrency::ThreadPool> tp(
+      concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP));
+
+  for (auto _ : state) {
+    ensemble.Compute(tp.get(), &X, &Y);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * n_rows);
+}
+
+BENCHMARK(BM_TreeEnsembleRegressor)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgNames({"trees", "depth", "rows", "block"})
+    ->Args({100, 6, 1000, 0})
+    ->Args({100, 6, 1000, 1})
+    ->Args({500, 8, 1000, 0})
+    ->Args({500, 8, 1000, 1})
+    ->Args({2000, 8, 100, 0})
+    ->Args({2000, 8, 100, 1})
+    ->Args({2000, 8, 10000, 0})
+    ->Args({2000, 8, 10000, 1})
+    ->Args({2000, 12, 1000, 0})
+    ->Args({2000, 12, 1000, 1});
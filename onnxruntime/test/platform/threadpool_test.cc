@@ -14,6 +14,8 @@
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -510,6 +512,65 @@ TEST(ThreadPoolTest, TestStagedMultiLoopSections_4Thread_100Loop) {
   TestStagedMultiLoopSections("TestStagedMultiLoopSections_4Thread_100Loop", 4, 100);
 }
 
+TEST(ThreadPoolTest, TestDegreeOfParallelismLimit) {
+  CreateThreadPoolAndTest("TestDegreeOfParallelismLimit", 4, [&](ThreadPool* tp) {
+    const int d_of_p = ThreadPool::DegreeOfParallelism(tp);
+    {
+      ThreadPool::DegreeOfParallelismLimit limit(2);
+      ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), std::min(d_of_p, 2));
+      {
+        ThreadPool::DegreeOfParallelismLimit sequential(1);
+        ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), 1);
+
+        // Every iteration runs on the calling thread.
+        const auto caller = std::this_thread::get_id();
+        std::atomic<int> num_iterations{0};
+        std::atomic<bool> on_caller{true};
+        ThreadPool::TryParallelFor(tp, 1000, 1000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          num_iterations += static_cast<int>(last - first);
+          if (std::this_thread::get_id() != caller) {
+            on_caller = false;
+          }
+        });
+        ASSERT_EQ(num_iterations, 1000);
+        ASSERT_TRUE(on_caller);
+      }
+      ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), std::min(d_of_p, 2));
+
+      // The limit only applies to the thread creating it.
+      int d_of_p_other_thread = 0;
+      std::thread([&]() { d_of_p_other_thread = ThreadPool::DegreeOfParallelism(tp); }).join();
+      ASSERT_EQ(d_of_p_other_thread, d_of_p);
+    }
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), d_of_p);
+
+    ThreadPool::DegreeOfParallelismLimit no_limit(0);
+    ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), d_of_p);
+  });
+}
+
+TEST(ThreadPoolTest, TestDegreeOfParallelismLimit_Hybrid) {
+  CreateThreadPoolAndTest(
+      "TestDegreeOfParallelismLimit_Hybrid", 4, [&](ThreadPool* tp) {
+        // Hybrid CPUs split the loops into several tasks per thread, the limit counts threads.
+        const int num_threads = ThreadPool::NumLoopThreads(tp);
+        const int tasks_per_thread = ThreadPool::DegreeOfParallelism(tp) / num_threads;
+        ASSERT_EQ(num_threads, 4);
+        ASSERT_GT(tasks_per_thread, 1);
+        {
+          ThreadPool::DegreeOfParallelismLimit limit(2);
+          ASSERT_EQ(ThreadPool::NumLoopThreads(tp), 2);
+          ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), 2 * tasks_per_thread);
+        }
+        {
+          ThreadPool::DegreeOfParallelismLimit sequential(1);
+          ASSERT_EQ(ThreadPool::NumLoopThreads(tp), 1);
+          ASSERT_EQ(ThreadPool::DegreeOfParallelism(tp), 1);
+        }
+      },
+      0, true);
+}
+
 #ifdef _WIN32
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
 #pragma warning(push)
@@ -2,11 +2,14 @@
 // Licensed under the MIT License.
 
 #include <cassert>
+#include <cmath>
 #include "gtest/gtest.h"
+#include "contrib_ops/cpu/bert/attention_common.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/tensor_op_test_utils.h"
 #include "test/common/cuda_op_test_utils.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/scoped_env_vars.h"
 
 namespace onnxruntime {
 namespace test {
@@ -781,6 +784,90 @@ TEST(AttentionTest, Attention4DAttnIsCausalBasicDifferentSequenceLength) {
   );
 }
 
+// Causal softmax(Q K^T / sqrt(head_size)) V of BxNxSxH inputs without past, query head n attending the KV head
+// n % kv_num_heads.
+static std::vector<float> CausalAttentionReference(const std::vector<float>& q, const std::vector<float>& k,
+                                                   const std::vector<float>& v, int batch_size, int q_num_heads,
+                                                   int kv_num_heads, int sequence_length, int head_size,
+                                                   int v_head_size) {
+  std::vector<float> y(batch_size * q_num_heads * sequence_length * v_head_size);
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_size));
+  for (int b = 0; b < batch_size; ++b) {
+    for (int n = 0; n < q_num_heads; ++n) {
+      const int kv_n = n % kv_num_heads;
+      const float* q_head = q.data() + (b * q_num_heads + n) * sequence_length * head_size;
+      const float* k_head = k.data() + (b * kv_num_heads + kv_n) * sequence_length * head_size;
+      const float* v_head = v.data() + (b * kv_num_heads + kv_n) * sequence_length * v_head_size;
+      float* y_head = y.data() + (b * q_num_heads + n) * sequence_length * v_head_size;
+      for (int s = 0; s < sequence_length; ++s) {
+        std::vector<float> probs(s + 1);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int t = 0; t <= s; ++t) {
+          float dot = 0.0f;
+          for (int h = 0; h < head_size; ++h) dot += q_head[s * head_size + h] * k_head[t * head_size + h];
+          probs[t] = dot * scale;
+          max_score = std::max(max_score, probs[t]);
+        }
+        float sum = 0.0f;
+        for (int t = 0; t <= s; ++t) {
+          probs[t] = std::exp(probs[t] - max_score);
+          sum += probs[t];
+        }
+        for (int h = 0; h < v_head_size; ++h) {
+          float acc = 0.0f;
+          for (int t = 0; t <= s; ++t) acc += probs[t] * v_head[t * v_head_size + h];
+          y_head[s * v_head_size + h] = acc / sum;
+        }
+      }
+    }
+  }
+  return y;
+}
+
+// A causal prompt long enough to be split into several query blocks, run with the tiled kernel and with the
+// materialized attention probs of ORT_DISABLE_FLASH_ATTENTION.
+static void RunCausalLongSequenceTest(int kv_num_heads) {
+  int batch_size = 2;            // Q.shape[0]
+  int q_num_heads = 4;           // Q.shape[1]
+  int q_sequence_length = 40;    // Q.shape[2]
+  int head_size = 8;             // Q.shape[3]
+  int kv_sequence_length = 40;   // K.shape[2] and V.shape[2]
+  int v_head_size = 6;           // V.shape[3]
+  int past_sequence_length = 0;  // past_key.shape[2] and past_value.shape[2]
+
+  std::vector<float> q(batch_size * q_num_heads * q_sequence_length * head_size);
+  std::vector<float> k(batch_size * kv_num_heads * kv_sequence_length * head_size);
+  std::vector<float> v(batch_size * kv_num_heads * kv_sequence_length * v_head_size);
+  for (size_t i = 0; i < q.size(); ++i) q[i] = static_cast<float>((i * 7) % 13) * 0.1f - 0.6f;
+  for (size_t i = 0; i < k.size(); ++i) k[i] = static_cast<float>((i * 5) % 11) * 0.1f - 0.5f;
+  for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<float>((i * 3) % 17) * 0.1f - 0.8f;
+
+  std::vector<float> y = CausalAttentionReference(q, k, v, batch_size, q_num_heads, kv_num_heads, q_sequence_length,
+                                                  head_size, v_head_size);
+
+  for (const char* disable_flash_attention : {"0", "1"}) {
+    SCOPED_TRACE(std::string("disable_flash_attention=") + disable_flash_attention);
+    ScopedEnvironmentVariables scoped_env_vars{
+        EnvVarMap{{onnxruntime::contrib::attention::kDisableFlashAttention, disable_flash_attention}}};
+    RunTest4D(batch_size, q_num_heads, q_sequence_length, head_size, kv_sequence_length, kv_num_heads, v_head_size, past_sequence_length,
+              q, k, v, std::vector<float>(), std::initializer_list<bool>(), std::vector<float>(), std::vector<float>(),
+              1, -1, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), -1, TensorType::kFloat,  // is_causal, qk_matmul_output_mode, scale, softcap, softmax_precision, tensor_type
+              y, std::vector<float>(), std::vector<float>(), std::vector<float>(),
+              false, true, true  // disable_cpu, disable_cuda, disable_dml
+    );
+  }
+}
+
+TEST(AttentionTest, Attention4DAttnIsCausalLongSequenceSharedKv) {
+  // All the query heads share one KV head.
+  RunCausalLongSequenceTest(1);
+}
+
+TEST(AttentionTest, Attention4DAttnIsCausalLongSequenceGroupedKv) {
+  // Query heads 0 and 2 share KV head 0, query heads 1 and 3 share KV head 1.
+  RunCausalLongSequenceTest(2);
+}
+
 TEST(AttentionTest, Attention4DDiffHeadsWithPastAndPresent) {
   int batch_size = 2;             // Q.shape[0]
   int q_num_heads = 3;            // Q.shape[1]
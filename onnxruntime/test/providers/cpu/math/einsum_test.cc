@@ -592,6 +592,92 @@ TEST(Einsum, ImplicitEinsumAsTensorContraction) {
   test.Run();
 }
 
+// Theme: Contraction path
+
+// Explicit
+// The operands are contracted in a different order than the input order
+TEST(Einsum, ExplicitEinsumWithContractionPath_Chain) {
+  constexpr int64_t I = 16, J = 16, K = 16, L = 2;
+  std::vector<float> x(I * J), y(J * K), z(K * L);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = static_cast<float>(n % 5) - 2.f;
+  for (size_t n = 0; n < y.size(); ++n) y[n] = static_cast<float>(n % 3) - 1.f;
+  for (size_t n = 0; n < z.size(); ++n) z[n] = static_cast<float>(n % 7) - 3.f;
+
+  std::vector<float> expected(I * L, 0.f);
+  for (int64_t i = 0; i < I; ++i)
+    for (int64_t j = 0; j < J; ++j)
+      for (int64_t k = 0; k < K; ++k)
+        for (int64_t l = 0; l < L; ++l)
+          expected[i * L + l] += x[i * J + j] * y[j * K + k] * z[k * L + l];
+
+  // Run twice so that the second run uses the cached contraction path
+  for (int run = 0; run < 2; ++run) {
+    OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+    test.AddAttribute<std::string>("equation", "ij,jk,kl->il");
+    test.AddInput<float>("x", {I, J}, x);
+    test.AddInput<float>("y", {J, K}, y);
+    test.AddInput<float>("z", {K, L}, z);
+    test.AddOutput<float>("o", {I, L}, expected);
+    test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
+  }
+}
+
+TEST(Einsum, ExplicitEinsumWithContractionPath_Batched_int64) {
+  // The last operand has a label (m) that is reduced before the pair-wise contractions
+  constexpr int64_t B = 2, I = 3, J = 8, K = 8, L = 8, M = 4;
+  std::vector<int64_t> w(B * I * J), x(B * J * K), y(B * K * L), z(L * M);
+  for (size_t n = 0; n < w.size(); ++n) w[n] = static_cast<int64_t>(n % 5) - 2;
+  for (size_t n = 0; n < x.size(); ++n) x[n] = static_cast<int64_t>(n % 3) - 1;
+  for (size_t n = 0; n < y.size(); ++n) y[n] = static_cast<int64_t>(n % 7) - 3;
+  for (size_t n = 0; n < z.size(); ++n) z[n] = static_cast<int64_t>(n % 4) - 1;
+
+  std::vector<int64_t> expected(B * I, 0);
+  for (int64_t b = 0; b < B; ++b)
+    for (int64_t i = 0; i < I; ++i)
+      for (int64_t j = 0; j < J; ++j)
+        for (int64_t k = 0; k < K; ++k)
+          for (int64_t l = 0; l < L; ++l)
+            for (int64_t m = 0; m < M; ++m)
+              expected[b * I + i] += w[(b * I + i) * J + j] * x[(b * J + j) * K + k] *
+                                     y[(b * K + k) * L + l] * z[l * M + m];
+
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "bij,bjk,bkl,lm->bi");
+  test.AddInput<int64_t>("w", {B, I, J}, w);
+  test.AddInput<int64_t>("x", {B, J, K}, x);
+  test.AddInput<int64_t>("y", {B, K, L}, y);
+  test.AddInput<int64_t>("z", {L, M}, z);
+  test.AddOutput<int64_t>("o", {B, I}, expected);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
+}
+
+// ROCm doesn't support double
+#ifndef USE_ROCM
+TEST(Einsum, ExplicitEinsumWithContractionPath_TransposedOperands_double) {
+  // The operands are stored transposed relative to the order of the pair-wise products
+  constexpr int64_t I = 12, J = 12, K = 12, L = 3;
+  std::vector<double> x(J * I), y(K * J), z(L * K);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = static_cast<double>(n % 5) - 2.;
+  for (size_t n = 0; n < y.size(); ++n) y[n] = static_cast<double>(n % 3) - 1.;
+  for (size_t n = 0; n < z.size(); ++n) z[n] = static_cast<double>(n % 7) - 3.;
+
+  std::vector<double> expected(I * L, 0.);
+  for (int64_t i = 0; i < I; ++i)
+    for (int64_t j = 0; j < J; ++j)
+      for (int64_t k = 0; k < K; ++k)
+        for (int64_t l = 0; l < L; ++l)
+          expected[i * L + l] += x[j * I + i] * y[k * J + j] * z[l * K + k];
+
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ji,kj,lk->il");
+  test.AddInput<double>("x", {J, I}, x);
+  test.AddInput<double>("y", {K, J}, y);
+  test.AddInput<double>("z", {L, K}, z);
+  test.AddOutput<double>("o", {I, L}, expected);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
+}
+#endif
+
 // Theme: Half support
 
 TEST(Einsum, ExplicitEinsumAsIdentity_1D_input_Half) {
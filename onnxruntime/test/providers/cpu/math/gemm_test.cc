@@ -4,6 +4,8 @@
 #include "gtest/gtest.h"
 #include "core/mlas/inc/mlas.h"
 #include "core/framework/run_options.h"
+#include "core/providers/cpu/math/gemm_matmul_common.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/common/cuda_op_test_utils.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/common/dnnl_op_test_utils.h"
@@ -1408,8 +1410,98 @@ TEST(GemmOpTest, SharedPrepackedWeights) {
               static_cast<size_t>(number_of_shared_pre_packed_weights_counter));
   }
 }
+
+TEST(GemmOpTest, BlockSparsePrepackedWeights) {
+  constexpr int64_t M = 5, K = 48, N = 40;
+  constexpr float alpha = 0.5f, beta = 2.0f;
+
+  // B is transposed, [N, K], with two thirds of its blocks of 16 columns of a row of B^T set to zeros.
+  std::vector<float> A(M * K), B(N * K), C(N), Y(M * N);
+  for (int64_t i = 0; i < M * K; ++i) {
+    A[i] = static_cast<float>((i % 11) - 5) * 0.25f;
+  }
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t k = 0; k < K; ++k) {
+      B[n * K + k] = ((k / 3 + n / 16) % 3 == 0) ? static_cast<float>(((n * 7 + k) % 5) - 2) : 0.0f;
+    }
+    C[n] = static_cast<float>(n % 4);
+  }
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      float sum = 0.0f;
+      for (int64_t k = 0; k < K; ++k) {
+        sum += A[m * K + k] * B[n * K + k];
+      }
+      Y[m * N + n] = alpha * sum + beta * C[n];
+    }
+  }
+
+  for (const char* min_zero_ratio : {"0", "0.6", "0.7"}) {
+    OpTester test("Gemm", 13);
+    test.AddAttribute("transA", static_cast<int64_t>(0));
+    test.AddAttribute("transB", static_cast<int64_t>(1));
+    test.AddAttribute("alpha", alpha);
+    test.AddAttribute("beta", beta);
+    test.AddInput<float>("A", {M, K}, A);
+    test.AddInput<float>("B", {N, K}, B, true);
+    test.AddInput<float>("C", {N}, C);
+    test.AddOutput<float>("Y", {M, N}, Y);
+    test.SetOutputTolerance(1e-4f);
+
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsBlockSparseWeightsMinZeroRatio,
+                                                      min_zero_ratio));
+
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    size_t number_of_pre_packed_weights_counter = 0;
+    test.Config(so)
+        .ConfigEps(std::move(execution_providers))
+        .RunWithConfig(&number_of_pre_packed_weights_counter);
+    // the dense packing is platform dependent, the block sparse packing is always used above the ratio
+    if (std::string(min_zero_ratio) == "0.6") {
+      ASSERT_EQ(number_of_pre_packed_weights_counter, static_cast<size_t>(1));
+    }
+  }
+}
 #endif
 
+TEST(GemmOpTest, BlockSparsePackingNeedsMostlyZeroBlocks) {
+  constexpr int64_t K = 32, N = 40;
+  AllocatorPtr alloc = CPUAllocator::DefaultInstance();
+
+  struct {
+    int64_t zero_rows_per_8;
+    float min_zero_ratio;
+    bool expect_block_sparse;
+  } cases[] = {
+      {3, 0.1f, false},  // most blocks are occupied: stays dense whatever the option
+      {4, 0.1f, true},   // half of the blocks are zeros
+      {6, 0.7f, true},
+      {5, 0.7f, false},  // below the option
+      {7, 0.0f, false},  // disabled
+  };
+
+  for (const auto& c : cases) {
+    SCOPED_TRACE(::testing::Message() << "zero rows per 8: " << c.zero_rows_per_8
+                                      << ", min_zero_ratio: " << c.min_zero_ratio);
+    std::vector<float> B(K * N);
+    for (int64_t k = 0; k < K; ++k) {
+      for (int64_t n = 0; n < N; ++n) {
+        B[k * N + n] = k % 8 < c.zero_rows_per_8 ? 0.0f : static_cast<float>(n % 5 + 1);
+      }
+    }
+    Tensor tensor_b(DataTypeImpl::GetType<float>(), TensorShape({K, N}), B.data(), alloc->Info());
+
+    IAllocatorUniquePtr<void> packed_b;
+    size_t packed_b_size = 0;
+    TensorShape b_shape;
+    EXPECT_EQ(GemmPackBBlockSparseFp32(alloc, tensor_b, false, c.min_zero_ratio, packed_b, packed_b_size, b_shape),
+              c.expect_block_sparse);
+    EXPECT_EQ(packed_b_size != 0, c.expect_block_sparse);
+  }
+}
+
 // Common helper function for GEMM optimize packed tests
 auto run_gemm_optimize_packed_test = [](int64_t M, int64_t K, int64_t N, BiasType bias_type, bool transA, bool transB) {
   OpTester test("Gemm", 13);
@@ -2,6 +2,7 @@
 // Copyright 2023 Amazon.com, Inc. or its affiliates. All Rights Reserved.
 // Licensed under the MIT License.
 
+#include "core/mlas/inc/mlas.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
@@ -11,7 +12,7 @@
 #include "test/common/tensor_op_test_utils.h"
 #include "default_providers.h"
 
-#if defined(__aarch64__) && defined(__linux__)
+#if defined(MLAS_SBGEMM_SUPPORTED)
 
 namespace onnxruntime {
 namespace test {
@@ -113,7 +114,8 @@ std::vector<MatMulTestData<T>> GenerateTestCases() {
 }
 
 template <typename T>
-void RunMatMulTest(int32_t opset_version, bool is_a_constant, bool is_b_constant, bool disable_fastmath) {
+void RunMatMulTest(int32_t opset_version, bool is_a_constant, bool is_b_constant, bool disable_fastmath,
+                   const char* fastmath_config_key = kOrtSessionOptionsMlasGemmFastMathBfloat16) {
   for (auto t : GenerateTestCases<T>()) {
     SCOPED_TRACE("test case: " + t.name);
 
@@ -144,8 +146,7 @@ void RunMatMulTest(int32_t opset_version, bool is_a_constant, bool is_b_constant
     }
 
     SessionOptions so;
-    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(
-        kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16, "1"));
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(fastmath_config_key, "1"));
 
     test.ConfigExcludeEps(excluded_providers)
         .Config(run_with_tunable_op)
@@ -153,8 +154,7 @@ void RunMatMulTest(int32_t opset_version, bool is_a_constant, bool is_b_constant
         .RunWithConfig();
 
     if (disable_fastmath) {
-      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(
-          kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16, "0"));
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(fastmath_config_key, "0"));
 
       test.ConfigExcludeEps(excluded_providers)
           .Config(run_with_tunable_op)
@@ -185,6 +185,15 @@ TEST(MathOpTest, MatMulFloatTypeInitializer_FastMath) {
   RunMatMulTest<float>(7, false, true, false);
 }
 
+// The former ARM64 specific option name is still honored.
+TEST(MathOpTest, MatMulFloatTypeInitializer_FastMathLegacyKey) {
+  // TODO: Unskip when fixed #41968513
+  if (DefaultDmlExecutionProvider().get() != nullptr) {
+    GTEST_SKIP() << "Skipping because of the following error: Assertion failed: m_bufferTensorDesc.TotalTensorSizeInBytes >= ComputeByteSizeFromDimensions(nonBroadcastDimensions, dataType)";
+  }
+  RunMatMulTest<float>(7, false, true, true, kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16);
+}
+
 TEST(MathOpTest, MatMulInt32Type_FastMath) {
   RunMatMulTest<int32_t>(9);
 }
@@ -237,7 +246,7 @@ TEST(MathOpTest, MatMulSharedPrepackedWeights_FastMath) {
   // Set up B as a shared initializer to be shared between sessions
   ASSERT_EQ(so.AddInitializer("B", &b), Status::OK());
   ASSERT_STATUS_OK(so.config_options.AddConfigEntry(
-      kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16, "1"));
+      kOrtSessionOptionsMlasGemmFastMathBfloat16, "1"));
 
   // We want all sessions running using this OpTester to be able to share pre-packed weights if applicable
   test.EnableSharingOfPrePackedWeightsAcrossSessions();
@@ -302,4 +311,4 @@ TEST(MathOpTest, MatMulUint64Type_DisableFastMath) {
 
 }  // namespace test
 }  // namespace onnxruntime
-#endif  // defined(__aarch64__) && defined(__linux__)
+#endif  // defined(MLAS_SBGEMM_SUPPORTED)
@@ -3,11 +3,13 @@
 
 #include "gtest/gtest.h"
 
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/providers/run_options_config_keys.h"
 #include "test/common/dnnl_op_test_utils.h"
 #include "test/common/cuda_op_test_utils.h"
 #include "test/common/tensor_op_test_utils.h"
+#include "test/util/include/temp_dir.h"
 #include "default_providers.h"
 
 namespace onnxruntime {
@@ -600,6 +602,97 @@ TEST(MathOpTest, MatMulSharedPrepackedWeights) {
   }
 }
 
+TEST(MathOpTest, MatMulBlockSparsePrepackedWeights) {
+  constexpr int64_t batch = 3, M = 2, K = 40, N = 37;
+
+  // Every other row of B is zero and the blocks of 16 columns of the other rows are zeros in turn.
+  std::vector<float> A(batch * M * K), B(K * N), Y(batch * M * N);
+  for (int64_t i = 0; i < batch * M * K; ++i) {
+    A[i] = static_cast<float>((i % 9) - 4) * 0.5f;
+  }
+  for (int64_t k = 0; k < K; ++k) {
+    for (int64_t n = 0; n < N; ++n) {
+      B[k * N + n] = (k % 2 == 0 && (k / 2 + n / 16) % 2 == 0) ? static_cast<float>(((k + n * 3) % 7) - 3) : 0.0f;
+    }
+  }
+  for (int64_t m = 0; m < batch * M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      float sum = 0.0f;
+      for (int64_t k = 0; k < K; ++k) {
+        sum += A[m * K + k] * B[k * N + n];
+      }
+      Y[m * N + n] = sum;
+    }
+  }
+
+  OpTester test("MatMul");
+  test.AddInput<float>("A", {batch, M, K}, A);
+  test.AddInput<float>("B", {K, N}, B, true);
+  test.AddOutput<float>("Y", {batch, M, N}, Y);
+  test.SetOutputTolerance(1e-4f);
+
+  SessionOptions so;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsBlockSparseWeightsMinZeroRatio, "0.7"));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  size_t number_of_pre_packed_weights_counter = 0;
+  test.Config(so)
+      .ConfigEps(std::move(execution_providers))
+      .RunWithConfig(&number_of_pre_packed_weights_counter);
+  ASSERT_EQ(number_of_pre_packed_weights_counter, static_cast<size_t>(1));
+}
+
+TEST(MathOpTest, MatMulPrepackedWeightsDiskCache) {
+  constexpr int64_t M = 3, K = 40, N = 37;
+
+  // Three quarters of the blocks of B are zeros, so that it is packed in the block sparse format when enabled.
+  std::vector<float> A(M * K), B(K * N), Y(M * N);
+  for (int64_t i = 0; i < M * K; ++i) {
+    A[i] = static_cast<float>((i % 9) - 4) * 0.5f;
+  }
+  for (int64_t k = 0; k < K; ++k) {
+    for (int64_t n = 0; n < N; ++n) {
+      B[k * N + n] = (k / 2 + n / 16) % 4 == 0 ? static_cast<float>(((k + n * 3) % 7) - 3) : 0.0f;
+    }
+  }
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      float sum = 0.0f;
+      for (int64_t k = 0; k < K; ++k) {
+        sum += A[m * K + k] * B[k * N + n];
+      }
+      Y[m * N + n] = sum;
+    }
+  }
+
+  // The first session writes the packed B to the cache, the second one restores the kernel from the cache entry.
+  for (const char* min_zero_ratio : {"0", "0.7"}) {
+    TemporaryDirectory cache_dir(ORT_TSTR("matmul_prepacked_weights_disk_cache_test"));
+    for (int i = 0; i < 2; ++i) {
+      OpTester test("MatMul");
+      test.AddInput<float>("A", {M, K}, A);
+      test.AddInput<float>("B", {K, N}, B, true);
+      test.AddOutput<float>("Y", {M, N}, Y);
+      test.SetOutputTolerance(1e-4f);
+
+      SessionOptions so;
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsBlockSparseWeightsMinZeroRatio,
+                                                        min_zero_ratio));
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsPrepackedWeightsCacheDir,
+                                                        PathToUTF8String(cache_dir.Path()).c_str()));
+
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCpuExecutionProvider());
+      size_t number_of_pre_packed_weights_counter = 0;
+      test.Config(so)
+          .ConfigEps(std::move(execution_providers))
+          .RunWithConfig(&number_of_pre_packed_weights_counter);
+      ASSERT_EQ(number_of_pre_packed_weights_counter, static_cast<size_t>(1));
+    }
+  }
+}
+
 #endif
 
 }  // namespace test
@@ -861,5 +861,47 @@ TEST(TopKOperator, SelectTopKThreaded) {
   TestThreaded<double>(k, n, batch_size);
 }
 
+// rows of a large vocabulary use the vectorized MLAS selection. the values repeat to check the order of equal values,
+// and the last row is mostly infinities so it falls back to the full ordering.
+static void TestLargeVocabulary(int64_t k, int64_t largest, int64_t sorted) {
+  constexpr int64_t rows = 3;
+  constexpr int64_t vocab_size = 32000;
+  const float infinity = std::numeric_limits<float>::infinity();
+
+  std::vector<float> input_vals(rows * vocab_size);
+  for (int64_t i = 0; i < rows * vocab_size; ++i) {
+    input_vals[i] = static_cast<float>((i * 7919) % 1000) * 0.5f;
+  }
+  std::fill(input_vals.begin() + 2 * vocab_size, input_vals.end(), largest ? -infinity : infinity);
+  input_vals[2 * vocab_size + 100] = 1.0f;
+  input_vals[2 * vocab_size + 20000] = 1.0f;
+
+  std::vector<float> expected_vals;
+  std::vector<int64_t> expected_indices;
+  for (int64_t i = 0; i < rows; ++i) {
+    const float* row = input_vals.data() + i * vocab_size;
+    std::vector<int64_t> order(vocab_size);
+    std::iota(order.begin(), order.end(), int64_t{0});
+    std::stable_sort(order.begin(), order.end(), [row, largest](int64_t lhs, int64_t rhs) {
+      return largest ? row[lhs] > row[rhs] : row[lhs] < row[rhs];
+    });
+    for (int64_t l = 0; l < k; ++l) {
+      expected_vals.push_back(row[order[l]]);
+      expected_indices.push_back(order[l]);
+    }
+  }
+
+  RunTest(11, k, input_vals, {rows, vocab_size}, expected_vals, expected_indices, {rows, k}, false, -1, largest,
+          sorted);
+}
+
+TEST(TopKOperator, LargeVocabulary) {
+  for (int64_t k : {2, 50, 1000}) {
+    TestLargeVocabulary(k, 1, 1);
+    TestLargeVocabulary(k, 0, 1);
+  }
+  TestLargeVocabulary(50, 1, 0);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
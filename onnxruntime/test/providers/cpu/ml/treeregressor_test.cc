@@ -1,8 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <limits>
 #include "gtest/gtest.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/asserts.h"
 
 namespace onnxruntime {
 namespace test {
@@ -30,9 +33,16 @@ void _multiply_update_array_string(std::vector<std::string>& data, int n) {
   }
 }
 
+// Runs the test with the block traversal enabled (see kOrtSessionOptionsTreeEnsembleBlockTraversal).
+void RunWithBlockTraversal(OpTester& test) {
+  SessionOptions so;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsTreeEnsembleBlockTraversal, "1"));
+  test.Run(so);
+}
+
 template <typename T>
 void GenTreeAndRunTest(int opsetml, const std::vector<T>& X, const std::vector<float>& base_values, const std::vector<float>& results, const std::string& aggFunction,
-                       bool one_obs = false, int64_t n_obs = 8, int n_trees = 1) {
+                       bool one_obs = false, int64_t n_obs = 8, int n_trees = 1, bool block_traversal = false) {
   OpTester test("TreeEnsembleRegressor", opsetml, onnxruntime::kMLDomain);
 
   // tree
@@ -121,7 +131,11 @@ void GenTreeAndRunTest(int opsetml, const std::vector<T>& X, const std::vector<f
     test.AddOutput<float>("Y", {n_obs, 2}, yn);
   }
 
-  test.Run();
+  if (block_traversal) {
+    RunWithBlockTraversal(test);
+  } else {
+    test.Run();
+  }
 }  // namespace test
 
 template <typename T, typename TH>
@@ -295,6 +309,16 @@ TEST(MLOpTest, TreeRegressorMultiTargetBatchTreeE2) {
   GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 200, 1);  // section E2
 }
 
+TEST(MLOpTest, TreeRegressorMultiTargetBlockTraversal) {
+  std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
+  std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+  std::vector<float> base_values{0.f, 0.f};
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 8, 1, true);     // section C2
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 400, 130, true);  // section C2
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 200, 30, true);   // section D2
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", true, 8, 1, true);      // section A2, node by node
+}
+
 TEST(MLOpTest, TreeRegressorMultiTargetAverage) {
   std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
   std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
@@ -336,7 +360,8 @@ TEST(MLOpTest, TreeRegressorMultiTargetMaxDouble) {
   GenTreeAndRunTest<double>(3, X, base_values, results, "MAX", true);
 }
 
-void GenTreeAndRunTest1(int opsetml, const std::string& aggFunction, bool one_obs, int64_t n_obs = 3, int n_trees = 1) {
+void GenTreeAndRunTest1(int opsetml, const std::string& aggFunction, bool one_obs, int64_t n_obs = 3, int n_trees = 1,
+                        bool block_traversal = false) {
   OpTester test("TreeEnsembleRegressor", opsetml, onnxruntime::kMLDomain);
 
   // tree
@@ -430,7 +455,11 @@ void GenTreeAndRunTest1(int opsetml, const std::string& aggFunction, bool one_ob
     test.AddInput<float>("X", {n_obs, 2}, xn);
     test.AddOutput<float>("Y", {n_obs, 1}, yn);
   }
-  test.Run();
+  if (block_traversal) {
+    RunWithBlockTraversal(test);
+  } else {
+    test.Run();
+  }
 }
 
 void GenTreeAndRunTest1_as_tensor(int opsetml, const std::string& aggFunction, bool one_obs, int64_t n_obs = 3, int n_trees = 1) {
@@ -596,6 +625,15 @@ TEST(MLOpTest, TreeRegressorSingleTargetBatchTreeE) {
   GenTreeAndRunTest1(3, "AVERAGE", false, 201, 1);  // section E
 }
 
+TEST(MLOpTest, TreeRegressorSingleTargetBlockTraversal) {
+  GenTreeAndRunTest1(3, "SUM", false, 3, 1, true);        // section C
+  GenTreeAndRunTest1(3, "SUM", false, 1023, 1, true);     // section C, several blocks of rows
+  GenTreeAndRunTest1(3, "AVERAGE", false, 201, 30, true);  // section D
+  GenTreeAndRunTest1(3, "MIN", false, 201, 130, true);     // section D
+  GenTreeAndRunTest1(3, "MAX", false, 201, 1, true);       // section E, node by node
+  GenTreeAndRunTest1(3, "SUM", true, 3, 1, true);          // section A, node by node
+}
+
 TEST(MLOpTest, TreeRegressorSingleTargetAverage) {
   GenTreeAndRunTest1(1, "AVERAGE", false);
   GenTreeAndRunTest1(3, "AVERAGE", false);
@@ -885,5 +923,108 @@ TEST(MLOpTest, TreeRegressorBranchEq) {
   test.Run();
 }
 
+TEST(MLOpTest, TreeRegressorBranchLtMissingTracks) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  // tree, the first leaf is above the last level
+  int64_t n_targets = 1;
+  std::vector<int64_t> nodes_featureids = {0, 0, 1, 0, 0};
+  std::vector<std::string> nodes_modes = {"BRANCH_LT", "LEAF", "BRANCH_LT", "LEAF", "LEAF"};
+  std::vector<float> nodes_values = {0.5, 0.0, 0.0, 0.0, 0.0};
+  std::vector<int64_t> nodes_treeids = {0, 0, 0, 0, 0};
+  std::vector<int64_t> nodes_nodeids = {0, 1, 2, 3, 4};
+  std::vector<int64_t> nodes_falsenodeids = {2, 0, 4, 0, 0};
+  std::vector<int64_t> nodes_truenodeids = {1, 0, 3, 0, 0};
+  std::vector<int64_t> nodes_missing_value_tracks_true = {1, 0, 0, 0, 0};
+
+  std::string post_transform = "NONE";
+  std::vector<int64_t> target_ids = {0, 0, 0};
+  std::vector<int64_t> target_nodeids = {1, 3, 4};
+  std::vector<int64_t> target_treeids = {0, 0, 0};
+  std::vector<float> target_weights = {1.0, 2.0, 3.0};
+
+  // add attributes
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("nodes_missing_value_tracks_true", nodes_missing_value_tracks_true);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", n_targets);
+
+  // fill input data
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> X = {0.2f, 9.0f, 0.5f, -1.0f, 0.7f, 0.0f, nan, 5.0f, 0.9f, nan};
+  std::vector<float> Y = {1.0f, 2.0f, 3.0f, 1.0f, 3.0f};
+  test.AddInput<float>("X", {5, 2}, X);
+  test.AddOutput<float>("Y", {5, 1}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorDeepTree) {
+  // a chain of 10 nodes is too deep to be packed as a perfect binary tree,
+  // a chain of 8 nodes would be more than 4 times larger once padded
+  for (int64_t depth : {10, 8}) {
+    OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+    int64_t n_targets = 1;
+    std::vector<int64_t> nodes_featureids, nodes_treeids, nodes_nodeids, nodes_falsenodeids, nodes_truenodeids;
+    std::vector<std::string> nodes_modes;
+    std::vector<float> nodes_values;
+    std::vector<int64_t> target_ids, target_nodeids, target_treeids;
+    std::vector<float> target_weights;
+    for (int64_t i = 0; i <= depth; ++i) {
+      const bool is_leaf = i == depth;
+      nodes_treeids.insert(nodes_treeids.end(), is_leaf ? 1 : 2, 0);
+      nodes_featureids.insert(nodes_featureids.end(), is_leaf ? 1 : 2, 0);
+      if (!is_leaf) {
+        // node 2i: x <= i, true branch goes to leaf 2i+1
+        nodes_nodeids.insert(nodes_nodeids.end(), {2 * i, 2 * i + 1});
+        nodes_modes.insert(nodes_modes.end(), {"BRANCH_LEQ", "LEAF"});
+        nodes_values.insert(nodes_values.end(), {static_cast<float>(i), 0.f});
+        nodes_truenodeids.insert(nodes_truenodeids.end(), {2 * i + 1, 0});
+        nodes_falsenodeids.insert(nodes_falsenodeids.end(), {2 * i + 2, 0});
+      } else {
+        nodes_nodeids.push_back(2 * i);
+        nodes_modes.push_back("LEAF");
+        nodes_values.push_back(0.f);
+        nodes_truenodeids.push_back(0);
+        nodes_falsenodeids.push_back(0);
+      }
+      target_ids.push_back(0);
+      target_treeids.push_back(0);
+      target_nodeids.push_back(is_leaf ? 2 * i : 2 * i + 1);
+      target_weights.push_back(is_leaf ? 100.f : static_cast<float>(i));
+    }
+
+    // add attributes
+    test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+    test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+    test.AddAttribute("nodes_treeids", nodes_treeids);
+    test.AddAttribute("nodes_nodeids", nodes_nodeids);
+    test.AddAttribute("nodes_featureids", nodes_featureids);
+    test.AddAttribute("nodes_values", nodes_values);
+    test.AddAttribute("nodes_modes", nodes_modes);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_ids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("n_targets", n_targets);
+
+    // fill input data
+    std::vector<float> X = {-1.0f, 3.5f, static_cast<float>(depth - 2), 20.0f};
+    std::vector<float> Y = {0.0f, 4.0f, static_cast<float>(depth - 2), 100.0f};
+    test.AddInput<float>("X", {4, 1}, X);
+    test.AddOutput<float>("Y", {4, 1}, Y);
+    test.Run();
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
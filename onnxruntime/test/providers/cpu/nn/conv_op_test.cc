@@ -1,8 +1,12 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 #include "core/graph/constants.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/default_providers.h"
 
 using namespace std;
 namespace onnxruntime {
@@ -1046,5 +1050,63 @@ TEST(ConvTest, Conv_AutoPad_with_non_default_strides) {
   TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape, true);
 }
 
+// Winograd algorithm selected through the session options, with the filter pre-packed
+TEST(ConvTest, Conv2D_Winograd) {
+  constexpr int64_t N = 2, C = 3, M = 5, H = 7, W = 9;
+  vector<float> X(N * C * H * W);
+  vector<float> Wt(M * C * 3 * 3);
+  vector<float> B(M);
+  for (size_t i = 0; i < X.size(); ++i) X[i] = static_cast<float>(i % 13) / 13.0f - 0.5f;
+  for (size_t i = 0; i < Wt.size(); ++i) Wt[i] = static_cast<float>(i % 7) / 7.0f - 0.25f;
+  for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i) * 0.1f;
+
+  // pads of 1 keep the spatial shape
+  vector<float> Y(N * M * H * W);
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t m = 0; m < M; ++m) {
+      for (int64_t h = 0; h < H; ++h) {
+        for (int64_t w = 0; w < W; ++w) {
+          float sum = B[m];
+          for (int64_t c = 0; c < C; ++c) {
+            for (int64_t kh = 0; kh < 3; ++kh) {
+              for (int64_t kw = 0; kw < 3; ++kw) {
+                const int64_t ih = h + kh - 1, iw = w + kw - 1;
+                if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+                  sum += X[((n * C + c) * H + ih) * W + iw] * Wt[((m * C + c) * 3 + kh) * 3 + kw];
+                }
+              }
+            }
+          }
+          Y[((n * M + m) * H + h) * W + w] = sum;
+        }
+      }
+    }
+  }
+
+  for (const char* output_tile : {"4", "6"}) {
+    OpTester test("Conv", 11);
+    test.AddAttribute("kernel_shape", vector<int64_t>{3, 3});
+    test.AddAttribute("pads", vector<int64_t>{1, 1, 1, 1});
+    test.AddInput<float>("X", {N, C, H, W}, X);
+    test.AddInput<float>("W", {M, C, 3, 3}, Wt, true);
+    test.AddInput<float>("B", {M}, B, true);
+    test.AddOutput<float>("Y", {N, M, H, W}, Y);
+    test.SetOutputTolerance(1e-4f);
+
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConvWinograd, output_tile));
+
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    size_t number_of_pre_packed_weights_counter = 0;
+    test.Config(so)
+        .ConfigEps(std::move(execution_providers))
+        .RunWithConfig(&number_of_pre_packed_weights_counter);
+    // the platform convolution overrides disable the Winograd algorithm
+    const bool is_supported = MlasConvWinogradPackFilterSize(4, 1, C, M) != 0;
+    ASSERT_EQ(number_of_pre_packed_weights_counter, static_cast<size_t>(is_supported ? 1 : 0)) << output_tile;
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -404,5 +404,36 @@ TEST(NonMaxSuppressionOpTest, WithIOUThresholdOpset11) {
   test.Run();
 }
 
+TEST(NonMaxSuppressionOpTest, ManySelectedBoxes) {
+  // 40 disjoint boxes in a row, and a shifted duplicate of each box with a lower score that is suppressed.
+  // The selected boxes span several blocks of the selection.
+  constexpr int64_t num_boxes = 40;
+  std::vector<float> boxes;
+  std::vector<float> scores(2 * 2 * num_boxes);
+  for (int64_t i = 0; i < 2 * num_boxes; ++i) {
+    const float x = static_cast<float>(i % num_boxes) * 2.0f + (i < num_boxes ? 0.0f : 0.05f);
+    boxes.insert(boxes.end(), {0.0f, x, 1.0f, x + 1.0f});
+    // class 0 selects the boxes in index order, class 1 in reverse index order
+    scores[i] = i < num_boxes ? 0.9f - 0.01f * i : 0.4f;
+    scores[2 * num_boxes + i] = i < num_boxes ? 0.1f + 0.01f * i : 0.05f;
+  }
+
+  std::vector<int64_t> selected_indices;
+  for (int64_t class_index = 0; class_index < 2; ++class_index) {
+    for (int64_t i = 0; i < num_boxes; ++i) {
+      selected_indices.insert(selected_indices.end(), {0, class_index, class_index == 0 ? i : num_boxes - 1 - i});
+    }
+  }
+
+  OpTester test("NonMaxSuppression", 11, kOnnxDomain);
+  test.AddInput<float>("boxes", {1, 2 * num_boxes, 4}, boxes);
+  test.AddInput<float>("scores", {1, 2, 2 * num_boxes}, scores);
+  test.AddInput<int64_t>("max_output_boxes_per_class", {}, {100L});
+  test.AddInput<float>("iou_threshold", {}, {0.5f});
+  test.AddInput<float>("score_threshold", {}, {0.0f});
+  test.AddOutput<int64_t>("selected_indices", {2 * num_boxes, 3}, selected_indices);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -2,6 +2,7 @@
 #include "test/providers/provider_test_utils.h"
 #include "test/util/include/default_providers.h"
 
+#include <cmath>
 #include <limits>
 
 namespace onnxruntime {
@@ -1007,5 +1008,54 @@ TYPED_TEST(GridSampleTest, test_grid_sample_20_4D_bicubic_reflection_no_align_co
   RunTests(test, GetExecutionProviders(20));
 }
 
+// The output points of an image are sampled by tiles that are shared by the channels. Check a grid of several
+// tiles, with a partial last tile and locations beyond the borders, against a reference bilinear sampling.
+TEST(GridSampleOpTest, Bilinear_MultipleTiles) {
+  constexpr int64_t N = 2, C = 3, H_in = 7, W_in = 9, H_out = 17, W_out = 33;
+
+  std::vector<float> X_data(N * C * H_in * W_in);
+  for (size_t i = 0; i < X_data.size(); ++i) {
+    X_data[i] = static_cast<float>(static_cast<int64_t>(i * 37 % 101) - 50) / 25.0f;
+  }
+  std::vector<float> Grid_data(N * H_out * W_out * 2);
+  for (size_t i = 0; i < Grid_data.size(); ++i) {
+    Grid_data[i] = static_cast<float>(static_cast<int64_t>(i * 53 % 97) - 48) / 40.0f;
+  }
+
+  // zeros padding, align_corners = 0
+  auto pixel = [&](const float* image, int64_t r, int64_t c) {
+    return (r >= 0 && r < H_in && c >= 0 && c < W_in) ? image[r * W_in + c] : 0.0f;
+  };
+  std::vector<float> Y_data(N * C * H_out * W_out);
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      const float* image = X_data.data() + (n * C + c) * H_in * W_in;
+      for (int64_t i = 0; i < H_out * W_out; ++i) {
+        const float* gridpoint = Grid_data.data() + (n * H_out * W_out + i) * 2;
+        const float x = ((gridpoint[0] + 1) * W_in - 1) / 2.f;
+        const float y = ((gridpoint[1] + 1) * H_in - 1) / 2.f;
+        const int64_t x1 = static_cast<int64_t>(std::floor(x));
+        const int64_t y1 = static_cast<int64_t>(std::floor(y));
+        const float dx1 = x - static_cast<float>(x1);
+        const float dx2 = static_cast<float>(x1 + 1) - x;
+        const float dy1 = y - static_cast<float>(y1);
+        const float dy2 = static_cast<float>(y1 + 1) - y;
+        Y_data[(n * C + c) * H_out * W_out + i] =
+            dy2 * (dx2 * pixel(image, y1, x1) + dx1 * pixel(image, y1, x1 + 1)) +
+            dy1 * (dx2 * pixel(image, y1 + 1, x1) + dx1 * pixel(image, y1 + 1, x1 + 1));
+      }
+    }
+  }
+
+  OpTester test("GridSample", 16);
+  test.AddInput<float>("X", {N, C, H_in, W_in}, X_data);
+  test.AddInput<float>("Grid", {N, H_out, W_out, 2}, Grid_data);
+  test.AddAttribute("mode", std::string("bilinear"));
+  test.AddAttribute("padding_mode", std::string("zeros"));
+  test.AddAttribute("align_corners", int64_t{0});
+  test.AddOutput<float>("Y", {N, C, H_out, W_out}, Y_data);
+  RunTests(test, GetExecutionProviders(16));
+}
+
 }  // namespace test
 }  // namespace onnxruntime